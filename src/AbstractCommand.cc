@@ -340,6 +340,9 @@ bool AbstractCommand::execute()
       throw DL_RETRY_EX2(EX_TIME_OUT, error_code::TIME_OUT);
     }
 
+    auto deadline = checkPoint_;
+    deadline.advance(timeout_);
+    e_->addTimer(deadline, this);
     addCommandSelf();
     return false;
   }
@@ -464,6 +467,9 @@ bool AbstractCommand::prepareForRetry(time_t wait)
     // We don't use wait so that Command can be executed by
     // DownloadEngine::setRefreshInterval(std::chrono::milliseconds(0)).
     command->setStatus(Command::STATUS_INACTIVE);
+    auto deadline = global::wallclock();
+    deadline.advance(std::chrono::seconds(wait));
+    e_->addTimer(deadline, command.get());
   }
   e_->addCommand(std::move(command));
   return true;
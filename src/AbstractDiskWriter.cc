@@ -39,10 +39,14 @@
 #  include <sys/mman.h>
 #endif // HAVE_MMAP
 #include <fcntl.h>
+#ifdef HAVE_SYS_UIO_H
+#  include <sys/uio.h>
+#endif // HAVE_SYS_UIO_H
 
 #include <cerrno>
 #include <cstring>
 #include <cassert>
+#include <climits>
 
 #include "File.h"
 #include "util.h"
@@ -53,6 +57,12 @@
 #include "DownloadFailureException.h"
 #include "error_code.h"
 #include "LogFactory.h"
+#ifdef ENABLE_THREADS
+#  include <vector>
+
+#  include "ThreadPool.h"
+#  include "a2functional.h"
+#endif // ENABLE_THREADS
 
 namespace aria2 {
 
@@ -67,7 +77,10 @@ AbstractDiskWriter::AbstractDiskWriter(const std::string& filename)
       enableMmap_(false),
       mapaddr_(nullptr),
       maplen_(0)
-
+#ifdef ENABLE_THREADS
+      ,
+      pendingWriteLength_(0)
+#endif // ENABLE_THREADS
 {
 }
 
@@ -130,6 +143,19 @@ void AbstractDiskWriter::openFile(int64_t totalLength)
 
 void AbstractDiskWriter::closeFile()
 {
+#ifdef ENABLE_THREADS
+  // This function is called from destructor, so that errors of
+  // queued writes cannot be thrown here.
+  for (;;) {
+    try {
+      waitWrite();
+      break;
+    }
+    catch (RecoverableException& e) {
+      A2_LOG_ERROR_EX(fmt("Writing file %s failed", filename_.c_str()), e);
+    }
+  }
+#endif // ENABLE_THREADS
 #if defined(HAVE_MMAP) || defined(__MINGW32__)
   if (mapaddr_) {
     int errNum = 0;
@@ -235,6 +261,7 @@ int openFileWithFlags(const std::string& filename, int flags,
 
 void AbstractDiskWriter::openExistingFile(int64_t totalLength)
 {
+  waitWrite();
   int flags = O_BINARY;
   if (readOnly_) {
     flags |= O_RDONLY;
@@ -248,6 +275,7 @@ void AbstractDiskWriter::openExistingFile(int64_t totalLength)
 void AbstractDiskWriter::createFile(int addFlags)
 {
   assert(!filename_.empty());
+  waitWrite();
   util::mkdirs(File(filename_).getDirname());
   fd_ = openFileWithFlags(filename_,
                           O_CREAT | O_RDWR | O_TRUNC | O_BINARY | addFlags,
@@ -263,7 +291,9 @@ ssize_t AbstractDiskWriter::writeDataInternal(const unsigned char* data,
   }
   else {
     ssize_t writtenLength = 0;
+#if defined(__MINGW32__) || !defined(HAVE_PWRITE)
     seek(offset);
+#endif // __MINGW32__ || !HAVE_PWRITE
     while ((size_t)writtenLength < len) {
 #ifdef __MINGW32__
       DWORD nwrite;
@@ -276,10 +306,17 @@ ssize_t AbstractDiskWriter::writeDataInternal(const unsigned char* data,
       }
 #else  // !__MINGW32__
       ssize_t ret = 0;
+#  ifdef HAVE_PWRITE
+      while ((ret = a2pwrite(fd_, data + writtenLength, len - writtenLength,
+                             offset + writtenLength)) == -1 &&
+             errno == EINTR)
+        ;
+#  else  // !HAVE_PWRITE
       while ((ret = write(fd_, data + writtenLength, len - writtenLength)) ==
                  -1 &&
              errno == EINTR)
         ;
+#  endif // !HAVE_PWRITE
       if (ret == -1) {
         return -1;
       }
@@ -302,7 +339,9 @@ ssize_t AbstractDiskWriter::readDataInternal(unsigned char* data, size_t len,
     return readlen;
   }
   else {
+#if defined(__MINGW32__) || !defined(HAVE_PREAD)
     seek(offset);
+#endif // __MINGW32__ || !HAVE_PREAD
 #ifdef __MINGW32__
     DWORD nread;
     if (ReadFile(fd_, data, len, &nread, 0)) {
@@ -313,13 +352,62 @@ ssize_t AbstractDiskWriter::readDataInternal(unsigned char* data, size_t len,
     }
 #else  // !__MINGW32__
     ssize_t ret = 0;
+#  ifdef HAVE_PREAD
+    while ((ret = a2pread(fd_, data, len, offset)) == -1 && errno == EINTR)
+      ;
+#  else  // !HAVE_PREAD
     while ((ret = read(fd_, data, len)) == -1 && errno == EINTR)
       ;
+#  endif // !HAVE_PREAD
     return ret;
 #endif // !__MINGW32__
   }
 }
 
+#ifdef HAVE_PWRITEV
+bool AbstractDiskWriter::writeDataVectorInternal(const DataBuffers& bufs,
+                                                 int64_t offset)
+{
+  std::vector<struct iovec> iov;
+  iov.reserve(bufs.size());
+  for (auto& buf : bufs) {
+    if (buf.second == 0) {
+      continue;
+    }
+    iov.push_back({const_cast<unsigned char*>(buf.first), buf.second});
+  }
+  size_t first = 0;
+  while (first < iov.size()) {
+    int iovcnt = std::min(iov.size() - first, static_cast<size_t>(IOV_MAX));
+    ssize_t ret;
+    while ((ret = a2pwritev(fd_, &iov[first], iovcnt, offset)) == -1 &&
+           errno == EINTR)
+      ;
+    if (ret == -1) {
+      return false;
+    }
+    if (ret == 0) {
+      // Nothing was written although the buffers are not empty.
+      // Retrying would loop forever.
+      errno = EIO;
+      return false;
+    }
+    offset += ret;
+    // Skip the buffers written completely, and adjust the partially
+    // written one.
+    for (; first < iov.size() && static_cast<size_t>(ret) >= iov[first].iov_len;
+         ++first) {
+      ret -= iov[first].iov_len;
+    }
+    if (first < iov.size()) {
+      iov[first].iov_base = static_cast<char*>(iov[first].iov_base) + ret;
+      iov[first].iov_len -= ret;
+    }
+  }
+  return true;
+}
+#endif // HAVE_PWRITEV
+
 void AbstractDiskWriter::seek(int64_t offset)
 {
   assert(offset >= 0);
@@ -441,26 +529,125 @@ bool isDiskFullError(int errNum)
 }
 } // namespace
 
+#ifdef ENABLE_THREADS
+namespace {
+// The maximum number of bytes queued for the worker thread per file.
+// When exceeded, writeData() waits for the disk.
+constexpr size_t MAX_PENDING_WRITE_LENGTH = 4_m;
+} // namespace
+
+void AbstractDiskWriter::reapPendingWrites(size_t maxLength)
+{
+  while (!pendingWrites_.empty()) {
+    auto& front = pendingWrites_.front();
+    if (pendingWriteLength_ <= maxLength &&
+        front.future.wait_for(std::chrono::seconds(0)) !=
+            std::future_status::ready) {
+      return;
+    }
+    auto future = std::move(front.future);
+    pendingWriteLength_ -= front.length;
+    pendingWrites_.pop_front();
+    future.get();
+  }
+}
+#endif // ENABLE_THREADS
+
+void AbstractDiskWriter::waitWrite()
+{
+#ifdef ENABLE_THREADS
+  while (!pendingWrites_.empty()) {
+    auto future = std::move(pendingWrites_.front().future);
+    pendingWriteLength_ -= pendingWrites_.front().length;
+    pendingWrites_.pop_front();
+    future.get();
+  }
+#endif // ENABLE_THREADS
+}
+
+#ifdef ENABLE_THREADS
+void AbstractDiskWriter::queueWrite(
+    std::shared_ptr<std::vector<unsigned char>> buf, int64_t offset)
+{
+  reapPendingWrites(MAX_PENDING_WRITE_LENGTH);
+  auto len = buf->size();
+  pendingWrites_.push_back(
+      {writeThreadPool_->submit([this, buf, offset]() {
+         writeDataOrThrow(buf->data(), buf->size(), offset);
+       }),
+       len});
+  pendingWriteLength_ += len;
+}
+#endif // ENABLE_THREADS
+
 void AbstractDiskWriter::writeData(const unsigned char* data, size_t len,
                                    int64_t offset)
 {
+#ifdef ENABLE_THREADS
+  if (writeThreadPool_ && !enableMmap_) {
+    queueWrite(std::make_shared<std::vector<unsigned char>>(data, data + len),
+               offset);
+    return;
+  }
+#endif // ENABLE_THREADS
+  waitWrite();
   ensureMmapWrite(len, offset);
-  if (writeDataInternal(data, len, offset) < 0) {
-    int errNum = fileError();
-    // If the error indicates disk full situation, throw
-    // DownloadFailureException and abort download instantly.
-    if (isDiskFullError(errNum)) {
-      throw DOWNLOAD_FAILURE_EXCEPTION3(
-          errNum,
-          fmt(EX_FILE_WRITE, filename_.c_str(), fileStrerror(errNum).c_str()),
-          error_code::NOT_ENOUGH_DISK_SPACE);
+  writeDataOrThrow(data, len, offset);
+}
+
+void AbstractDiskWriter::writeDataVector(const DataBuffers& bufs,
+                                         int64_t offset)
+{
+  if (bufs.size() == 1) {
+    writeData(bufs[0].first, bufs[0].second, offset);
+    return;
+  }
+#ifdef ENABLE_THREADS
+  if (writeThreadPool_ && !enableMmap_) {
+    // Join the buffers, so that the worker thread writes them at once.
+    auto data = std::make_shared<std::vector<unsigned char>>();
+    for (auto& buf : bufs) {
+      data->insert(std::end(*data), buf.first, buf.first + buf.second);
     }
-    else {
-      throw DL_ABORT_EX3(
-          errNum,
-          fmt(EX_FILE_WRITE, filename_.c_str(), fileStrerror(errNum).c_str()),
-          error_code::FILE_IO_ERROR);
+    queueWrite(std::move(data), offset);
+    return;
+  }
+#endif // ENABLE_THREADS
+#ifdef HAVE_PWRITEV
+  if (!enableMmap_) {
+    waitWrite();
+    if (!writeDataVectorInternal(bufs, offset)) {
+      throwWriteError(fileError());
     }
+    return;
+  }
+#endif // HAVE_PWRITEV
+  writeDataBuffers(*this, bufs, offset);
+}
+
+void AbstractDiskWriter::writeDataOrThrow(const unsigned char* data,
+                                          size_t len, int64_t offset)
+{
+  if (writeDataInternal(data, len, offset) < 0) {
+    throwWriteError(fileError());
+  }
+}
+
+void AbstractDiskWriter::throwWriteError(int errNum)
+{
+  // If the error indicates disk full situation, throw
+  // DownloadFailureException and abort download instantly.
+  if (isDiskFullError(errNum)) {
+    throw DOWNLOAD_FAILURE_EXCEPTION3(
+        errNum,
+        fmt(EX_FILE_WRITE, filename_.c_str(), fileStrerror(errNum).c_str()),
+        error_code::NOT_ENOUGH_DISK_SPACE);
+  }
+  else {
+    throw DL_ABORT_EX3(
+        errNum,
+        fmt(EX_FILE_WRITE, filename_.c_str(), fileStrerror(errNum).c_str()),
+        error_code::FILE_IO_ERROR);
   }
 }
 
@@ -468,6 +655,7 @@ ssize_t AbstractDiskWriter::readData(unsigned char* data, size_t len,
                                      int64_t offset)
 {
   ssize_t ret;
+  waitWrite();
   if ((ret = readDataInternal(data, len, offset)) < 0) {
     int errNum = fileError();
     throw DL_ABORT_EX3(
@@ -480,6 +668,7 @@ ssize_t AbstractDiskWriter::readData(unsigned char* data, size_t len,
 
 void AbstractDiskWriter::truncate(int64_t length)
 {
+  waitWrite();
   if (fd_ == A2_BAD_FD) {
     throw DL_ABORT_EX("File not yet opened.");
   }
@@ -501,6 +690,7 @@ void AbstractDiskWriter::truncate(int64_t length)
 
 void AbstractDiskWriter::allocate(int64_t offset, int64_t length, bool sparse)
 {
+  waitWrite();
   if (fd_ == A2_BAD_FD) {
     throw DL_ABORT_EX("File not yet opened.");
   }
@@ -575,7 +765,11 @@ void AbstractDiskWriter::allocate(int64_t offset, int64_t length, bool sparse)
 #endif // HAVE_SOME_FALLOCATE
 }
 
-int64_t AbstractDiskWriter::size() { return File(filename_).size(); }
+int64_t AbstractDiskWriter::size()
+{
+  waitWrite();
+  return File(filename_).size();
+}
 
 void AbstractDiskWriter::enableReadOnly() { readOnly_ = true; }
 
@@ -590,4 +784,22 @@ void AbstractDiskWriter::dropCache(int64_t len, int64_t offset)
 #endif // HAVE_POSIX_FADVISE
 }
 
+int AbstractDiskWriter::getReadFd()
+{
+#ifdef __MINGW32__
+  return -1;
+#else  // !__MINGW32__
+  waitWrite();
+  return fd_;
+#endif // !__MINGW32__
+}
+
+#ifdef ENABLE_THREADS
+void AbstractDiskWriter::enableAsyncWrite(
+    std::shared_ptr<ThreadPool> threadPool)
+{
+  writeThreadPool_ = std::move(threadPool);
+}
+#endif // ENABLE_THREADS
+
 } // namespace aria2
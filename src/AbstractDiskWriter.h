@@ -37,6 +37,10 @@
 
 #include "DiskWriter.h"
 #include <string>
+#ifdef ENABLE_THREADS
+#  include <deque>
+#  include <future>
+#endif // ENABLE_THREADS
 
 namespace aria2 {
 
@@ -58,8 +62,47 @@ private:
   unsigned char* mapaddr_;
   int64_t maplen_;
 
+#ifdef ENABLE_THREADS
+  std::shared_ptr<ThreadPool> writeThreadPool_;
+
+  struct PendingWrite {
+    std::future<void> future;
+    size_t length;
+  };
+
+  // Writes handed to writeThreadPool_, oldest first.
+  std::deque<PendingWrite> pendingWrites_;
+
+  // The sum of the length of pendingWrites_.
+  size_t pendingWriteLength_;
+
+  // Removes completed writes from pendingWrites_ and waits for the
+  // oldest ones while pendingWriteLength_ exceeds |maxLength|.  The
+  // exception thrown by a failed write is rethrown.
+  void reapPendingWrites(size_t maxLength);
+
+  // Queues |buf| to be written at |offset| by writeThreadPool_.
+  void queueWrite(std::shared_ptr<std::vector<unsigned char>> buf,
+                  int64_t offset);
+#endif // ENABLE_THREADS
+
+  // Waits for all writes handed to the worker thread.  This is no-op
+  // unless async write is enabled.
+  void waitWrite();
+
   ssize_t writeDataInternal(const unsigned char* data, size_t len,
                             int64_t offset);
+
+  void writeDataOrThrow(const unsigned char* data, size_t len,
+                        int64_t offset);
+
+#ifdef HAVE_PWRITEV
+  // Writes |bufs| using pwritev.  Returns false if it fails.
+  bool writeDataVectorInternal(const DataBuffers& bufs, int64_t offset);
+#endif // HAVE_PWRITEV
+
+  // Throws exception for write error |errNum|.
+  void throwWriteError(int errNum);
   ssize_t readDataInternal(unsigned char* data, size_t len, int64_t offset);
 
   void seek(int64_t offset);
@@ -82,6 +125,9 @@ public:
   virtual void writeData(const unsigned char* data, size_t len,
                          int64_t offset) CXX11_OVERRIDE;
 
+  virtual void writeDataVector(const DataBuffers& bufs,
+                               int64_t offset) CXX11_OVERRIDE;
+
   virtual ssize_t readData(unsigned char* data, size_t len,
                            int64_t offset) CXX11_OVERRIDE;
 
@@ -100,6 +146,13 @@ public:
   virtual void enableMmap() CXX11_OVERRIDE;
 
   virtual void dropCache(int64_t len, int64_t offset) CXX11_OVERRIDE;
+
+  virtual int getReadFd() CXX11_OVERRIDE;
+
+#ifdef ENABLE_THREADS
+  virtual void
+  enableAsyncWrite(std::shared_ptr<ThreadPool> threadPool) CXX11_OVERRIDE;
+#endif // ENABLE_THREADS
 };
 
 } // namespace aria2
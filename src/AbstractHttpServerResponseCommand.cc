@@ -128,6 +128,9 @@ bool AbstractHttpServerResponseCommand::execute()
     }
     else {
       updateReadWriteCheck();
+      auto deadline = timeoutTimer_;
+      deadline.advance(30_s);
+      e_->addTimer(deadline, this);
       e_->addCommand(std::unique_ptr<Command>(this));
       return false;
     }
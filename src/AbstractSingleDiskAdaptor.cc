@@ -94,13 +94,17 @@ ssize_t AbstractSingleDiskAdaptor::readDataDropCache(unsigned char* data,
   return rv;
 }
 
-void AbstractSingleDiskAdaptor::writeCache(const WrDiskCacheEntry* entry)
+void AbstractSingleDiskAdaptor::writeDataVector(const DataBuffers& bufs,
+                                                int64_t offset)
 {
-  for (auto& d : entry->getDataSet()) {
-    A2_LOG_DEBUG(fmt("Cache flush goff=%" PRId64 ", len=%lu", d->goff,
-                     static_cast<unsigned long>(d->len)));
-    writeData(d->data + d->offset, d->len, d->goff);
-  }
+  diskWriter_->writeDataVector(bufs, offset);
+}
+
+int AbstractSingleDiskAdaptor::getReadFd(int64_t offset, int64_t& fileOffset,
+                                         size_t& len)
+{
+  fileOffset = offset;
+  return diskWriter_->getReadFd();
 }
 
 bool AbstractSingleDiskAdaptor::fileExists()
@@ -147,6 +151,14 @@ void AbstractSingleDiskAdaptor::disableReadOnly()
 
 void AbstractSingleDiskAdaptor::enableMmap() { diskWriter_->enableMmap(); }
 
+#ifdef ENABLE_THREADS
+void AbstractSingleDiskAdaptor::enableAsyncWrite(
+    std::shared_ptr<ThreadPool> threadPool)
+{
+  diskWriter_->enableAsyncWrite(std::move(threadPool));
+}
+#endif // ENABLE_THREADS
+
 void AbstractSingleDiskAdaptor::cutTrailingGarbage()
 {
   if (File(getFilePath()).size() > totalLength_) {
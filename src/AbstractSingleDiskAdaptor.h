@@ -70,7 +70,11 @@ public:
   virtual ssize_t readDataDropCache(unsigned char* data, size_t len,
                                     int64_t offset) CXX11_OVERRIDE;
 
-  virtual void writeCache(const WrDiskCacheEntry* entry) CXX11_OVERRIDE;
+  virtual void writeDataVector(const DataBuffers& bufs,
+                               int64_t offset) CXX11_OVERRIDE;
+
+  virtual int getReadFd(int64_t offset, int64_t& fileOffset,
+                        size_t& len) CXX11_OVERRIDE;
 
   virtual bool fileExists() CXX11_OVERRIDE;
 
@@ -91,6 +95,12 @@ public:
 
   virtual void enableMmap() CXX11_OVERRIDE;
 
+#ifdef ENABLE_THREADS
+  // Make sure that DiskWriter is set before calling this function.
+  virtual void
+  enableAsyncWrite(std::shared_ptr<ThreadPool> threadPool) CXX11_OVERRIDE;
+#endif // ENABLE_THREADS
+
   virtual void cutTrailingGarbage() CXX11_OVERRIDE;
 
   virtual const std::string& getFilePath() = 0;
@@ -124,6 +124,9 @@ bool ActivePeerConnectionCommand::execute()
       }
     }
   }
+  auto deadline = checkPoint_;
+  deadline.advance(interval_);
+  e_->addTimer(deadline, this);
   e_->addCommand(std::unique_ptr<Command>(this));
   return false;
 }
@@ -47,6 +47,10 @@ namespace aria2 {
 
 BackupConnectInfo::BackupConnectInfo() : cancel(false) {}
 
+namespace {
+constexpr auto INITIAL_TIMEOUT = std::chrono::milliseconds(300);
+} // namespace
+
 BackupIPv4ConnectCommand::BackupIPv4ConnectCommand(
     cuid_t cuid, const std::string& ipaddr, uint16_t port,
     const std::shared_ptr<BackupConnectInfo>& info, Command* mainCommand,
@@ -113,13 +117,15 @@ bool BackupIPv4ConnectCommand::execute()
         retval = true;
       }
     }
+    else if (timeoutCheck_.difference(global::wallclock()) >= timeout_) {
+      A2_LOG_INFO(fmt("CUID#%" PRId64 " - Backup connection command timeout",
+                      getCuid()));
+      retval = true;
+    }
   }
-  else if (!socket_) {
-    // TODO Although we check 300ms initial timeout as described in
-    // RFC 6555, the interval will be much longer and around 1 second
-    // due to the refresh interval mechanism in DownloadEngine.
-    if (startTime_.difference(global::wallclock()) >=
-        std::chrono::milliseconds(300)) {
+  else {
+    // The 300ms initial timeout is described in RFC 6555.
+    if (startTime_.difference(global::wallclock()) >= INITIAL_TIMEOUT) {
       socket_ = std::make_shared<SocketCore>();
       try {
         socket_->establishConnection(ipaddr_, port_);
@@ -134,12 +140,17 @@ bool BackupIPv4ConnectCommand::execute()
       }
     }
   }
-  else if (timeoutCheck_.difference(global::wallclock()) >= timeout_) {
-    A2_LOG_INFO(
-        fmt("CUID#%" PRId64 " - Backup connection command timeout", getCuid()));
-    retval = true;
-  }
   if (!retval) {
+    Timer deadline;
+    if (socket_) {
+      deadline = timeoutCheck_;
+      deadline.advance(timeout_);
+    }
+    else {
+      deadline = startTime_;
+      deadline.advance(INITIAL_TIMEOUT);
+    }
+    e_->addTimer(deadline, this);
     e_->addCommand(std::unique_ptr<Command>(this));
   }
   return retval;
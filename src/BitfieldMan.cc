@@ -465,9 +465,15 @@ namespace {
 template <typename Array>
 bool copyBitfield(unsigned char* dst, const Array& src, size_t blocks)
 {
-  unsigned char bits = 0;
+  uint64_t bits = 0;
   size_t len = (blocks + 7) / 8;
-  for (size_t i = 0; i < len - 1; ++i) {
+  size_t nwords = (len - 1) / 8;
+  for (size_t i = 0; i < nwords; ++i) {
+    auto w = bitfield::loadWord(src, i);
+    bitfield::storeWord(dst, i, w);
+    bits |= w;
+  }
+  for (size_t i = nwords * 8; i < len - 1; ++i) {
     dst[i] = src[i];
     bits |= dst[i];
   }
@@ -853,18 +859,19 @@ void BitfieldMan::updateCache()
 
 bool BitfieldMan::isBitRangeSet(size_t startIndex, size_t endIndex) const
 {
-  for (size_t i = startIndex; i <= endIndex; ++i) {
-    if (!isBitSet(i)) {
-      return false;
-    }
+  if (startIndex > endIndex) {
+    return true;
   }
-  return true;
+  if (endIndex >= blocks_) {
+    return false;
+  }
+  return bitfield::isBitRangeSet(bitfield_, startIndex, endIndex);
 }
 
 void BitfieldMan::unsetBitRange(size_t startIndex, size_t endIndex)
 {
   for (size_t i = startIndex; i <= endIndex; ++i) {
-    unsetBit(i);
+    setBitInternal(bitfield_, i, false);
   }
   updateCache();
 }
@@ -872,7 +879,7 @@ void BitfieldMan::unsetBitRange(size_t startIndex, size_t endIndex)
 void BitfieldMan::setBitRange(size_t startIndex, size_t endIndex)
 {
   for (size_t i = startIndex; i <= endIndex; ++i) {
-    setBit(i);
+    setBitInternal(bitfield_, i, true);
   }
   updateCache();
 }
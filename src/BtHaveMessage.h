@@ -36,10 +36,12 @@
 #define D_BT_HAVE_MESSAGE_H
 
 #include "IndexBtMessage.h"
+#include "FreeListAllocated.h"
 
 namespace aria2 {
 
-class BtHaveMessage : public IndexBtMessage {
+class BtHaveMessage : public IndexBtMessage,
+                      public FreeListAllocated<BtHaveMessage> {
 public:
   BtHaveMessage(size_t index = 0);
 
@@ -59,6 +59,8 @@
 #include "array_fun.h"
 #include "WrDiskCache.h"
 #include "WrDiskCacheEntry.h"
+#include "RdDiskCache.h"
+#include "RequestGroup.h"
 #include "DownloadFailureException.h"
 #include "BtRejectMessage.h"
 
@@ -215,22 +217,59 @@ void BtPieceMessage::send()
 void BtPieceMessage::pushPieceData(int64_t offset, int32_t length) const
 {
   assert(length <= static_cast<int32_t>(MAX_BLOCK_LENGTH));
-  auto buf = std::vector<unsigned char>(length + MESSAGE_HEADER_LENGTH);
-  createMessageHeader(buf.data());
-  ssize_t r;
-  r = getPieceStorage()->getDiskAdaptor()->readData(
-      buf.data() + MESSAGE_HEADER_LENGTH, length, offset);
-  if (r == length) {
-    const auto& peer = getPeer();
+  const auto& peer = getPeer();
+  // Unless the read cache is used, let the kernel send the data
+  // directly from the file.
+  if (!getPieceStorage()->getRdDiskCache() &&
+      getPeerConnection()->canPushFile()) {
+    auto buf = std::vector<unsigned char>(MESSAGE_HEADER_LENGTH);
+    createMessageHeader(buf.data());
+    getPeerConnection()->pushBytes(std::move(buf));
+    getPeerConnection()->pushFile(
+        getPieceStorage()->getDiskAdaptor(), offset, length,
+        make_unique<PieceSendUpdate>(downloadContext_, peer, 0));
+  }
+  else {
+    auto buf = std::vector<unsigned char>(length + MESSAGE_HEADER_LENGTH);
+    createMessageHeader(buf.data());
+    ssize_t r =
+        readPieceData(buf.data() + MESSAGE_HEADER_LENGTH, length, offset);
+    if (r != length) {
+      throw DL_ABORT_EX(EX_DATA_READ);
+    }
     getPeerConnection()->pushBytes(
         std::move(buf), make_unique<PieceSendUpdate>(downloadContext_, peer,
                                                      MESSAGE_HEADER_LENGTH));
-    peer->updateUploadSpeed(length);
-    downloadContext_->updateUploadSpeed(length);
   }
-  else {
-    throw DL_ABORT_EX(EX_DATA_READ);
+  peer->updateUploadSpeed(length);
+  downloadContext_->updateUploadSpeed(length);
+}
+
+ssize_t BtPieceMessage::readPieceData(unsigned char* data, int32_t length,
+                                      int64_t offset) const
+{
+  auto rdDiskCache = getPieceStorage()->getRdDiskCache();
+  int32_t pieceLength = getPieceStorage()->getPieceLength(index_);
+  if (rdDiskCache &&
+      static_cast<size_t>(pieceLength) <= rdDiskCache->getLimit()) {
+    auto gid = downloadContext_->getOwnerRequestGroup()->getGID();
+    auto cache = rdDiskCache->get(gid, index_);
+    if (!cache) {
+      // Read the whole piece, expecting that the other blocks of the
+      // piece are requested soon by this or the other peers.
+      auto pieceData = std::vector<unsigned char>(pieceLength);
+      ssize_t r = getPieceStorage()->getDiskAdaptor()->readData(
+          pieceData.data(), pieceLength, offset - begin_);
+      if (r == pieceLength) {
+        cache = rdDiskCache->add(gid, index_, std::move(pieceData));
+      }
+    }
+    if (cache && begin_ + length <= pieceLength) {
+      memcpy(data, cache->data() + begin_, length);
+      return length;
+    }
   }
+  return getPieceStorage()->getDiskAdaptor()->readData(data, length, offset);
 }
 
 std::string BtPieceMessage::toString() const
@@ -244,19 +283,21 @@ bool BtPieceMessage::checkPieceHash(const std::shared_ptr<Piece>& piece)
   if (!getPieceStorage()->isEndGame() && piece->isHashCalculated()) {
     A2_LOG_DEBUG(fmt("Hash is available!! index=%lu",
                      static_cast<unsigned long>(piece->getIndex())));
-    return piece->getDigest() ==
-           downloadContext_->getPieceHash(piece->getIndex());
+    return downloadContext_->matchPieceHash(piece->getIndex(),
+                                            piece->getDigest());
   }
   else {
     A2_LOG_DEBUG(fmt("Calculating hash index=%lu",
                      static_cast<unsigned long>(piece->getIndex())));
     try {
-      return piece->getDigestWithWrCache(downloadContext_->getPieceLength(),
-                                         getPieceStorage()->getDiskAdaptor()) ==
-             downloadContext_->getPieceHash(piece->getIndex());
+      return downloadContext_->matchPieceHash(
+          piece->getIndex(),
+          piece->getDigestWithWrCache(downloadContext_->getPieceLength(),
+                                      getPieceStorage()->getDiskAdaptor()));
     }
     catch (RecoverableException& e) {
       piece->clearAllBlock(getPieceStorage()->getWrDiskCache());
+      piece->destroyHashContext();
       throw;
     }
   }
@@ -36,6 +36,7 @@
 #define D_BT_PIECE_MESSAGE_H
 
 #include "AbstractBtMessage.h"
+#include "FreeListAllocated.h"
 
 namespace aria2 {
 
@@ -43,7 +44,8 @@ class Piece;
 class DownloadContext;
 class PeerStorage;
 
-class BtPieceMessage : public AbstractBtMessage {
+class BtPieceMessage : public AbstractBtMessage,
+                       public FreeListAllocated<BtPieceMessage> {
 private:
   size_t index_;
   int32_t begin_;
@@ -60,6 +62,11 @@ private:
 
   void pushPieceData(int64_t offset, int32_t length) const;
 
+  // Reads the block at |offset| into |data|, using the read cache if
+  // it is available.
+  ssize_t readPieceData(unsigned char* data, int32_t length,
+                        int64_t offset) const;
+
 public:
   BtPieceMessage(size_t index = 0, int32_t begin = 0, int32_t blockLength = 0);
 
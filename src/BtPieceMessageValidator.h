@@ -36,12 +36,15 @@
 #define D_BT_PIECE_MESSAGE_VALIDATOR_H
 
 #include "BtMessageValidator.h"
+#include "FreeListAllocated.h"
 
 namespace aria2 {
 
 class BtPieceMessage;
 
-class BtPieceMessageValidator : public BtMessageValidator {
+class BtPieceMessageValidator
+    : public BtMessageValidator,
+      public FreeListAllocated<BtPieceMessageValidator> {
 private:
   const BtPieceMessage* message_;
   size_t numPiece_;
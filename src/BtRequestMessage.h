@@ -36,10 +36,12 @@
 #define D_BT_REQUEST_MESSAGE_H
 
 #include "RangeBtMessage.h"
+#include "FreeListAllocated.h"
 
 namespace aria2 {
 
-class BtRequestMessage : public RangeBtMessage {
+class BtRequestMessage : public RangeBtMessage,
+                         public FreeListAllocated<BtRequestMessage> {
 private:
   size_t blockIndex_;
 
@@ -33,9 +33,15 @@
  */
 /* copyright --> */
 #include "CheckIntegrityCommand.h"
+
+#include <limits>
+
 #include "CheckIntegrityEntry.h"
+#include "CheckIntegrityMan.h"
 #include "DownloadEngine.h"
 #include "RequestGroup.h"
+#include "PieceStorage.h"
+#include "DiskAdaptor.h"
 #include "Logger.h"
 #include "LogFactory.h"
 #include "message.h"
@@ -45,6 +51,11 @@
 #include "RecoverableException.h"
 #include "util.h"
 #include "fmt.h"
+#ifdef ENABLE_THREADS
+#  include "ThreadPool.h"
+#  include "OpenedFileCounter.h"
+#  include "WakeupPipe.h"
+#endif // ENABLE_THREADS
 
 namespace aria2 {
 
@@ -52,49 +63,163 @@ CheckIntegrityCommand::CheckIntegrityCommand(cuid_t cuid,
                                              RequestGroup* requestGroup,
                                              DownloadEngine* e,
                                              CheckIntegrityEntry* entry)
-    : RealtimeCommand{cuid, requestGroup, e}, entry_{entry}
+    : Command{cuid},
+      requestGroup_{requestGroup},
+      e_{e},
+      entry_{entry}
+#ifdef ENABLE_THREADS
+      ,
+      cancel_{false}
+#endif // ENABLE_THREADS
 {
+  setStatusActive();
+  requestGroup_->increaseNumCommand();
 }
 
 CheckIntegrityCommand::~CheckIntegrityCommand()
 {
-  getDownloadEngine()->getCheckIntegrityMan()->dropPickedEntry();
+#ifdef ENABLE_THREADS
+  if (future_.valid()) {
+    // entry_ is still used by a worker thread.  Ask it to stop and
+    // wait for it, which takes at most one chunk.
+    cancel_ = true;
+    future_.wait();
+    finishBackgroundValidation();
+  }
+  if (wakeupPipe_) {
+    e_->deleteFdForReadCheck(wakeupPipe_->getReadFd(), this);
+  }
+#endif // ENABLE_THREADS
+  requestGroup_->decreaseNumCommand();
+  e_->getCheckIntegrityMan()->dropPickedEntry(entry_);
 }
 
-bool CheckIntegrityCommand::executeInternal()
+bool CheckIntegrityCommand::execute()
 {
-  if (getRequestGroup()->isHaltRequested()) {
+  if (requestGroup_->isHaltRequested()) {
     return true;
   }
-  entry_->validateChunk();
-  if (entry_->finished()) {
-    // Enable control file saving here. See also
-    // RequestGroup::processCheckIntegrityEntry() to know why this is
-    // needed.
-    getRequestGroup()->enableSaveControlFile();
-    if (getRequestGroup()->downloadFinished()) {
-      A2_LOG_NOTICE(
-          fmt(MSG_VERIFICATION_SUCCESSFUL,
-              getRequestGroup()->getDownloadContext()->getBasePath().c_str()));
-      std::vector<std::unique_ptr<Command>> commands;
-      entry_->onDownloadFinished(commands, getDownloadEngine());
-      getDownloadEngine()->addCommand(std::move(commands));
+  try {
+#ifdef ENABLE_THREADS
+    auto threadPool = e_->getCheckIntegrityMan()->getThreadPool();
+    if (threadPool) {
+      return executeBackground(threadPool);
     }
-    else {
-      A2_LOG_ERROR(
-          fmt(MSG_VERIFICATION_FAILED,
-              getRequestGroup()->getDownloadContext()->getBasePath().c_str()));
-      std::vector<std::unique_ptr<Command>> commands;
-      entry_->onDownloadIncomplete(commands, getDownloadEngine());
-      getDownloadEngine()->addCommand(std::move(commands));
+#endif // ENABLE_THREADS
+    setStatusRealtime();
+    e_->setNoWait(true);
+    entry_->validateChunk();
+    if (entry_->finished()) {
+      onValidationFinished();
+      return true;
     }
-    getDownloadEngine()->setNoWait(true);
-    return true;
+    e_->addCommand(std::unique_ptr<Command>(this));
+    return false;
   }
-  else {
-    getDownloadEngine()->addCommand(std::unique_ptr<Command>(this));
+  catch (RecoverableException& ex) {
+    return handleException(ex);
+  }
+}
+
+#ifdef ENABLE_THREADS
+bool CheckIntegrityCommand::executeBackground(ThreadPool* threadPool)
+{
+  if (!future_.valid()) {
+    startBackgroundValidation(threadPool);
+    e_->addCommand(std::unique_ptr<Command>(this));
+    return false;
+  }
+  if (wakeupPipe_->drain()) {
+    // The worker thread notifies just before it returns.  The result
+    // is stored right after that.
+    future_.wait();
+  }
+  else if (future_.wait_for(std::chrono::seconds(0)) !=
+           std::future_status::ready) {
+    // Executed by other reason, for example, halt.
+    e_->addCommand(std::unique_ptr<Command>(this));
     return false;
   }
+  finishBackgroundValidation();
+  // Rethrows the exception thrown in the worker thread, if any.
+  future_.get();
+  entry_->storeResult();
+  onValidationFinished();
+  e_->setNoWait(true);
+  return true;
+}
+
+void CheckIntegrityCommand::startBackgroundValidation(ThreadPool* threadPool)
+{
+  auto diskAdaptor = requestGroup_->getPieceStorage()->getDiskAdaptor();
+  // OpenedFileCounter closes files of any download from this thread,
+  // while the worker thread is reading them.  Release the files
+  // counted by it and detach it from DiskAdaptor during validation.
+  openedFileCounter_ = diskAdaptor->getOpenedFileCounter();
+  if (openedFileCounter_) {
+    openedFileCounter_->reduceNumOfOpenedFile(
+        diskAdaptor->tryCloseFile(std::numeric_limits<size_t>::max()));
+    diskAdaptor->setOpenedFileCounter(nullptr);
+  }
+  // Files are read sequentially, so that keeping one file open is
+  // enough.
+  diskAdaptor->setMaxOpenFiles(1);
+  if (!wakeupPipe_) {
+    wakeupPipe_ = make_unique<WakeupPipe>();
+    e_->addFdForReadCheck(wakeupPipe_->getReadFd(), this);
+  }
+  A2_LOG_INFO(fmt("CUID#%" PRId64 " - Validating files in worker thread.",
+                  getCuid()));
+  future_ = threadPool->submit([this]() {
+    try {
+      do {
+        entry_->checkChunk();
+      } while (!entry_->finished() && !cancel_);
+    }
+    catch (...) {
+      wakeupPipe_->notify();
+      throw;
+    }
+    wakeupPipe_->notify();
+  });
+}
+
+void CheckIntegrityCommand::finishBackgroundValidation()
+{
+  auto diskAdaptor = requestGroup_->getPieceStorage()->getDiskAdaptor();
+  diskAdaptor->setMaxOpenFiles(0);
+  if (openedFileCounter_) {
+    // Files opened by the worker thread are not counted.
+    diskAdaptor->tryCloseFile(std::numeric_limits<size_t>::max());
+    diskAdaptor->setOpenedFileCounter(std::move(openedFileCounter_));
+    openedFileCounter_.reset();
+  }
+}
+#endif // ENABLE_THREADS
+
+void CheckIntegrityCommand::onValidationFinished()
+{
+  // Enable control file saving here. See also
+  // RequestGroup::processCheckIntegrityEntry() to know why this is
+  // needed.
+  requestGroup_->enableSaveControlFile();
+  if (requestGroup_->downloadFinished()) {
+    A2_LOG_NOTICE(
+        fmt(MSG_VERIFICATION_SUCCESSFUL,
+            requestGroup_->getDownloadContext()->getBasePath().c_str()));
+    std::vector<std::unique_ptr<Command>> commands;
+    entry_->onDownloadFinished(commands, e_);
+    e_->addCommand(std::move(commands));
+  }
+  else {
+    A2_LOG_ERROR(
+        fmt(MSG_VERIFICATION_FAILED,
+            requestGroup_->getDownloadContext()->getBasePath().c_str()));
+    std::vector<std::unique_ptr<Command>> commands;
+    entry_->onDownloadIncomplete(commands, e_);
+    e_->addCommand(std::move(commands));
+  }
+  e_->setNoWait(true);
 }
 
 bool CheckIntegrityCommand::handleException(Exception& e)
@@ -102,7 +227,7 @@ bool CheckIntegrityCommand::handleException(Exception& e)
   A2_LOG_ERROR_EX(fmt(MSG_FILE_VALIDATION_FAILURE, getCuid()), e);
   A2_LOG_ERROR(
       fmt(MSG_DOWNLOAD_NOT_COMPLETE, getCuid(),
-          getRequestGroup()->getDownloadContext()->getBasePath().c_str()));
+          requestGroup_->getDownloadContext()->getBasePath().c_str()));
   return true;
 }
 
@@ -35,27 +35,69 @@
 #ifndef D_CHECK_INTEGRITY_COMMAND_H
 #define D_CHECK_INTEGRITY_COMMAND_H
 
-#include "RealtimeCommand.h"
+#include "Command.h"
 
 #include <memory>
+#ifdef ENABLE_THREADS
+#  include <atomic>
+#  include <future>
+#endif // ENABLE_THREADS
 
 namespace aria2 {
 
 class CheckIntegrityEntry;
+class RequestGroup;
+class DownloadEngine;
+class Exception;
+#ifdef ENABLE_THREADS
+class ThreadPool;
+class OpenedFileCounter;
+class WakeupPipe;
+#endif // ENABLE_THREADS
 
-class CheckIntegrityCommand : public RealtimeCommand {
+// Validates CheckIntegrityEntry.  If CheckIntegrityMan has
+// ThreadPool, the entry is validated by a worker thread, which wakes
+// up this command through WakeupPipe when it is done.  Otherwise, the
+// entry is validated chunk by chunk in DownloadEngine's thread.
+class CheckIntegrityCommand : public Command {
 private:
+  RequestGroup* requestGroup_;
+
+  DownloadEngine* e_;
+
   CheckIntegrityEntry* entry_;
 
+#ifdef ENABLE_THREADS
+  // Valid while entry_ is validated by a worker thread.
+  std::future<void> future_;
+
+  std::atomic<bool> cancel_;
+
+  // Notified by the worker thread when validation finishes.
+  std::unique_ptr<WakeupPipe> wakeupPipe_;
+
+  // OpenedFileCounter detached from DiskAdaptor during validation in
+  // a worker thread.
+  std::shared_ptr<OpenedFileCounter> openedFileCounter_;
+
+  bool executeBackground(ThreadPool* threadPool);
+
+  void startBackgroundValidation(ThreadPool* threadPool);
+
+  void finishBackgroundValidation();
+#endif // ENABLE_THREADS
+
+  void onValidationFinished();
+
+  bool handleException(Exception& e);
+
 public:
   CheckIntegrityCommand(cuid_t cuid, RequestGroup* requestGroup,
                         DownloadEngine* e, CheckIntegrityEntry* entry);
 
   virtual ~CheckIntegrityCommand();
 
-  virtual bool executeInternal() CXX11_OVERRIDE;
-
-  virtual bool handleException(Exception& e) CXX11_OVERRIDE;
+  virtual bool execute() CXX11_OVERRIDE;
 };
 
 } // namespace aria2
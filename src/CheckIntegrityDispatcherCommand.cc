@@ -33,8 +33,11 @@
  */
 /* copyright --> */
 #include "CheckIntegrityDispatcherCommand.h"
+#include "CheckIntegrityMan.h"
 #include "CheckIntegrityEntry.h"
 #include "CheckIntegrityCommand.h"
+#include "DownloadEngine.h"
+#include "RequestGroupMan.h"
 #include "message.h"
 #include "Logger.h"
 #include "LogFactory.h"
@@ -44,21 +47,38 @@
 namespace aria2 {
 
 CheckIntegrityDispatcherCommand::CheckIntegrityDispatcherCommand(
-    cuid_t cuid, CheckIntegrityMan* fileAllocMan, DownloadEngine* e)
-    : SequentialDispatcherCommand<CheckIntegrityEntry>{cuid, fileAllocMan, e}
+    cuid_t cuid, CheckIntegrityMan* checkMan, DownloadEngine* e)
+    : Command{cuid}, checkMan_{checkMan}, e_{e}
 {
   setStatusRealtime();
 }
 
+bool CheckIntegrityDispatcherCommand::execute()
+{
+  if (e_->getRequestGroupMan()->downloadFinished() || e_->isHaltRequested()) {
+    return true;
+  }
+  if (checkMan_->canPickNext()) {
+    // With worker threads, several entries may be dispatched at once.
+    do {
+      e_->addCommand(createCommand(checkMan_->pickNext()));
+    } while (checkMan_->canPickNext());
+    e_->setNoWait(true);
+  }
+
+  e_->addRoutineCommand(std::unique_ptr<Command>(this));
+  return false;
+}
+
 std::unique_ptr<Command>
 CheckIntegrityDispatcherCommand::createCommand(CheckIntegrityEntry* entry)
 {
-  cuid_t newCUID = getDownloadEngine()->newCUID();
+  cuid_t newCUID = e_->newCUID();
   A2_LOG_INFO(fmt("CUID#%" PRId64 " - Dispatching CheckIntegrityCommand "
                   "CUID#%" PRId64 ".",
                   getCuid(), newCUID));
   return make_unique<CheckIntegrityCommand>(newCUID, entry->getRequestGroup(),
-                                            getDownloadEngine(), entry);
+                                            e_, entry);
 }
 
 } // namespace aria2
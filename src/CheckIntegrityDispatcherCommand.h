@@ -35,22 +35,29 @@
 #ifndef D_CHECK_INTEGRITY_DISPATCHER_COMMAND_H
 #define D_CHECK_INTEGRITY_DISPATCHER_COMMAND_H
 
-#include "SequentialDispatcherCommand.h"
-#include "CheckIntegrityMan.h"
+#include "Command.h"
+
+#include <memory>
 
 namespace aria2 {
 
+class CheckIntegrityMan;
 class CheckIntegrityEntry;
+class DownloadEngine;
+
+class CheckIntegrityDispatcherCommand : public Command {
+private:
+  CheckIntegrityMan* checkMan_;
+
+  DownloadEngine* e_;
+
+  std::unique_ptr<Command> createCommand(CheckIntegrityEntry* entry);
 
-class CheckIntegrityDispatcherCommand
-    : public SequentialDispatcherCommand<CheckIntegrityEntry> {
 public:
   CheckIntegrityDispatcherCommand(cuid_t cuid, CheckIntegrityMan* checkMan,
                                   DownloadEngine* e);
 
-protected:
-  virtual std::unique_ptr<Command>
-  createCommand(CheckIntegrityEntry* entry) CXX11_OVERRIDE;
+  virtual bool execute() CXX11_OVERRIDE;
 };
 
 } // namespace aria2
@@ -54,6 +54,10 @@ CheckIntegrityEntry::~CheckIntegrityEntry() = default;
 
 void CheckIntegrityEntry::validateChunk() { validator_->validateChunk(); }
 
+void CheckIntegrityEntry::checkChunk() { validator_->checkChunk(); }
+
+void CheckIntegrityEntry::storeResult() { validator_->storeResult(); }
+
 int64_t CheckIntegrityEntry::getTotalLength()
 {
   if (!validator_) {
@@ -73,6 +73,16 @@ public:
 
   virtual void validateChunk();
 
+  // Same as validateChunk(), but the result is not stored to
+  // PieceStorage even after finished() becomes true.  This function
+  // can be called from a worker thread.  See IteratableValidator.
+  void checkChunk();
+
+  // Stores the result of checkChunk() to PieceStorage.  Call this
+  // function from DownloadEngine's thread after finished() returns
+  // true.
+  void storeResult();
+
   virtual bool finished() CXX11_OVERRIDE;
 
   virtual bool isValidationReady() = 0;
@@ -0,0 +1,120 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2018 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#include "CheckIntegrityMan.h"
+
+#include <algorithm>
+
+#include "CheckIntegrityEntry.h"
+#include "Command.h"
+#ifdef ENABLE_THREADS
+#  include "ThreadPool.h"
+#endif // ENABLE_THREADS
+
+namespace aria2 {
+
+CheckIntegrityMan::CheckIntegrityMan() = default;
+
+CheckIntegrityMan::~CheckIntegrityMan() = default;
+
+CheckIntegrityEntry* CheckIntegrityMan::findPickedEntry(
+    const std::function<bool(const CheckIntegrityEntry&)>& pred) const
+{
+  for (auto& e : pickedEntries_) {
+    if (pred(*e)) {
+      return e.get();
+    }
+  }
+  return nullptr;
+}
+
+void CheckIntegrityMan::dropPickedEntry(const CheckIntegrityEntry* entry)
+{
+  auto i = std::find_if(std::begin(pickedEntries_), std::end(pickedEntries_),
+                        [entry](const std::unique_ptr<CheckIntegrityEntry>& e) {
+                          return e.get() == entry;
+                        });
+  if (i != std::end(pickedEntries_)) {
+    pickedEntries_.erase(i);
+  }
+}
+
+bool CheckIntegrityMan::canPickNext() const
+{
+  if (!hasNext()) {
+    return false;
+  }
+  size_t maxPicked = 1;
+#ifdef ENABLE_THREADS
+  if (threadPool_) {
+    maxPicked = threadPool_->getNumThreads();
+  }
+#endif // ENABLE_THREADS
+  return pickedEntries_.size() < maxPicked;
+}
+
+CheckIntegrityEntry* CheckIntegrityMan::pickNext()
+{
+  if (!hasNext()) {
+    return nullptr;
+  }
+  pickedEntries_.push_back(std::move(entries_.front()));
+  entries_.pop_front();
+  return pickedEntries_.back().get();
+}
+
+void CheckIntegrityMan::pushEntry(std::unique_ptr<CheckIntegrityEntry> entry)
+{
+  entries_.push_back(std::move(entry));
+}
+
+bool CheckIntegrityMan::isQueued(
+    const std::function<bool(const CheckIntegrityEntry&)>& pred) const
+{
+  for (auto& e : entries_) {
+    if (pred(*e)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+#ifdef ENABLE_THREADS
+void CheckIntegrityMan::setThreadPool(std::unique_ptr<ThreadPool> threadPool)
+{
+  threadPool_ = std::move(threadPool);
+}
+#endif // ENABLE_THREADS
+
+} // namespace aria2
@@ -36,13 +36,73 @@
 #define D_CHECK_INTEGRITY_MAN_H
 
 #include "common.h"
-#include "SequentialPicker.h"
+
+#include <deque>
+#include <vector>
+#include <memory>
+#include <functional>
 
 namespace aria2 {
 
 class CheckIntegrityEntry;
+#ifdef ENABLE_THREADS
+class ThreadPool;
+#endif // ENABLE_THREADS
+
+// Queue of CheckIntegrityEntry.  Entries are picked in FIFO order.
+// Without worker threads, only one entry is picked and validated in
+// DownloadEngine's thread at a time.  With worker threads, up to the
+// number of threads entries are picked and validated in parallel.
+class CheckIntegrityMan {
+private:
+  std::deque<std::unique_ptr<CheckIntegrityEntry>> entries_;
+  std::vector<std::unique_ptr<CheckIntegrityEntry>> pickedEntries_;
+#ifdef ENABLE_THREADS
+  std::unique_ptr<ThreadPool> threadPool_;
+#endif // ENABLE_THREADS
+
+public:
+  CheckIntegrityMan();
+
+  ~CheckIntegrityMan();
+
+  bool isPicked() const { return !pickedEntries_.empty(); }
+
+  const std::vector<std::unique_ptr<CheckIntegrityEntry>>&
+  getPickedEntries() const
+  {
+    return pickedEntries_;
+  }
+
+  // Returns the picked entry satisfying |pred|, or nullptr.
+  CheckIntegrityEntry*
+  findPickedEntry(const std::function<bool(const CheckIntegrityEntry&)>& pred)
+      const;
+
+  void dropPickedEntry(const CheckIntegrityEntry* entry);
+
+  bool hasNext() const { return !entries_.empty(); }
+
+  // Returns true if the next entry can be picked now.
+  bool canPickNext() const;
+
+  CheckIntegrityEntry* pickNext();
+
+  void pushEntry(std::unique_ptr<CheckIntegrityEntry> entry);
+
+  size_t countEntryInQueue() const { return entries_.size(); }
+
+  bool isQueued(
+      const std::function<bool(const CheckIntegrityEntry&)>& pred) const;
+
+#ifdef ENABLE_THREADS
+  // Validates entries using |threadPool|.  Passing nullptr makes
+  // validation run in DownloadEngine's thread.
+  void setThreadPool(std::unique_ptr<ThreadPool> threadPool);
 
-typedef SequentialPicker<CheckIntegrityEntry> CheckIntegrityMan;
+  ThreadPool* getThreadPool() const { return threadPool_.get(); }
+#endif // ENABLE_THREADS
+};
 
 } // namespace aria2
 
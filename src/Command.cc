@@ -39,14 +39,25 @@ namespace aria2 {
 
 Command::Command(cuid_t cuid)
     : cuid_(cuid),
-      status_(STATUS_INACTIVE),
+      // New Command is executed at least once, so that it can
+      // register its I/O events and timers.
+      status_(STATUS_ACTIVE),
       readEvent_(false),
       writeEvent_(false),
       errorEvent_(false),
-      hupEvent_(false)
+      hupEvent_(false),
+      scheduler_(nullptr),
+      timerScheduler_(nullptr)
 {
 }
 
+Command::~Command()
+{
+  if (timerScheduler_) {
+    timerScheduler_->cancelTimer(this);
+  }
+}
+
 void Command::transitStatus()
 {
   switch (status_) {
@@ -57,7 +68,15 @@ void Command::transitStatus()
   }
 }
 
-void Command::setStatus(STATUS status) { status_ = status; }
+void Command::setStatus(STATUS status)
+{
+  status_ = status;
+  if (scheduler_ && statusMatch(STATUS_ACTIVE)) {
+    auto scheduler = scheduler_;
+    scheduler_ = nullptr;
+    scheduler->commandReady(this);
+  }
+}
 
 void Command::readEventReceived() { readEvent_ = true; }
 
@@ -41,6 +41,22 @@ namespace aria2 {
 
 typedef int64_t cuid_t;
 
+class Command;
+
+// Receives Commands which become runnable while they are parked in
+// the scheduler's wait list, so that they can be moved to the run
+// queue without scanning all Commands.
+class CommandScheduler {
+public:
+  virtual ~CommandScheduler() = default;
+
+  virtual void commandReady(Command* command) = 0;
+
+  // Called when command, which has a pending timer in this
+  // scheduler, is deleted.
+  virtual void cancelTimer(Command* command) = 0;
+};
+
 class Command {
 public:
   enum STATUS {
@@ -61,6 +77,10 @@ private:
   bool errorEvent_;
   bool hupEvent_;
 
+  CommandScheduler* scheduler_;
+
+  CommandScheduler* timerScheduler_;
+
 protected:
   bool readEventEnabled() const { return readEvent_; }
 
@@ -73,17 +93,17 @@ protected:
 public:
   Command(cuid_t cuid);
 
-  virtual ~Command() = default;
+  virtual ~Command();
 
   virtual bool execute() = 0;
 
   cuid_t getCuid() const { return cuid_; }
 
-  void setStatusActive() { status_ = STATUS_ACTIVE; }
+  void setStatusActive() { setStatus(STATUS_ACTIVE); }
 
-  void setStatusInactive() { status_ = STATUS_INACTIVE; }
+  void setStatusInactive() { setStatus(STATUS_INACTIVE); }
 
-  void setStatusRealtime() { status_ = STATUS_REALTIME; }
+  void setStatusRealtime() { setStatus(STATUS_REALTIME); }
 
   void setStatus(STATUS status);
 
@@ -103,6 +123,20 @@ public:
   void hupEventReceived();
 
   void clearIOEvents();
+
+  // Tells this Command that it is parked in scheduler.  When the
+  // status of this Command becomes STATUS_ACTIVE or higher,
+  // scheduler->commandReady(this) is called once and scheduler is
+  // forgotten.  Pass nullptr to detach.
+  void setScheduler(CommandScheduler* scheduler) { scheduler_ = scheduler; }
+
+  // Tells this Command that it has a pending timer in scheduler.
+  // scheduler->cancelTimer(this) is called when this Command is
+  // deleted.  Pass nullptr when the timer is gone.
+  void setTimerScheduler(CommandScheduler* scheduler)
+  {
+    timerScheduler_ = scheduler;
+  }
 };
 
 } // namespace aria2
@@ -365,24 +365,22 @@ void ConsoleStatCalc::calculateStat(const DownloadEngine* e)
       }
     }
   }
-  {
-    auto& entry = e->getCheckIntegrityMan()->getPickedEntry();
-    if (entry) {
-      o << " [Checksum:#"
-        << GroupId::toAbbrevHex(entry->getRequestGroup()->getGID()) << " "
-        << sizeFormatter(entry->getCurrentLength()) << "B/"
-        << sizeFormatter(entry->getTotalLength()) << "B(";
-      if (entry->getTotalLength() > 0) {
-        o << 100LL * entry->getCurrentLength() / entry->getTotalLength();
-      }
-      else {
-        o << "--";
-      }
-      o << "%)]";
-      if (e->getCheckIntegrityMan()->hasNext()) {
-        o << "(+" << e->getCheckIntegrityMan()->countEntryInQueue() << ")";
-      }
+  for (auto& entry : e->getCheckIntegrityMan()->getPickedEntries()) {
+    o << " [Checksum:#"
+      << GroupId::toAbbrevHex(entry->getRequestGroup()->getGID()) << " "
+      << sizeFormatter(entry->getCurrentLength()) << "B/"
+      << sizeFormatter(entry->getTotalLength()) << "B(";
+    if (entry->getTotalLength() > 0) {
+      o << 100LL * entry->getCurrentLength() / entry->getTotalLength();
     }
+    else {
+      o << "--";
+    }
+    o << "%)]";
+  }
+  if (e->getCheckIntegrityMan()->isPicked() &&
+      e->getCheckIntegrityMan()->hasNext()) {
+    o << "(+" << e->getCheckIntegrityMan()->countEntryInQueue() << ")";
   }
   if (isTTY_) {
     if (truncate_) {
@@ -71,6 +71,29 @@ private:
 
   size_t inFlightMessage_;
 
+  // Addresses of the nodes which have not replied in expected time.
+  // They are not counted against concurrency_.
+  std::vector<std::pair<std::string, uint16_t>> stalledNodes_;
+
+  size_t concurrency_;
+
+  // True if the lookup has converged and onFinish() has been called,
+  // but replies from stalled nodes are still awaited.
+  bool done_;
+
+  // Returns true if the node at ipaddr:port was stalled, and forgets
+  // it.
+  bool unstall(const std::string& ipaddr, uint16_t port)
+  {
+    auto i = std::find(std::begin(stalledNodes_), std::end(stalledNodes_),
+                       std::make_pair(ipaddr, port));
+    if (i == std::end(stalledNodes_)) {
+      return false;
+    }
+    stalledNodes_.erase(i);
+    return true;
+  }
+
   template <typename Container>
   void toEntries(Container& entries,
                  const std::vector<std::shared_ptr<DHTNode>>& nodes) const
@@ -83,7 +106,8 @@ private:
   void sendMessage()
   {
     for (auto i = std::begin(entries_), eoi = std::end(entries_);
-         i != eoi && inFlightMessage_ < ALPHA; ++i) {
+         i != eoi && inFlightMessage_ < concurrency_ + stalledNodes_.size();
+         ++i) {
       if ((*i)->used == false) {
         ++inFlightMessage_;
         (*i)->used = true;
@@ -95,15 +119,27 @@ private:
 
   void sendMessageAndCheckFinish()
   {
+    if (done_) {
+      if (inFlightMessage_ == 0) {
+        setFinished(true);
+      }
+      return;
+    }
     if (needsAdditionalOutgoingMessage()) {
       sendMessage();
     }
-    if (inFlightMessage_ == 0) {
+    if (inFlightMessage_ <= stalledNodes_.size()) {
+      // Nothing is left to query.  Don't let stalled nodes delay the
+      // result; the task is kept until they reply or time out, since
+      // their callbacks refer to it.
       A2_LOG_DEBUG(fmt("Finished node_lookup for node ID %s",
                        util::toHex(targetID_, DHT_ID_LENGTH).c_str()));
       onFinish();
       updateBucket();
-      setFinished(true);
+      done_ = true;
+      if (inFlightMessage_ == 0) {
+        setFinished(true);
+      }
     }
     else {
       A2_LOG_DEBUG(fmt("%lu in flight message for node ID %s",
@@ -137,12 +173,14 @@ protected:
   virtual std::unique_ptr<DHTMessageCallback> createCallback() = 0;
 
 public:
-  DHTAbstractNodeLookupTask(const unsigned char* targetID) : inFlightMessage_(0)
+  DHTAbstractNodeLookupTask(const unsigned char* targetID)
+      : inFlightMessage_(0), concurrency_(DHT_LOOKUP_CONCURRENCY), done_(false)
   {
     memcpy(targetID_, targetID, DHT_ID_LENGTH);
   }
 
-  static const size_t ALPHA = 3;
+  // Sets the number of nodes queried in parallel.
+  void setConcurrency(size_t concurrency) { concurrency_ = concurrency; }
 
   virtual void startup() CXX11_OVERRIDE
   {
@@ -154,7 +192,6 @@ public:
       setFinished(true);
     }
     else {
-      // TODO use RTT here
       inFlightMessage_ = 0;
       sendMessage();
       if (inFlightMessage_ == 0) {
@@ -167,6 +204,13 @@ public:
   void onReceived(const ResponseMessage* message)
   {
     --inFlightMessage_;
+    unstall(message->getRemoteNode()->getIPAddress(),
+            message->getRemoteNode()->getPort());
+    if (done_) {
+      onReceivedInternal(message);
+      sendMessageAndCheckFinish();
+      return;
+    }
     // Replace old Node ID with new Node ID.
     for (auto& entry : entries_) {
       if (entry->node->getIPAddress() ==
@@ -213,6 +257,7 @@ public:
     A2_LOG_DEBUG(fmt("node lookup message timeout for node ID=%s",
                      util::toHex(node->getID(), DHT_ID_LENGTH).c_str()));
     --inFlightMessage_;
+    unstall(node->getIPAddress(), node->getPort());
     for (auto i = std::begin(entries_), eoi = std::end(entries_); i != eoi;
          ++i) {
       if (*(*i)->node == *node) {
@@ -222,6 +267,20 @@ public:
     }
     sendMessageAndCheckFinish();
   }
+
+  void onStall(const std::shared_ptr<DHTNode>& node)
+  {
+    if (done_ || std::find(std::begin(stalledNodes_), std::end(stalledNodes_),
+                           std::make_pair(node->getIPAddress(),
+                                          node->getPort())) !=
+                     std::end(stalledNodes_)) {
+      return;
+    }
+    A2_LOG_DEBUG(fmt("node lookup message stalled for node ID=%s",
+                     util::toHex(node->getID(), DHT_ID_LENGTH).c_str()));
+    stalledNodes_.emplace_back(node->getIPAddress(), node->getPort());
+    sendMessageAndCheckFinish();
+  }
 };
 
 } // namespace aria2
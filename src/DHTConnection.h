@@ -38,6 +38,9 @@
 #include "common.h"
 #include <sys/types.h>
 #include <string>
+#include <vector>
+
+#include "a2netcompat.h"
 
 namespace aria2 {
 
@@ -50,6 +53,16 @@ public:
 
   virtual ssize_t sendMessage(const unsigned char* data, size_t len,
                               const std::string& host, uint16_t port) = 0;
+
+  // Receives at most |n| messages at once.  See
+  // SocketCore::readDataFrom(Datagram*, size_t).  Returns the number
+  // of messages received.
+  virtual size_t receiveMessages(Datagram* msgs, size_t n) = 0;
+
+  // Sends messages which sendMessage() has not sent yet.  The
+  // destinations of the messages which cannot be sent because of an
+  // error are appended to |failed|.
+  virtual void flush(std::vector<Endpoint>& failed) = 0;
 };
 
 } // namespace aria2
@@ -36,6 +36,7 @@
 
 #include <utility>
 #include <algorithm>
+#include <array>
 
 #include "LogFactory.h"
 #include "Logger.h"
@@ -105,7 +106,49 @@ ssize_t DHTConnectionImpl::receiveMessage(unsigned char* data, size_t len,
 ssize_t DHTConnectionImpl::sendMessage(const unsigned char* data, size_t len,
                                        const std::string& host, uint16_t port)
 {
-  return socket_->writeData(data, len, host, port);
+  outbox_.push_back(
+      OutgoingMessage{std::vector<unsigned char>(data, data + len),
+                      Endpoint{host, AF_UNSPEC, port}});
+  return len;
+}
+
+size_t DHTConnectionImpl::receiveMessages(Datagram* msgs, size_t n)
+{
+  return socket_->readDataFrom(msgs, n);
+}
+
+namespace {
+constexpr size_t SEND_BATCH_SIZE = 32;
+} // namespace
+
+void DHTConnectionImpl::flush(std::vector<Endpoint>& failed)
+{
+  std::array<Datagram, SEND_BATCH_SIZE> msgs;
+  while (!outbox_.empty()) {
+    size_t n = std::min(outbox_.size(), msgs.size());
+    for (size_t i = 0; i < n; ++i) {
+      auto& m = outbox_[i];
+      msgs[i].data = m.data.data();
+      msgs[i].length = m.data.size();
+      msgs[i].endpoint = m.endpoint;
+    }
+    size_t nsent;
+    try {
+      nsent = socket_->writeData(msgs.data(), n);
+    }
+    catch (RecoverableException& e) {
+      const auto& endpoint = outbox_.front().endpoint;
+      A2_LOG_INFO_EX(fmt("Failed to send UDP message to %s:%u",
+                         endpoint.addr.c_str(), endpoint.port),
+                     e);
+      failed.push_back(endpoint);
+      nsent = 1;
+    }
+    if (nsent == 0) {
+      break;
+    }
+    outbox_.erase(std::begin(outbox_), std::begin(outbox_) + nsent);
+  }
 }
 
 } // namespace aria2
@@ -38,6 +38,8 @@
 #include "DHTConnection.h"
 
 #include <memory>
+#include <deque>
+#include <vector>
 
 #include "SegList.h"
 
@@ -51,6 +53,14 @@ private:
 
   int family_;
 
+  struct OutgoingMessage {
+    std::vector<unsigned char> data;
+    Endpoint endpoint;
+  };
+
+  // Messages queued by sendMessage() and sent together by flush().
+  std::deque<OutgoingMessage> outbox_;
+
 public:
   DHTConnectionImpl(int family);
 
@@ -81,10 +91,19 @@ public:
                                  std::string& host,
                                  uint16_t& port) CXX11_OVERRIDE;
 
+  // Queues data to be sent by flush() and returns len.
   virtual ssize_t sendMessage(const unsigned char* data, size_t len,
                               const std::string& host,
                               uint16_t port) CXX11_OVERRIDE;
 
+  virtual size_t receiveMessages(Datagram* msgs, size_t n) CXX11_OVERRIDE;
+
+  // Sends queued messages in batches.  A message which cannot be
+  // sent because of an error is discarded, and its destination is
+  // appended to |failed|.  If the socket buffer is full, the rest of
+  // messages are kept for the next call.
+  virtual void flush(std::vector<Endpoint>& failed) CXX11_OVERRIDE;
+
   const std::shared_ptr<SocketCore>& getSocket() const { return socket_; }
 };
 
@@ -52,6 +52,21 @@ constexpr size_t DHT_TRANSACTION_ID_LENGTH = 4;
 // See --dht-message-timeout option.
 constexpr auto DHT_MESSAGE_TIMEOUT = 10_s;
 
+// The lower bound of the timeout computed from the RTT of a node.
+constexpr auto DHT_MESSAGE_MIN_TIMEOUT = 2_s;
+
+// When a node whose RTT is unknown does not reply within this time,
+// lookups stop waiting for it and query another node, while the reply
+// is still accepted until the message times out.
+constexpr auto DHT_MESSAGE_STALL_TIMEOUT = 1_s;
+
+// The lower bound of the stall timeout computed from the RTT of a
+// node.
+constexpr auto DHT_MESSAGE_MIN_STALL_TIMEOUT = 500_ms;
+
+// See --dht-lookup-concurrency option.
+constexpr size_t DHT_LOOKUP_CONCURRENCY = 3;
+
 constexpr auto DHT_NODE_CONTACT_INTERVAL = 15_min;
 
 constexpr auto DHT_BUCKET_REFRESH_INTERVAL = 15_min;
@@ -64,6 +79,13 @@ constexpr auto DHT_PEER_ANNOUNCE_INTERVAL = 15_min;
 
 constexpr auto DHT_PEER_ANNOUNCE_CHECK_INTERVAL = 5_min;
 
+// The maximum number of peers stored for one infohash.
+constexpr size_t DHT_PEER_ANNOUNCE_MAX_PEERS = 500;
+
+// The maximum number of peers stored for all infohashes.  When it is
+// exceeded, the least recently announced peers are dropped.
+constexpr size_t DHT_PEER_ANNOUNCE_MAX_TOTAL_PEERS = 100000;
+
 constexpr auto DHT_TOKEN_UPDATE_INTERVAL = 10_min;
 
 } // namespace aria2
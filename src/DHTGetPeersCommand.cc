@@ -125,6 +125,11 @@ bool DHTGetPeersCommand::execute()
     task_.reset();
   }
 
+  // The lookup task and the number of peers are checked once per
+  // second.
+  auto deadline = global::wallclock();
+  deadline.advance(1_s);
+  e_->addTimer(deadline, this);
   e_->addCommand(std::unique_ptr<Command>(this));
   return false;
 }
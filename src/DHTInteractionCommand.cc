@@ -40,6 +40,7 @@
 #include "RecoverableException.h"
 #include "DHTMessageDispatcher.h"
 #include "DHTMessageReceiver.h"
+#include "DHTMessageTracker.h"
 #include "DHTTaskQueue.h"
 #include "DHTMessage.h"
 #include "SocketCore.h"
@@ -58,6 +59,14 @@
 
 namespace aria2 {
 
+namespace {
+// The number of UDP messages received in one call.
+constexpr size_t RECV_BATCH_SIZE = 16;
+// The buffer length for each UDP message.  This is large enough for
+// any UDP datagram, so that a message is never truncated.
+constexpr size_t RECV_MESSAGE_LENGTH = 64_k;
+} // namespace
+
 // TODO This name of this command is misleading, because now it also
 // handles UDP trackers as well as DHT.
 DHTInteractionCommand::DHTInteractionCommand(cuid_t cuid, DownloadEngine* e)
@@ -65,7 +74,8 @@ DHTInteractionCommand::DHTInteractionCommand(cuid_t cuid, DownloadEngine* e)
       e_{e},
       dispatcher_{nullptr},
       receiver_{nullptr},
-      taskQueue_{nullptr}
+      taskQueue_{nullptr},
+      recvBuf_(RECV_BATCH_SIZE * RECV_MESSAGE_LENGTH)
 {
   setStatusRealtime();
 }
@@ -109,36 +119,44 @@ bool DHTInteractionCommand::execute()
 
   taskQueue_->executeTask();
 
-  std::string remoteAddr;
-  uint16_t remotePort;
-  std::array<unsigned char, 64_k> data;
+  std::array<Datagram, RECV_BATCH_SIZE> msgs;
   try {
     while (1) {
-      ssize_t length = connection_->receiveMessage(data.data(), data.size(),
-                                                   remoteAddr, remotePort);
-      if (length <= 0) {
-        break;
+      for (size_t i = 0; i < msgs.size(); ++i) {
+        msgs[i].data = &recvBuf_[i * RECV_MESSAGE_LENGTH];
+        msgs[i].length = RECV_MESSAGE_LENGTH;
       }
-      if (data[0] == 'd') {
-        // udp tracker response does not start with 'd', so assume
-        // this message belongs to DHT. nothrow.
-        receiver_->receiveMessage(remoteAddr, remotePort, data.data(), length);
-      }
-      else {
-        // this may be udp tracker response. nothrow.
-        std::shared_ptr<UDPTrackerRequest> req;
-        if (udpTrackerClient_->receiveReply(req, data.data(), length,
-                                            remoteAddr, remotePort,
-                                            global::wallclock()) == 0) {
-          if (req->action == UDPT_ACT_ANNOUNCE) {
-            auto c = static_cast<TrackerWatcherCommand*>(req->user_data);
-            if (c) {
-              c->setStatus(Command::STATUS_ONESHOT_REALTIME);
-              e_->setNoWait(true);
+      size_t n = connection_->receiveMessages(msgs.data(), msgs.size());
+      for (size_t i = 0; i < n; ++i) {
+        const auto& msg = msgs[i];
+        if (msg.length == 0) {
+          continue;
+        }
+        if (msg.data[0] == 'd') {
+          // udp tracker response does not start with 'd', so assume
+          // this message belongs to DHT. nothrow.
+          receiver_->receiveMessage(msg.endpoint.addr, msg.endpoint.port,
+                                    msg.data, msg.length);
+        }
+        else {
+          // this may be udp tracker response. nothrow.
+          std::shared_ptr<UDPTrackerRequest> req;
+          if (udpTrackerClient_->receiveReply(
+                  req, msg.data, msg.length, msg.endpoint.addr,
+                  msg.endpoint.port, global::wallclock()) == 0) {
+            if (req->action == UDPT_ACT_ANNOUNCE) {
+              auto c = static_cast<TrackerWatcherCommand*>(req->user_data);
+              if (c) {
+                c->setStatus(Command::STATUS_ONESHOT_REALTIME);
+                e_->setNoWait(true);
+              }
             }
           }
         }
       }
+      if (n < msgs.size()) {
+        break;
+      }
     }
   }
   catch (RecoverableException& e) {
@@ -146,7 +164,12 @@ bool DHTInteractionCommand::execute()
   }
   receiver_->handleTimeout();
   udpTrackerClient_->handleTimeout(global::wallclock());
+  // Messages are queued in connection_ and sent together by flush()
+  // below.
   dispatcher_->sendMessages();
+  std::string remoteAddr;
+  uint16_t remotePort;
+  std::array<unsigned char, 64_k> data;
   while (!udpTrackerClient_->getPendingRequests().empty()) {
     // no throw
     ssize_t length = udpTrackerClient_->createRequest(
@@ -154,15 +177,28 @@ bool DHTInteractionCommand::execute()
     if (length == -1) {
       break;
     }
-    try {
-      // throw
-      connection_->sendMessage(data.data(), length, remoteAddr, remotePort);
-      udpTrackerClient_->requestSent(global::wallclock());
-    }
-    catch (RecoverableException& e) {
-      A2_LOG_INFO_EX("Exception thrown while sending UDP tracker request.", e);
-      udpTrackerClient_->requestFail(UDPT_ERR_NETWORK);
-    }
+    // The request is queued, and a failure is reported after flush()
+    // below.
+    connection_->sendMessage(data.data(), length, remoteAddr, remotePort);
+    udpTrackerClient_->requestSent(global::wallclock());
+  }
+  std::vector<Endpoint> failed;
+  connection_->flush(failed);
+  for (const auto& endpoint : failed) {
+    // The destination is either a DHT node or a UDP tracker.
+    receiver_->getMessageTracker()->handleSendFailure(endpoint.addr,
+                                                      endpoint.port);
+    udpTrackerClient_->requestFail(endpoint.addr, endpoint.port,
+                                   UDPT_ERR_NETWORK);
+  }
+  // Wake up the engine when the next DHT message times out or stalls,
+  // and when the next UDP tracker request is resent or times out.
+  Timer deadline;
+  if (receiver_->getMessageTracker()->getNextDeadline(deadline)) {
+    e_->addTimer(deadline, this);
+  }
+  if (udpTrackerClient_->getNextDeadline(deadline)) {
+    e_->addTimer(deadline, this);
   }
   e_->addRoutineCommand(std::unique_ptr<Command>(this));
   return false;
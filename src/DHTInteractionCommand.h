@@ -38,6 +38,7 @@
 #include "Command.h"
 
 #include <memory>
+#include <vector>
 
 namespace aria2 {
 
@@ -58,6 +59,8 @@ private:
   std::shared_ptr<SocketCore> readCheckSocket_;
   std::unique_ptr<DHTConnection> connection_;
   std::shared_ptr<UDPTrackerClient> udpTrackerClient_;
+  // Buffer to receive a batch of UDP messages.
+  std::vector<unsigned char> recvBuf_;
 
 public:
   DHTInteractionCommand(cuid_t cuid, DownloadEngine* e);
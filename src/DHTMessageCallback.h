@@ -64,6 +64,10 @@ public:
   virtual void visit(const DHTPingReplyMessage* message) = 0;
 
   virtual void onTimeout(const std::shared_ptr<DHTNode>& remoteNode) = 0;
+
+  // Called when remoteNode has not replied for longer than expected.
+  // onReceived() or onTimeout() is still called later.
+  virtual void onStall(const std::shared_ptr<DHTNode>& remoteNode) {}
 };
 
 } // namespace aria2
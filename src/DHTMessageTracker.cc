@@ -60,9 +60,20 @@ void DHTMessageTracker::addMessage(DHTMessage* message,
                                    std::chrono::seconds timeout,
                                    std::unique_ptr<DHTMessageCallback> callback)
 {
+  auto& node = message->getRemoteNode();
+  std::chrono::milliseconds replyTimeout = timeout;
+  std::chrono::milliseconds stallTimeout = DHT_MESSAGE_STALL_TIMEOUT;
+  if (node->isRTTMeasured()) {
+    auto t = node->getReplyTimeout(timeout);
+    replyTimeout = std::min(replyTimeout,
+                            std::max<std::chrono::milliseconds>(
+                                t * 2, DHT_MESSAGE_MIN_TIMEOUT));
+    stallTimeout = std::max<std::chrono::milliseconds>(
+        t, DHT_MESSAGE_MIN_STALL_TIMEOUT);
+  }
   entries_.push_back(make_unique<DHTMessageTrackerEntry>(
-      message->getRemoteNode(), message->getTransactionID(),
-      message->getMessageType(), std::move(timeout), std::move(callback)));
+      node, message->getTransactionID(), message->getMessageType(),
+      replyTimeout, std::move(callback), stallTimeout));
 }
 
 std::pair<std::unique_ptr<DHTResponseMessage>,
@@ -122,8 +133,6 @@ void DHTMessageTracker::handleTimeoutEntry(DHTMessageTrackerEntry* entry)
     auto& node = entry->getTargetNode();
     A2_LOG_DEBUG(fmt("Message timeout: To:%s:%u", node->getIPAddress().c_str(),
                      node->getPort()));
-    node->updateRTT(std::chrono::duration_cast<std::chrono::milliseconds>(
-        entry->getElapsed()));
     node->timeout();
     if (node->isBad()) {
       A2_LOG_DEBUG(fmt("Marked bad: %s:%u", node->getIPAddress().c_str(),
@@ -149,13 +158,50 @@ void DHTMessageTracker::handleTimeout()
                          handleTimeoutEntry(ent.get());
                          return true;
                        }
-                       else {
-                         return false;
+                       if (ent->isStalled()) {
+                         ent->setStalled();
+                         auto& callback = ent->getCallback();
+                         if (callback) {
+                           callback->onStall(ent->getTargetNode());
+                         }
                        }
+                       return false;
                      }),
       std::end(entries_));
 }
 
+void DHTMessageTracker::handleSendFailure(const std::string& ipaddr,
+                                          uint16_t port)
+{
+  entries_.erase(
+      std::remove_if(std::begin(entries_), std::end(entries_),
+                     [&](const std::unique_ptr<DHTMessageTrackerEntry>& ent) {
+                       auto& node = ent->getTargetNode();
+                       if (node->getPort() == port &&
+                           node->getIPAddress() == ipaddr) {
+                         handleTimeoutEntry(ent.get());
+                         return true;
+                       }
+                       return false;
+                     }),
+      std::end(entries_));
+}
+
+bool DHTMessageTracker::getNextDeadline(Timer& deadline) const
+{
+  if (entries_.empty()) {
+    return false;
+  }
+  deadline = entries_.front()->getDeadline();
+  for (auto& ent : entries_) {
+    auto t = ent->getDeadline();
+    if (t < deadline) {
+      deadline = t;
+    }
+  }
+  return true;
+}
+
 const DHTMessageTrackerEntry*
 DHTMessageTracker::getEntryFor(const DHTMessage* message) const
 {
@@ -42,6 +42,7 @@
 #include <memory>
 
 #include "a2time.h"
+#include "TimerA2.h"
 #include "ValueBase.h"
 
 namespace aria2 {
@@ -64,6 +65,9 @@ private:
 public:
   DHTMessageTracker();
 
+  // |timeout| is the maximum time to wait for a reply.  If the RTT of
+  // the remote node has been measured, a shorter timeout is computed
+  // from it.
   void addMessage(DHTMessage* message, std::chrono::seconds timeout,
                   std::unique_ptr<DHTMessageCallback> callback =
                       std::unique_ptr<DHTMessageCallback>{});
@@ -72,8 +76,18 @@ public:
             std::unique_ptr<DHTMessageCallback>>
   messageArrived(const Dict* dict, const std::string& ipaddr, uint16_t port);
 
+  // Handles timed out messages, and notifies callbacks of stalled
+  // ones.
   void handleTimeout();
 
+  // Handles the messages to ipaddr:port as timed out, because they
+  // could not be sent.
+  void handleSendFailure(const std::string& ipaddr, uint16_t port);
+
+  // Stores the earliest time when handleTimeout() has something to do
+  // in |deadline|.  Returns false if there is no message.
+  bool getNextDeadline(Timer& deadline) const;
+
   // Made public so that unnamed functor can access this
   void handleTimeoutEntry(DHTMessageTrackerEntry* entry);
 
@@ -33,6 +33,9 @@
  */
 /* copyright --> */
 #include "DHTMessageTrackerEntry.h"
+
+#include <algorithm>
+
 #include "DHTNode.h"
 #include "DHTMessage.h"
 #include "DHTMessageCallback.h"
@@ -44,14 +47,17 @@ namespace aria2 {
 
 DHTMessageTrackerEntry::DHTMessageTrackerEntry(
     std::shared_ptr<DHTNode> targetNode, std::string transactionID,
-    std::string messageType, std::chrono::seconds timeout,
-    std::unique_ptr<DHTMessageCallback> callback)
+    std::string messageType, std::chrono::milliseconds timeout,
+    std::unique_ptr<DHTMessageCallback> callback,
+    std::chrono::milliseconds stallTimeout)
     : targetNode_{std::move(targetNode)},
       transactionID_{std::move(transactionID)},
       messageType_{std::move(messageType)},
       callback_{std::move(callback)},
       dispatchedTime_{global::wallclock()},
-      timeout_{std::move(timeout)}
+      timeout_{std::move(timeout)},
+      stallTimeout_{std::min(stallTimeout, timeout_)},
+      stalled_{false}
 {
 }
 
@@ -60,6 +66,19 @@ bool DHTMessageTrackerEntry::isTimeout() const
   return dispatchedTime_.difference(global::wallclock()) >= timeout_;
 }
 
+bool DHTMessageTrackerEntry::isStalled() const
+{
+  return !stalled_ &&
+         dispatchedTime_.difference(global::wallclock()) >= stallTimeout_;
+}
+
+Timer DHTMessageTrackerEntry::getDeadline() const
+{
+  auto deadline = dispatchedTime_;
+  deadline.advance(stalled_ ? timeout_ : stallTimeout_);
+  return deadline;
+}
+
 void DHTMessageTrackerEntry::extendTimeout() {}
 
 bool DHTMessageTrackerEntry::match(const std::string& transactionID,
@@ -61,17 +61,33 @@ private:
 
   Timer dispatchedTime_;
 
-  std::chrono::seconds timeout_;
+  std::chrono::milliseconds timeout_;
+
+  std::chrono::milliseconds stallTimeout_;
+
+  bool stalled_;
 
 public:
+  // If |stallTimeout| is not given, it is the same as |timeout|.
   DHTMessageTrackerEntry(std::shared_ptr<DHTNode> targetNode,
                          std::string transactionID, std::string messageType,
-                         std::chrono::seconds timeout,
+                         std::chrono::milliseconds timeout,
                          std::unique_ptr<DHTMessageCallback> callback =
-                             std::unique_ptr<DHTMessageCallback>{});
+                             std::unique_ptr<DHTMessageCallback>{},
+                         std::chrono::milliseconds stallTimeout =
+                             std::chrono::milliseconds::max());
 
   bool isTimeout() const;
 
+  // Returns true if stallTimeout has elapsed and the entry has not
+  // been marked as stalled yet.
+  bool isStalled() const;
+
+  void setStalled() { stalled_ = true; }
+
+  // Returns the time when isTimeout() or isStalled() becomes true.
+  Timer getDeadline() const;
+
   void extendTimeout();
 
   bool match(const std::string& transactionID, const std::string& ipaddr,
@@ -44,13 +44,23 @@
 namespace aria2 {
 
 DHTNode::DHTNode()
-    : port_(0), rtt_(0), condition_(0), lastContact_(Timer::zero())
+    : port_(0),
+      rtt_(0),
+      rttVar_(0),
+      rttMeasured_(false),
+      condition_(0),
+      lastContact_(Timer::zero())
 {
   generateID();
 }
 
 DHTNode::DHTNode(const unsigned char* id)
-    : port_(0), rtt_(0), condition_(1), lastContact_(Timer::zero())
+    : port_(0),
+      rtt_(0),
+      rttVar_(0),
+      rttMeasured_(false),
+      condition_(1),
+      lastContact_(Timer::zero())
 {
   memcpy(id_, id, DHT_ID_LENGTH);
 }
@@ -99,6 +109,28 @@ void DHTNode::updateLastContact() { lastContact_ = global::wallclock(); }
 
 void DHTNode::timeout() { ++condition_; }
 
+void DHTNode::updateRTT(std::chrono::milliseconds t)
+{
+  if (!rttMeasured_) {
+    rtt_ = t;
+    rttVar_ = t / 2;
+    rttMeasured_ = true;
+    return;
+  }
+  auto diff = rtt_ > t ? rtt_ - t : t - rtt_;
+  rttVar_ = (rttVar_ * 3 + diff) / 4;
+  rtt_ = (rtt_ * 7 + t) / 8;
+}
+
+std::chrono::milliseconds
+DHTNode::getReplyTimeout(std::chrono::milliseconds fallback) const
+{
+  if (!rttMeasured_) {
+    return fallback;
+  }
+  return rtt_ + rttVar_ * 4;
+}
+
 std::string DHTNode::toString() const
 {
   return fmt("DHTNode ID=%s, Host=%s(%u), Condition=%d, RTT=%ld",
@@ -52,8 +52,13 @@ private:
 
   uint16_t port_;
 
+  // Smoothed RTT and its variation, computed as in RFC 6298.
   std::chrono::milliseconds rtt_;
 
+  std::chrono::milliseconds rttVar_;
+
+  bool rttMeasured_;
+
   int condition_;
 
   Timer lastContact_;
@@ -72,7 +77,18 @@ public:
 
   const unsigned char* getID() const { return id_; }
 
-  void updateRTT(std::chrono::milliseconds t) { rtt_ = std::move(t); }
+  // Updates the smoothed RTT with the new sample |t|.
+  void updateRTT(std::chrono::milliseconds t);
+
+  const std::chrono::milliseconds& getRTT() const { return rtt_; }
+
+  bool isRTTMeasured() const { return rttMeasured_; }
+
+  // Returns the time to wait for a reply, computed from the smoothed
+  // RTT and its variation.  Returns |fallback| if no RTT has been
+  // measured.
+  std::chrono::milliseconds
+  getReplyTimeout(std::chrono::milliseconds fallback) const;
 
   const std::string& getIPAddress() const { return ipaddr_; }
 
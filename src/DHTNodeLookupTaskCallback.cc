@@ -77,4 +77,10 @@ void DHTNodeLookupTaskCallback::onTimeout(
   task_->onTimeout(remoteNode);
 }
 
+void DHTNodeLookupTaskCallback::onStall(
+    const std::shared_ptr<DHTNode>& remoteNode)
+{
+  task_->onStall(remoteNode);
+}
+
 } // namespace aria2
@@ -58,6 +58,9 @@ public:
 
   virtual void
   onTimeout(const std::shared_ptr<DHTNode>& remoteNode) CXX11_OVERRIDE;
+
+  virtual void
+  onStall(const std::shared_ptr<DHTNode>& remoteNode) CXX11_OVERRIDE;
 };
 
 } // namespace aria2
@@ -49,16 +49,44 @@ DHTPeerAnnounceEntry::DHTPeerAnnounceEntry(const unsigned char* infoHash)
 
 DHTPeerAnnounceEntry::~DHTPeerAnnounceEntry() = default;
 
-void DHTPeerAnnounceEntry::addPeerAddrEntry(const PeerAddrEntry& entry)
+bool DHTPeerAnnounceEntry::addPeerAddrEntry(const PeerAddrEntry& entry)
 {
+  notifyUpdate();
   auto i = std::find(peerAddrEntries_.begin(), peerAddrEntries_.end(), entry);
-  if (i == peerAddrEntries_.end()) {
+  if (i != peerAddrEntries_.end()) {
+    (*i).notifyUpdate();
+    return false;
+  }
+  if (peerAddrEntries_.size() < DHT_PEER_ANNOUNCE_MAX_PEERS) {
     peerAddrEntries_.push_back(entry);
   }
   else {
-    (*i).notifyUpdate();
+    auto oldest = std::min_element(
+        std::begin(peerAddrEntries_), std::end(peerAddrEntries_),
+        [](const PeerAddrEntry& lhs, const PeerAddrEntry& rhs) {
+          return lhs.getLastUpdated() < rhs.getLastUpdated();
+        });
+    *oldest = entry;
+  }
+  return true;
+}
+
+const PeerAddrEntry*
+DHTPeerAnnounceEntry::findPeerAddrEntry(const PeerAddrEntry& entry) const
+{
+  auto i = std::find(peerAddrEntries_.begin(), peerAddrEntries_.end(), entry);
+  if (i == peerAddrEntries_.end()) {
+    return nullptr;
+  }
+  return &*i;
+}
+
+void DHTPeerAnnounceEntry::removePeerAddrEntry(const PeerAddrEntry& entry)
+{
+  auto i = std::find(peerAddrEntries_.begin(), peerAddrEntries_.end(), entry);
+  if (i != peerAddrEntries_.end()) {
+    peerAddrEntries_.erase(i);
   }
-  notifyUpdate();
 }
 
 size_t DHTPeerAnnounceEntry::countPeerAddrEntry() const
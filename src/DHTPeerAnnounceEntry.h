@@ -62,8 +62,16 @@ public:
   ~DHTPeerAnnounceEntry();
 
   // add peer addr entry.
-  // if it already exists, update "Last Updated" property.
-  void addPeerAddrEntry(const PeerAddrEntry& entry);
+  // if it already exists, update "Last Updated" property.  If there
+  // are already DHT_PEER_ANNOUNCE_MAX_PEERS entries, the least
+  // recently updated one is replaced.  Returns true if |entry| is
+  // stored as a new entry.
+  bool addPeerAddrEntry(const PeerAddrEntry& entry);
+
+  // Returns the stored entry which equals to |entry|, or nullptr.
+  const PeerAddrEntry* findPeerAddrEntry(const PeerAddrEntry& entry) const;
+
+  void removePeerAddrEntry(const PeerAddrEntry& entry);
 
   size_t countPeerAddrEntry() const;
 
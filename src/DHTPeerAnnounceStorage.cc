@@ -52,33 +52,33 @@
 
 namespace aria2 {
 
-DHTPeerAnnounceStorage::DHTPeerAnnounceStorage()
-    : taskQueue_{nullptr}, taskFactory_{nullptr}
+namespace {
+DHTPeerAnnounceStorage::InfoHash toInfoHash(const unsigned char* infoHash)
 {
+  DHTPeerAnnounceStorage::InfoHash res;
+  memcpy(res.data(), infoHash, DHT_ID_LENGTH);
+  return res;
 }
+} // namespace
 
-bool DHTPeerAnnounceStorage::InfoHashLess::
-operator()(const std::shared_ptr<DHTPeerAnnounceEntry>& lhs,
-           const std::shared_ptr<DHTPeerAnnounceEntry>& rhs)
+DHTPeerAnnounceStorage::DHTPeerAnnounceStorage()
+    : numPeer_{0},
+      maxPeer_{DHT_PEER_ANNOUNCE_MAX_TOTAL_PEERS},
+      taskQueue_{nullptr},
+      taskFactory_{nullptr}
 {
-  return memcmp(lhs->getInfoHash(), rhs->getInfoHash(), DHT_ID_LENGTH) < 0;
 }
 
-std::shared_ptr<DHTPeerAnnounceEntry>
-DHTPeerAnnounceStorage::getPeerAnnounceEntry(const unsigned char* infoHash)
-{
-  auto entry = std::make_shared<DHTPeerAnnounceEntry>(infoHash);
+DHTPeerAnnounceStorage::~DHTPeerAnnounceStorage() = default;
 
-  auto i = entries_.lower_bound(entry);
-
-  if (i != entries_.end() &&
-      memcmp(infoHash, (*i)->getInfoHash(), DHT_ID_LENGTH) == 0) {
-    entry = *i;
-  }
-  else {
-    entries_.insert(i, entry);
-  }
-  return entry;
+size_t DHTPeerAnnounceStorage::InfoHashHash::
+operator()(const InfoHash& infoHash) const
+{
+  // Infohashes are SHA-1 digests, so any part of them is uniformly
+  // distributed.
+  size_t h;
+  memcpy(&h, infoHash.data(), sizeof(h));
+  return h;
 }
 
 void DHTPeerAnnounceStorage::addPeerAnnounce(const unsigned char* infoHash,
@@ -88,24 +88,87 @@ void DHTPeerAnnounceStorage::addPeerAnnounce(const unsigned char* infoHash,
   A2_LOG_DEBUG(fmt("Adding %s:%u to peer announce list: infoHash=%s",
                    ipaddr.c_str(), port,
                    util::toHex(infoHash, DHT_ID_LENGTH).c_str()));
-  getPeerAnnounceEntry(infoHash)->addPeerAddrEntry(PeerAddrEntry(ipaddr, port));
+  PeerAddrEntry peerAddrEntry(ipaddr, port, global::wallclock());
+  if (!peerAddrEntry.good()) {
+    A2_LOG_DEBUG(fmt("Ignored peer announce from bad address %s",
+                     ipaddr.c_str()));
+    return;
+  }
+  auto key = toInfoHash(infoHash);
+  auto i = entries_.find(key);
+  if (i == entries_.end()) {
+    i = entries_.emplace(key, DHTPeerAnnounceEntry(infoHash)).first;
+  }
+  auto& entry = (*i).second;
+  auto p = entry.findPeerAddrEntry(peerAddrEntry);
+  // If the peer was announced at the same time, its element in
+  // expiryQueue_ stays the latest one.
+  auto queued = p && !(p->getLastUpdated() < peerAddrEntry.getLastUpdated());
+  auto before = entry.countPeerAddrEntry();
+  if (entry.addPeerAddrEntry(peerAddrEntry)) {
+    numPeer_ += entry.countPeerAddrEntry() - before;
+  }
+  if (!queued) {
+    expiryQueue_.push_back(Announce{key, peerAddrEntry});
+    shrink();
+  }
+}
+
+bool DHTPeerAnnounceStorage::isLatest(const Announce& announce) const
+{
+  auto i = entries_.find(announce.infoHash);
+  if (i == entries_.end()) {
+    return false;
+  }
+  auto p = (*i).second.findPeerAddrEntry(announce.peerAddrEntry);
+  return p &&
+         !(announce.peerAddrEntry.getLastUpdated() < p->getLastUpdated());
+}
+
+void DHTPeerAnnounceStorage::expireFront()
+{
+  auto announce = std::move(expiryQueue_.front());
+  expiryQueue_.pop_front();
+  if (!isLatest(announce)) {
+    return;
+  }
+  auto i = entries_.find(announce.infoHash);
+  auto& entry = (*i).second;
+  entry.removePeerAddrEntry(announce.peerAddrEntry);
+  --numPeer_;
+  if (entry.empty()) {
+    entries_.erase(i);
+  }
+}
+
+void DHTPeerAnnounceStorage::shrink()
+{
+  while (!expiryQueue_.empty() && numPeer_ > maxPeer_) {
+    expireFront();
+  }
+  // Each stored peer has exactly one latest element.  Removing stale
+  // elements only after they outnumber the peers keeps the cost
+  // amortized constant per announce.
+  if (expiryQueue_.size() > 2 * numPeer_) {
+    expiryQueue_.erase(
+        std::remove_if(
+            std::begin(expiryQueue_), std::end(expiryQueue_),
+            [this](const Announce& announce) { return !isLatest(announce); }),
+        std::end(expiryQueue_));
+  }
 }
 
 bool DHTPeerAnnounceStorage::contains(const unsigned char* infoHash) const
 {
-  auto entry = std::make_shared<DHTPeerAnnounceEntry>(infoHash);
-  return std::binary_search(entries_.begin(), entries_.end(), entry,
-                            InfoHashLess());
+  return entries_.count(toInfoHash(infoHash));
 }
 
 void DHTPeerAnnounceStorage::getPeers(std::vector<std::shared_ptr<Peer>>& peers,
                                       const unsigned char* infoHash)
 {
-  auto entry = std::make_shared<DHTPeerAnnounceEntry>(infoHash);
-
-  auto i = entries_.find(entry);
+  auto i = entries_.find(toInfoHash(infoHash));
   if (i != entries_.end()) {
-    (*i)->getPeers(peers);
+    (*i).second.getPeers(peers);
   }
 }
 
@@ -113,27 +176,38 @@ void DHTPeerAnnounceStorage::handleTimeout()
 {
   A2_LOG_DEBUG(fmt("Now purge peer announces(%lu entries) which are timed out.",
                    static_cast<unsigned long>(entries_.size())));
-  std::for_each(std::begin(entries_), std::end(entries_),
-                [](const std::shared_ptr<DHTPeerAnnounceEntry>& e) {
-                  e->removeStalePeerAddrEntry(DHT_PEER_ANNOUNCE_PURGE_INTERVAL);
-                });
-
-  for (auto i = std::begin(entries_); i != std::end(entries_);) {
-    if ((*i)->empty()) {
-      entries_.erase(i++);
-    }
-    else {
-      ++i;
-    }
+  while (!expiryQueue_.empty() &&
+         expiryQueue_.front().peerAddrEntry.getLastUpdated().difference(
+             global::wallclock()) >= DHT_PEER_ANNOUNCE_PURGE_INTERVAL) {
+    expireFront();
   }
-  A2_LOG_DEBUG(fmt("Currently %lu peer announce entries",
-                   static_cast<unsigned long>(entries_.size())));
+  A2_LOG_DEBUG(fmt("Currently %lu peer announce entries, %lu peers",
+                   static_cast<unsigned long>(entries_.size()),
+                   static_cast<unsigned long>(numPeer_)));
+}
+
+size_t DHTPeerAnnounceStorage::estimateMemory() const
+{
+  // Each element of unordered_map is allocated as a node holding the
+  // next pointer and the cached hash value besides the value.
+  return entries_.bucket_count() * sizeof(void*) +
+         entries_.size() *
+             (sizeof(decltype(entries_)::value_type) + 2 * sizeof(void*)) +
+         numPeer_ * sizeof(PeerAddrEntry) +
+         expiryQueue_.size() * sizeof(Announce);
+}
+
+void DHTPeerAnnounceStorage::setMaxPeer(size_t maxPeer)
+{
+  maxPeer_ = maxPeer;
+  shrink();
 }
 
 void DHTPeerAnnounceStorage::announcePeer()
 {
   A2_LOG_DEBUG("Now announcing peer.");
-  for (auto& e : entries_) {
+  for (auto& i : entries_) {
+    auto e = &i.second;
     if (e->getLastUpdated().difference(global::wallclock()) <
         DHT_PEER_ANNOUNCE_INTERVAL) {
       continue;
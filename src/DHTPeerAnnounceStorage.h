@@ -37,31 +37,63 @@
 
 #include "common.h"
 
-#include <set>
+#include <array>
+#include <deque>
+#include <unordered_map>
 #include <vector>
 #include <string>
 #include <memory>
 
+#include "DHTConstants.h"
+#include "DHTPeerAnnounceEntry.h"
+
 namespace aria2 {
 
 class Peer;
-class DHTPeerAnnounceEntry;
 class DHTTaskQueue;
 class DHTTaskFactory;
 
 class DHTPeerAnnounceStorage {
+public:
+  typedef std::array<unsigned char, DHT_ID_LENGTH> InfoHash;
+
 private:
-  class InfoHashLess {
+  class InfoHashHash {
   public:
-    bool operator()(const std::shared_ptr<DHTPeerAnnounceEntry>& lhs,
-                    const std::shared_ptr<DHTPeerAnnounceEntry>& rhs);
+    size_t operator()(const InfoHash& infoHash) const;
+  };
+
+  std::unordered_map<InfoHash, DHTPeerAnnounceEntry, InfoHashHash> entries_;
+
+  // Every announce is appended with its time, so that the queue is
+  // ordered by announce time and the front is the least recently
+  // announced peer.  An element is stale if its peer has been
+  // announced again or replaced since then; such elements are
+  // skipped when popped.
+  struct Announce {
+    InfoHash infoHash;
+    PeerAddrEntry peerAddrEntry;
   };
-  typedef std::set<std::shared_ptr<DHTPeerAnnounceEntry>, InfoHashLess>
-      DHTPeerAnnounceEntrySet;
-  DHTPeerAnnounceEntrySet entries_;
 
-  std::shared_ptr<DHTPeerAnnounceEntry>
-  getPeerAnnounceEntry(const unsigned char* infoHash);
+  std::deque<Announce> expiryQueue_;
+
+  // The total number of peers in entries_.
+  size_t numPeer_;
+
+  size_t maxPeer_;
+
+  // Returns true if |announce| is the latest announce of a stored
+  // peer.
+  bool isLatest(const Announce& announce) const;
+
+  // Pops the front of expiryQueue_ and removes its peer unless the
+  // element is stale.
+  void expireFront();
+
+  // Drops the least recently announced peers while the number of
+  // peers is over the limit, and removes stale elements from
+  // expiryQueue_ once they outnumber the stored peers.
+  void shrink();
 
   DHTTaskQueue* taskQueue_;
 
@@ -70,6 +102,8 @@ private:
 public:
   DHTPeerAnnounceStorage();
 
+  ~DHTPeerAnnounceStorage();
+
   void addPeerAnnounce(const unsigned char* infoHash, const std::string& ipaddr,
                        uint16_t port);
 
@@ -79,9 +113,21 @@ public:
                 const unsigned char* infoHash);
 
   // drop peer announce entry which is not updated in the past
-  // DHT_PEER_ANNOUNCE_PURGE_INTERVAL seconds.
+  // DHT_PEER_ANNOUNCE_PURGE_INTERVAL seconds.  Only expired peers are
+  // visited.
   void handleTimeout();
 
+  size_t countInfoHash() const { return entries_.size(); }
+
+  size_t countPeer() const { return numPeer_; }
+
+  // Returns the estimated number of bytes used to store announces.
+  size_t estimateMemory() const;
+
+  // Sets the maximum number of peers stored for all infohashes.  The
+  // default value is DHT_PEER_ANNOUNCE_MAX_TOTAL_PEERS.
+  void setMaxPeer(size_t maxPeer);
+
   // announce peer in every DHT_PEER_ANNOUNCE_PURGE_INTERVAL.
   // The torrents which are announced in the past
   // DHT_PEER_ANNOUNCE_PURGE_INTERVAL
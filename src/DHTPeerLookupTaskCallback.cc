@@ -74,4 +74,10 @@ void DHTPeerLookupTaskCallback::onTimeout(
   task_->onTimeout(remoteNode);
 }
 
+void DHTPeerLookupTaskCallback::onStall(
+    const std::shared_ptr<DHTNode>& remoteNode)
+{
+  task_->onStall(remoteNode);
+}
+
 } // namespace aria2
@@ -46,6 +46,8 @@
 
 namespace aria2 {
 
+DHTRegistry::Data::Data() : initialized(false) {}
+
 DHTRegistry::Data DHTRegistry::data_;
 
 DHTRegistry::Data DHTRegistry::data6_;
@@ -68,4 +70,18 @@ void DHTRegistry::clearData() { clear(data_); }
 
 void DHTRegistry::clearData6() { clear(data6_); }
 
+void DHTRegistry::getPeerAnnounceStat(size_t& numInfoHash, size_t& numPeer,
+                                      size_t& memory)
+{
+  numInfoHash = numPeer = memory = 0;
+  for (auto storage : {data_.peerAnnounceStorage.get(),
+                       data6_.peerAnnounceStorage.get()}) {
+    if (storage) {
+      numInfoHash += storage->countInfoHash();
+      numPeer += storage->countPeer();
+      memory += storage->estimateMemory();
+    }
+  }
+}
+
 } // namespace aria2
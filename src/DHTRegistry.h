@@ -74,7 +74,7 @@ private:
 
     std::unique_ptr<DHTMessageFactory> messageFactory;
 
-    Data() : initialized(false) {}
+    Data();
   };
 
   static Data data_;
@@ -104,6 +104,12 @@ public:
   static bool isInitialized6() { return data6_.initialized; }
 
   static void setInitialized6(bool f) { data6_.initialized = f; }
+
+  // Stores the number of infohashes and peers in the peer announce
+  // storages of IPv4 and IPv6 DHT, and their estimated memory usage
+  // in bytes, in |numInfoHash|, |numPeer| and |memory| respectively.
+  static void getPeerAnnounceStat(size_t& numInfoHash, size_t& numPeer,
+                                  size_t& memory);
 };
 
 } // namespace aria2
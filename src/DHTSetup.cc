@@ -167,6 +167,8 @@ DHTSetup::setup(DownloadEngine* e, int family)
     taskFactory->setMessageFactory(factory.get());
     taskFactory->setTaskQueue(taskQueue.get());
     taskFactory->setTimeout(std::chrono::seconds(messageTimeout));
+    taskFactory->setLookupConcurrency(
+        e->getOption()->getAsInt(PREF_DHT_LOOKUP_CONCURRENCY));
 
     routingTable->setTaskQueue(taskQueue.get());
     routingTable->setTaskFactory(taskFactory.get());
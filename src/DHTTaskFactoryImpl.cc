@@ -55,7 +55,8 @@ DHTTaskFactoryImpl::DHTTaskFactoryImpl()
       dispatcher_(nullptr),
       factory_(nullptr),
       taskQueue_(nullptr),
-      timeout_(DHT_MESSAGE_TIMEOUT)
+      timeout_(DHT_MESSAGE_TIMEOUT),
+      lookupConcurrency_(DHT_LOOKUP_CONCURRENCY)
 {
 }
 
@@ -75,6 +76,7 @@ std::shared_ptr<DHTTask>
 DHTTaskFactoryImpl::createNodeLookupTask(const unsigned char* targetID)
 {
   auto task = std::make_shared<DHTNodeLookupTask>(targetID);
+  task->setConcurrency(lookupConcurrency_);
   setCommonProperty(task);
   return task;
 }
@@ -93,6 +95,7 @@ std::shared_ptr<DHTTask> DHTTaskFactoryImpl::createPeerLookupTask(
   auto task = std::make_shared<DHTPeerLookupTask>(ctx, tcpPort);
   // TODO this may be not freed by RequestGroup::releaseRuntimeResource()
   task->setPeerStorage(peerStorage);
+  task->setConcurrency(lookupConcurrency_);
   setCommonProperty(task);
   return task;
 }
@@ -61,6 +61,8 @@ private:
 
   std::chrono::seconds timeout_;
 
+  size_t lookupConcurrency_;
+
   void setCommonProperty(const std::shared_ptr<DHTAbstractTask>& task);
 
 public:
@@ -102,6 +104,11 @@ public:
   {
     timeout_ = std::move(timeout);
   }
+
+  void setLookupConcurrency(size_t concurrency)
+  {
+    lookupConcurrency_ = concurrency;
+  }
 };
 
 } // namespace aria2
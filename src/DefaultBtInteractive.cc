@@ -212,6 +212,9 @@ void DefaultBtInteractive::addHandshakeExtendedMessageToQueue()
 
 void DefaultBtInteractive::addBitfieldMessageToQueue()
 {
+  // The message below carries every piece advertised so far, so
+  // checkHave() does not have to send them again as have messages.
+  lastHaveIndex_ = pieceStorage_->getLastHaveIndex();
   if (peer_->isFastExtensionEnabled()) {
     if (pieceStorage_->allDownloadFinished()) {
       dispatcher_->addMessageToQueue(messageFactory_->createHaveAllMessage());
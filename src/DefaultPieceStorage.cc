@@ -92,7 +92,8 @@ DefaultPieceStorage::DefaultPieceStorage(
       pieceStatMan_(std::make_shared<PieceStatMan>(
           downloadContext->getNumPieces(), true)),
       pieceSelector_(make_unique<RarestPieceSelector>(pieceStatMan_)),
-      wrDiskCache_(nullptr)
+      wrDiskCache_(nullptr),
+      rdDiskCache_(nullptr)
 {
   const std::string& pieceSelectorOpt =
       option_->get(PREF_STREAM_PIECE_SELECTOR);
@@ -137,7 +138,9 @@ std::shared_ptr<Piece> DefaultPieceStorage::checkOutPiece(size_t index,
       !piece->getWrDiskCacheEntry()) {
     // So, we rely on the fact that diskAdaptor_ is not reinitialized
     // in the session.
-    piece->initWrCache(wrDiskCache_, diskAdaptor_);
+    piece->initWrCache(wrDiskCache_, diskAdaptor_,
+                       static_cast<int64_t>(index) *
+                           downloadContext_->getPieceLength());
   }
   return piece;
 }
@@ -685,6 +688,8 @@ std::shared_ptr<DiskAdaptor> DefaultPieceStorage::getDiskAdaptor()
 
 WrDiskCache* DefaultPieceStorage::getWrDiskCache() { return wrDiskCache_; }
 
+RdDiskCache* DefaultPieceStorage::getRdDiskCache() { return rdDiskCache_; }
+
 void DefaultPieceStorage::flushWrDiskCacheEntry()
 {
   if (!wrDiskCache_) {
@@ -716,21 +721,30 @@ void DefaultPieceStorage::advertisePiece(cuid_t cuid, size_t index,
 uint64_t DefaultPieceStorage::getAdvertisedPieceIndexes(
     std::vector<size_t>& indexes, cuid_t myCuid, uint64_t lastHaveIndex)
 {
-  auto it =
-      std::upper_bound(std::begin(haves_), std::end(haves_), lastHaveIndex,
-                       [](uint64_t lastHaveIndex, const HaveEntry& have) {
-                         return lastHaveIndex < have.haveIndex;
-                       });
-
-  if (it == std::end(haves_)) {
+  // Every PeerInteractionCommand calls this function in each
+  // iteration, so return early if there is nothing new for the
+  // caller.
+  if (haves_.empty() || lastHaveIndex >= haves_.back().haveIndex) {
     return lastHaveIndex;
   }
 
+  // haveIndex of the entries in haves_ is contiguous, so we can
+  // locate the first new entry without searching.
+  auto it = std::begin(haves_);
+  if (lastHaveIndex >= haves_.front().haveIndex) {
+    it += lastHaveIndex - haves_.front().haveIndex + 1;
+  }
+
   for (; it != std::end(haves_); ++it) {
     indexes.push_back((*it).index);
   }
 
-  return (*(std::end(haves_) - 1)).haveIndex;
+  return haves_.back().haveIndex;
+}
+
+uint64_t DefaultPieceStorage::getLastHaveIndex() const
+{
+  return nextHaveIndex_ - 1;
 }
 
 void DefaultPieceStorage::removeAdvertisedPiece(const Timer& expiry)
@@ -35,11 +35,45 @@
 #include "DiskAdaptor.h"
 #include "FileEntry.h"
 #include "OpenedFileCounter.h"
+#include "WrDiskCacheEntry.h"
+#include "LogFactory.h"
+#include "fmt.h"
 
 namespace aria2 {
 
-DiskAdaptor::DiskAdaptor() : fileAllocationMethod_(FILE_ALLOC_ADAPTIVE) {}
+DiskAdaptor::DiskAdaptor()
+    : fileAllocationMethod_(FILE_ALLOC_ADAPTIVE), maxOpenFiles_(0)
+{
+}
 
 DiskAdaptor::~DiskAdaptor() = default;
 
+void DiskAdaptor::writeCache(const WrDiskCacheEntry* entry)
+{
+  DataBuffers bufs;
+  int64_t goff = 0;
+  int64_t last = 0;
+  for (auto& d : entry->getDataSet()) {
+    A2_LOG_DEBUG(fmt("Cache flush goff=%" PRId64 ", len=%lu", d->goff,
+                     static_cast<unsigned long>(d->len)));
+    if (!bufs.empty() && d->goff != last) {
+      writeDataVector(bufs, goff);
+      bufs.clear();
+    }
+    if (bufs.empty()) {
+      goff = last = d->goff;
+    }
+    bufs.emplace_back(d->data + d->offset, d->len);
+    last += d->len;
+  }
+  if (!bufs.empty()) {
+    writeDataVector(bufs, goff);
+  }
+}
+
+void DiskAdaptor::writeDataVector(const DataBuffers& bufs, int64_t offset)
+{
+  writeDataBuffers(*this, bufs, offset);
+}
+
 } // namespace aria2
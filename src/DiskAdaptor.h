@@ -42,6 +42,7 @@
 #include <memory>
 
 #include "TimeA2.h"
+#include "DiskWriter.h"
 
 namespace aria2 {
 
@@ -49,6 +50,9 @@ class FileEntry;
 class FileAllocationIterator;
 class WrDiskCacheEntry;
 class OpenedFileCounter;
+#ifdef ENABLE_THREADS
+class ThreadPool;
+#endif // ENABLE_THREADS
 
 class DiskAdaptor : public BinaryStream {
 public:
@@ -96,6 +100,12 @@ public:
   // have been opened before this method call.
   virtual void enableMmap() {}
 
+#ifdef ENABLE_THREADS
+  // Lets DiskWriters write data in |threadPool|.  See
+  // DiskWriter::enableAsyncWrite().
+  virtual void enableAsyncWrite(std::shared_ptr<ThreadPool> threadPool) {}
+#endif // ENABLE_THREADS
+
   // Assumed each file length is stored in fileEntries or DiskAdaptor knows it.
   // If each actual file's length is larger than that, truncate file to that
   // length.
@@ -111,8 +121,24 @@ public:
   virtual ssize_t readDataDropCache(unsigned char* data, size_t len,
                                     int64_t offset) = 0;
 
-  // Writes cached data to the underlying disk.
-  virtual void writeCache(const WrDiskCacheEntry* entry) = 0;
+  // Writes cached data to the underlying disk.  Adjacent data are
+  // passed to writeDataVector() together.
+  virtual void writeCache(const WrDiskCacheEntry* entry);
+
+  // Writes |bufs| to the region starting at |offset|.  The default
+  // implementation calls writeData() for each buffer.
+  virtual void writeDataVector(const DataBuffers& bufs, int64_t offset);
+
+  // Returns the file descriptor of the file which contains |offset|,
+  // opening the file if necessary, and stores the offset in that
+  // file in |fileOffset|.  |len| is reduced so that the region does
+  // not go beyond the end of the file.  Returns -1 if the data cannot
+  // be read by a file descriptor.  The default implementation returns
+  // -1.
+  virtual int getReadFd(int64_t offset, int64_t& fileOffset, size_t& len)
+  {
+    return -1;
+  }
 
   void setFileAllocationMethod(FileAllocationMethod method)
   {
@@ -137,12 +163,20 @@ public:
     return openedFileCounter_;
   }
 
+  // Sets the maximum number of files this object keeps open at the
+  // same time when OpenedFileCounter is not set.  0 means no limit.
+  void setMaxOpenFiles(size_t maxOpenFiles) { maxOpenFiles_ = maxOpenFiles; }
+
+  size_t getMaxOpenFiles() const { return maxOpenFiles_; }
+
 private:
   std::vector<std::shared_ptr<FileEntry>> fileEntries_;
 
   FileAllocationMethod fileAllocationMethod_;
 
   std::shared_ptr<OpenedFileCounter> openedFileCounter_;
+
+  size_t maxOpenFiles_;
 };
 
 } // namespace aria2
@@ -37,8 +37,33 @@
 
 #include "BinaryStream.h"
 
+#include <vector>
+#include <utility>
+#ifdef ENABLE_THREADS
+#  include <memory>
+#endif // ENABLE_THREADS
+
 namespace aria2 {
 
+// Pointers to data and their lengths, written to consecutive region
+// of a file.
+typedef std::vector<std::pair<const unsigned char*, size_t>> DataBuffers;
+
+// Writes |bufs| to |out| one by one, starting at |offset|.  This is
+// the fallback for the stream which cannot write them at once.
+inline void writeDataBuffers(BinaryStream& out, const DataBuffers& bufs,
+                             int64_t offset)
+{
+  for (auto& buf : bufs) {
+    out.writeData(buf.first, buf.second, offset);
+    offset += buf.second;
+  }
+}
+
+#ifdef ENABLE_THREADS
+class ThreadPool;
+#endif // ENABLE_THREADS
+
 /**
  * Interface for writing to a binary stream of bytes.
  *
@@ -85,6 +110,29 @@ public:
 
   // Drops cache in range [offset, offset + len)
   virtual void dropCache(int64_t len, int64_t offset) {}
+
+  // Returns the file descriptor of the opened file, from which the
+  // written data can be read directly, for example, by sendfile(2).
+  // Returns -1 if it is not available. The default implementation
+  // returns -1.
+  virtual int getReadFd() { return -1; }
+
+  // Writes |bufs| to the region starting at |offset|.  The
+  // implementation may write them with one system call.  The default
+  // implementation calls writeData() for each buffer.
+  virtual void writeDataVector(const DataBuffers& bufs, int64_t offset)
+  {
+    writeDataBuffers(*this, bufs, offset);
+  }
+
+#ifdef ENABLE_THREADS
+  // Makes writeData() hand the data to |threadPool| and return
+  // without waiting for the disk.  Other functions wait for the
+  // queued writes before they touch the file.  |threadPool| must have
+  // only one thread so that writes are done in order.  This is an
+  // optional functionality. The default implementation is do nothing.
+  virtual void enableAsyncWrite(std::shared_ptr<ThreadPool> threadPool) {}
+#endif // ENABLE_THREADS
 };
 
 } // namespace aria2
@@ -132,10 +132,15 @@ void flushWrDiskCacheEntry(WrDiskCache* wrDiskCache,
 
 bool DownloadCommand::executeInternal()
 {
-  if (getDownloadEngine()
-          ->getRequestGroupMan()
-          ->doesOverallDownloadSpeedExceed() ||
-      getRequestGroup()->doesDownloadSpeedExceed()) {
+  // The download bucket of RequestGroup also applies the overall
+  // limit.
+  auto& bucket = getRequestGroup()->getDownloadBucket();
+  size_t quota = bucket.available(global::wallclock());
+  if (quota == 0) {
+    // Wake up as soon as the limit permits to receive data again.
+    auto deadline = global::wallclock();
+    deadline.advance(bucket.timeToAvailable(global::wallclock()));
+    getDownloadEngine()->addTimer(deadline, this);
     addCommandSelf();
     disableReadCheckSocket();
     disableWriteCheckSocket();
@@ -157,8 +162,8 @@ bool DownloadCommand::executeInternal()
     // read data from socket here, we will get EOF and leaves 2nd
     // response unprocessed.  To prevent this, we don't read from
     // socket when buffer is not empty.
-    eof = getSocketRecvBuffer()->recv() == 0 && !getSocket()->wantRead() &&
-          !getSocket()->wantWrite();
+    eof = getSocketRecvBuffer()->recv(quota) == 0 &&
+          !getSocket()->wantRead() && !getSocket()->wantWrite();
   }
   if (!eof) {
     size_t bufSize;
@@ -242,9 +247,8 @@ bool DownloadCommand::executeInternal()
       A2_LOG_INFO(fmt(MSG_SEGMENT_DOWNLOAD_COMPLETED, getCuid()));
 
       {
-        const std::string& expectedPieceHash =
-            getDownloadContext()->getPieceHash(segment->getIndex());
-        if (pieceHashValidationEnabled_ && !expectedPieceHash.empty()) {
+        if (pieceHashValidationEnabled_ &&
+            getDownloadContext()->getPieceHash(segment->getIndex())) {
           if (
 #ifdef ENABLE_BITTORRENT
               // TODO Is this necessary?
@@ -254,14 +258,14 @@ bool DownloadCommand::executeInternal()
               segment->isHashCalculated()) {
             A2_LOG_DEBUG(fmt("Hash is available! index=%lu",
                              static_cast<unsigned long>(segment->getIndex())));
-            validatePieceHash(segment, expectedPieceHash, segment->getDigest());
+            validatePieceHash(segment, segment->getDigest());
           }
           else {
             try {
               std::string actualHash =
                   segment->getPiece()->getDigestWithWrCache(
                       segment->getSegmentLength(), diskAdaptor);
-              validatePieceHash(segment, expectedPieceHash, actualHash);
+              validatePieceHash(segment, actualHash);
             }
             catch (RecoverableException& e) {
               segment->clear(getPieceStorage()->getWrDiskCache());
@@ -287,6 +291,12 @@ bool DownloadCommand::executeInternal()
   }
   else {
     checkLowestDownloadSpeed();
+    if (lowestDownloadSpeedLimit_ > 0) {
+      // Check the speed even if the server stops sending data.
+      auto deadline = global::wallclock();
+      deadline.advance(1_s);
+      getDownloadEngine()->addTimer(deadline, this);
+    }
     setWriteCheckSocketIf(getSocket(), shouldEnableWriteCheck());
     checkSocketRecvBuffer();
     addCommandSelf();
@@ -381,17 +391,20 @@ bool DownloadCommand::prepareForNextSegment()
 }
 
 void DownloadCommand::validatePieceHash(const std::shared_ptr<Segment>& segment,
-                                        const std::string& expectedHash,
                                         const std::string& actualHash)
 {
-  if (actualHash == expectedHash) {
+  const auto& dctx = getDownloadContext();
+  if (dctx->matchPieceHash(segment->getIndex(), actualHash)) {
     A2_LOG_INFO(fmt(MSG_GOOD_CHUNK_CHECKSUM, util::toHex(actualHash).c_str()));
     completeSegment(getCuid(), segment);
   }
   else {
     A2_LOG_INFO(fmt(EX_INVALID_CHUNK_CHECKSUM,
                     static_cast<unsigned long>(segment->getIndex()),
-                    segment->getPosition(), util::toHex(expectedHash).c_str(),
+                    segment->getPosition(),
+                    util::toHex(dctx->getPieceHash(segment->getIndex()),
+                                dctx->getPieceHashLength())
+                        .c_str(),
                     util::toHex(actualHash).c_str()));
     segment->clear(getPieceStorage()->getWrDiskCache());
     getSegmentMan()->cancelSegment(getCuid());
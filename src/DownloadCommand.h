@@ -62,7 +62,6 @@ private:
   bool sinkFilterOnly_;
 
   void validatePieceHash(const std::shared_ptr<Segment>& segment,
-                         const std::string& expectedPieceHash,
                          const std::string& actualPieceHash);
 
   void checkLowestDownloadSpeed() const;
@@ -51,6 +51,7 @@ DownloadContext::DownloadContext()
     : ownerRequestGroup_(nullptr),
       attrs_(MAX_CTX_ATTR),
       downloadStopTime_(Timer::zero()),
+      pieceHashLength_(0),
       pieceLength_(0),
       checksumVerified_(false),
       knowsTotalLength_(true),
@@ -67,6 +68,7 @@ DownloadContext::DownloadContext(int32_t pieceLength, int64_t totalLength,
     : ownerRequestGroup_(nullptr),
       attrs_(MAX_CTX_ATTR),
       downloadStopTime_(Timer::zero()),
+      pieceHashLength_(0),
       pieceLength_(pieceLength),
       checksumVerified_(false),
       knowsTotalLength_(true),
@@ -270,18 +272,37 @@ bool DownloadContext::isChecksumVerificationAvailable() const
 
 bool DownloadContext::isPieceHashVerificationAvailable() const
 {
-  return !pieceHashType_.empty() && pieceHashes_.size() > 0 &&
-         pieceHashes_.size() == getNumPieces();
+  return !pieceHashType_.empty() && countPieceHash() > 0 &&
+         countPieceHash() == getNumPieces();
 }
 
-const std::string& DownloadContext::getPieceHash(size_t index) const
+const char* DownloadContext::getPieceHash(size_t index) const
 {
-  if (index < pieceHashes_.size()) {
-    return pieceHashes_[index];
+  if (index < countPieceHash()) {
+    return pieceHashes_.data() + index * pieceHashLength_;
   }
   else {
-    return A2STR::NIL;
+    return nullptr;
+  }
+}
+
+bool DownloadContext::matchPieceHash(size_t index,
+                                     const std::string& digest) const
+{
+  return index < countPieceHash() && digest.size() == pieceHashLength_ &&
+         pieceHashes_.compare(index * pieceHashLength_, pieceHashLength_,
+                              digest) == 0;
+}
+
+void DownloadContext::setPieceHashes(const std::string& hashType,
+                                     std::string hashData, size_t hashLength)
+{
+  if (hashLength == 0 ? !hashData.empty() : hashData.size() % hashLength) {
+    throw DL_ABORT_EX("Piece hashes have different lengths.");
   }
+  pieceHashType_ = hashType;
+  pieceHashes_ = std::move(hashData);
+  pieceHashLength_ = hashLength;
 }
 
 void DownloadContext::setDigest(const std::string& hashType,
@@ -304,6 +325,7 @@ void DownloadContext::setSignature(std::unique_ptr<Signature> signature)
 void DownloadContext::updateDownload(size_t bytes)
 {
   netStat_.updateDownload(bytes);
+  ownerRequestGroup_->getDownloadBucket().consume(bytes, global::wallclock());
   RequestGroupMan* rgman = ownerRequestGroup_->getRequestGroupMan();
   if (rgman) {
     rgman->getNetStat().updateDownload(bytes);
@@ -313,6 +335,9 @@ void DownloadContext::updateDownload(size_t bytes)
 void DownloadContext::updateUploadSpeed(size_t bytes)
 {
   netStat_.updateUploadSpeed(bytes);
+  // Piece data are accounted when they are queued for sending, so
+  // that doesUploadSpeedExceed() stops queuing more immediately.
+  ownerRequestGroup_->getUploadBucket().consume(bytes, global::wallclock());
   auto rgman = ownerRequestGroup_->getRequestGroupMan();
   if (rgman) {
     rgman->getNetStat().updateUploadSpeed(bytes);
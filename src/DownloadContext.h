@@ -48,6 +48,7 @@
 #include "SegList.h"
 #include "ContextAttribute.h"
 #include "NetStat.h"
+#include "DlAbortEx.h"
 
 namespace aria2 {
 
@@ -65,7 +66,11 @@ private:
 
   std::vector<std::shared_ptr<FileEntry>> fileEntries_;
 
-  std::vector<std::string> pieceHashes_;
+  // Piece hashes are stored back to back in a single string instead
+  // of a string per piece.  Each hash is pieceHashLength_ bytes long.
+  std::string pieceHashes_;
+
+  size_t pieceHashLength_;
 
   NetStat netStat_;
 
@@ -99,21 +104,44 @@ public:
 
   ~DownloadContext();
 
-  const std::string& getPieceHash(size_t index) const;
+  // Returns the pointer to the hash of the piece at index, which is
+  // getPieceHashLength() bytes long, or nullptr if index is out of
+  // range.
+  const char* getPieceHash(size_t index) const;
+
+  // Returns true if digest equals to the hash of the piece at index.
+  bool matchPieceHash(size_t index, const std::string& digest) const;
+
+  size_t getPieceHashLength() const { return pieceHashLength_; }
 
-  const std::vector<std::string>& getPieceHashes() const
+  size_t countPieceHash() const
   {
-    return pieceHashes_;
+    return pieceHashLength_ == 0 ? 0 : pieceHashes_.size() / pieceHashLength_;
   }
 
+  // Throws DlAbortEx if hashes in [first, last) don't have the same
+  // length.
   template <typename InputIterator>
   void setPieceHashes(const std::string& hashType, InputIterator first,
                       InputIterator last)
   {
-    pieceHashType_ = hashType;
-    pieceHashes_.assign(first, last);
+    std::string hashData;
+    size_t hashLength = first == last ? 0 : (*first).size();
+    for (; first != last; ++first) {
+      if ((*first).size() != hashLength) {
+        throw DL_ABORT_EX("Piece hashes have different lengths.");
+      }
+      hashData += *first;
+    }
+    setPieceHashes(hashType, std::move(hashData), hashLength);
   }
 
+  // Sets piece hashes from hashData, which contains hashes of
+  // hashLength bytes back to back.  Throws DlAbortEx if the length of
+  // hashData is not a multiple of hashLength.
+  void setPieceHashes(const std::string& hashType, std::string hashData,
+                      size_t hashLength);
+
   int64_t getTotalLength() const;
 
   bool knowsTotalLength() const { return knowsTotalLength_; }
@@ -226,12 +254,15 @@ public:
   NetStat& getNetStat() { return netStat_; }
 
   // This method also updates global download length held by
-  // RequestGroupMan via getOwnerRequestGroup().
+  // RequestGroupMan via getOwnerRequestGroup(), and takes bytes from
+  // the download bucket of the owner RequestGroup.
   void updateDownload(size_t bytes);
 
   // This method also updates global upload length held by
   // RequestGroupMan via getOwnerRequestGroup().
   void updateUploadLength(size_t bytes);
+  // Also takes bytes from the upload bucket of the owner
+  // RequestGroup.
   void updateUploadSpeed(size_t bytes);
 };
 
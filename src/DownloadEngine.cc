@@ -61,6 +61,7 @@
 #include "Request.h"
 #include "EventPoll.h"
 #include "Command.h"
+#include "TimerWheel.h"
 #include "FileAllocationEntry.h"
 #include "CheckIntegrityEntry.h"
 #include "BtProgressInfoFile.h"
@@ -91,15 +92,17 @@ volatile sig_atomic_t globalHaltRequested = 0;
 } // namespace global
 
 namespace {
+// The maximum time to wait for I/O events.
 constexpr auto DEFAULT_REFRESH_INTERVAL = 1_s;
+constexpr auto TIMER_TICK = std::chrono::milliseconds(10);
 } // namespace
 
 DownloadEngine::DownloadEngine(std::unique_ptr<EventPoll> eventPoll)
     : eventPoll_(std::move(eventPoll)),
       haltRequested_(0),
       noWait_(true),
+      deliveringEvents_(false),
       refreshInterval_(DEFAULT_REFRESH_INTERVAL),
-      lastRefresh_(Timer::zero()),
       cookieStorage_(make_unique<CookieStorage>()),
 #ifdef ENABLE_BITTORRENT
       btRegistry_(make_unique<BtRegistry>()),
@@ -108,7 +111,8 @@ DownloadEngine::DownloadEngine(std::unique_ptr<EventPoll> eventPoll)
       asyncDNSServers_(nullptr),
 #endif // HAVE_ARES_ADDR_NODE
       dnsCache_(make_unique<DNSCache>()),
-      option_(nullptr)
+      option_(nullptr),
+      timerWheel_(make_unique<TimerWheel>(TIMER_TICK, global::wallclock()))
 {
   unsigned char sessionId[20];
   util::generateRandomKey(sessionId);
@@ -117,6 +121,12 @@ DownloadEngine::DownloadEngine(std::unique_ptr<EventPoll> eventPoll)
 
 DownloadEngine::~DownloadEngine()
 {
+  for (auto& command : commands_) {
+    command->setScheduler(nullptr);
+  }
+  for (auto& ent : timerDeadlines_) {
+    ent.first->setTimerScheduler(nullptr);
+  }
 #ifdef HAVE_ARES_ADDR_NODE
   setAsyncDNSServers(nullptr);
 #endif // HAVE_ARES_ADDR_NODE
@@ -147,6 +157,129 @@ void executeCommand(std::deque<std::unique_ptr<Command>>& commands,
 }
 } // namespace
 
+namespace {
+void executeCommand(std::unique_ptr<Command> com)
+{
+  com->transitStatus();
+  if (com->execute()) {
+    com.reset();
+  }
+  else {
+    com->clearIOEvents();
+    com.release();
+  }
+}
+} // namespace
+
+void DownloadEngine::scheduleCommand(std::unique_ptr<Command> command)
+{
+  if (command->statusMatch(Command::STATUS_ACTIVE)) {
+    readyCommands_.push_back(std::move(command));
+    return;
+  }
+  auto c = command.get();
+  commands_.push_back(std::move(command));
+  commandIndex_.emplace(c, --commands_.end());
+  c->setScheduler(this);
+}
+
+void DownloadEngine::commandReady(Command* command)
+{
+  auto i = commandIndex_.find(command);
+  if (i == std::end(commandIndex_)) {
+    return;
+  }
+  readyCommands_.push_back(std::move(*(*i).second));
+  commands_.erase((*i).second);
+  commandIndex_.erase(i);
+  if (!deliveringEvents_) {
+    // Activated by another Command.  Don't let it wait for the next
+    // I/O event.
+    noWait_ = true;
+  }
+}
+
+void DownloadEngine::addTimer(const Timer& deadline, Command* command)
+{
+  auto i = timerDeadlines_.find(command);
+  if (i == std::end(timerDeadlines_)) {
+    timerDeadlines_.emplace(command, deadline);
+    command->setTimerScheduler(this);
+  }
+  else if (deadline < (*i).second) {
+    (*i).second = deadline;
+  }
+  else {
+    return;
+  }
+  timerWheel_->add(deadline, command);
+}
+
+void DownloadEngine::cancelTimer(Command* command)
+{
+  timerDeadlines_.erase(command);
+}
+
+void DownloadEngine::expireTimers()
+{
+  std::vector<Command*> commands;
+  timerWheel_->expire(global::wallclock(), commands);
+  deliveringEvents_ = true;
+  for (auto command : commands) {
+    // The entries of deleted Commands were removed by cancelTimer().
+    // If the address has been reused by another Command, its deadline
+    // tells whether this wheel entry is its own.
+    auto i = timerDeadlines_.find(command);
+    if (i == std::end(timerDeadlines_)) {
+      continue;
+    }
+    if (global::wallclock() < (*i).second) {
+      // Either a stale entry, or a deadline which was clamped to the
+      // range of timerWheel_.  Make sure that the deadline is still
+      // in timerWheel_.
+      timerWheel_->add((*i).second, command);
+      continue;
+    }
+    timerDeadlines_.erase(i);
+    command->setTimerScheduler(nullptr);
+    command->setStatusActive();
+  }
+  deliveringEvents_ = false;
+}
+
+void DownloadEngine::executeReadyCommands()
+{
+  size_t max = readyCommands_.size();
+  for (size_t i = 0; i < max; ++i) {
+    auto com = std::move(readyCommands_.front());
+    readyCommands_.pop_front();
+    if (!com->statusMatch(Command::STATUS_ACTIVE)) {
+      com->clearIOEvents();
+      scheduleCommand(std::move(com));
+      continue;
+    }
+    executeCommand(std::move(com));
+  }
+}
+
+void DownloadEngine::executeAllCommands()
+{
+  std::vector<std::unique_ptr<Command>> commands;
+  commands.reserve(readyCommands_.size() + commands_.size());
+  std::move(std::begin(readyCommands_), std::end(readyCommands_),
+            std::back_inserter(commands));
+  readyCommands_.clear();
+  for (auto& com : commands_) {
+    com->setScheduler(nullptr);
+    commands.push_back(std::move(com));
+  }
+  commands_.clear();
+  commandIndex_.clear();
+  for (auto& com : commands) {
+    executeCommand(std::move(com));
+  }
+}
+
 namespace {
 class GlobalHaltRequestedFinalizer {
 public:
@@ -166,21 +299,25 @@ private:
 int DownloadEngine::run(bool oneshot)
 {
   GlobalHaltRequestedFinalizer ghrf(oneshot);
-  while (!commands_.empty() || !routineCommands_.empty()) {
-    if (!commands_.empty()) {
+  while (!commands_.empty() || !readyCommands_.empty() ||
+         !routineCommands_.empty()) {
+    if (!commands_.empty() || !readyCommands_.empty()) {
       waitData();
     }
     noWait_ = false;
     global::wallclock().reset();
+    expireTimers();
     calculateStatistics();
-    if (lastRefresh_.difference(global::wallclock()) + A2_DELTA_MILLIS >=
-        refreshInterval_) {
+    if (refreshInterval_ == std::chrono::milliseconds(0) ||
+        (requestGroupMan_ && requestGroupMan_->refreshRequested())) {
       refreshInterval_ = DEFAULT_REFRESH_INTERVAL;
-      lastRefresh_ = global::wallclock();
-      executeCommand(commands_, Command::STATUS_ALL);
+      if (requestGroupMan_) {
+        requestGroupMan_->clearRefresh();
+      }
+      executeAllCommands();
     }
     else {
-      executeCommand(commands_, Command::STATUS_ACTIVE);
+      executeReadyCommands();
     }
     executeCommand(routineCommands_, Command::STATUS_ALL);
     afterEachIteration();
@@ -199,12 +336,14 @@ void DownloadEngine::waitData()
     tv.tv_sec = tv.tv_usec = 0;
   }
   else {
-    auto t =
-        std::chrono::duration_cast<std::chrono::microseconds>(refreshInterval_);
+    auto t = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::min(refreshInterval_, timerWheel_->nextTimeout(Timer())));
     tv.tv_sec = t.count() / 1000000;
     tv.tv_usec = t.count() % 1000000;
   }
+  deliveringEvents_ = true;
   eventPoll_->poll(tv);
+  deliveringEvents_ = false;
 }
 
 bool DownloadEngine::addSocketForReadCheck(
@@ -235,6 +374,16 @@ bool DownloadEngine::deleteSocketForWriteCheck(
                                   EventPoll::EVENT_WRITE);
 }
 
+bool DownloadEngine::addFdForReadCheck(sock_t fd, Command* command)
+{
+  return eventPoll_->addEvents(fd, command, EventPoll::EVENT_READ);
+}
+
+bool DownloadEngine::deleteFdForReadCheck(sock_t fd, Command* command)
+{
+  return eventPoll_->deleteEvents(fd, command, EventPoll::EVENT_READ);
+}
+
 void DownloadEngine::calculateStatistics()
 {
   if (statCalc_) {
@@ -275,12 +424,14 @@ void DownloadEngine::requestHalt()
 {
   haltRequested_ = std::max(haltRequested_, 1);
   requestGroupMan_->halt();
+  setRefreshInterval(std::chrono::milliseconds(0));
 }
 
 void DownloadEngine::requestForceHalt()
 {
   haltRequested_ = std::max(haltRequested_, 2);
   requestGroupMan_->forceHalt();
+  setRefreshInterval(std::chrono::milliseconds(0));
 }
 
 void DownloadEngine::setStatCalc(std::unique_ptr<StatCalc> statCalc)
@@ -585,14 +736,14 @@ void DownloadEngine::setRefreshInterval(std::chrono::milliseconds interval)
 
 void DownloadEngine::addCommand(std::vector<std::unique_ptr<Command>> commands)
 {
-  commands_.insert(commands_.end(),
-                   std::make_move_iterator(std::begin(commands)),
-                   std::make_move_iterator(std::end(commands)));
+  for (auto& command : commands) {
+    scheduleCommand(std::move(command));
+  }
 }
 
 void DownloadEngine::addCommand(std::unique_ptr<Command> command)
 {
-  commands_.push_back(std::move(command));
+  scheduleCommand(std::move(command));
 }
 
 void DownloadEngine::setRequestGroupMan(std::unique_ptr<RequestGroupMan> rgman)
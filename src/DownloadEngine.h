@@ -39,7 +39,9 @@
 
 #include <string>
 #include <deque>
+#include <list>
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include <memory>
 
@@ -50,6 +52,7 @@
 #include "FileAllocationMan.h"
 #include "CheckIntegrityMan.h"
 #include "DNSCache.h"
+#include "Command.h"
 #ifdef ENABLE_ASYNC_DNS
 #  include "AsyncNameResolver.h"
 #endif // ENABLE_ASYNC_DNS
@@ -64,7 +67,7 @@ class CookieStorage;
 class AuthConfigFactory;
 class Request;
 class EventPoll;
-class Command;
+class TimerWheel;
 #ifdef ENABLE_BITTORRENT
 class BtRegistry;
 #endif // ENABLE_BITTORRENT
@@ -81,10 +84,26 @@ class HMACResult;
 } // namespace security
 } // namespace util
 
-class DownloadEngine {
+class DownloadEngine : public CommandScheduler {
 private:
   void waitData();
 
+  // Moves command to readyCommands_ if its status is STATUS_ACTIVE or
+  // higher.  Otherwise parks it in commands_ until EventPoll (or
+  // another Command) activates it, its timer expires or refresh is
+  // requested.
+  void scheduleCommand(std::unique_ptr<Command> command);
+
+  // Executes Commands in readyCommands_.  Commands activated during
+  // this call are executed in the next iteration.
+  void executeReadyCommands();
+
+  // Executes all Commands regardless of their status.
+  void executeAllCommands();
+
+  // Activates the parked Commands whose timers have expired.
+  void expireTimers();
+
   std::string sessionId_;
 
   std::unique_ptr<EventPoll> eventPoll_;
@@ -126,8 +145,12 @@ private:
 
   bool noWait_;
 
+  // true while EventPoll or timerWheel_ is delivering events
+  bool deliveringEvents_;
+
+  // The maximum time to wait for I/O events.  If it is 0, all
+  // Commands are executed in the next iteration.
   std::chrono::milliseconds refreshInterval_;
-  Timer lastRefresh_;
 
   std::unique_ptr<CookieStorage> cookieStorage_;
 
@@ -170,7 +193,22 @@ private:
   // Ensure that Commands are cleaned up before requestGroupMan_ is
   // deleted.
   std::deque<std::unique_ptr<Command>> routineCommands_;
-  std::deque<std::unique_ptr<Command>> commands_;
+  // Commands waiting for I/O events, timers or refresh.
+  std::list<std::unique_ptr<Command>> commands_;
+  // Position of each Command in commands_, so that a Command can be
+  // moved to readyCommands_ in constant time when it is activated.
+  std::unordered_map<Command*, std::list<std::unique_ptr<Command>>::iterator>
+      commandIndex_;
+  // Commands to be executed in the next iteration.
+  std::deque<std::unique_ptr<Command>> readyCommands_;
+
+  std::unique_ptr<TimerWheel> timerWheel_;
+  // The earliest pending timer of each Command.  Used to avoid adding
+  // redundant entries to timerWheel_.  An entry is removed when its
+  // Command is deleted, so that the Commands in this map are always
+  // alive.  timerWheel_ may still hold stale entries, which are
+  // ignored unless this map has a due deadline for the address.
+  std::unordered_map<Command*, Timer> timerDeadlines_;
 
   std::unique_ptr<util::security::HMAC> tokenHMAC_;
   std::unique_ptr<util::security::HMACResult> tokenExpected_;
@@ -178,7 +216,7 @@ private:
 public:
   DownloadEngine(std::unique_ptr<EventPoll> eventPoll);
 
-  ~DownloadEngine();
+  virtual ~DownloadEngine();
 
   // If oneshot is true, this function returns after one event polling
   // and performing action for them. This function returns 1 when
@@ -195,6 +233,11 @@ public:
   bool deleteSocketForWriteCheck(const std::shared_ptr<SocketCore>& socket,
                                  Command* command);
 
+  // Same as addSocketForReadCheck(), but takes a file descriptor
+  // which is not owned by SocketCore, such as WakeupPipe.
+  bool addFdForReadCheck(sock_t fd, Command* command);
+  bool deleteFdForReadCheck(sock_t fd, Command* command);
+
 #ifdef ENABLE_ASYNC_DNS
 
   bool addNameResolverCheck(const std::shared_ptr<AsyncNameResolver>& resolver,
@@ -208,6 +251,22 @@ public:
 
   void addCommand(std::unique_ptr<Command> command);
 
+  virtual void commandReady(Command* command) CXX11_OVERRIDE;
+
+  // Wakes up command at deadline.  Parked Commands are executed only
+  // when they are activated, so a Command which has a timeout or
+  // interval must register its deadline by this function.  If command
+  // already has a pending timer which expires before deadline, this
+  // function does nothing; command is expected to call this function
+  // again when it is executed.  command may be deleted before
+  // deadline; the timer is canceled then.
+  void addTimer(const Timer& deadline, Command* command);
+
+  virtual void cancelTimer(Command* command) CXX11_OVERRIDE;
+
+  // For unittest only
+  size_t countTimer() const { return timerDeadlines_.size(); }
+
   const std::unique_ptr<RequestGroupMan>& getRequestGroupMan() const
   {
     return requestGroupMan_;
@@ -322,6 +381,10 @@ public:
 
   const std::unique_ptr<AuthConfigFactory>& getAuthConfigFactory() const;
 
+  // If interval is 0, all Commands, including parked ones, are
+  // executed in the next iteration.  This is used to let Commands
+  // notice the state changes which do not cause I/O events,
+  // e.g., halt request.
   void setRefreshInterval(std::chrono::milliseconds interval);
 
   const std::string getSessionId() const { return sessionId_; }
@@ -58,6 +58,9 @@
 #include "DownloadContext.h"
 #include "array_fun.h"
 #include "EvictSocketPoolCommand.h"
+#ifdef ENABLE_THREADS
+#  include "ThreadPool.h"
+#endif // ENABLE_THREADS
 #ifdef HAVE_LIBUV
 #  include "LibuvEventPoll.h"
 #endif // HAVE_LIBUV
@@ -156,10 +159,23 @@ std::unique_ptr<DownloadEngine> DownloadEngineFactory::newDownloadEngine(
     auto requestGroupMan = make_unique<RequestGroupMan>(
         std::move(requestGroups), MAX_CONCURRENT_DOWNLOADS, op);
     requestGroupMan->initWrDiskCache();
+    requestGroupMan->initRdDiskCache();
+#ifdef ENABLE_THREADS
+    requestGroupMan->initWriteThreadPool();
+#endif // ENABLE_THREADS
     e->setRequestGroupMan(std::move(requestGroupMan));
   }
   e->setFileAllocationMan(make_unique<FileAllocationMan>());
-  e->setCheckIntegrityMan(make_unique<CheckIntegrityMan>());
+  {
+    auto checkIntegrityMan = make_unique<CheckIntegrityMan>();
+#ifdef ENABLE_THREADS
+    if (op->getAsInt(PREF_CHECK_INTEGRITY_THREADS) > 0) {
+      checkIntegrityMan->setThreadPool(
+          make_unique<ThreadPool>(op->getAsInt(PREF_CHECK_INTEGRITY_THREADS)));
+    }
+#endif // ENABLE_THREADS
+    e->setCheckIntegrityMan(std::move(checkIntegrityMan));
+  }
   e->addRoutineCommand(
       make_unique<FillRequestGroupCommand>(e->newCUID(), e.get()));
   e->addRoutineCommand(make_unique<FileAllocationDispatcherCommand>(
@@ -50,6 +50,7 @@ DownloadResult::DownloadResult()
       numPieces(0),
       pieceLength(0),
       result(error_code::UNDEFINED),
+      seq(0),
       inMemoryDownload(false)
 {
 }
@@ -99,6 +99,10 @@ struct DownloadResult {
 
   std::string resultMessage;
 
+  // Serial number assigned by RequestGroupMan::addDownloadResult().
+  // A result added later has larger number.
+  uint64_t seq;
+
   bool inMemoryDownload;
 
   DownloadResult();
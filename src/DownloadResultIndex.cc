@@ -0,0 +1,137 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2018 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#include "DownloadResultIndex.h"
+
+#include <algorithm>
+
+#include "DownloadResult.h"
+
+namespace aria2 {
+
+namespace {
+const DownloadResultIndex::SeqList EMPTY_SEQ_LIST;
+} // namespace
+
+namespace {
+bool isError(error_code::Value code)
+{
+  return code != error_code::FINISHED && code != error_code::REMOVED;
+}
+} // namespace
+
+namespace {
+void removeSeq(DownloadResultIndex::SeqList& seqs, uint64_t seq)
+{
+  if (!seqs.empty() && seqs.front() == seq) {
+    seqs.pop_front();
+    return;
+  }
+  auto i = std::lower_bound(std::begin(seqs), std::end(seqs), seq);
+  if (i != std::end(seqs) && *i == seq) {
+    seqs.erase(i);
+  }
+}
+} // namespace
+
+namespace {
+template <typename Map, typename Key>
+void removeSeq(Map& m, const Key& key, uint64_t seq)
+{
+  auto i = m.find(key);
+  if (i == std::end(m)) {
+    return;
+  }
+  removeSeq((*i).second, seq);
+  // Don't keep the entries of the directories no longer used.
+  if ((*i).second.empty()) {
+    m.erase(i);
+  }
+}
+} // namespace
+
+namespace {
+template <typename Map, typename Key>
+const DownloadResultIndex::SeqList& findSeqList(const Map& m, const Key& key)
+{
+  auto i = m.find(key);
+  if (i == std::end(m)) {
+    return EMPTY_SEQ_LIST;
+  }
+  return (*i).second;
+}
+} // namespace
+
+DownloadResultIndex::DownloadResultIndex() = default;
+
+DownloadResultIndex::~DownloadResultIndex() = default;
+
+void DownloadResultIndex::add(const DownloadResult& dr)
+{
+  byErrorCode_[dr.result].push_back(dr.seq);
+  byDir_[dr.dir].push_back(dr.seq);
+  if (isError(dr.result)) {
+    errors_.push_back(dr.seq);
+  }
+}
+
+void DownloadResultIndex::remove(const DownloadResult& dr)
+{
+  removeSeq(byErrorCode_, static_cast<int>(dr.result), dr.seq);
+  removeSeq(byDir_, dr.dir, dr.seq);
+  if (isError(dr.result)) {
+    removeSeq(errors_, dr.seq);
+  }
+}
+
+void DownloadResultIndex::clear()
+{
+  byErrorCode_.clear();
+  byDir_.clear();
+  errors_.clear();
+}
+
+const DownloadResultIndex::SeqList&
+DownloadResultIndex::findByErrorCode(error_code::Value code) const
+{
+  return findSeqList(byErrorCode_, static_cast<int>(code));
+}
+
+const DownloadResultIndex::SeqList&
+DownloadResultIndex::findByDir(const std::string& dir) const
+{
+  return findSeqList(byDir_, dir);
+}
+
+} // namespace aria2
@@ -0,0 +1,91 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2018 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#ifndef D_DOWNLOAD_RESULT_INDEX_H
+#define D_DOWNLOAD_RESULT_INDEX_H
+
+#include "common.h"
+
+#include <deque>
+#include <string>
+#include <unordered_map>
+
+#include "error_code.h"
+
+namespace aria2 {
+
+struct DownloadResult;
+
+// Secondary indexes of the download results kept by RequestGroupMan.
+// Each index maps an attribute of the download results to the list
+// of DownloadResult::seq of the results having it, in ascending
+// order.  Since the results are added in ascending order of seq and
+// usually evicted from the oldest one, both operations are O(1).
+class DownloadResultIndex {
+public:
+  typedef std::deque<uint64_t> SeqList;
+
+  DownloadResultIndex();
+
+  ~DownloadResultIndex();
+
+  // Adds |dr| to the indexes.  dr.seq must be larger than the one of
+  // any result added so far.
+  void add(const DownloadResult& dr);
+
+  // Removes |dr| from the indexes.  Complexity: O(1) if |dr| is the
+  // oldest result in each index, otherwise O(N).
+  void remove(const DownloadResult& dr);
+
+  void clear();
+
+  // Returns the results whose result is |code|.
+  const SeqList& findByErrorCode(error_code::Value code) const;
+
+  // Returns the results which stopped due to error, that is, neither
+  // completed nor removed.
+  const SeqList& findErrors() const { return errors_; }
+
+  // Returns the results whose download directory is |dir|.
+  const SeqList& findByDir(const std::string& dir) const;
+
+private:
+  std::unordered_map<int, SeqList> byErrorCode_;
+  std::unordered_map<std::string, SeqList> byDir_;
+  SeqList errors_;
+};
+
+} // namespace aria2
+
+#endif // D_DOWNLOAD_RESULT_INDEX_H
@@ -355,10 +355,19 @@ public:
   }
 
   // Calls AsyncNameResolver::process(ARES_SOCKET_BAD,
-  // ARES_SOCKET_BAD).
+  // ARES_SOCKET_BAD).  If the query has finished, for example by
+  // timeout, activates command_ so that it notices the result.
   void processTimeout()
   {
     nameResolver_->process(ARES_SOCKET_BAD, ARES_SOCKET_BAD);
+    switch (nameResolver_->getStatus()) {
+    case AsyncNameResolver::STATUS_SUCCESS:
+    case AsyncNameResolver::STATUS_ERROR:
+      command_->setStatusActive();
+      break;
+    default:
+      break;
+    }
   }
 };
 #else  // !ENABLE_ASYNC_DNS
@@ -0,0 +1,138 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2018 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#ifndef D_FREE_LIST_ALLOCATED_H
+#define D_FREE_LIST_ALLOCATED_H
+
+#include "common.h"
+
+#include <new>
+
+namespace aria2 {
+
+// Keeps up to MaxFree released blocks of sizeof(T) bytes and hands
+// them out again before asking the global allocator.  Not thread
+// safe: only use it for objects which are created and destroyed in
+// the main thread.
+template <typename T, size_t MaxFree> class FreeList {
+private:
+  struct Block {
+    Block* next;
+  };
+
+  Block* head_;
+  size_t size_;
+
+public:
+  FreeList() : head_(nullptr), size_(0) {}
+
+  ~FreeList()
+  {
+    while (head_) {
+      auto next = head_->next;
+      ::operator delete(head_);
+      head_ = next;
+    }
+  }
+
+  FreeList(const FreeList&) = delete;
+  FreeList& operator=(const FreeList&) = delete;
+
+  void* allocate()
+  {
+    if (!head_) {
+      return ::operator new(sizeof(T));
+    }
+    auto block = head_;
+    head_ = head_->next;
+    --size_;
+    return block;
+  }
+
+  void deallocate(void* p)
+  {
+    if (size_ == MaxFree) {
+      ::operator delete(p);
+      return;
+    }
+    auto block = static_cast<Block*>(p);
+    block->next = head_;
+    head_ = block;
+    ++size_;
+  }
+
+  size_t size() const { return size_; }
+};
+
+// Derive T from FreeListAllocated<T> to recycle the storage of T
+// objects through a per-type FreeList.  Objects are still created by
+// new (or make_unique) and destroyed by delete, so ownership is
+// unchanged.  The storage of an object whose dynamic type is a
+// subclass of T with different size goes to the global allocator.
+template <typename T, size_t MaxFree = 1024> class FreeListAllocated {
+public:
+  static void* operator new(size_t size)
+  {
+    if (size != sizeof(T)) {
+      return ::operator new(size);
+    }
+    return freeList().allocate();
+  }
+
+  static void operator delete(void* p, size_t size)
+  {
+    if (!p) {
+      return;
+    }
+    if (size != sizeof(T)) {
+      ::operator delete(p);
+      return;
+    }
+    freeList().deallocate(p);
+  }
+
+  // Returns the number of blocks kept for reuse.
+  static size_t countFreeBlock() { return freeList().size(); }
+
+private:
+  static FreeList<T, MaxFree>& freeList()
+  {
+    static FreeList<T, MaxFree> freeList;
+    return freeList;
+  }
+};
+
+} // namespace aria2
+
+#endif // D_FREE_LIST_ALLOCATED_H
@@ -95,22 +95,41 @@ std::string GZipEncoder::encode(const unsigned char* in, size_t length,
   return out;
 }
 
+namespace {
+constexpr size_t INPUT_BUFFER_SIZE = 16_k;
+} // namespace
+
+void GZipEncoder::flushInput(int flush)
+{
+  internalBuf_ +=
+      encode(reinterpret_cast<const unsigned char*>(inputBuf_.data()),
+             inputBuf_.size(), flush);
+  inputBuf_.clear();
+}
+
+void GZipEncoder::feed(const char* s, size_t length)
+{
+  inputBuf_.append(s, length);
+  if (inputBuf_.size() >= INPUT_BUFFER_SIZE) {
+    flushInput(Z_NO_FLUSH);
+  }
+}
+
 std::string GZipEncoder::str()
 {
-  internalBuf_ += encode(nullptr, 0, Z_FINISH);
+  flushInput(Z_FINISH);
   return internalBuf_;
 }
 
 GZipEncoder& GZipEncoder::operator<<(const char* s)
 {
-  internalBuf_ += encode(reinterpret_cast<const unsigned char*>(s), strlen(s));
+  feed(s, strlen(s));
   return *this;
 }
 
 GZipEncoder& GZipEncoder::operator<<(const std::string& s)
 {
-  internalBuf_ +=
-      encode(reinterpret_cast<const unsigned char*>(s.data()), s.size());
+  feed(s.data(), s.size());
   return *this;
 }
 
@@ -123,7 +142,7 @@ GZipEncoder& GZipEncoder::operator<<(int64_t i)
 
 GZipEncoder& GZipEncoder::write(const char* s, size_t length)
 {
-  internalBuf_ += encode(reinterpret_cast<const unsigned char*>(s), length);
+  feed(s, length);
   return *this;
 }
 
@@ -49,6 +49,15 @@ private:
   // Internal buffer for deflated data.
   std::string internalBuf_;
 
+  // Data fed by operator<<() and write() is kept here and given to
+  // deflater when it grows to INPUT_BUFFER_SIZE bytes, so that small
+  // pieces of data are not deflated one by one.
+  std::string inputBuf_;
+
+  void feed(const char* s, size_t length);
+
+  void flushInput(int flush);
+
   std::string encode(const unsigned char* in, size_t length, int flush);
   // Not implemented
   GZipEncoder& operator<<(char c);
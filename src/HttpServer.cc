@@ -51,7 +51,7 @@
 #include "SocketRecvBuffer.h"
 #include "TimeA2.h"
 #include "array_fun.h"
-#include "JsonDiskWriter.h"
+#include "JsonRpcDiskWriter.h"
 #ifdef ENABLE_XML_RPC
 #  include "XmlRpcDiskWriter.h"
 #endif // ENABLE_XML_RPC
@@ -380,7 +380,7 @@ int HttpServer::setupResponseRecv()
     if (path == "/jsonrpc") {
       if (reqType_ != RPC_TYPE_JSON) {
         reqType_ = RPC_TYPE_JSON;
-        lastBody_ = make_unique<json::JsonDiskWriter>();
+        lastBody_ = make_unique<rpc::JsonRpcDiskWriter>();
       }
       return 0;
     }
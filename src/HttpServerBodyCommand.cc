@@ -58,8 +58,7 @@
 #include "RpcRequest.h"
 #include "RpcResponse.h"
 #include "rpc_helper.h"
-#include "JsonDiskWriter.h"
-#include "ValueBaseJsonParser.h"
+#include "JsonRpcDiskWriter.h"
 #ifdef ENABLE_XML_RPC
 #  include "XmlRpcRequestParserStateMachine.h"
 #  include "XmlRpcDiskWriter.h"
@@ -254,23 +253,20 @@ bool HttpServerBodyCommand::execute()
         case RPC_TYPE_JSON:
         case RPC_TYPE_JSONP: {
           std::string callback;
-          std::unique_ptr<ValueBase> json;
-          ssize_t error = 0;
+          rpc::JsonRpcRequestParser jsonpParser;
+          rpc::JsonRpcRequestParser* parser;
+          int error;
           if (httpServer_->getRequestType() == RPC_TYPE_JSONP) {
             json::JsonGetParam param = json::decodeGetParams(query);
             callback = param.callback;
-            ssize_t error = 0;
-            json = json::ValueBaseJsonParser().parseFinal(
-                param.request.c_str(), param.request.size(), error);
+            parser = &jsonpParser;
+            error = parser->parse(param.request.c_str(), param.request.size());
           }
           else {
             auto dw =
-                static_cast<json::JsonDiskWriter*>(httpServer_->getBody());
+                static_cast<rpc::JsonRpcDiskWriter*>(httpServer_->getBody());
             error = dw->finalize();
-            if (error == 0) {
-              json = dw->getResult();
-            }
-            dw->reset();
+            parser = &dw->getParser();
           }
           if (error < 0) {
             A2_LOG_INFO(fmt("CUID#%" PRId64
@@ -281,32 +277,18 @@ bool HttpServerBodyCommand::execute()
             sendJsonRpcResponse(res, callback);
             return true;
           }
-          Dict* jsondict = downcast<Dict>(json);
-          if (jsondict) {
-            auto res = rpc::processJsonRpcRequest(jsondict, e_);
-            sendJsonRpcResponse(res, callback);
+          auto& calls = parser->getCalls();
+          if (parser->isBatch()) {
+            std::vector<rpc::RpcResponse> results;
+            results.reserve(calls.size());
+            for (auto& call : calls) {
+              results.push_back(rpc::processJsonRpcCall(std::move(call), e_));
+            }
+            sendJsonRpcBatchResponse(results, callback);
           }
           else {
-            List* jsonlist = downcast<List>(json);
-            if (jsonlist) {
-              // This is batch call
-              std::vector<rpc::RpcResponse> results;
-              for (List::ValueType::const_iterator i = jsonlist->begin(),
-                                                   eoi = jsonlist->end();
-                   i != eoi; ++i) {
-                Dict* jsondict = downcast<Dict>(*i);
-                if (jsondict) {
-                  auto resp = rpc::processJsonRpcRequest(jsondict, e_);
-                  results.push_back(std::move(resp));
-                }
-              }
-              sendJsonRpcBatchResponse(results, callback);
-            }
-            else {
-              rpc::RpcResponse res(rpc::createJsonRpcErrorResponse(
-                  -32600, "Invalid Request.", Null::g()));
-              sendJsonRpcResponse(res, callback);
-            }
+            auto res = rpc::processJsonRpcCall(std::move(calls[0]), e_);
+            sendJsonRpcResponse(res, callback);
           }
           return true;
         }
@@ -318,6 +300,9 @@ bool HttpServerBodyCommand::execute()
       }
       else {
         updateWriteCheck();
+        auto deadline = timeoutTimer_;
+        deadline.advance(30_s);
+        e_->addTimer(deadline, this);
         e_->addCommand(std::unique_ptr<Command>(this));
         return false;
       }
@@ -328,6 +313,9 @@ bool HttpServerBodyCommand::execute()
         return true;
       }
       else {
+        auto deadline = timeoutTimer_;
+        deadline.advance(30_s);
+        e_->addTimer(deadline, this);
         e_->addCommand(std::unique_ptr<Command>(this));
         return false;
       }
@@ -185,6 +185,9 @@ bool HttpServerCommand::execute()
         // finished.
         if (!socket_->tlsAccept()) {
           updateWriteCheck();
+          auto deadline = timeoutTimer_;
+          deadline.advance(30_s);
+          e_->addTimer(deadline, this);
           e_->addCommand(std::unique_ptr<Command>(this));
           return false;
         }
@@ -193,6 +196,9 @@ bool HttpServerCommand::execute()
 
       if (!httpServer_->receiveRequest()) {
         updateWriteCheck();
+        auto deadline = timeoutTimer_;
+        deadline.advance(30_s);
+        e_->addTimer(deadline, this);
         e_->addCommand(std::unique_ptr<Command>(this));
         return false;
       }
@@ -263,6 +269,9 @@ bool HttpServerCommand::execute()
         return true;
       }
       else {
+        auto deadline = timeoutTimer_;
+        deadline.advance(30_s);
+        e_->addTimer(deadline, this);
         e_->addCommand(std::unique_ptr<Command>(this));
         return false;
       }
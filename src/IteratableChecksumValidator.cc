@@ -60,6 +60,14 @@ IteratableChecksumValidator::IteratableChecksumValidator(
 IteratableChecksumValidator::~IteratableChecksumValidator() = default;
 
 void IteratableChecksumValidator::validateChunk()
+{
+  checkChunk();
+  if (finished()) {
+    storeResult();
+  }
+}
+
+void IteratableChecksumValidator::checkChunk()
 {
   // Don't guard with !finished() to allow zero-length file to be
   // verified.
@@ -69,19 +77,23 @@ void IteratableChecksumValidator::validateChunk()
   ctx_->update(buf.data(), length);
   currentOffset_ += length;
   if (finished()) {
-    std::string actualDigest = ctx_->digest();
-    if (dctx_->getDigest() == actualDigest) {
-      pieceStorage_->markAllPiecesDone();
-      dctx_->setChecksumVerified(true);
-    }
-    else {
-      A2_LOG_INFO(fmt("Checksum validation failed. expected=%s, actual=%s",
-                      util::toHex(dctx_->getDigest()).c_str(),
-                      util::toHex(actualDigest).c_str()));
-      BitfieldMan bitfield(dctx_->getPieceLength(), dctx_->getTotalLength());
-      pieceStorage_->setBitfield(bitfield.getBitfield(),
-                                 bitfield.getBitfieldLength());
-    }
+    actualDigest_ = ctx_->digest();
+  }
+}
+
+void IteratableChecksumValidator::storeResult()
+{
+  if (dctx_->getDigest() == actualDigest_) {
+    pieceStorage_->markAllPiecesDone();
+    dctx_->setChecksumVerified(true);
+  }
+  else {
+    A2_LOG_INFO(fmt("Checksum validation failed. expected=%s, actual=%s",
+                    util::toHex(dctx_->getDigest()).c_str(),
+                    util::toHex(actualDigest_).c_str()));
+    BitfieldMan bitfield(dctx_->getPieceLength(), dctx_->getTotalLength());
+    pieceStorage_->setBitfield(bitfield.getBitfield(),
+                               bitfield.getBitfieldLength());
   }
 }
 
@@ -104,6 +116,7 @@ void IteratableChecksumValidator::init()
 {
   currentOffset_ = 0;
   ctx_ = MessageDigest::create(dctx_->getHashType());
+  actualDigest_.clear();
 }
 
 } // namespace aria2
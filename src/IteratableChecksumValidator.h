@@ -37,7 +37,9 @@
 
 #include "IteratableValidator.h"
 
+#include <string>
 #include <memory>
+#include <atomic>
 
 namespace aria2 {
 
@@ -51,10 +53,13 @@ private:
 
   std::shared_ptr<PieceStorage> pieceStorage_;
 
-  int64_t currentOffset_;
+  // Updated by checkChunk(), which may run in a worker thread.
+  std::atomic<int64_t> currentOffset_;
 
   std::unique_ptr<MessageDigest> ctx_;
 
+  std::string actualDigest_;
+
 public:
   IteratableChecksumValidator(
       const std::shared_ptr<DownloadContext>& dctx,
@@ -66,6 +71,10 @@ public:
 
   virtual void validateChunk() CXX11_OVERRIDE;
 
+  virtual void checkChunk() CXX11_OVERRIDE;
+
+  virtual void storeResult() CXX11_OVERRIDE;
+
   virtual bool finished() const CXX11_OVERRIDE;
 
   virtual int64_t getCurrentOffset() const CXX11_OVERRIDE
@@ -68,12 +68,22 @@ IteratableChunkChecksumValidator::IteratableChunkChecksumValidator(
 IteratableChunkChecksumValidator::~IteratableChunkChecksumValidator() = default;
 
 void IteratableChunkChecksumValidator::validateChunk()
+{
+  if (!finished()) {
+    checkChunk();
+    if (finished()) {
+      storeResult();
+    }
+  }
+}
+
+void IteratableChunkChecksumValidator::checkChunk()
 {
   if (!finished()) {
     std::string actualChecksum;
     try {
       actualChecksum = calculateActualChecksum();
-      if (actualChecksum == dctx_->getPieceHashes()[currentIndex_]) {
+      if (dctx_->matchPieceHash(currentIndex_, actualChecksum)) {
         bitfield_->setBit(currentIndex_);
       }
       else {
@@ -81,7 +91,9 @@ void IteratableChunkChecksumValidator::validateChunk()
             fmt(EX_INVALID_CHUNK_CHECKSUM,
                 static_cast<unsigned long>(currentIndex_),
                 static_cast<int64_t>(getCurrentOffset()),
-                util::toHex(dctx_->getPieceHashes()[currentIndex_]).c_str(),
+                util::toHex(dctx_->getPieceHash(currentIndex_),
+                            dctx_->getPieceHashLength())
+                    .c_str(),
                 util::toHex(actualChecksum).c_str()));
         bitfield_->unsetBit(currentIndex_);
       }
@@ -96,13 +108,15 @@ void IteratableChunkChecksumValidator::validateChunk()
     }
 
     ++currentIndex_;
-    if (finished()) {
-      pieceStorage_->setBitfield(bitfield_->getBitfield(),
-                                 bitfield_->getBitfieldLength());
-    }
   }
 }
 
+void IteratableChunkChecksumValidator::storeResult()
+{
+  pieceStorage_->setBitfield(bitfield_->getBitfield(),
+                             bitfield_->getBitfieldLength());
+}
+
 std::string IteratableChunkChecksumValidator::calculateActualChecksum()
 {
   int64_t offset = getCurrentOffset();
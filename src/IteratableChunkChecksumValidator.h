@@ -39,6 +39,7 @@
 
 #include <string>
 #include <memory>
+#include <atomic>
 
 namespace aria2 {
 
@@ -52,7 +53,8 @@ private:
   std::shared_ptr<DownloadContext> dctx_;
   std::shared_ptr<PieceStorage> pieceStorage_;
   std::unique_ptr<BitfieldMan> bitfield_;
-  size_t currentIndex_;
+  // Updated by checkChunk(), which may run in a worker thread.
+  std::atomic<size_t> currentIndex_;
   std::unique_ptr<MessageDigest> ctx_;
 
   std::string calculateActualChecksum();
@@ -70,6 +72,10 @@ public:
 
   virtual void validateChunk() CXX11_OVERRIDE;
 
+  virtual void checkChunk() CXX11_OVERRIDE;
+
+  virtual void storeResult() CXX11_OVERRIDE;
+
   virtual bool finished() const CXX11_OVERRIDE;
 
   virtual int64_t getCurrentOffset() const CXX11_OVERRIDE;
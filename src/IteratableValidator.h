@@ -48,6 +48,13 @@ namespace aria2 {
  * Then, call validateChunk() until finished() returns true.
  * The progress information is available using getCurrentOffset() and
  * getTotalLength().
+ *
+ * validateChunk() is checkChunk() followed by storeResult() once
+ * finished() returns true.  checkChunk() only touches the files being
+ * validated and this object, so that it can be called from a worker
+ * thread while getCurrentOffset() is called from DownloadEngine's
+ * thread.  storeResult() updates PieceStorage and must be called from
+ * DownloadEngine's thread.
  */
 class IteratableValidator {
 public:
@@ -57,6 +64,10 @@ public:
 
   virtual void validateChunk() = 0;
 
+  virtual void checkChunk() = 0;
+
+  virtual void storeResult() = 0;
+
   virtual bool finished() const = 0;
 
   virtual int64_t getCurrentOffset() const = 0;
@@ -0,0 +1,568 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2018 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#include "JsonRpcRequestParser.h"
+
+#include <cstring>
+#include <algorithm>
+
+#include "JsonParser.h"
+#include "ValueBase.h"
+#include "util.h"
+
+namespace aria2 {
+
+namespace rpc {
+
+namespace {
+// JsonParser fails when its state stack reaches 50 entries.
+const int MAX_DEPTH = 50;
+} // namespace
+
+namespace {
+bool isSpace(char c) { return util::isLws(c) || util::isCRLF(c); }
+} // namespace
+
+namespace {
+char unescape(char c)
+{
+  switch (c) {
+  case 'b':
+    return '\b';
+  case 'f':
+    return '\f';
+  case 'n':
+    return '\n';
+  case 'r':
+    return '\r';
+  case 't':
+    return '\t';
+  default:
+    return c;
+  }
+}
+} // namespace
+
+JsonRpcRequestParser::JsonRpcRequestParser()
+    : p_(nullptr), last_(nullptr), batch_(false)
+{
+}
+
+JsonRpcRequestParser::~JsonRpcRequestParser() = default;
+
+void JsonRpcRequestParser::reset()
+{
+  calls_.clear();
+  batch_ = false;
+}
+
+int JsonRpcRequestParser::parse(const char* data, size_t size)
+{
+  reset();
+  p_ = data;
+  last_ = data + size;
+  if (!skipSpace()) {
+    return json::ERR_PREMATURE_DATA;
+  }
+  int rv;
+  switch (*p_) {
+  case '{':
+    calls_.emplace_back();
+    rv = parseCall(calls_.back(), 1);
+    break;
+  case '[':
+    batch_ = true;
+    rv = parseBatch();
+    break;
+  default:
+    // Valid JSON, but not a request.
+    rv = parseValue(nullptr, 0);
+    if (rv == 0) {
+      calls_.emplace_back();
+      calls_.back().error = -32600;
+    }
+    break;
+  }
+  return rv;
+}
+
+int JsonRpcRequestParser::parseBatch()
+{
+  ++p_;
+  if (!skipSpace()) {
+    return json::ERR_PREMATURE_DATA;
+  }
+  if (*p_ == ']') {
+    ++p_;
+    return 0;
+  }
+  for (;;) {
+    if (!skipSpace()) {
+      return json::ERR_PREMATURE_DATA;
+    }
+    int rv;
+    if (*p_ == '{') {
+      calls_.emplace_back();
+      rv = parseCall(calls_.back(), 2);
+    }
+    else {
+      // Elements other than object are ignored.
+      rv = parseValue(nullptr, 1);
+    }
+    if (rv < 0) {
+      return rv;
+    }
+    if (!skipSpace()) {
+      return json::ERR_PREMATURE_DATA;
+    }
+    if (*p_ == ']') {
+      ++p_;
+      return 0;
+    }
+    if (*p_ != ',') {
+      return json::ERR_UNEXPECTED_CHAR_BEFORE_ARRAY_SEP;
+    }
+    ++p_;
+  }
+}
+
+template <typename F> int JsonRpcRequestParser::parseMembers(F f)
+{
+  ++p_;
+  for (;;) {
+    if (!skipSpace()) {
+      return json::ERR_PREMATURE_DATA;
+    }
+    // JsonParser allows a trailing comma before '}'.
+    if (*p_ == '}') {
+      ++p_;
+      return 0;
+    }
+    if (*p_ != '"') {
+      return json::ERR_UNEXPECTED_CHAR_BEFORE_OBJ_KEY;
+    }
+    ++p_;
+    key_.clear();
+    int rv = parseString(&key_);
+    if (rv < 0) {
+      return rv;
+    }
+    if (!skipSpace()) {
+      return json::ERR_PREMATURE_DATA;
+    }
+    if (*p_ != ':') {
+      return json::ERR_UNEXPECTED_CHAR_BEFORE_OBJ_VAL;
+    }
+    ++p_;
+    rv = f();
+    if (rv < 0) {
+      return rv;
+    }
+    if (!skipSpace()) {
+      return json::ERR_PREMATURE_DATA;
+    }
+    if (*p_ == ',') {
+      ++p_;
+    }
+    else if (*p_ == '}') {
+      ++p_;
+      return 0;
+    }
+    else {
+      return json::ERR_UNEXPECTED_CHAR_BEFORE_OBJ_SEP;
+    }
+  }
+}
+
+int JsonRpcRequestParser::parseCall(JsonRpcCall& call, int depth)
+{
+  // Same as Dict, the last one wins if a key appears more than once.
+  bool hasMethod = false;
+  std::unique_ptr<ValueBase> params;
+  int rv = parseMembers([&]() {
+    if (key_ == "id") {
+      return parseValue(&call.req.id, depth);
+    }
+    if (key_ == "method") {
+      if (!skipSpace()) {
+        return static_cast<int>(json::ERR_PREMATURE_DATA);
+      }
+      hasMethod = *p_ == '"';
+      if (hasMethod) {
+        ++p_;
+        call.req.methodName.clear();
+        return parseString(&call.req.methodName);
+      }
+      return parseValue(nullptr, depth);
+    }
+    if (key_ == "params") {
+      return parseValue(&params, depth);
+    }
+    return parseValue(nullptr, depth);
+  });
+  if (rv < 0) {
+    return rv;
+  }
+  call.req.jsonRpc = true;
+  if (!call.req.id || !hasMethod) {
+    call.error = -32600;
+  }
+  else if (!params) {
+    call.req.params = List::g();
+  }
+  else if (downcast<List>(params)) {
+    call.req.params.reset(static_cast<List*>(params.release()));
+  }
+  else {
+    // TODO No support for Named params
+    call.error = -32602;
+  }
+  return 0;
+}
+
+int JsonRpcRequestParser::parseValue(std::unique_ptr<ValueBase>* out,
+                                     int depth)
+{
+  if (!skipSpace()) {
+    return json::ERR_PREMATURE_DATA;
+  }
+  switch (*p_) {
+  case '{':
+    return parseDict(out, depth + 1);
+  case '[':
+    return parseList(out, depth + 1);
+  case '"': {
+    ++p_;
+    if (!out) {
+      return parseString(nullptr);
+    }
+    std::string s;
+    int rv = parseString(&s);
+    if (rv == 0) {
+      *out = String::g(std::move(s));
+    }
+    return rv;
+  }
+  case 't':
+    if (out) {
+      *out = Bool::gTrue();
+    }
+    return parseLiteral("true", 4);
+  case 'f':
+    if (out) {
+      *out = Bool::gFalse();
+    }
+    return parseLiteral("false", 5);
+  case 'n':
+    if (out) {
+      *out = Null::g();
+    }
+    return parseLiteral("null", 4);
+  default:
+    if (*p_ == '-' || util::isDigit(*p_)) {
+      return parseNumber(out);
+    }
+    return json::ERR_UNEXPECTED_CHAR_BEFORE_VAL;
+  }
+}
+
+int JsonRpcRequestParser::parseDict(std::unique_ptr<ValueBase>* out,
+                                    int depth)
+{
+  if (depth >= MAX_DEPTH) {
+    return json::ERR_STRUCTURE_TOO_DEEP;
+  }
+  std::unique_ptr<Dict> dict;
+  if (out) {
+    dict = Dict::g();
+  }
+  int rv = parseMembers([&]() {
+    if (!dict) {
+      return parseValue(nullptr, depth);
+    }
+    // key_ is overwritten while the value is parsed.
+    auto key = key_;
+    std::unique_ptr<ValueBase> value;
+    int rv = parseValue(&value, depth);
+    if (rv == 0) {
+      dict->put(std::move(key), std::move(value));
+    }
+    return rv;
+  });
+  if (rv == 0 && out) {
+    *out = std::move(dict);
+  }
+  return rv;
+}
+
+int JsonRpcRequestParser::parseList(std::unique_ptr<ValueBase>* out,
+                                    int depth)
+{
+  if (depth >= MAX_DEPTH) {
+    return json::ERR_STRUCTURE_TOO_DEEP;
+  }
+  std::unique_ptr<List> list;
+  if (out) {
+    list = List::g();
+  }
+  ++p_;
+  if (!skipSpace()) {
+    return json::ERR_PREMATURE_DATA;
+  }
+  if (*p_ != ']') {
+    for (;;) {
+      std::unique_ptr<ValueBase> value;
+      int rv = parseValue(list ? &value : nullptr, depth);
+      if (rv < 0) {
+        return rv;
+      }
+      if (list) {
+        list->append(std::move(value));
+      }
+      if (!skipSpace()) {
+        return json::ERR_PREMATURE_DATA;
+      }
+      if (*p_ == ']') {
+        break;
+      }
+      if (*p_ != ',') {
+        return json::ERR_UNEXPECTED_CHAR_BEFORE_ARRAY_SEP;
+      }
+      ++p_;
+    }
+  }
+  ++p_;
+  if (out) {
+    *out = std::move(list);
+  }
+  return 0;
+}
+
+int JsonRpcRequestParser::parseString(std::string* out)
+{
+  // q is the first '"' at or after p_.  It is searched again only
+  // when an escape sequence consumed it.
+  auto q = static_cast<const char*>(memchr(p_, '"', last_ - p_));
+  for (;;) {
+    if (!q) {
+      return json::ERR_PREMATURE_DATA;
+    }
+    auto bs = static_cast<const char*>(memchr(p_, '\\', q - p_));
+    if (!bs) {
+      if (out) {
+        out->append(p_, q);
+      }
+      p_ = q + 1;
+      return 0;
+    }
+    if (out) {
+      out->append(p_, bs);
+    }
+    p_ = bs + 1;
+    if (p_ == last_) {
+      return json::ERR_PREMATURE_DATA;
+    }
+    char c = *p_++;
+    if (c == 'u') {
+      int rv = parseUnicode(out);
+      if (rv < 0) {
+        return rv;
+      }
+    }
+    else if (out) {
+      *out += unescape(c);
+    }
+    if (p_ > q) {
+      q = static_cast<const char*>(memchr(p_, '"', last_ - p_));
+    }
+  }
+}
+
+int JsonRpcRequestParser::parseUnicode(std::string* out)
+{
+  uint32_t codepoint;
+  int rv = parseHex4(codepoint);
+  if (rv < 0) {
+    return rv;
+  }
+  char temp[4];
+  size_t len;
+  if (in(codepoint, 0xD800u, 0xDBFFu)) {
+    // This is high-surrogate codepoint
+    if (last_ - p_ < 2) {
+      return json::ERR_PREMATURE_DATA;
+    }
+    if (p_[0] != '\\' || p_[1] != 'u') {
+      return json::ERR_INVALID_UNICODE_POINT;
+    }
+    p_ += 2;
+    uint32_t codepoint2;
+    rv = parseHex4(codepoint2);
+    if (rv < 0) {
+      return rv;
+    }
+    if (!in(codepoint2, 0xDC00u, 0xDFFFu)) {
+      return json::ERR_INVALID_UNICODE_POINT;
+    }
+    uint32_t fullcodepoint = 0x010000u;
+    fullcodepoint += (codepoint & 0x03FFu) << 10;
+    fullcodepoint += (codepoint2 & 0x03FFu);
+    temp[0] = 0xf0u | (fullcodepoint >> 18);
+    temp[1] = 0x80u | ((fullcodepoint >> 12) & 0x003Fu);
+    temp[2] = 0x80u | ((fullcodepoint >> 6) & 0x003Fu);
+    temp[3] = 0x80u | (fullcodepoint & 0x003Fu);
+    len = 4;
+  }
+  else if (codepoint <= 0x007fu) {
+    temp[0] = static_cast<char>(codepoint);
+    len = 1;
+  }
+  else if (codepoint <= 0x07ffu) {
+    temp[0] = 0xC0u | (codepoint >> 6);
+    temp[1] = 0x80u | (codepoint & 0x003fu);
+    len = 2;
+  }
+  else {
+    temp[0] = 0xE0u | (codepoint >> 12);
+    temp[1] = 0x80u | ((codepoint >> 6) & 0x003Fu);
+    temp[2] = 0x80u | (codepoint & 0x003Fu);
+    len = 3;
+  }
+  if (out) {
+    out->append(temp, len);
+  }
+  return 0;
+}
+
+int JsonRpcRequestParser::parseHex4(uint32_t& codepoint)
+{
+  codepoint = 0;
+  for (int i = 0; i < 4; ++i, ++p_) {
+    if (p_ == last_) {
+      return json::ERR_PREMATURE_DATA;
+    }
+    if (!util::isHexDigit(*p_)) {
+      return json::ERR_INVALID_UNICODE_POINT;
+    }
+    codepoint = codepoint * 16 + util::hexCharToUInt(*p_);
+  }
+  return 0;
+}
+
+int JsonRpcRequestParser::parseNumber(std::unique_ptr<ValueBase>* out)
+{
+  int64_t sign = 1;
+  if (*p_ == '-') {
+    sign = -1;
+    ++p_;
+  }
+  int64_t number = 0;
+  auto first = p_;
+  for (; p_ != last_ && in(*p_, '0', '9'); ++p_) {
+    if ((INT64_MAX - (*p_ - '0')) / 10 < number) {
+      return json::ERR_NUMBER_OUT_OF_RANGE;
+    }
+    number *= 10;
+    number += *p_ - '0';
+  }
+  // As JsonParser does, a number must be followed by something.
+  if (p_ == last_) {
+    return json::ERR_PREMATURE_DATA;
+  }
+  if (p_ == first) {
+    return json::ERR_INVALID_NUMBER;
+  }
+  // TODO Ignore frac and exp, as ValueBaseStructParserStateMachine
+  // does.
+  if (*p_ == '.') {
+    first = ++p_;
+    for (; p_ != last_ && in(*p_, '0', '9'); ++p_)
+      ;
+    if (p_ == last_) {
+      return json::ERR_PREMATURE_DATA;
+    }
+    if (p_ == first) {
+      return json::ERR_INVALID_NUMBER;
+    }
+  }
+  if (*p_ == 'e' || *p_ == 'E') {
+    ++p_;
+    if (p_ != last_ && (*p_ == '+' || *p_ == '-')) {
+      ++p_;
+    }
+    int exp = 0;
+    first = p_;
+    for (; p_ != last_ && in(*p_, '0', '9'); ++p_) {
+      exp *= 10;
+      exp += *p_ - '0';
+      if (exp > 18) {
+        return json::ERR_NUMBER_OUT_OF_RANGE;
+      }
+    }
+    if (p_ == last_) {
+      return json::ERR_PREMATURE_DATA;
+    }
+    if (p_ == first) {
+      return json::ERR_INVALID_NUMBER;
+    }
+  }
+  if (out) {
+    *out = Integer::g(sign * number);
+  }
+  return 0;
+}
+
+int JsonRpcRequestParser::parseLiteral(const char* literal, size_t len)
+{
+  size_t n = std::min(len, static_cast<size_t>(last_ - p_));
+  if (memcmp(p_, literal, n) != 0) {
+    return json::ERR_UNEXPECTED_LITERAL;
+  }
+  if (n < len) {
+    return json::ERR_PREMATURE_DATA;
+  }
+  p_ += len;
+  return 0;
+}
+
+bool JsonRpcRequestParser::skipSpace()
+{
+  for (; p_ != last_ && isSpace(*p_); ++p_)
+    ;
+  return p_ != last_;
+}
+
+} // namespace rpc
+
+} // namespace aria2
@@ -0,0 +1,119 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2018 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#ifndef D_JSON_RPC_REQUEST_PARSER_H
+#define D_JSON_RPC_REQUEST_PARSER_H
+
+#include "common.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "RpcRequest.h"
+
+namespace aria2 {
+
+namespace rpc {
+
+// JSON-RPC call read by JsonRpcRequestParser.
+struct JsonRpcCall {
+  JsonRpcCall() : error(0) {}
+
+  RpcRequest req;
+  // JSON-RPC error code if the call is not a valid request object,
+  // or 0.  req.id is set if the object has "id".
+  int error;
+};
+
+// Parses a whole JSON-RPC request held in memory in one pass.
+// Unlike ValueBaseJsonParser, request objects are not built as Dict:
+// "method" is read straight into RpcRequest::methodName, members
+// other than "id", "method" and "params" are skipped without
+// allocation, and only the values of "id" and "params" are built as
+// ValueBase.  A string without escape sequences is copied out of the
+// input at once, and its end is found by memchr().  The accepted
+// syntax is the same as JsonParser.
+class JsonRpcRequestParser {
+public:
+  JsonRpcRequestParser();
+  ~JsonRpcRequestParser();
+
+  // Parses |size| bytes of data |data|, which must be a complete
+  // request.  Returns 0 if it succeeds, or one of the negative
+  // json::JsonError codes.  The input is not referenced after this
+  // function returns.
+  int parse(const char* data, size_t size);
+
+  // Returns true if the last parsed request is a batch call.
+  bool isBatch() const { return batch_; }
+
+  // Returns the calls of the last parsed request.  If it is not a
+  // batch call, this contains exactly one call.
+  std::vector<JsonRpcCall>& getCalls() { return calls_; }
+
+  void reset();
+
+private:
+  // Parses members of the object starting at p_.  For each member,
+  // the key is stored in key_ and f() is called to parse its value.
+  template <typename F> int parseMembers(F f);
+
+  int parseBatch();
+  int parseCall(JsonRpcCall& call, int depth);
+  // If |out| is nullptr, the value is only validated.  The |depth| is
+  // the number of the containers enclosing the value.
+  int parseValue(std::unique_ptr<ValueBase>* out, int depth);
+  int parseDict(std::unique_ptr<ValueBase>* out, int depth);
+  int parseList(std::unique_ptr<ValueBase>* out, int depth);
+  int parseString(std::string* out);
+  int parseUnicode(std::string* out);
+  int parseHex4(uint32_t& codepoint);
+  int parseNumber(std::unique_ptr<ValueBase>* out);
+  int parseLiteral(const char* literal, size_t len);
+  // Skips white spaces and returns true if data remains.
+  bool skipSpace();
+
+  const char* p_;
+  const char* last_;
+  std::string key_;
+  std::vector<JsonRpcCall> calls_;
+  bool batch_;
+};
+
+} // namespace rpc
+
+} // namespace aria2
+
+#endif // D_JSON_RPC_REQUEST_PARSER_H
@@ -0,0 +1,123 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2018 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#include "JsonStructWriter.h"
+
+#include "json.h"
+#include "util.h"
+
+namespace aria2 {
+
+namespace json {
+
+JsonStructWriter::JsonStructWriter(std::string& out)
+    : out_(out), afterKey_(false)
+{
+}
+
+JsonStructWriter::~JsonStructWriter() = default;
+
+void JsonStructWriter::separate()
+{
+  if (afterKey_) {
+    afterKey_ = false;
+    return;
+  }
+  if (first_.empty()) {
+    return;
+  }
+  if (first_.back()) {
+    first_.back() = false;
+  }
+  else {
+    out_ += ',';
+  }
+}
+
+void JsonStructWriter::writeString(const std::string& s)
+{
+  out_ += '"';
+  jsonEscape(out_, s);
+  out_ += '"';
+}
+
+void JsonStructWriter::beginDict()
+{
+  separate();
+  out_ += '{';
+  first_.push_back(true);
+}
+
+void JsonStructWriter::endDict()
+{
+  first_.pop_back();
+  out_ += '}';
+}
+
+void JsonStructWriter::beginList()
+{
+  separate();
+  out_ += '[';
+  first_.push_back(true);
+}
+
+void JsonStructWriter::endList()
+{
+  first_.pop_back();
+  out_ += ']';
+}
+
+void JsonStructWriter::key(const std::string& k)
+{
+  separate();
+  writeString(k);
+  out_ += ':';
+  afterKey_ = true;
+}
+
+void JsonStructWriter::value(const std::string& s)
+{
+  separate();
+  writeString(s);
+}
+
+void JsonStructWriter::value(int64_t i)
+{
+  separate();
+  out_ += util::itos(i);
+}
+
+} // namespace json
+
+} // namespace aria2
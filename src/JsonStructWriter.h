@@ -0,0 +1,87 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2018 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#ifndef D_JSON_STRUCT_WRITER_H
+#define D_JSON_STRUCT_WRITER_H
+
+#include "StructWriter.h"
+
+#include <vector>
+
+namespace aria2 {
+
+namespace json {
+
+// Implementation of StructWriter which appends JSON text to a string
+// as values are written, without building intermediate objects.
+class JsonStructWriter : public StructWriter {
+public:
+  explicit JsonStructWriter(std::string& out);
+
+  virtual ~JsonStructWriter();
+
+  virtual void beginDict() CXX11_OVERRIDE;
+
+  virtual void endDict() CXX11_OVERRIDE;
+
+  virtual void beginList() CXX11_OVERRIDE;
+
+  virtual void endList() CXX11_OVERRIDE;
+
+  virtual void key(const std::string& k) CXX11_OVERRIDE;
+
+  virtual void value(const std::string& s) CXX11_OVERRIDE;
+
+  virtual void value(int64_t i) CXX11_OVERRIDE;
+
+private:
+  // Writes "," if the next value is not the first one in the current
+  // dict or list.
+  void separate();
+
+  void writeString(const std::string& s);
+
+  std::string& out_;
+  // For each open dict or list, true if nothing has been written in
+  // it yet.
+  std::vector<bool> first_;
+  // true if key() has been called and its value is not written yet.
+  bool afterKey_;
+};
+
+} // namespace json
+
+} // namespace aria2
+
+#endif // D_JSON_STRUCT_WRITER_H
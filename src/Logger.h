@@ -39,6 +39,9 @@
 
 #include <string>
 #include <memory>
+#ifdef ENABLE_THREADS
+#  include <mutex>
+#endif // ENABLE_THREADS
 
 namespace aria2 {
 
@@ -64,6 +67,10 @@ private:
   // true if console log output is enabled.
   bool consoleOutput_;
   bool colorOutput_;
+#ifdef ENABLE_THREADS
+  // Serializes log output from worker threads.
+  std::mutex mutex_;
+#endif // ENABLE_THREADS
   // Don't allow copying
   Logger(const Logger&);
   Logger& operator=(const Logger&);
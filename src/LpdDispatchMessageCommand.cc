@@ -42,6 +42,7 @@
 #include "SocketCore.h"
 #include "util.h"
 #include "fmt.h"
+#include "wallclock.h"
 
 namespace aria2 {
 
@@ -87,6 +88,16 @@ bool LpdDispatchMessageCommand::execute()
       tryCount_ = 0;
     }
   }
+  Timer deadline;
+  if (dispatcher_->isAnnounceReady()) {
+    // Retry shortly.
+    deadline = global::wallclock();
+    deadline.advance(1_s);
+  }
+  else {
+    deadline = dispatcher_->getNextAnnounceTime();
+  }
+  e_->addTimer(deadline, this);
   e_->addCommand(std::unique_ptr<Command>(this));
   return false;
 }
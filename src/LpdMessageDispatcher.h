@@ -73,6 +73,9 @@ public:
   // default 5mins.
   bool isAnnounceReady() const;
 
+  // Returns the time when isAnnounceReady() becomes true.
+  Timer getNextAnnounceTime() const;
+
   // Sends LPD message. If message is sent returns true. Otherwise
   // returns false.
   bool sendMessage();
@@ -188,6 +188,11 @@ void MultiDiskAdaptor::resetDiskWriterEntries()
       if (readOnly_) {
         dwent->getDiskWriter()->enableReadOnly();
       }
+#ifdef ENABLE_THREADS
+      if (writeThreadPool_) {
+        dwent->getDiskWriter()->enableAsyncWrite(writeThreadPool_);
+      }
+#endif // ENABLE_THREADS
       // TODO mmap is not enabled at this moment. Call enableMmap()
       // after this function call.
     }
@@ -220,6 +225,10 @@ void MultiDiskAdaptor::openIfNot(DiskWriterEntry* entry,
     if (openedFileCounter) {
       openedFileCounter->ensureMaxOpenFileLimit(1);
     }
+    else if (getMaxOpenFiles() > 0 &&
+             openedDiskWriterEntries_.size() >= getMaxOpenFiles()) {
+      tryCloseFile(openedDiskWriterEntries_.size() - getMaxOpenFiles() + 1);
+    }
     (entry->*open)();
     openedDiskWriterEntries_.push_back(entry);
   }
@@ -410,13 +419,63 @@ ssize_t MultiDiskAdaptor::readData(unsigned char* data, size_t len,
   return totalReadLength;
 }
 
-void MultiDiskAdaptor::writeCache(const WrDiskCacheEntry* entry)
+void MultiDiskAdaptor::writeDataVector(const DataBuffers& bufs, int64_t offset)
+{
+  auto i = findFirstDiskWriterEntry(diskWriterEntries_, offset);
+  // The buffers to be written to *i, starting at fileOffset.
+  DataBuffers fileBufs;
+  int64_t fileOffset = offset - (*i)->getFileEntry()->getOffset();
+  int64_t fileBufLength = 0;
+  auto flush = [&]() {
+    if (fileBufs.empty()) {
+      return;
+    }
+    openIfNot((*i).get(), &DiskWriterEntry::openFile);
+    if (!(*i)->isOpen()) {
+      throwOnDiskWriterNotOpened((*i).get(),
+                                 (*i)->getFileEntry()->getOffset() +
+                                     fileOffset);
+    }
+    (*i)->getDiskWriter()->writeDataVector(fileBufs, fileOffset);
+    fileBufs.clear();
+  };
+  for (auto& buf : bufs) {
+    auto data = buf.first;
+    auto len = buf.second;
+    while (len > 0) {
+      int64_t room = (*i)->getFileEntry()->getLength() - fileOffset -
+                     fileBufLength;
+      if (room <= 0) {
+        flush();
+        if (++i == std::end(diskWriterEntries_)) {
+          throw DL_ABORT_EX(fmt(EX_FILE_OFFSET_OUT_OF_RANGE,
+                                (*(i - 1))->getFileEntry()->getLastOffset()));
+        }
+        fileOffset = 0;
+        fileBufLength = 0;
+        continue;
+      }
+      auto n = std::min(static_cast<int64_t>(len), room);
+      fileBufs.emplace_back(data, n);
+      fileBufLength += n;
+      data += n;
+      len -= n;
+    }
+  }
+  flush();
+}
+
+int MultiDiskAdaptor::getReadFd(int64_t offset, int64_t& fileOffset,
+                                size_t& len)
 {
-  for (auto& d : entry->getDataSet()) {
-    A2_LOG_DEBUG(fmt("Cache flush goff=%" PRId64 ", len=%lu", d->goff,
-                     static_cast<unsigned long>(d->len)));
-    writeData(d->data + d->offset, d->len, d->goff);
+  auto i = findFirstDiskWriterEntry(diskWriterEntries_, offset);
+  fileOffset = offset - (*i)->getFileEntry()->getOffset();
+  len = calculateLength((*i).get(), fileOffset, len);
+  openIfNot((*i).get(), &DiskWriterEntry::openFile);
+  if (!(*i)->isOpen()) {
+    throwOnDiskWriterNotOpened((*i).get(), offset);
   }
+  return (*i)->getDiskWriter()->getReadFd();
 }
 
 bool MultiDiskAdaptor::fileExists()
@@ -455,6 +514,19 @@ void MultiDiskAdaptor::enableMmap()
   }
 }
 
+#ifdef ENABLE_THREADS
+void MultiDiskAdaptor::enableAsyncWrite(std::shared_ptr<ThreadPool> threadPool)
+{
+  writeThreadPool_ = std::move(threadPool);
+  for (auto& dwent : diskWriterEntries_) {
+    auto& dw = dwent->getDiskWriter();
+    if (dw) {
+      dw->enableAsyncWrite(writeThreadPool_);
+    }
+  }
+}
+#endif // ENABLE_THREADS
+
 void MultiDiskAdaptor::cutTrailingGarbage()
 {
   for (auto& dwent : diskWriterEntries_) {
@@ -103,6 +103,10 @@ private:
 
   bool readOnly_;
 
+#ifdef ENABLE_THREADS
+  std::shared_ptr<ThreadPool> writeThreadPool_;
+#endif // ENABLE_THREADS
+
   void resetDiskWriterEntries();
 
   void openIfNot(DiskWriterEntry* entry, void (DiskWriterEntry::*f)());
@@ -133,7 +137,11 @@ public:
   virtual ssize_t readDataDropCache(unsigned char* data, size_t len,
                                     int64_t offset) CXX11_OVERRIDE;
 
-  virtual void writeCache(const WrDiskCacheEntry* entry) CXX11_OVERRIDE;
+  virtual void writeDataVector(const DataBuffers& bufs,
+                               int64_t offset) CXX11_OVERRIDE;
+
+  virtual int getReadFd(int64_t offset, int64_t& fileOffset,
+                        size_t& len) CXX11_OVERRIDE;
 
   virtual bool fileExists() CXX11_OVERRIDE;
 
@@ -152,6 +160,11 @@ public:
   // opened.
   virtual void enableMmap() CXX11_OVERRIDE;
 
+#ifdef ENABLE_THREADS
+  virtual void
+  enableAsyncWrite(std::shared_ptr<ThreadPool> threadPool) CXX11_OVERRIDE;
+#endif // ENABLE_THREADS
+
   void setPieceLength(int32_t pieceLength) { pieceLength_ = pieceLength; }
 
   int32_t getPieceLength() const { return pieceLength_; }
@@ -81,20 +81,20 @@ int NetStat::calculateAvgUploadSpeed()
 void NetStat::updateDownload(size_t bytes)
 {
   downloadSpeed_.update(bytes);
-  sessionDownloadLength_ += bytes;
+  sessionDownloadLength_.fetch_add(bytes, std::memory_order_relaxed);
 }
 
 void NetStat::updateUpload(size_t bytes)
 {
   uploadSpeed_.update(bytes);
-  sessionUploadLength_ += bytes;
+  sessionUploadLength_.fetch_add(bytes, std::memory_order_relaxed);
 }
 
 void NetStat::updateUploadSpeed(size_t bytes) { uploadSpeed_.update(bytes); }
 
 void NetStat::updateUploadLength(size_t bytes)
 {
-  sessionUploadLength_ += bytes;
+  sessionUploadLength_.fetch_add(bytes, std::memory_order_relaxed);
 }
 
 int NetStat::getMaxDownloadSpeed() const
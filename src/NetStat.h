@@ -37,6 +37,8 @@
 
 #include "common.h"
 
+#include <atomic>
+
 #include "SpeedCalc.h"
 #include "TransferStat.h"
 
@@ -71,6 +73,8 @@ public:
 
   int calculateAvgUploadSpeed();
 
+  // The update functions only touch atomic counters and may be called
+  // from any thread.
   void updateDownload(size_t bytes);
 
   void updateUpload(size_t bytes);
@@ -97,13 +101,19 @@ public:
 
   STATUS getStatus() const { return status_; }
 
-  uint64_t getSessionDownloadLength() const { return sessionDownloadLength_; }
+  uint64_t getSessionDownloadLength() const
+  {
+    return sessionDownloadLength_.load(std::memory_order_relaxed);
+  }
 
-  uint64_t getSessionUploadLength() const { return sessionUploadLength_; }
+  uint64_t getSessionUploadLength() const
+  {
+    return sessionUploadLength_.load(std::memory_order_relaxed);
+  }
 
   void addSessionDownloadLength(uint64_t length)
   {
-    sessionDownloadLength_ += length;
+    sessionDownloadLength_.fetch_add(length, std::memory_order_relaxed);
   }
 
   TransferStat toTransferStat();
@@ -115,8 +125,8 @@ private:
   STATUS status_;
   int avgDownloadSpeed_;
   int avgUploadSpeed_;
-  int64_t sessionDownloadLength_;
-  int64_t sessionUploadLength_;
+  std::atomic<int64_t> sessionDownloadLength_;
+  std::atomic<int64_t> sessionUploadLength_;
 };
 
 } // namespace aria2
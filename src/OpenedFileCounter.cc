@@ -70,7 +70,7 @@ void OpenedFileCounter::ensureMaxOpenFileLimit(size_t numNewFiles)
   std::advance(mark, SimpleRandomizer::getInstance()->getRandomNumber(
                          requestGroups.size()));
 
-  auto closeFun = [&left](const std::shared_ptr<RequestGroup>& group) {
+  auto closeFun = [&left, this](const std::shared_ptr<RequestGroup>& group) {
     auto& ps = group->getPieceStorage();
 
     if (!ps) {
@@ -79,7 +79,9 @@ void OpenedFileCounter::ensureMaxOpenFileLimit(size_t numNewFiles)
 
     auto diskAdaptor = ps->getDiskAdaptor();
 
-    if (!diskAdaptor) {
+    // Files of DiskAdaptor detached from this object are not counted
+    // here and may be in use by other thread.
+    if (!diskAdaptor || diskAdaptor->getOpenedFileCounter().get() != this) {
       return;
     }
 
@@ -119,6 +119,16 @@ std::vector<OptionHandler*> OptionHandlerFactory::createOptionHandlers()
     op->setChangeOptionForReserved(true);
     handlers.push_back(op);
   }
+#ifdef ENABLE_THREADS
+  {
+    OptionHandler* op(new BooleanOptionHandler(PREF_ASYNC_DISK_WRITE,
+                                               TEXT_ASYNC_DISK_WRITE,
+                                               A2_V_FALSE,
+                                               OptionHandler::OPT_ARG));
+    op->addTag(TAG_ADVANCED);
+    handlers.push_back(op);
+  }
+#endif // ENABLE_THREADS
   {
     OptionHandler* op(new NumberOptionHandler(
         PREF_AUTO_SAVE_INTERVAL, TEXT_AUTO_SAVE_INTERVAL, "60", 0, 600));
@@ -139,6 +149,16 @@ std::vector<OptionHandler*> OptionHandlerFactory::createOptionHandlers()
     op->setChangeOptionForReserved(true);
     handlers.push_back(op);
   }
+#ifdef ENABLE_THREADS
+  {
+    OptionHandler* op(new NumberOptionHandler(PREF_CHECK_INTEGRITY_THREADS,
+                                              TEXT_CHECK_INTEGRITY_THREADS,
+                                              "0", 0, 64));
+    op->addTag(TAG_ADVANCED);
+    op->addTag(TAG_CHECKSUM);
+    handlers.push_back(op);
+  }
+#endif // ENABLE_THREADS
   {
     OptionHandler* op(new BooleanOptionHandler(PREF_CONDITIONAL_GET,
                                                TEXT_CONDITIONAL_GET, A2_V_FALSE,
@@ -185,6 +205,13 @@ std::vector<OptionHandler*> OptionHandlerFactory::createOptionHandlers()
     op->addTag(TAG_ADVANCED);
     handlers.push_back(op);
   }
+  {
+    OptionHandler* op(new UnitNumberOptionHandler(
+        PREF_DISK_READ_CACHE, TEXT_DISK_READ_CACHE, "0", 0));
+    op->addTag(TAG_ADVANCED);
+    op->addTag(TAG_BITTORRENT);
+    handlers.push_back(op);
+  }
   {
     OptionHandler* op(new ParameterOptionHandler(
         PREF_CONSOLE_LOG_LEVEL, TEXT_CONSOLE_LOG_LEVEL, V_NOTICE,
@@ -1757,6 +1784,13 @@ std::vector<OptionHandler*> OptionHandlerFactory::createOptionHandlers()
     op->addTag(TAG_BITTORRENT);
     handlers.push_back(op);
   }
+  {
+    OptionHandler* op(new NumberOptionHandler(PREF_DHT_LOOKUP_CONCURRENCY,
+                                              TEXT_DHT_LOOKUP_CONCURRENCY,
+                                              "3", 1, 16));
+    op->addTag(TAG_BITTORRENT);
+    handlers.push_back(op);
+  }
   {
     OptionHandler* op(new BooleanOptionHandler(
         PREF_ENABLE_DHT, TEXT_ENABLE_DHT, A2_V_TRUE, OptionHandler::OPT_ARG));
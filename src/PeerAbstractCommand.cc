@@ -97,6 +97,9 @@ bool PeerAbstractCommand::execute()
     if (checkPoint_.difference(global::wallclock()) >= timeout_) {
       throw DL_ABORT_EX(EX_TIME_OUT);
     }
+    auto deadline = checkPoint_;
+    deadline.advance(timeout_);
+    e_->addTimer(deadline, this);
     return executeInternal();
   }
   catch (DownloadFailureException& err) {
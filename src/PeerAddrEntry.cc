@@ -33,13 +33,19 @@
  */
 /* copyright --> */
 #include "PeerAddrEntry.h"
+
+#include <cstring>
+
 #include "wallclock.h"
+#include "bittorrent_helper.h"
+#include "a2netcompat.h"
 
 namespace aria2 {
 
 PeerAddrEntry::PeerAddrEntry(const std::string& ipaddr, uint16_t port,
                              Timer updated)
-    : ipaddr_(ipaddr), port_(port), lastUpdated_(updated)
+    : compactLength_(bittorrent::packcompact(compact_, ipaddr, port)),
+      lastUpdated_(std::move(updated))
 {
 }
 
@@ -50,18 +56,37 @@ PeerAddrEntry::~PeerAddrEntry() = default;
 PeerAddrEntry& PeerAddrEntry::operator=(const PeerAddrEntry& c)
 {
   if (this != &c) {
-    ipaddr_ = c.ipaddr_;
-    port_ = c.port_;
+    memcpy(compact_, c.compact_, c.compactLength_);
+    compactLength_ = c.compactLength_;
     lastUpdated_ = c.lastUpdated_;
   }
   return *this;
 }
 
+std::string PeerAddrEntry::getIPAddress() const
+{
+  if (!good()) {
+    return "";
+  }
+  return bittorrent::unpackcompact(
+             compact_, compactLength_ == COMPACT_LEN_IPV6 ? AF_INET6 : AF_INET)
+      .first;
+}
+
+uint16_t PeerAddrEntry::getPort() const
+{
+  if (!good()) {
+    return 0;
+  }
+  return (compact_[compactLength_ - 2] << 8) | compact_[compactLength_ - 1];
+}
+
 void PeerAddrEntry::notifyUpdate() { lastUpdated_ = global::wallclock(); }
 
 bool PeerAddrEntry::operator==(const PeerAddrEntry& entry) const
 {
-  return ipaddr_ == entry.ipaddr_ && port_ == entry.port_;
+  return compactLength_ == entry.compactLength_ &&
+         memcmp(compact_, entry.compact_, compactLength_) == 0;
 }
 
 } // namespace aria2
@@ -40,14 +40,17 @@
 #include <string>
 
 #include "TimerA2.h"
+#include "BtConstants.h"
 
 namespace aria2 {
 
+// Address and port are stored in compact form, so that an entry needs
+// no heap allocation.
 class PeerAddrEntry {
 private:
-  std::string ipaddr_;
+  unsigned char compact_[COMPACT_LEN_IPV6];
 
-  uint16_t port_;
+  uint8_t compactLength_;
 
   Timer lastUpdated_;
 
@@ -59,9 +62,17 @@ public:
 
   PeerAddrEntry& operator=(const PeerAddrEntry& c);
 
-  const std::string& getIPAddress() const { return ipaddr_; }
+  // Returns false if the address given to the constructor is not a
+  // numeric IPv4 or IPv6 address.
+  bool good() const { return compactLength_ != 0; }
 
-  uint16_t getPort() const { return port_; }
+  std::string getIPAddress() const;
+
+  uint16_t getPort() const;
+
+  const unsigned char* getCompact() const { return compact_; }
+
+  size_t getCompactLength() const { return compactLength_; }
 
   const Timer& getLastUpdated() const { return lastUpdated_; }
 
@@ -36,6 +36,7 @@
 #include "DownloadEngine.h"
 #include "BtRuntime.h"
 #include "PeerStorage.h"
+#include "wallclock.h"
 
 namespace aria2 {
 
@@ -54,6 +55,9 @@ bool PeerChokeCommand::execute()
   if (peerStorage_->chokeRoundIntervalElapsed()) {
     peerStorage_->executeChoke();
   }
+  auto deadline = global::wallclock();
+  deadline.advance(1_s);
+  e_->addTimer(deadline, this);
   e_->addCommand(std::unique_ptr<Command>(this));
   return false;
 }
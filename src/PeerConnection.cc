@@ -92,6 +92,24 @@ void PeerConnection::pushBytes(std::vector<unsigned char> data,
   socketBuffer_.pushBytes(std::move(data), std::move(progressUpdate));
 }
 
+bool PeerConnection::canPushFile() const
+{
+#ifdef HAVE_SENDFILE
+  return !encryptionEnabled_;
+#else  // !HAVE_SENDFILE
+  return false;
+#endif // !HAVE_SENDFILE
+}
+
+void PeerConnection::pushFile(std::shared_ptr<DiskAdaptor> diskAdaptor,
+                              int64_t offset, size_t length,
+                              std::unique_ptr<ProgressUpdate> progressUpdate)
+{
+  assert(!encryptionEnabled_);
+  socketBuffer_.pushFile(std::move(diskAdaptor), offset, length,
+                         std::move(progressUpdate));
+}
+
 bool PeerConnection::receiveMessage(unsigned char* data, size_t& dataLength)
 {
   while (1) {
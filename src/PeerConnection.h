@@ -50,6 +50,7 @@ namespace aria2 {
 class Peer;
 class SocketCore;
 class ARC4Encryptor;
+class DiskAdaptor;
 
 // The maximum length of buffer. If the message length (including 4
 // bytes length and payload length) is larger than this value, it is
@@ -100,6 +101,20 @@ public:
                  std::unique_ptr<ProgressUpdate> progressUpdate =
                      std::unique_ptr<ProgressUpdate>{});
 
+  // Returns true if pushFile() can be used.  It is false if
+  // sendfile(2) is not available or encryption is enabled, since the
+  // data must be encrypted in user space.
+  bool canPushFile() const;
+
+  // Pushes |length| bytes of data at |offset| in |diskAdaptor| into
+  // send buffer.  The data are sent directly from the file by
+  // sendfile(2).  Call this function only if canPushFile() returns
+  // true.
+  void pushFile(std::shared_ptr<DiskAdaptor> diskAdaptor, int64_t offset,
+                size_t length,
+                std::unique_ptr<ProgressUpdate> progressUpdate =
+                    std::unique_ptr<ProgressUpdate>{});
+
   bool receiveMessage(unsigned char* data, size_t& dataLength);
 
   /**
@@ -72,6 +72,7 @@
 #include "RequestGroup.h"
 #include "DefaultExtensionMessageFactory.h"
 #include "RequestGroupMan.h"
+#include "wallclock.h"
 #include "ExtensionMessageRegistry.h"
 #include "bittorrent_helper.h"
 #include "UTMetadataRequestFactory.h"
@@ -339,18 +340,28 @@ bool PeerInteractionCommand::executeInternal()
       sequence_ = WIRED;
       break;
     }
-    case WIRED:
+    case WIRED: {
       btInteractive_->doInteractionProcessing();
       if (btInteractive_->countReceivedMessageInIteration() > 0) {
         updateKeepAlive();
       }
-
-      if (getDownloadEngine()
-              ->getRequestGroupMan()
-              ->doesOverallDownloadSpeedExceed() ||
-          requestGroup_->doesDownloadSpeedExceed()) {
+      // BtInteractive sends keep-alive, cancels timed out requests and
+      // announces the pieces completed by other connections on its
+      // own, so come back even if the socket stays quiet.
+      auto tick = global::wallclock();
+      tick.advance(1_s);
+      getDownloadEngine()->addTimer(tick, this);
+
+      // The download bucket of RequestGroup also applies the overall
+      // limit.
+      if (requestGroup_->doesDownloadSpeedExceed()) {
         disableReadCheckSocket();
         setNoCheck(true);
+        // Wake up as soon as the limit permits to receive data again.
+        auto deadline = global::wallclock();
+        deadline.advance(requestGroup_->getDownloadBucket().timeToAvailable(
+            global::wallclock()));
+        getDownloadEngine()->addTimer(deadline, this);
       }
       else {
         setReadCheckSocket(getSocket());
@@ -359,14 +370,20 @@ bool PeerInteractionCommand::executeInternal()
       done = true;
       break;
     }
+    }
   }
-  if ((btInteractive_->countPendingMessage() > 0 ||
-       btInteractive_->isSendingMessageInProgress()) &&
-      !getDownloadEngine()
-           ->getRequestGroupMan()
-           ->doesOverallUploadSpeedExceed() &&
-      !requestGroup_->doesUploadSpeedExceed()) {
-    setWriteCheckSocket(getSocket());
+  if (btInteractive_->countPendingMessage() > 0 ||
+      btInteractive_->isSendingMessageInProgress()) {
+    if (requestGroup_->doesUploadSpeedExceed()) {
+      disableWriteCheckSocket();
+      auto deadline = global::wallclock();
+      deadline.advance(requestGroup_->getUploadBucket().timeToAvailable(
+          global::wallclock()));
+      getDownloadEngine()->addTimer(deadline, this);
+    }
+    else {
+      setWriteCheckSocket(getSocket());
+    }
   }
   else {
     disableWriteCheckSocket();
@@ -51,14 +51,22 @@
 
 namespace aria2 {
 
-Piece::Piece() : index_(0), length_(0), nextBegin_(0), usedBySegment_(false) {}
+Piece::Piece()
+    : index_(0),
+      length_(0),
+      nextBegin_(0),
+      usedBySegment_(false),
+      offset_(0)
+{
+}
 
 Piece::Piece(size_t index, int64_t length, int32_t blockLength)
     : bitfield_(make_unique<BitfieldMan>(blockLength, length)),
       index_(index),
       length_(length),
       nextBegin_(0),
-      usedBySegment_(false)
+      usedBySegment_(false),
+      offset_(0)
 {
 }
 
@@ -204,6 +212,7 @@ bool Piece::updateHash(int64_t begin, const unsigned char* data,
     }
     mdctx_->update(data, dataLength);
     nextBegin_ += dataLength;
+    updateHashWithWrCache();
     return true;
   }
   else {
@@ -211,6 +220,36 @@ bool Piece::updateHash(int64_t begin, const unsigned char* data,
   }
 }
 
+void Piece::updateHashWithWrCache()
+{
+  if (!wrCache_) {
+    return;
+  }
+  // The data flushed to the disk are not available here.  Then the
+  // hash is left incomplete, and it is calculated by
+  // getDigestWithWrCache() when this piece is completed.
+  const WrDiskCacheEntry::DataCellSet& dataSet = wrCache_->getDataSet();
+  WrDiskCacheEntry::DataCell key{};
+  while (nextBegin_ < length_) {
+    key.goff = offset_ + nextBegin_;
+    auto i = dataSet.upper_bound(&key);
+    if (i == std::begin(dataSet)) {
+      return;
+    }
+    auto d = *--i;
+    int64_t end = std::min(d->goff + static_cast<int64_t>(d->len),
+                           offset_ + length_);
+    if (end <= key.goff) {
+      return;
+    }
+    // Only the part past nextBegin_ is new if data overlap.
+    size_t skip = key.goff - d->goff;
+    size_t len = end - key.goff;
+    mdctx_->update(d->data + d->offset + skip, len);
+    nextBegin_ += len;
+  }
+}
+
 bool Piece::isHashCalculated() const { return mdctx_ && nextBegin_ == length_; }
 
 std::string Piece::getDigest()
@@ -298,7 +337,8 @@ void Piece::removeUser(cuid_t cuid)
 }
 
 void Piece::initWrCache(WrDiskCache* diskCache,
-                        const std::shared_ptr<DiskAdaptor>& diskAdaptor)
+                        const std::shared_ptr<DiskAdaptor>& diskAdaptor,
+                        int64_t offset)
 {
   if (!diskCache) {
     return;
@@ -307,6 +347,7 @@ void Piece::initWrCache(WrDiskCache* diskCache,
   wrCache_ = make_unique<WrDiskCacheEntry>(diskAdaptor);
   bool rv = diskCache->add(wrCache_.get());
   assert(rv);
+  offset_ = offset;
 }
 
 void Piece::flushWrCache(WrDiskCache* diskCache)
@@ -68,6 +68,12 @@ private:
 
   bool usedBySegment_;
 
+  // The offset of this piece in DiskAdaptor, given by initWrCache().
+  int64_t offset_;
+
+  // Feeds the data in wrCache_ which start at nextBegin_ to mdctx_.
+  void updateHashWithWrCache();
+
   Piece(const Piece& piece) = delete;
   Piece& operator=(const Piece& piece) = delete;
 
@@ -145,7 +151,10 @@ public:
 
   // Updates hash value. This function compares begin and private variable
   // nextBegin_ and only when they are equal, hash is updated eating data and
-  // returns true. Otherwise returns false.
+  // returns true. Otherwise returns false.  After data is eaten, the data
+  // cached in the write disk cache entry which follow it are also eaten, so
+  // that the data received ahead of nextBegin_ are hashed without being kept
+  // in another buffer.
   bool updateHash(int64_t begin, const unsigned char* data, size_t dataLength);
 
   bool isHashCalculated() const;
@@ -174,8 +183,10 @@ public:
   bool getUsedBySegment() const { return usedBySegment_; }
   void setUsedBySegment(bool f) { usedBySegment_ = f; }
 
+  // |offset| is the offset of this piece in |diskAdaptor|.
   void initWrCache(WrDiskCache* diskCache,
-                   const std::shared_ptr<DiskAdaptor>& diskAdaptor);
+                   const std::shared_ptr<DiskAdaptor>& diskAdaptor,
+                   int64_t offset);
   void flushWrCache(WrDiskCache* diskCache);
   void clearWrCache(WrDiskCache* diskCache);
   void updateWrCache(WrDiskCache* diskCache, unsigned char* data, size_t offset,
@@ -39,11 +39,19 @@
 
 #include "SimpleRandomizer.h"
 #include "bitfield.h"
+#include "array_fun.h"
+
+using namespace aria2::expr;
 
 namespace aria2 {
 
 PieceStatMan::PieceStatMan(size_t pieceNum, bool randomShuffle)
-    : order_(pieceNum), counts_(pieceNum)
+    : order_(pieceNum),
+      counts_(pieceNum),
+      pos_(pieceNum),
+      buckets_{0, pieceNum},
+      bucketBitfields_(1, std::vector<unsigned char>((pieceNum + 7) / 8)),
+      randomShuffle_(randomShuffle)
 {
   for (size_t i = 0; i < pieceNum; ++i) {
     order_[i] = i;
@@ -53,66 +61,133 @@ PieceStatMan::PieceStatMan(size_t pieceNum, bool randomShuffle)
     std::shuffle(order_.begin(), order_.end(),
                  *SimpleRandomizer::getInstance());
   }
+  sorted_ = order_;
+  for (size_t i = 0; i < pieceNum; ++i) {
+    pos_[sorted_[i]] = i;
+    bitfield::flipBit(bucketBitfields_[0].data(), bucketBitfields_[0].size(),
+                      i);
+  }
 }
 
 PieceStatMan::~PieceStatMan() = default;
 
-namespace {
-void inc(int& x)
+void PieceStatMan::swap(size_t p, size_t q)
 {
-  if (x < std::numeric_limits<int>::max()) {
-    ++x;
+  std::swap(sorted_[p], sorted_[q]);
+  pos_[sorted_[p]] = p;
+  pos_[sorted_[q]] = q;
+}
+
+void PieceStatMan::swapRandom(size_t p, size_t first, size_t last)
+{
+  if (randomShuffle_) {
+    swap(p, first + SimpleRandomizer::getInstance()->getRandomNumber(
+                        last - first));
   }
 }
-} // namespace
 
-namespace {
-void sub(int& x)
+void PieceStatMan::inc(size_t index)
 {
-  if (x > 0) {
-    --x;
+  int c = counts_[index];
+  if (c == std::numeric_limits<int>::max()) {
+    return;
+  }
+  if (buckets_.size() < static_cast<size_t>(c) + 3) {
+    buckets_.push_back(sorted_.size());
+    bucketBitfields_.emplace_back(bucketBitfields_[0].size());
   }
+  // Move index to the end of bucket c, which becomes the head of
+  // bucket c + 1.
+  swap(pos_[index], --buckets_[c + 1]);
+  swapRandom(buckets_[c + 1], buckets_[c + 1], buckets_[c + 2]);
+  auto len = bucketBitfields_[0].size();
+  bitfield::flipBit(bucketBitfields_[c].data(), len, index);
+  bitfield::flipBit(bucketBitfields_[c + 1].data(), len, index);
+  ++counts_[index];
 }
-} // namespace
 
-void PieceStatMan::addPieceStats(const unsigned char* bitfield,
-                                 size_t bitfieldLength)
+void PieceStatMan::sub(size_t index)
+{
+  int c = counts_[index];
+  if (c == 0) {
+    return;
+  }
+  // Move index to the head of bucket c, which becomes the end of
+  // bucket c - 1.
+  swap(pos_[index], buckets_[c]++);
+  swapRandom(buckets_[c] - 1, buckets_[c - 1], buckets_[c]);
+  auto len = bucketBitfields_[0].size();
+  bitfield::flipBit(bucketBitfields_[c].data(), len, index);
+  bitfield::flipBit(bucketBitfields_[c - 1].data(), len, index);
+  --counts_[index];
+}
+
+bool PieceStatMan::getRarestPiece(size_t& index, const unsigned char* bitfield,
+                                  size_t nbits) const
 {
-  for (size_t i = 0, nbits = counts_.size(); i < nbits; ++i) {
-    if (bitfield::test(bitfield, nbits, i)) {
-      inc(counts_[i]);
+  nbits = std::min(nbits, counts_.size());
+  size_t nwords = (nbits + 63) / 64;
+  for (size_t c = 0; c + 1 < buckets_.size(); ++c) {
+    size_t first = buckets_[c];
+    size_t last = buckets_[c + 1];
+    if (last - first <= nwords) {
+      for (size_t p = first; p < last; ++p) {
+        if (sorted_[p] < nbits && bitfield::test(bitfield, nbits, sorted_[p])) {
+          index = sorted_[p];
+          return true;
+        }
+      }
+      continue;
+    }
+    size_t best = last;
+    bitfield::forEachSetBit(array(bucketBitfields_[c].data()) &
+                                array(bitfield),
+                            nbits, [this, &best](size_t i) {
+                              best = std::min(best, pos_[i]);
+                              return true;
+                            });
+    if (best != last) {
+      index = sorted_[best];
+      return true;
     }
   }
+  return false;
+}
+
+void PieceStatMan::addPieceStats(const unsigned char* bitfield,
+                                 size_t bitfieldLength)
+{
+  bitfield::forEachSetBit(bitfield, counts_.size(), [this](size_t i) {
+    inc(i);
+    return true;
+  });
 }
 
 void PieceStatMan::subtractPieceStats(const unsigned char* bitfield,
                                       size_t bitfieldLength)
 {
-  for (size_t i = 0, nbits = counts_.size(); i < nbits; ++i) {
-    if (bitfield::test(bitfield, nbits, i)) {
-      sub(counts_[i]);
-    }
-  }
+  bitfield::forEachSetBit(bitfield, counts_.size(), [this](size_t i) {
+    sub(i);
+    return true;
+  });
 }
 
 void PieceStatMan::updatePieceStats(const unsigned char* newBitfield,
                                     size_t newBitfieldLength,
                                     const unsigned char* oldBitfield)
 {
-  for (size_t i = 0, nbits = counts_.size(); i < nbits; ++i) {
-    bool inNew = bitfield::test(newBitfield, nbits, i);
-    bool inOld = bitfield::test(oldBitfield, nbits, i);
-    if (inNew) {
-      if (!inOld) {
-        inc(counts_[i]);
-      }
-    }
-    else if (inOld) {
-      sub(counts_[i]);
-    }
-  }
+  bitfield::forEachSetBit(array(newBitfield) & ~array(oldBitfield),
+                          counts_.size(), [this](size_t i) {
+                            inc(i);
+                            return true;
+                          });
+  bitfield::forEachSetBit(~array(newBitfield) & array(oldBitfield),
+                          counts_.size(), [this](size_t i) {
+                            sub(i);
+                            return true;
+                          });
 }
 
-void PieceStatMan::addPieceStats(size_t index) { inc(counts_[index]); }
+void PieceStatMan::addPieceStats(size_t index) { inc(index); }
 
 } // namespace aria2
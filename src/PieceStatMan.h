@@ -45,6 +45,30 @@ class PieceStatMan {
 private:
   std::vector<size_t> order_;
   std::vector<int> counts_;
+  // Piece indexes sorted by counts_ in ascending order.  Pieces with
+  // the same count form a bucket; within a bucket, the order is
+  // derived from order_.
+  std::vector<size_t> sorted_;
+  // Position of each piece in sorted_.
+  std::vector<size_t> pos_;
+  // buckets_[c] is the position of the first piece with count c in
+  // sorted_.  The bucket ends at buckets_[c + 1].
+  std::vector<size_t> buckets_;
+  // bucketBitfields_[c] has the bits of the pieces with count c set,
+  // so that a bucket is matched against a bitfield a word at a time.
+  std::vector<std::vector<unsigned char>> bucketBitfields_;
+  bool randomShuffle_;
+
+  void inc(size_t index);
+
+  void sub(size_t index);
+
+  void swap(size_t p, size_t q);
+
+  // Swaps the piece at p with a random one in [first, last) if
+  // randomShuffle_ is true, so that the pieces with the same count
+  // stay in random order.
+  void swapRandom(size_t p, size_t first, size_t last);
 
 public:
   PieceStatMan(size_t pieceNum, bool randomShuffle);
@@ -64,6 +88,21 @@ public:
   const std::vector<size_t>& getOrder() const { return order_; }
 
   const std::vector<int>& getCounts() const { return counts_; }
+
+  // Returns piece indexes sorted by availability, the rarest first.
+  // Moving a piece between buckets takes constant time, so this is
+  // always up to date.
+  const std::vector<size_t>& getRarestOrder() const { return sorted_; }
+
+  // Stores the rarest piece among the pieces set in bitfield to
+  // index.  Among the pieces with the same count, the one which comes
+  // first in getRarestOrder() is chosen.  bitfield contains nbits
+  // bits.  Returns true if such piece is found.  The buckets are
+  // searched from the rarest, and each of them is scanned piece by
+  // piece or matched against bitfield a word at a time, whichever is
+  // cheaper.
+  bool getRarestPiece(size_t& index, const unsigned char* bitfield,
+                      size_t nbits) const;
 };
 
 } // namespace aria2
@@ -52,6 +52,7 @@ class Peer;
 #endif // ENABLE_BITTORRENT
 class DiskAdaptor;
 class WrDiskCache;
+class RdDiskCache;
 
 class PieceStorage {
 public:
@@ -226,6 +227,10 @@ public:
 
   virtual WrDiskCache* getWrDiskCache() = 0;
 
+  // Returns the read cache used to serve upload requests, or nullptr
+  // if it is disabled.
+  virtual RdDiskCache* getRdDiskCache() = 0;
+
   // Flushes write disk cache for in-flight piece and evicts them.
   virtual void flushWrDiskCacheEntry() = 0;
 
@@ -246,6 +251,14 @@ public:
                                              cuid_t myCuid,
                                              uint64_t lastHaveIndex) = 0;
 
+  /**
+   * Returns the index of the most recently advertised piece, or 0 if
+   * no piece has been advertised.  Passing it to
+   * getAdvertisedPieceIndexes() as lastHaveIndex skips all pieces
+   * advertised so far.
+   */
+  virtual uint64_t getLastHaveIndex() const = 0;
+
   /**
    * Removes have entry if its registeredTime is at least as old as
    * expiry.
@@ -36,12 +36,15 @@
 #define D_RANGE_BT_MESSAGE_VALIDATOR_H
 
 #include "BtMessageValidator.h"
+#include "FreeListAllocated.h"
 
 namespace aria2 {
 
 class RangeBtMessage;
 
-class RangeBtMessageValidator : public BtMessageValidator {
+class RangeBtMessageValidator
+    : public BtMessageValidator,
+      public FreeListAllocated<RangeBtMessageValidator> {
 private:
   const RangeBtMessage* message_;
   size_t numPiece_;
@@ -0,0 +1,111 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2018 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#include "RdDiskCache.h"
+
+#include "WrDiskCache.h"
+#include "LogFactory.h"
+#include "fmt.h"
+
+namespace aria2 {
+
+RdDiskCache::RdDiskCache(size_t limit, const WrDiskCache* wrDiskCache)
+    : limit_(limit), total_(0), wrDiskCache_(wrDiskCache)
+{
+}
+
+RdDiskCache::~RdDiskCache() = default;
+
+const std::vector<unsigned char>* RdDiskCache::get(a2_gid_t gid,
+                                                   size_t index)
+{
+  auto i = index_.find(Key(gid, index));
+  if (i == std::end(index_)) {
+    return nullptr;
+  }
+  lru_.splice(std::begin(lru_), lru_, (*i).second);
+  return &(*i).second->data;
+}
+
+const std::vector<unsigned char>*
+RdDiskCache::add(a2_gid_t gid, size_t index, std::vector<unsigned char> data)
+{
+  auto key = Key(gid, index);
+  auto i = index_.find(key);
+  if (i != std::end(index_)) {
+    erase((*i).second);
+  }
+  if (!ensureLimit(data.size())) {
+    return nullptr;
+  }
+  total_ += data.size();
+  lru_.push_front(Entry{key, std::move(data)});
+  index_.insert(std::make_pair(key, std::begin(lru_)));
+  return &lru_.front().data;
+}
+
+void RdDiskCache::remove(a2_gid_t gid)
+{
+  for (auto i = index_.lower_bound(Key(gid, 0));
+       i != std::end(index_) && (*i).first.first == gid;) {
+    auto j = (*i).second;
+    ++i;
+    erase(j);
+  }
+}
+
+bool RdDiskCache::ensureLimit(size_t extra)
+{
+  size_t wrSize = wrDiskCache_ ? wrDiskCache_->getSize() : 0;
+  if (extra + wrSize > limit_) {
+    return false;
+  }
+  while (!lru_.empty() && total_ + extra + wrSize > limit_) {
+    auto& ent = lru_.back();
+    A2_LOG_DEBUG(fmt("Evict read cache entry gid=%s, index=%lu",
+                     GroupId::toHex(ent.key.first).c_str(),
+                     static_cast<unsigned long>(ent.key.second)));
+    erase(--std::end(lru_));
+  }
+  return true;
+}
+
+void RdDiskCache::erase(EntryList::iterator i)
+{
+  total_ -= (*i).data.size();
+  index_.erase((*i).key);
+  lru_.erase(i);
+}
+
+} // namespace aria2
@@ -0,0 +1,96 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2018 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#ifndef D_RD_DISK_CACHE_H
+#define D_RD_DISK_CACHE_H
+
+#include "common.h"
+
+#include <list>
+#include <map>
+#include <vector>
+
+#include "GroupId.h"
+
+namespace aria2 {
+
+class WrDiskCache;
+
+// Caches whole pieces read from the disk to serve upload requests.
+// The cache is created for aria2 instance and shared by all
+// downloads. The least recently used pieces are evicted first.
+class RdDiskCache {
+public:
+  // |wrDiskCache| may be nullptr. If it is not, the data cached in it
+  // are counted against |limit| as well.
+  RdDiskCache(size_t limit, const WrDiskCache* wrDiskCache = nullptr);
+  ~RdDiskCache();
+  // Returns the cached data of the piece |index| of the download
+  // |gid|, or nullptr if it is not cached.
+  const std::vector<unsigned char>* get(a2_gid_t gid, size_t index);
+  // Stores |data| as the piece |index| of the download |gid| and
+  // returns the pointer to the stored data. If |data| does not fit in
+  // the cache, nothing is stored and nullptr is returned.
+  const std::vector<unsigned char>* add(a2_gid_t gid, size_t index,
+                                        std::vector<unsigned char> data);
+  // Removes all pieces of the download |gid|.
+  void remove(a2_gid_t gid);
+  size_t getSize() const { return total_; }
+  size_t getLimit() const { return limit_; }
+  size_t getNumEntry() const { return lru_.size(); }
+
+private:
+  typedef std::pair<a2_gid_t, size_t> Key;
+  struct Entry {
+    Key key;
+    std::vector<unsigned char> data;
+  };
+  typedef std::list<Entry> EntryList;
+  // Evicts entries so that the cache can store |extra| more bytes.
+  // Returns false if it cannot.
+  bool ensureLimit(size_t extra);
+  void erase(EntryList::iterator i);
+  // Maximum number of bytes the storage can cache.
+  size_t limit_;
+  // Current number of bytes cached.
+  size_t total_;
+  const WrDiskCache* wrDiskCache_;
+  // The most recently used entry comes first.
+  EntryList lru_;
+  std::map<Key, EntryList::iterator> index_;
+};
+
+} // namespace aria2
+
+#endif // D_RD_DISK_CACHE_H
@@ -59,6 +59,8 @@
 #include "DlAbortEx.h"
 #include "DownloadFailureException.h"
 #include "RequestGroupMan.h"
+#include "RdDiskCache.h"
+#include "wallclock.h"
 #include "DefaultBtProgressInfoFile.h"
 #include "DefaultPieceStorage.h"
 #include "download_handlers.h"
@@ -119,6 +121,8 @@
 
 namespace aria2 {
 
+uint64_t RequestGroup::lastStatusVersion_ = 0;
+
 RequestGroup::RequestGroup(const std::shared_ptr<GroupId>& gid,
                            const std::shared_ptr<Option>& option)
     : belongsToGID_(0),
@@ -140,8 +144,9 @@ RequestGroup::RequestGroup(const std::shared_ptr<GroupId>& gid,
       numStreamCommand_(0),
       numCommand_(0),
       fileNotFoundCount_(0),
-      maxDownloadSpeedLimit_(option->getAsInt(PREF_MAX_DOWNLOAD_LIMIT)),
-      maxUploadSpeedLimit_(option->getAsInt(PREF_MAX_UPLOAD_LIMIT)),
+      statusVersion_(0),
+      downloadBucket_(option->getAsInt(PREF_MAX_DOWNLOAD_LIMIT)),
+      uploadBucket_(option->getAsInt(PREF_MAX_UPLOAD_LIMIT)),
       resumeFailureCount_(0),
       haltReason_(RequestGroup::NONE),
       lastErrorCode_(error_code::UNDEFINED),
@@ -596,6 +601,7 @@ void RequestGroup::initPieceStorage()
 #endif // !ENABLE_BITTORRENT
     if (requestGroupMan_) {
       ps->setWrDiskCache(requestGroupMan_->getWrDiskCache());
+      ps->setRdDiskCache(requestGroupMan_->getRdDiskCache());
     }
     if (diskWriterFactory_) {
       ps->setDiskWriterFactory(diskWriterFactory_);
@@ -613,6 +619,12 @@ void RequestGroup::initPieceStorage()
   if (requestGroupMan_) {
     tempPieceStorage->getDiskAdaptor()->setOpenedFileCounter(
         requestGroupMan_->getOpenedFileCounter());
+#ifdef ENABLE_THREADS
+    if (requestGroupMan_->getWriteThreadPool()) {
+      tempPieceStorage->getDiskAdaptor()->enableAsyncWrite(
+          requestGroupMan_->getWriteThreadPool());
+    }
+#endif // ENABLE_THREADS
   }
   segmentMan_ =
       std::make_shared<SegmentMan>(downloadContext_, tempPieceStorage);
@@ -1002,6 +1014,10 @@ void RequestGroup::setHaltRequested(bool f, HaltReason haltReason)
   if (haltRequested_) {
     pauseRequested_ = false;
     haltReason_ = haltReason;
+    if (requestGroupMan_) {
+      // Commands of this download may be waiting for I/O events.
+      requestGroupMan_->requestRefresh();
+    }
   }
 #ifdef ENABLE_BITTORRENT
   if (btRuntime_) {
@@ -1016,7 +1032,11 @@ void RequestGroup::setForceHaltRequested(bool f, HaltReason haltReason)
   forceHaltRequested_ = f;
 }
 
-void RequestGroup::setPauseRequested(bool f) { pauseRequested_ = f; }
+void RequestGroup::setPauseRequested(bool f)
+{
+  pauseRequested_ = f;
+  updateStatusVersion();
+}
 
 void RequestGroup::setRestartRequested(bool f) { restartRequested_ = f; }
 
@@ -1029,6 +1049,10 @@ void RequestGroup::releaseRuntimeResource(DownloadEngine* e)
 #endif // ENABLE_BITTORRENT
   if (pieceStorage_) {
     pieceStorage_->removeAdvertisedPiece(Timer::zero());
+    auto rdDiskCache = pieceStorage_->getRdDiskCache();
+    if (rdDiskCache) {
+      rdDiskCache->remove(gid_->getNumericId());
+    }
   }
   // Don't reset segmentMan_ and pieceStorage_ here to provide
   // progress information via RPC
@@ -1277,14 +1301,25 @@ void RequestGroup::setTimeout(std::chrono::seconds timeout)
 
 bool RequestGroup::doesDownloadSpeedExceed()
 {
-  int spd = downloadContext_->getNetStat().calculateDownloadSpeed();
-  return maxDownloadSpeedLimit_ > 0 && maxDownloadSpeedLimit_ < spd;
+  return downloadBucket_.available(global::wallclock()) == 0;
 }
 
 bool RequestGroup::doesUploadSpeedExceed()
 {
-  int spd = downloadContext_->getNetStat().calculateUploadSpeed();
-  return maxUploadSpeedLimit_ > 0 && maxUploadSpeedLimit_ < spd;
+  return uploadBucket_.available(global::wallclock()) == 0;
+}
+
+void RequestGroup::setRequestGroupMan(RequestGroupMan* requestGroupMan)
+{
+  requestGroupMan_ = requestGroupMan;
+  if (requestGroupMan_) {
+    downloadBucket_.setParent(&requestGroupMan_->getDownloadBucket());
+    uploadBucket_.setParent(&requestGroupMan_->getUploadBucket());
+  }
+  else {
+    downloadBucket_.setParent(nullptr);
+    uploadBucket_.setParent(nullptr);
+  }
 }
 
 void RequestGroup::saveControlFile() const
@@ -49,6 +49,7 @@
 #include "error_code.h"
 #include "MetadataInfo.h"
 #include "GroupId.h"
+#include "TokenBucket.h"
 
 namespace aria2 {
 
@@ -157,9 +158,18 @@ private:
 
   int fileNotFoundCount_;
 
-  int maxDownloadSpeedLimit_;
+  // Updated whenever the status reported by aria2.tellStatus changes
+  // other than by transfer, connections or verification, or this
+  // download is added to or removed from RequestGroupMan.
+  uint64_t statusVersion_;
 
-  int maxUploadSpeedLimit_;
+  // The last value given to statusVersion_ of any RequestGroup.
+  static uint64_t lastStatusVersion_;
+
+  // Their parents are the buckets of requestGroupMan_.
+  TokenBucket downloadBucket_;
+
+  TokenBucket uploadBucket_;
 
   int resumeFailureCount_;
 
@@ -426,23 +436,27 @@ public:
 
   const std::chrono::seconds& getTimeout() const { return timeout_; }
 
-  // Returns true if current download speed exceeds
-  // maxDownloadSpeedLimit_.  Always returns false if
-  // maxDownloadSpeedLimit_ == 0.  Otherwise returns false.
+  // Returns true if the download limit of this group or the overall
+  // download limit does not permit to receive any data now.
   bool doesDownloadSpeedExceed();
 
-  // Returns true if current upload speed exceeds
-  // maxUploadSpeedLimit_. Always returns false if
-  // maxUploadSpeedLimit_ == 0. Otherwise returns false.
+  // Returns true if the upload limit of this group or the overall
+  // upload limit does not permit to send any data now.
   bool doesUploadSpeedExceed();
 
-  int getMaxDownloadSpeedLimit() const { return maxDownloadSpeedLimit_; }
+  int getMaxDownloadSpeedLimit() const { return downloadBucket_.getRate(); }
+
+  void setMaxDownloadSpeedLimit(int speed) { downloadBucket_.setRate(speed); }
+
+  int getMaxUploadSpeedLimit() const { return uploadBucket_.getRate(); }
 
-  void setMaxDownloadSpeedLimit(int speed) { maxDownloadSpeedLimit_ = speed; }
+  void setMaxUploadSpeedLimit(int speed) { uploadBucket_.setRate(speed); }
 
-  int getMaxUploadSpeedLimit() const { return maxUploadSpeedLimit_; }
+  // Data received or sent by this group are accounted to these
+  // buckets, which also take the overall limits into account.
+  TokenBucket& getDownloadBucket() { return downloadBucket_; }
 
-  void setMaxUploadSpeedLimit(int speed) { maxUploadSpeedLimit_ = speed; }
+  TokenBucket& getUploadBucket() { return uploadBucket_; }
 
   void setLastErrorCode(error_code::Value code, const char* message = "")
   {
@@ -467,22 +481,28 @@ public:
     for (; groupFirst != groupLast; ++groupFirst) {
       followedByGIDs_.push_back((*groupFirst)->getGID());
     }
+    updateStatusVersion();
   }
 
   const std::vector<a2_gid_t>& followedBy() const { return followedByGIDs_; }
 
-  void following(a2_gid_t gid) { followingGID_ = gid; }
+  void following(a2_gid_t gid)
+  {
+    followingGID_ = gid;
+    updateStatusVersion();
+  }
 
   a2_gid_t following() const { return followingGID_; }
 
-  void belongsTo(a2_gid_t gid) { belongsToGID_ = gid; }
+  void belongsTo(a2_gid_t gid)
+  {
+    belongsToGID_ = gid;
+    updateStatusVersion();
+  }
 
   a2_gid_t belongsTo() const { return belongsToGID_; }
 
-  void setRequestGroupMan(RequestGroupMan* requestGroupMan)
-  {
-    requestGroupMan_ = requestGroupMan;
-  }
+  void setRequestGroupMan(RequestGroupMan* requestGroupMan);
 
   RequestGroupMan* getRequestGroupMan() { return requestGroupMan_; }
 
@@ -504,7 +524,21 @@ public:
 
   int getState() const { return state_; }
 
-  void setState(int state) { state_ = state; }
+  void setState(int state)
+  {
+    state_ = state;
+    updateStatusVersion();
+  }
+
+  // Call this function when the options or the files of this download
+  // are changed.
+  void updateStatusVersion() { statusVersion_ = ++lastStatusVersion_; }
+
+  uint64_t getStatusVersion() const { return statusVersion_; }
+
+  // Returns the last status version given to any RequestGroup.  If
+  // this is unchanged, so is the status version of every download.
+  static uint64_t getLastStatusVersion() { return lastStatusVersion_; }
 
   bool isSeedOnlyEnabled() { return seedOnly_; }
 
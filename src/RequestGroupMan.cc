@@ -78,11 +78,15 @@
 #include "Notifier.h"
 #include "PeerStat.h"
 #include "WrDiskCache.h"
+#include "RdDiskCache.h"
 #include "PieceStorage.h"
 #include "DiskAdaptor.h"
 #include "SimpleRandomizer.h"
 #include "array_fun.h"
 #include "OpenedFileCounter.h"
+#ifdef ENABLE_THREADS
+#  include "ThreadPool.h"
+#endif // ENABLE_THREADS
 #include "wallclock.h"
 #include "RpcMethodImpl.h"
 #ifdef ENABLE_BITTORRENT
@@ -113,12 +117,11 @@ RequestGroupMan::RequestGroupMan(
       numActive_(0),
       option_(option),
       serverStatMan_(std::make_shared<ServerStatMan>()),
-      maxOverallDownloadSpeedLimit_(
-          option->getAsInt(PREF_MAX_OVERALL_DOWNLOAD_LIMIT)),
-      maxOverallUploadSpeedLimit_(
-          option->getAsInt(PREF_MAX_OVERALL_UPLOAD_LIMIT)),
+      downloadBucket_(option->getAsInt(PREF_MAX_OVERALL_DOWNLOAD_LIMIT)),
+      uploadBucket_(option->getAsInt(PREF_MAX_OVERALL_UPLOAD_LIMIT)),
       keepRunning_(option->getAsBool(PREF_ENABLE_RPC)),
       queueCheck_(true),
+      refresh_(false),
       removedErrorResult_(0),
       removedLastErrorResult_(error_code::FINISHED),
       maxDownloadResult_(option->getAsInt(PREF_MAX_DOWNLOAD_RESULT)),
@@ -162,6 +165,7 @@ void RequestGroupMan::addRequestGroup(
     const std::shared_ptr<RequestGroup>& group)
 {
   ++numActive_;
+  group->updateStatusVersion();
   requestGroups_.push_back(group->getGID(), group);
 }
 
@@ -169,6 +173,9 @@ void RequestGroupMan::addReservedGroup(
     const std::vector<std::shared_ptr<RequestGroup>>& groups)
 {
   requestQueueCheck();
+  for (auto& group : groups) {
+    group->updateStatusVersion();
+  }
   appendReservedGroup(reservedGroups_, groups.begin(), groups.end());
 }
 
@@ -176,6 +183,7 @@ void RequestGroupMan::addReservedGroup(
     const std::shared_ptr<RequestGroup>& group)
 {
   requestQueueCheck();
+  group->updateStatusVersion();
   reservedGroups_.push_back(group->getGID(), group);
 }
 
@@ -193,6 +201,9 @@ void RequestGroupMan::insertReservedGroup(
 {
   requestQueueCheck();
   pos = std::min(reservedGroups_.size(), pos);
+  for (auto& group : groups) {
+    group->updateStatusVersion();
+  }
   reservedGroups_.insert(pos, RequestGroupKeyFunc(), groups.begin(),
                          groups.end());
 }
@@ -202,6 +213,7 @@ void RequestGroupMan::insertReservedGroup(
 {
   requestQueueCheck();
   pos = std::min(reservedGroups_.size(), pos);
+  group->updateStatusVersion();
   reservedGroups_.insert(pos, group->getGID(), group);
 }
 
@@ -234,6 +246,11 @@ size_t RequestGroupMan::changeReservedGroupPosition(a2_gid_t gid, int pos,
 
 bool RequestGroupMan::removeReservedGroup(a2_gid_t gid)
 {
+  auto group = reservedGroups_.get(gid);
+  if (!group) {
+    return false;
+  }
+  group->updateStatusVersion();
   return reservedGroups_.remove(gid);
 }
 
@@ -458,6 +475,7 @@ public:
         e_->getRequestGroupMan()->addDownloadResult(dr);
         executeStopHook(group, e_->getOption(), dr->result);
         group->releaseRuntimeResource(e_);
+        group->updateStatusVersion();
       }
 
       group->setRestartRequested(false);
@@ -480,6 +498,10 @@ void RequestGroupMan::removeStoppedGroup(DownloadEngine* e)
   if (numRemoved > 0) {
     A2_LOG_DEBUG(fmt("%lu RequestGroup(s) deleted.",
                      static_cast<unsigned long>(numRemoved)));
+    if (downloadFinished()) {
+      // Let the Commands which run until all downloads finish exit.
+      requestRefresh();
+    }
   }
 }
 
@@ -909,8 +931,29 @@ RequestGroupMan::findDownloadResult(a2_gid_t gid) const
   return downloadResults_.get(gid);
 }
 
+size_t RequestGroupMan::findDownloadResultPosition(uint64_t seq) const
+{
+  // downloadResults_ is sorted by seq.
+  size_t first = 0, last = downloadResults_.size();
+  while (first < last) {
+    size_t mid = first + (last - first) / 2;
+    if (downloadResults_[mid]->seq < seq) {
+      first = mid + 1;
+    }
+    else {
+      last = mid;
+    }
+  }
+  return first;
+}
+
 bool RequestGroupMan::removeDownloadResult(a2_gid_t gid)
 {
+  auto dr = downloadResults_.get(gid);
+  if (!dr) {
+    return false;
+  }
+  downloadResultIndex_.remove(*dr);
   return downloadResults_.remove(gid);
 }
 
@@ -918,8 +961,12 @@ void RequestGroupMan::addDownloadResult(
     const std::shared_ptr<DownloadResult>& dr)
 {
   ++numStoppedTotal_;
+  dr->seq = numStoppedTotal_;
   bool rv = downloadResults_.push_back(dr->gid->getNumericId(), dr);
   assert(rv);
+  if (rv) {
+    downloadResultIndex_.add(*dr);
+  }
   while (downloadResults_.size() > maxDownloadResult_) {
     // Save last encountered error code so that we can report it
     // later.
@@ -937,11 +984,16 @@ void RequestGroupMan::addDownloadResult(
         }
       }
     }
+    downloadResultIndex_.remove(*dr);
     downloadResults_.pop_front();
   }
 }
 
-void RequestGroupMan::purgeDownloadResult() { downloadResults_.clear(); }
+void RequestGroupMan::purgeDownloadResult()
+{
+  downloadResults_.clear();
+  downloadResultIndex_.clear();
+}
 
 std::shared_ptr<ServerStat>
 RequestGroupMan::findServerStat(const std::string& hostname,
@@ -985,14 +1037,12 @@ void RequestGroupMan::removeStaleServerStat(const std::chrono::seconds& timeout)
 
 bool RequestGroupMan::doesOverallDownloadSpeedExceed()
 {
-  return maxOverallDownloadSpeedLimit_ > 0 &&
-         maxOverallDownloadSpeedLimit_ < netStat_.calculateDownloadSpeed();
+  return downloadBucket_.available(global::wallclock()) == 0;
 }
 
 bool RequestGroupMan::doesOverallUploadSpeedExceed()
 {
-  return maxOverallUploadSpeedLimit_ > 0 &&
-         maxOverallUploadSpeedLimit_ < netStat_.calculateUploadSpeed();
+  return uploadBucket_.available(global::wallclock()) == 0;
 }
 
 void RequestGroupMan::getUsedHosts(
@@ -1054,6 +1104,26 @@ void RequestGroupMan::initWrDiskCache()
   }
 }
 
+void RequestGroupMan::initRdDiskCache()
+{
+  assert(!rdDiskCache_);
+  size_t limit = option_->getAsInt(PREF_DISK_READ_CACHE);
+  if (limit > 0) {
+    rdDiskCache_ = make_unique<RdDiskCache>(limit, wrDiskCache_.get());
+  }
+}
+
+#ifdef ENABLE_THREADS
+void RequestGroupMan::initWriteThreadPool()
+{
+  assert(!writeThreadPool_);
+  if (option_->getAsBool(PREF_ASYNC_DISK_WRITE)) {
+    // Use one thread so that writes to a file are done in order.
+    writeThreadPool_ = std::make_shared<ThreadPool>(1);
+  }
+}
+#endif // ENABLE_THREADS
+
 void RequestGroupMan::decreaseNumActive()
 {
   assert(numActive_ > 0);
@@ -1090,9 +1160,9 @@ int RequestGroupMan::optimizeConcurrentDownloads()
   }
 
   // apply the rule
-  if ((maxOverallDownloadSpeedLimit_ > 0) &&
-      (optimizationSpeed_ > maxOverallDownloadSpeedLimit_)) {
-    optimizationSpeed_ = maxOverallDownloadSpeedLimit_;
+  if ((downloadBucket_.getRate() > 0) &&
+      (optimizationSpeed_ > downloadBucket_.getRate())) {
+    optimizationSpeed_ = downloadBucket_.getRate();
   }
   int maxConcurrentDownloads =
       ceil(optimizeConcurrentDownloadsCoeffA_ +
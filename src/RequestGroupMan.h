@@ -47,6 +47,8 @@
 #include "TransferStat.h"
 #include "RequestGroup.h"
 #include "NetStat.h"
+#include "DownloadResultIndex.h"
+#include "TokenBucket.h"
 #include "IndexedList.h"
 
 namespace aria2 {
@@ -60,6 +62,10 @@ class Option;
 class OutputFile;
 class UriListParser;
 class WrDiskCache;
+class RdDiskCache;
+#ifdef ENABLE_THREADS
+class ThreadPool;
+#endif // ENABLE_THREADS
 class OpenedFileCounter;
 
 typedef IndexedList<a2_gid_t, std::shared_ptr<RequestGroup>> RequestGroupList;
@@ -71,6 +77,7 @@ private:
   RequestGroupList requestGroups_;
   RequestGroupList reservedGroups_;
   DownloadResultList downloadResults_;
+  DownloadResultIndex downloadResultIndex_;
   // This includes download result which did not finish, and deleted
   // from downloadResults_.  This is used to save them in
   // SessionSerializer.
@@ -95,9 +102,10 @@ private:
 
   std::shared_ptr<ServerStatMan> serverStatMan_;
 
-  int maxOverallDownloadSpeedLimit_;
+  // Parents of the download and upload buckets of RequestGroups.
+  TokenBucket downloadBucket_;
 
-  int maxOverallUploadSpeedLimit_;
+  TokenBucket uploadBucket_;
 
   NetStat netStat_;
 
@@ -107,6 +115,8 @@ private:
 
   bool queueCheck_;
 
+  bool refresh_;
+
   // The number of error DownloadResult removed because of upper limit
   // of the queue
   int removedErrorResult_;
@@ -121,8 +131,15 @@ private:
 
   std::unique_ptr<WrDiskCache> wrDiskCache_;
 
+  std::unique_ptr<RdDiskCache> rdDiskCache_;
+
   std::shared_ptr<OpenedFileCounter> openedFileCounter_;
 
+#ifdef ENABLE_THREADS
+  // The worker thread which writes downloaded data to disk.
+  std::shared_ptr<ThreadPool> writeThreadPool_;
+#endif // ENABLE_THREADS
+
   // The number of stopped downloads so far in total, including
   // evicted DownloadResults.
   size_t numStoppedTotal_;
@@ -256,6 +273,15 @@ public:
 
   std::shared_ptr<DownloadResult> findDownloadResult(a2_gid_t gid) const;
 
+  const DownloadResultIndex& getDownloadResultIndex() const
+  {
+    return downloadResultIndex_;
+  }
+
+  // Returns the position in getDownloadResults() of the first result
+  // whose seq is not less than |seq|.  Complexity: O(logN)
+  size_t findDownloadResultPosition(uint64_t seq) const;
+
   // Removes all download results.
   void purgeDownloadResult();
 
@@ -286,35 +312,34 @@ public:
 
   void removeStaleServerStat(const std::chrono::seconds& timeout);
 
-  // Returns true if current download speed exceeds
-  // maxOverallDownloadSpeedLimit_.  Always returns false if
-  // maxOverallDownloadSpeedLimit_ == 0.  Otherwise returns false.
+  // Returns true if the overall download limit does not permit to
+  // receive any data now.  Always returns false if the limit is 0.
   bool doesOverallDownloadSpeedExceed();
 
   void setMaxOverallDownloadSpeedLimit(int speed)
   {
-    maxOverallDownloadSpeedLimit_ = speed;
+    downloadBucket_.setRate(speed);
   }
 
   int getMaxOverallDownloadSpeedLimit() const
   {
-    return maxOverallDownloadSpeedLimit_;
+    return downloadBucket_.getRate();
   }
 
-  // Returns true if current upload speed exceeds
-  // maxOverallUploadSpeedLimit_. Always returns false if
-  // maxOverallUploadSpeedLimit_ == 0. Otherwise returns false.
+  // Returns true if the overall upload limit does not permit to send
+  // any data now.  Always returns false if the limit is 0.
   bool doesOverallUploadSpeedExceed();
 
   void setMaxOverallUploadSpeedLimit(int speed)
   {
-    maxOverallUploadSpeedLimit_ = speed;
+    uploadBucket_.setRate(speed);
   }
 
-  int getMaxOverallUploadSpeedLimit() const
-  {
-    return maxOverallUploadSpeedLimit_;
-  }
+  int getMaxOverallUploadSpeedLimit() const { return uploadBucket_.getRate(); }
+
+  TokenBucket& getDownloadBucket() { return downloadBucket_; }
+
+  TokenBucket& getUploadBucket() { return uploadBucket_; }
 
   void setMaxConcurrentDownloads(int max) { maxConcurrentDownloads_ = max; }
 
@@ -327,6 +352,14 @@ public:
 
   bool queueCheckRequested() const { return queueCheck_; }
 
+  // Call this function to let DownloadEngine execute all Commands,
+  // including parked ones, in the next iteration.
+  void requestRefresh() { refresh_ = true; }
+
+  void clearRefresh() { refresh_ = false; }
+
+  bool refreshRequested() const { return refresh_; }
+
   // Returns currently used hosts and its use count.
   void getUsedHosts(std::vector<std::pair<size_t, std::string>>& usedHosts);
 
@@ -347,6 +380,24 @@ public:
   // its value is 0, cache storage will not be initialized.
   void initWrDiskCache();
 
+  RdDiskCache* getRdDiskCache() const { return rdDiskCache_.get(); }
+
+  // Initializes RdDiskCache according to PREF_DISK_READ_CACHE
+  // option.  If its value is 0, cache storage will not be
+  // initialized.  Call this function after initWrDiskCache().
+  void initRdDiskCache();
+
+#ifdef ENABLE_THREADS
+  // Starts the worker thread for disk writes if PREF_ASYNC_DISK_WRITE
+  // is true.
+  void initWriteThreadPool();
+
+  const std::shared_ptr<ThreadPool>& getWriteThreadPool() const
+  {
+    return writeThreadPool_;
+  }
+#endif // ENABLE_THREADS
+
   void setKeepRunning(bool flag) { keepRunning_ = flag; }
 
   bool getKeepRunning() const { return keepRunning_; }
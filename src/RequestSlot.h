@@ -39,10 +39,11 @@
 #include "TimerA2.h"
 #include "Piece.h"
 #include "wallclock.h"
+#include "FreeListAllocated.h"
 
 namespace aria2 {
 
-class RequestSlot {
+class RequestSlot : public FreeListAllocated<RequestSlot> {
 public:
   RequestSlot(size_t index, int32_t begin, int32_t length, size_t blockIndex,
               std::shared_ptr<Piece> piece = nullptr)
@@ -104,6 +104,11 @@ RpcResponse RpcMethod::execute(RpcRequest req, DownloadEngine* e)
   }
 }
 
+RpcResponse RpcMethod::executeJson(RpcRequest req, DownloadEngine* e)
+{
+  return execute(std::move(req), e);
+}
+
 namespace {
 template <typename InputIterator, typename Pred>
 void gatherOption(InputIterator first, InputIterator last, Pred pred,
@@ -101,6 +101,13 @@ public:
   // Do work to fulfill RpcRequest req and returns its result as
   // RpcResponse. This method delegates to process() method.
   virtual RpcResponse execute(RpcRequest req, DownloadEngine* e);
+
+  // Same as execute(), but the result may be returned in
+  // RpcResponse::json, already encoded in JSON, instead of
+  // RpcResponse::param.  Use this only if the response is passed to
+  // toJson() or toJsonBatch().  The default implementation calls
+  // execute().
+  virtual RpcResponse executeJson(RpcRequest req, DownloadEngine* e);
 };
 
 } // namespace rpc
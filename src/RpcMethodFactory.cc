@@ -75,6 +75,7 @@ std::vector<std::string> rpcMethodNames = {
     "aria2.tellActive",
     "aria2.tellWaiting",
     "aria2.tellStopped",
+    "aria2.queryDownloads",
     "aria2.getOption",
     "aria2.changeUri",
     "aria2.changeOption",
@@ -88,6 +89,8 @@ std::vector<std::string> rpcMethodNames = {
     "aria2.forceShutdown",
     "aria2.getGlobalStat",
     "aria2.saveSession",
+    "aria2.subscribeStatus",
+    "aria2.unsubscribeStatus",
     "system.multicall",
     "system.listMethods",
     "system.listNotifications",
@@ -104,6 +107,7 @@ std::vector<std::string> rpcNotificationsNames = {
 #ifdef ENABLE_BITTORRENT
     "aria2.onBtDownloadComplete",
 #endif // ENABLE_BITTORRENT
+    "aria2.onStatusChange",
 };
 } // namespace
 
@@ -199,6 +203,10 @@ std::unique_ptr<RpcMethod> createMethod(const std::string& methodName)
     return make_unique<TellStoppedRpcMethod>();
   }
 
+  if (methodName == QueryDownloadsRpcMethod::getMethodName()) {
+    return make_unique<QueryDownloadsRpcMethod>();
+  }
+
   if (methodName == GetOptionRpcMethod::getMethodName()) {
     return make_unique<GetOptionRpcMethod>();
   }
@@ -251,6 +259,14 @@ std::unique_ptr<RpcMethod> createMethod(const std::string& methodName)
     return make_unique<SaveSessionRpcMethod>();
   }
 
+  if (methodName == SubscribeStatusRpcMethod::getMethodName()) {
+    return make_unique<SubscribeStatusRpcMethod>();
+  }
+
+  if (methodName == UnsubscribeStatusRpcMethod::getMethodName()) {
+    return make_unique<UnsubscribeStatusRpcMethod>();
+  }
+
   if (methodName == SystemMulticallRpcMethod::getMethodName()) {
     return make_unique<SystemMulticallRpcMethod>();
   }
@@ -36,6 +36,7 @@
 
 #include <cassert>
 #include <algorithm>
+#include <limits>
 #include <sstream>
 
 #include "Logger.h"
@@ -69,6 +70,9 @@
 #include "MessageDigest.h"
 #include "message_digest_helper.h"
 #include "OpenedFileCounter.h"
+#include "StructWriter.h"
+#include "ValueBaseStructWriter.h"
+#include "JsonStructWriter.h"
 #ifdef ENABLE_BITTORRENT
 #  include "bittorrent_helper.h"
 #  include "BtRegistry.h"
@@ -76,8 +80,13 @@
 #  include "Peer.h"
 #  include "BtRuntime.h"
 #  include "BtAnnounce.h"
+#  include "DHTRegistry.h"
 #endif // ENABLE_BITTORRENT
 #include "CheckIntegrityEntry.h"
+#ifdef ENABLE_WEBSOCKET
+#  include "WebSocketSession.h"
+#  include "StatusSubscription.h"
+#endif // ENABLE_WEBSOCKET
 
 namespace aria2 {
 
@@ -145,6 +154,9 @@ const char KEY_NUM_WAITING[] = "numWaiting";
 const char KEY_NUM_STOPPED[] = "numStopped";
 const char KEY_NUM_ACTIVE[] = "numActive";
 const char KEY_NUM_STOPPED_TOTAL[] = "numStoppedTotal";
+const char KEY_NUM_DHT_ANNOUNCE_INFO_HASHES[] = "numDhtAnnounceInfoHashes";
+const char KEY_NUM_DHT_ANNOUNCE_PEERS[] = "numDhtAnnouncePeers";
+const char KEY_DHT_ANNOUNCE_MEMORY[] = "dhtAnnounceMemory";
 const char KEY_VERIFIED_LENGTH[] = "verifiedLength";
 const char KEY_VERIFY_PENDING[] = "verifyIntegrityPending";
 } // namespace
@@ -533,76 +545,84 @@ std::unique_ptr<ValueBase> UnpauseAllRpcMethod::process(const RpcRequest& req,
 
 namespace {
 template <typename InputIterator>
-void createUriEntry(List* uriList, InputIterator first, InputIterator last,
-                    const std::string& status)
+void createUriEntry(StructWriter& writer, InputIterator first,
+                    InputIterator last, const std::string& status)
 {
   for (; first != last; ++first) {
-    auto entry = Dict::g();
-    entry->put(KEY_URI, *first);
-    entry->put(KEY_STATUS, status);
-    uriList->append(std::move(entry));
+    writer.beginDict();
+    writer.put(KEY_URI, *first);
+    writer.put(KEY_STATUS, status);
+    writer.endDict();
   }
 }
 } // namespace
 
 namespace {
-void createUriEntry(List* uriList, const std::shared_ptr<FileEntry>& file)
+// Writes the URIs of file as the elements of the current list of
+// writer.
+void createUriEntry(StructWriter& writer,
+                    const std::shared_ptr<FileEntry>& file)
 {
-  createUriEntry(uriList, std::begin(file->getSpentUris()),
+  createUriEntry(writer, std::begin(file->getSpentUris()),
                  std::end(file->getSpentUris()), VLB_USED);
-  createUriEntry(uriList, std::begin(file->getRemainingUris()),
+  createUriEntry(writer, std::begin(file->getRemainingUris()),
                  std::end(file->getRemainingUris()), VLB_WAITING);
 }
 } // namespace
 
 namespace {
+// Writes files in [first, last) as a list.
 template <typename InputIterator>
-void createFileEntry(List* files, InputIterator first, InputIterator last,
-                     const BitfieldMan* bf)
+void createFileEntry(StructWriter& writer, InputIterator first,
+                     InputIterator last, const BitfieldMan* bf)
 {
+  writer.beginList();
   size_t index = 1;
   for (; first != last; ++first, ++index) {
-    auto entry = Dict::g();
-    entry->put(KEY_INDEX, util::uitos(index));
-    entry->put(KEY_PATH, (*first)->getPath());
-    entry->put(KEY_SELECTED, (*first)->isRequested() ? VLB_TRUE : VLB_FALSE);
-    entry->put(KEY_LENGTH, util::itos((*first)->getLength()));
+    writer.beginDict();
+    writer.put(KEY_INDEX, util::uitos(index));
+    writer.put(KEY_PATH, (*first)->getPath());
+    writer.put(KEY_SELECTED, (*first)->isRequested() ? VLB_TRUE : VLB_FALSE);
+    writer.put(KEY_LENGTH, util::itos((*first)->getLength()));
     int64_t completedLength = bf->getOffsetCompletedLength(
         (*first)->getOffset(), (*first)->getLength());
-    entry->put(KEY_COMPLETED_LENGTH, util::itos(completedLength));
+    writer.put(KEY_COMPLETED_LENGTH, util::itos(completedLength));
 
-    auto uriList = List::g();
-    createUriEntry(uriList.get(), *first);
-    entry->put(KEY_URIS, std::move(uriList));
-    files->append(std::move(entry));
+    writer.key(KEY_URIS);
+    writer.beginList();
+    createUriEntry(writer, *first);
+    writer.endList();
+    writer.endDict();
   }
+  writer.endList();
 }
 } // namespace
 
 namespace {
 template <typename InputIterator>
-void createFileEntry(List* files, InputIterator first, InputIterator last,
-                     int64_t totalLength, int32_t pieceLength,
-                     const std::string& bitfield)
+void createFileEntry(StructWriter& writer, InputIterator first,
+                     InputIterator last, int64_t totalLength,
+                     int32_t pieceLength, const std::string& bitfield)
 {
   BitfieldMan bf(pieceLength, totalLength);
   bf.setBitfield(reinterpret_cast<const unsigned char*>(bitfield.data()),
                  bitfield.size());
-  createFileEntry(files, first, last, &bf);
+  createFileEntry(writer, first, last, &bf);
 }
 } // namespace
 
 namespace {
 template <typename InputIterator>
-void createFileEntry(List* files, InputIterator first, InputIterator last,
-                     int64_t totalLength, int32_t pieceLength,
+void createFileEntry(StructWriter& writer, InputIterator first,
+                     InputIterator last, int64_t totalLength,
+                     int32_t pieceLength,
                      const std::shared_ptr<PieceStorage>& ps)
 {
   BitfieldMan bf(pieceLength, totalLength);
   if (ps) {
     bf.setBitfield(ps->getBitfield(), ps->getBitfieldLength());
   }
-  createFileEntry(files, first, last, &bf);
+  createFileEntry(writer, first, last, &bf);
 }
 } // namespace
 
@@ -613,140 +633,158 @@ bool requested_key(const std::vector<std::string>& keys, const std::string& k)
 }
 } // namespace
 
-void gatherProgressCommon(Dict* entryDict,
+void gatherProgressCommon(StructWriter& writer,
                           const std::shared_ptr<RequestGroup>& group,
                           const std::vector<std::string>& keys)
 {
   auto& ps = group->getPieceStorage();
   if (requested_key(keys, KEY_GID)) {
-    entryDict->put(KEY_GID, GroupId::toHex(group->getGID()).c_str());
+    writer.put(KEY_GID, GroupId::toHex(group->getGID()).c_str());
   }
   if (requested_key(keys, KEY_TOTAL_LENGTH)) {
     // This is "filtered" total length if --select-file is used.
-    entryDict->put(KEY_TOTAL_LENGTH, util::itos(group->getTotalLength()));
+    writer.put(KEY_TOTAL_LENGTH, util::itos(group->getTotalLength()));
   }
   if (requested_key(keys, KEY_COMPLETED_LENGTH)) {
     // This is "filtered" total length if --select-file is used.
-    entryDict->put(KEY_COMPLETED_LENGTH,
-                   util::itos(group->getCompletedLength()));
+    writer.put(KEY_COMPLETED_LENGTH, util::itos(group->getCompletedLength()));
   }
   TransferStat stat = group->calculateStat();
   if (requested_key(keys, KEY_DOWNLOAD_SPEED)) {
-    entryDict->put(KEY_DOWNLOAD_SPEED, util::itos(stat.downloadSpeed));
+    writer.put(KEY_DOWNLOAD_SPEED, util::itos(stat.downloadSpeed));
   }
   if (requested_key(keys, KEY_UPLOAD_SPEED)) {
-    entryDict->put(KEY_UPLOAD_SPEED, util::itos(stat.uploadSpeed));
+    writer.put(KEY_UPLOAD_SPEED, util::itos(stat.uploadSpeed));
   }
   if (requested_key(keys, KEY_UPLOAD_LENGTH)) {
-    entryDict->put(KEY_UPLOAD_LENGTH, util::itos(stat.allTimeUploadLength));
+    writer.put(KEY_UPLOAD_LENGTH, util::itos(stat.allTimeUploadLength));
   }
   if (requested_key(keys, KEY_CONNECTIONS)) {
-    entryDict->put(KEY_CONNECTIONS, util::itos(group->getNumConnection()));
+    writer.put(KEY_CONNECTIONS, util::itos(group->getNumConnection()));
   }
   if (requested_key(keys, KEY_BITFIELD)) {
     if (ps) {
       if (ps->getBitfieldLength() > 0) {
-        entryDict->put(KEY_BITFIELD,
-                       util::toHex(ps->getBitfield(), ps->getBitfieldLength()));
+        writer.put(KEY_BITFIELD,
+                   util::toHex(ps->getBitfield(), ps->getBitfieldLength()));
       }
     }
   }
   auto& dctx = group->getDownloadContext();
   if (requested_key(keys, KEY_PIECE_LENGTH)) {
-    entryDict->put(KEY_PIECE_LENGTH, util::itos(dctx->getPieceLength()));
+    writer.put(KEY_PIECE_LENGTH, util::itos(dctx->getPieceLength()));
   }
   if (requested_key(keys, KEY_NUM_PIECES)) {
-    entryDict->put(KEY_NUM_PIECES, util::uitos(dctx->getNumPieces()));
+    writer.put(KEY_NUM_PIECES, util::uitos(dctx->getNumPieces()));
   }
   if (requested_key(keys, KEY_FOLLOWED_BY)) {
     if (!group->followedBy().empty()) {
-      auto list = List::g();
+      writer.key(KEY_FOLLOWED_BY);
+      writer.beginList();
       // The element is GID.
       for (auto& gid : group->followedBy()) {
-        list->append(GroupId::toHex(gid));
+        writer.value(GroupId::toHex(gid));
       }
-      entryDict->put(KEY_FOLLOWED_BY, std::move(list));
+      writer.endList();
     }
   }
   if (requested_key(keys, KEY_FOLLOWING)) {
     if (group->following()) {
-      entryDict->put(KEY_FOLLOWING, GroupId::toHex(group->following()));
+      writer.put(KEY_FOLLOWING, GroupId::toHex(group->following()));
     }
   }
   if (requested_key(keys, KEY_BELONGS_TO)) {
     if (group->belongsTo()) {
-      entryDict->put(KEY_BELONGS_TO, GroupId::toHex(group->belongsTo()));
+      writer.put(KEY_BELONGS_TO, GroupId::toHex(group->belongsTo()));
     }
   }
   if (requested_key(keys, KEY_FILES)) {
-    auto files = List::g();
-    createFileEntry(files.get(), std::begin(dctx->getFileEntries()),
+    writer.key(KEY_FILES);
+    createFileEntry(writer, std::begin(dctx->getFileEntries()),
                     std::end(dctx->getFileEntries()), dctx->getTotalLength(),
                     dctx->getPieceLength(), ps);
-    entryDict->put(KEY_FILES, std::move(files));
   }
   if (requested_key(keys, KEY_DIR)) {
-    entryDict->put(KEY_DIR, group->getOption()->get(PREF_DIR));
+    writer.put(KEY_DIR, group->getOption()->get(PREF_DIR));
   }
 }
 
+void gatherProgressCommon(Dict* entryDict,
+                          const std::shared_ptr<RequestGroup>& group,
+                          const std::vector<std::string>& keys)
+{
+  ValueBaseStructWriter writer(entryDict);
+  gatherProgressCommon(writer, group, keys);
+}
+
 #ifdef ENABLE_BITTORRENT
-void gatherBitTorrentMetadata(Dict* btDict, TorrentAttribute* torrentAttrs)
+void gatherBitTorrentMetadata(StructWriter& writer,
+                              TorrentAttribute* torrentAttrs)
 {
   if (!torrentAttrs->comment.empty()) {
-    btDict->put(KEY_COMMENT, torrentAttrs->comment);
+    writer.put(KEY_COMMENT, torrentAttrs->comment);
   }
   if (torrentAttrs->creationDate) {
-    btDict->put(KEY_CREATION_DATE, Integer::g(torrentAttrs->creationDate));
+    writer.put(KEY_CREATION_DATE,
+               static_cast<int64_t>(torrentAttrs->creationDate));
   }
   if (torrentAttrs->mode) {
-    btDict->put(KEY_MODE, bittorrent::getModeString(torrentAttrs->mode));
+    writer.put(KEY_MODE, bittorrent::getModeString(torrentAttrs->mode));
   }
-  auto destAnnounceList = List::g();
+  writer.key(KEY_ANNOUNCE_LIST);
+  writer.beginList();
   for (auto& annlist : torrentAttrs->announceList) {
-    auto destAnnounceTier = List::g();
+    writer.beginList();
     for (auto& ann : annlist) {
-      destAnnounceTier->append(ann);
+      writer.value(ann);
     }
-    destAnnounceList->append(std::move(destAnnounceTier));
+    writer.endList();
   }
-  btDict->put(KEY_ANNOUNCE_LIST, std::move(destAnnounceList));
+  writer.endList();
   if (!torrentAttrs->metadata.empty()) {
-    auto infoDict = Dict::g();
-    infoDict->put(KEY_NAME, torrentAttrs->name);
-    btDict->put(KEY_INFO, std::move(infoDict));
+    writer.key(KEY_INFO);
+    writer.beginDict();
+    writer.put(KEY_NAME, torrentAttrs->name);
+    writer.endDict();
   }
 }
 
+void gatherBitTorrentMetadata(Dict* btDict, TorrentAttribute* torrentAttrs)
+{
+  ValueBaseStructWriter writer(btDict);
+  gatherBitTorrentMetadata(writer, torrentAttrs);
+}
+
 namespace {
-void gatherProgressBitTorrent(Dict* entryDict,
+void gatherProgressBitTorrent(StructWriter& writer,
                               const std::shared_ptr<RequestGroup>& group,
                               TorrentAttribute* torrentAttrs,
                               BtObject* btObject,
                               const std::vector<std::string>& keys)
 {
   if (requested_key(keys, KEY_INFO_HASH)) {
-    entryDict->put(KEY_INFO_HASH, util::toHex(torrentAttrs->infoHash));
+    writer.put(KEY_INFO_HASH, util::toHex(torrentAttrs->infoHash));
   }
   if (requested_key(keys, KEY_BITTORRENT)) {
-    auto btDict = Dict::g();
-    gatherBitTorrentMetadata(btDict.get(), torrentAttrs);
-    entryDict->put(KEY_BITTORRENT, std::move(btDict));
+    writer.key(KEY_BITTORRENT);
+    writer.beginDict();
+    gatherBitTorrentMetadata(writer, torrentAttrs);
+    writer.endDict();
   }
   if (requested_key(keys, KEY_NUM_SEEDERS)) {
     if (!btObject) {
-      entryDict->put(KEY_NUM_SEEDERS, VLB_ZERO);
+      writer.put(KEY_NUM_SEEDERS, VLB_ZERO);
     }
     else {
       auto& peerStorage = btObject->peerStorage;
       assert(peerStorage);
       auto& peers = peerStorage->getUsedPeers();
-      entryDict->put(KEY_NUM_SEEDERS,
-                     util::uitos(countSeeder(peers.begin(), peers.end())));
+      writer.put(KEY_NUM_SEEDERS,
+                 util::uitos(countSeeder(peers.begin(), peers.end())));
     }
   }
   if (requested_key(keys, KEY_SEEDER)) {
-    entryDict->put(KEY_SEEDER, group->isSeeder() ? VLB_TRUE : VLB_FALSE);
+    writer.put(KEY_SEEDER, group->isSeeder() ? VLB_TRUE : VLB_FALSE);
   }
 }
 } // namespace
@@ -785,128 +823,148 @@ void gatherPeer(List* peers, const std::shared_ptr<PeerStorage>& ps)
 #endif // ENABLE_BITTORRENT
 
 namespace {
-void gatherProgress(Dict* entryDict, const std::shared_ptr<RequestGroup>& group,
+void gatherProgress(StructWriter& writer,
+                    const std::shared_ptr<RequestGroup>& group,
                     DownloadEngine* e, const std::vector<std::string>& keys)
 {
-  gatherProgressCommon(entryDict, group, keys);
+  gatherProgressCommon(writer, group, keys);
 #ifdef ENABLE_BITTORRENT
   if (group->getDownloadContext()->hasAttribute(CTX_ATTR_BT)) {
     gatherProgressBitTorrent(
-        entryDict, group,
+        writer, group,
         bittorrent::getTorrentAttrs(group->getDownloadContext()),
         e->getBtRegistry()->get(group->getGID()), keys);
   }
 #endif // ENABLE_BITTORRENT
   if (e->getCheckIntegrityMan()) {
-    if (e->getCheckIntegrityMan()->isPicked(
-            [&group](const CheckIntegrityEntry& ent) {
-              return ent.getRequestGroup() == group.get();
-            })) {
-      entryDict->put(
-          KEY_VERIFIED_LENGTH,
-          util::itos(
-              e->getCheckIntegrityMan()->getPickedEntry()->getCurrentLength()));
+    auto entry = e->getCheckIntegrityMan()->findPickedEntry(
+        [&group](const CheckIntegrityEntry& ent) {
+          return ent.getRequestGroup() == group.get();
+        });
+    if (entry) {
+      writer.put(KEY_VERIFIED_LENGTH, util::itos(entry->getCurrentLength()));
     }
     if (e->getCheckIntegrityMan()->isQueued(
             [&group](const CheckIntegrityEntry& ent) {
               return ent.getRequestGroup() == group.get();
             })) {
-      entryDict->put(KEY_VERIFY_PENDING, VLB_TRUE);
+      writer.put(KEY_VERIFY_PENDING, VLB_TRUE);
     }
   }
 }
 } // namespace
 
-void gatherStoppedDownload(Dict* entryDict,
+void gatherRequestGroupStatus(StructWriter& writer,
+                              const std::shared_ptr<RequestGroup>& group,
+                              DownloadEngine* e,
+                              const std::vector<std::string>& keys)
+{
+  if (requested_key(keys, KEY_STATUS)) {
+    if (group->getState() == RequestGroup::STATE_ACTIVE) {
+      writer.put(KEY_STATUS, VLB_ACTIVE);
+    }
+    else {
+      if (group->isPauseRequested()) {
+        writer.put(KEY_STATUS, VLB_PAUSED);
+      }
+      else {
+        writer.put(KEY_STATUS, VLB_WAITING);
+      }
+    }
+  }
+  gatherProgress(writer, group, e, keys);
+}
+
+void gatherStoppedDownload(StructWriter& writer,
                            const std::shared_ptr<DownloadResult>& ds,
                            const std::vector<std::string>& keys)
 {
   if (requested_key(keys, KEY_GID)) {
-    entryDict->put(KEY_GID, ds->gid->toHex());
+    writer.put(KEY_GID, ds->gid->toHex());
   }
   if (requested_key(keys, KEY_ERROR_CODE)) {
-    entryDict->put(KEY_ERROR_CODE, util::itos(static_cast<int>(ds->result)));
+    writer.put(KEY_ERROR_CODE, util::itos(static_cast<int>(ds->result)));
   }
   if (requested_key(keys, KEY_ERROR_MESSAGE)) {
-    entryDict->put(KEY_ERROR_MESSAGE, ds->resultMessage);
+    writer.put(KEY_ERROR_MESSAGE, ds->resultMessage);
   }
   if (requested_key(keys, KEY_STATUS)) {
     if (ds->result == error_code::REMOVED) {
-      entryDict->put(KEY_STATUS, VLB_REMOVED);
+      writer.put(KEY_STATUS, VLB_REMOVED);
     }
     else if (ds->result == error_code::FINISHED) {
-      entryDict->put(KEY_STATUS, VLB_COMPLETE);
+      writer.put(KEY_STATUS, VLB_COMPLETE);
     }
     else {
-      entryDict->put(KEY_STATUS, VLB_ERROR);
+      writer.put(KEY_STATUS, VLB_ERROR);
     }
   }
   if (requested_key(keys, KEY_FOLLOWED_BY)) {
     if (!ds->followedBy.empty()) {
-      auto list = List::g();
+      writer.key(KEY_FOLLOWED_BY);
+      writer.beginList();
       // The element is GID.
       for (auto gid : ds->followedBy) {
-        list->append(GroupId::toHex(gid));
+        writer.value(GroupId::toHex(gid));
       }
-      entryDict->put(KEY_FOLLOWED_BY, std::move(list));
+      writer.endList();
     }
   }
   if (requested_key(keys, KEY_FOLLOWING)) {
     if (ds->following) {
-      entryDict->put(KEY_FOLLOWING, GroupId::toHex(ds->following));
+      writer.put(KEY_FOLLOWING, GroupId::toHex(ds->following));
     }
   }
   if (requested_key(keys, KEY_BELONGS_TO)) {
     if (ds->belongsTo) {
-      entryDict->put(KEY_BELONGS_TO, GroupId::toHex(ds->belongsTo));
+      writer.put(KEY_BELONGS_TO, GroupId::toHex(ds->belongsTo));
     }
   }
   if (requested_key(keys, KEY_FILES)) {
-    auto files = List::g();
-    createFileEntry(files.get(), std::begin(ds->fileEntries),
+    writer.key(KEY_FILES);
+    createFileEntry(writer, std::begin(ds->fileEntries),
                     std::end(ds->fileEntries), ds->totalLength, ds->pieceLength,
                     ds->bitfield);
-    entryDict->put(KEY_FILES, std::move(files));
   }
   if (requested_key(keys, KEY_TOTAL_LENGTH)) {
-    entryDict->put(KEY_TOTAL_LENGTH, util::itos(ds->totalLength));
+    writer.put(KEY_TOTAL_LENGTH, util::itos(ds->totalLength));
   }
   if (requested_key(keys, KEY_COMPLETED_LENGTH)) {
-    entryDict->put(KEY_COMPLETED_LENGTH, util::itos(ds->completedLength));
+    writer.put(KEY_COMPLETED_LENGTH, util::itos(ds->completedLength));
   }
   if (requested_key(keys, KEY_UPLOAD_LENGTH)) {
-    entryDict->put(KEY_UPLOAD_LENGTH, util::itos(ds->uploadLength));
+    writer.put(KEY_UPLOAD_LENGTH, util::itos(ds->uploadLength));
   }
   if (requested_key(keys, KEY_BITFIELD)) {
     if (!ds->bitfield.empty()) {
-      entryDict->put(KEY_BITFIELD, util::toHex(ds->bitfield));
+      writer.put(KEY_BITFIELD, util::toHex(ds->bitfield));
     }
   }
   if (requested_key(keys, KEY_DOWNLOAD_SPEED)) {
-    entryDict->put(KEY_DOWNLOAD_SPEED, VLB_ZERO);
+    writer.put(KEY_DOWNLOAD_SPEED, VLB_ZERO);
   }
   if (requested_key(keys, KEY_UPLOAD_SPEED)) {
-    entryDict->put(KEY_UPLOAD_SPEED, VLB_ZERO);
+    writer.put(KEY_UPLOAD_SPEED, VLB_ZERO);
   }
   if (!ds->infoHash.empty()) {
     if (requested_key(keys, KEY_INFO_HASH)) {
-      entryDict->put(KEY_INFO_HASH, util::toHex(ds->infoHash));
+      writer.put(KEY_INFO_HASH, util::toHex(ds->infoHash));
     }
     if (requested_key(keys, KEY_NUM_SEEDERS)) {
-      entryDict->put(KEY_NUM_SEEDERS, VLB_ZERO);
+      writer.put(KEY_NUM_SEEDERS, VLB_ZERO);
     }
   }
   if (requested_key(keys, KEY_PIECE_LENGTH)) {
-    entryDict->put(KEY_PIECE_LENGTH, util::itos(ds->pieceLength));
+    writer.put(KEY_PIECE_LENGTH, util::itos(ds->pieceLength));
   }
   if (requested_key(keys, KEY_NUM_PIECES)) {
-    entryDict->put(KEY_NUM_PIECES, util::uitos(ds->numPieces));
+    writer.put(KEY_NUM_PIECES, util::uitos(ds->numPieces));
   }
   if (requested_key(keys, KEY_CONNECTIONS)) {
-    entryDict->put(KEY_CONNECTIONS, VLB_ZERO);
+    writer.put(KEY_CONNECTIONS, VLB_ZERO);
   }
   if (requested_key(keys, KEY_DIR)) {
-    entryDict->put(KEY_DIR, ds->dir);
+    writer.put(KEY_DIR, ds->dir);
   }
 
 #ifdef ENABLE_BITTORRENT
@@ -914,21 +972,58 @@ void gatherStoppedDownload(Dict* entryDict,
     const auto attrs =
         static_cast<TorrentAttribute*>(ds->attrs[CTX_ATTR_BT].get());
     if (requested_key(keys, KEY_BITTORRENT)) {
-      auto btDict = Dict::g();
-      gatherBitTorrentMetadata(btDict.get(), attrs);
-      entryDict->put(KEY_BITTORRENT, std::move(btDict));
+      writer.key(KEY_BITTORRENT);
+      writer.beginDict();
+      gatherBitTorrentMetadata(writer, attrs);
+      writer.endDict();
     }
   }
 #endif // ENABLE_BITTORRENT
 }
 
-std::unique_ptr<ValueBase> GetFilesRpcMethod::process(const RpcRequest& req,
-                                                      DownloadEngine* e)
+void gatherStoppedDownload(Dict* entryDict,
+                           const std::shared_ptr<DownloadResult>& ds,
+                           const std::vector<std::string>& keys)
+{
+  ValueBaseStructWriter writer(entryDict);
+  gatherStoppedDownload(writer, ds, keys);
+}
+
+std::unique_ptr<ValueBase>
+StructWriterRpcMethod::process(const RpcRequest& req, DownloadEngine* e)
+{
+  ValueBaseStructWriter writer;
+  write(writer, req, e);
+  return writer.getResult();
+}
+
+RpcResponse StructWriterRpcMethod::executeJson(RpcRequest req,
+                                               DownloadEngine* e)
+{
+  auto authorized = RpcResponse::NOTAUTHORIZED;
+  try {
+    authorize(req, e);
+    authorized = RpcResponse::AUTHORIZED;
+    std::string json;
+    json::JsonStructWriter writer(json);
+    write(writer, req, e);
+    RpcResponse res(0, authorized, nullptr, std::move(req.id));
+    res.json = std::move(json);
+    return res;
+  }
+  catch (RecoverableException& ex) {
+    A2_LOG_DEBUG_EX(EX_EXCEPTION_CAUGHT, ex);
+    return RpcResponse(1, authorized, createErrorResponse(ex, req),
+                       std::move(req.id));
+  }
+}
+
+void GetFilesRpcMethod::write(StructWriter& writer, const RpcRequest& req,
+                              DownloadEngine* e)
 {
   const String* gidParam = checkRequiredParam<String>(req, 0);
 
   a2_gid_t gid = str2Gid(gidParam);
-  auto files = List::g();
   auto group = e->getRequestGroupMan()->findGroup(gid);
   if (!group) {
     auto dr = e->getRequestGroupMan()->findDownloadResult(gid);
@@ -937,24 +1032,23 @@ std::unique_ptr<ValueBase> GetFilesRpcMethod::process(const RpcRequest& req,
                             GroupId::toHex(gid).c_str()));
     }
     else {
-      createFileEntry(files.get(), std::begin(dr->fileEntries),
+      createFileEntry(writer, std::begin(dr->fileEntries),
                       std::end(dr->fileEntries), dr->totalLength,
                       dr->pieceLength, dr->bitfield);
     }
   }
   else {
     auto& dctx = group->getDownloadContext();
-    createFileEntry(files.get(),
+    createFileEntry(writer,
                     std::begin(group->getDownloadContext()->getFileEntries()),
                     std::end(group->getDownloadContext()->getFileEntries()),
                     dctx->getTotalLength(), dctx->getPieceLength(),
                     group->getPieceStorage());
   }
-  return std::move(files);
 }
 
-std::unique_ptr<ValueBase> GetUrisRpcMethod::process(const RpcRequest& req,
-                                                     DownloadEngine* e)
+void GetUrisRpcMethod::write(StructWriter& writer, const RpcRequest& req,
+                             DownloadEngine* e)
 {
   const String* gidParam = checkRequiredParam<String>(req, 0);
 
@@ -964,13 +1058,12 @@ std::unique_ptr<ValueBase> GetUrisRpcMethod::process(const RpcRequest& req,
     throw DL_ABORT_EX(fmt("No URI data is available for GID#%s",
                           GroupId::toHex(gid).c_str()));
   }
-  auto uriList = List::g();
+  writer.beginList();
   // TODO Current implementation just returns first FileEntry's URIs.
   if (!group->getDownloadContext()->getFileEntries().empty()) {
-    createUriEntry(uriList.get(),
-                   group->getDownloadContext()->getFirstFileEntry());
+    createUriEntry(writer, group->getDownloadContext()->getFirstFileEntry());
   }
-  return std::move(uriList);
+  writer.endList();
 }
 
 #ifdef ENABLE_BITTORRENT
@@ -995,8 +1088,8 @@ std::unique_ptr<ValueBase> GetPeersRpcMethod::process(const RpcRequest& req,
 }
 #endif // ENABLE_BITTORRENT
 
-std::unique_ptr<ValueBase> TellStatusRpcMethod::process(const RpcRequest& req,
-                                                        DownloadEngine* e)
+void TellStatusRpcMethod::write(StructWriter& writer, const RpcRequest& req,
+                                DownloadEngine* e)
 {
   const String* gidParam = checkRequiredParam<String>(req, 0);
   const List* keysParam = checkParam<List>(req, 1);
@@ -1006,51 +1099,40 @@ std::unique_ptr<ValueBase> TellStatusRpcMethod::process(const RpcRequest& req,
   toStringList(std::back_inserter(keys), keysParam);
 
   auto group = e->getRequestGroupMan()->findGroup(gid);
-  auto entryDict = Dict::g();
   if (!group) {
     auto ds = e->getRequestGroupMan()->findDownloadResult(gid);
     if (!ds) {
       throw DL_ABORT_EX(
           fmt("No such download for GID#%s", GroupId::toHex(gid).c_str()));
     }
-    gatherStoppedDownload(entryDict.get(), ds, keys);
+    writer.beginDict();
+    gatherStoppedDownload(writer, ds, keys);
+    writer.endDict();
   }
   else {
-    if (requested_key(keys, KEY_STATUS)) {
-      if (group->getState() == RequestGroup::STATE_ACTIVE) {
-        entryDict->put(KEY_STATUS, VLB_ACTIVE);
-      }
-      else {
-        if (group->isPauseRequested()) {
-          entryDict->put(KEY_STATUS, VLB_PAUSED);
-        }
-        else {
-          entryDict->put(KEY_STATUS, VLB_WAITING);
-        }
-      }
-    }
-    gatherProgress(entryDict.get(), group, e, keys);
+    writer.beginDict();
+    gatherRequestGroupStatus(writer, group, e, keys);
+    writer.endDict();
   }
-  return std::move(entryDict);
 }
 
-std::unique_ptr<ValueBase> TellActiveRpcMethod::process(const RpcRequest& req,
-                                                        DownloadEngine* e)
+void TellActiveRpcMethod::write(StructWriter& writer, const RpcRequest& req,
+                                DownloadEngine* e)
 {
   const List* keysParam = checkParam<List>(req, 0);
   std::vector<std::string> keys;
   toStringList(std::back_inserter(keys), keysParam);
-  auto list = List::g();
   bool statusReq = requested_key(keys, KEY_STATUS);
+  writer.beginList();
   for (auto& group : e->getRequestGroupMan()->getRequestGroups()) {
-    auto entryDict = Dict::g();
+    writer.beginDict();
     if (statusReq) {
-      entryDict->put(KEY_STATUS, VLB_ACTIVE);
+      writer.put(KEY_STATUS, VLB_ACTIVE);
     }
-    gatherProgress(entryDict.get(), group, e, keys);
-    list->append(std::move(entryDict));
+    gatherProgress(writer, group, e, keys);
+    writer.endDict();
   }
-  return std::move(list);
+  writer.endList();
 }
 
 const RequestGroupList& TellWaitingRpcMethod::getItems(DownloadEngine* e) const
@@ -1059,18 +1141,18 @@ const RequestGroupList& TellWaitingRpcMethod::getItems(DownloadEngine* e) const
 }
 
 void TellWaitingRpcMethod::createEntry(
-    Dict* entryDict, const std::shared_ptr<RequestGroup>& item,
+    StructWriter& writer, const std::shared_ptr<RequestGroup>& item,
     DownloadEngine* e, const std::vector<std::string>& keys) const
 {
   if (requested_key(keys, KEY_STATUS)) {
     if (item->isPauseRequested()) {
-      entryDict->put(KEY_STATUS, VLB_PAUSED);
+      writer.put(KEY_STATUS, VLB_PAUSED);
     }
     else {
-      entryDict->put(KEY_STATUS, VLB_WAITING);
+      writer.put(KEY_STATUS, VLB_WAITING);
     }
   }
-  gatherProgress(entryDict, item, e, keys);
+  gatherProgress(writer, item, e, keys);
 }
 
 const DownloadResultList&
@@ -1080,10 +1162,535 @@ TellStoppedRpcMethod::getItems(DownloadEngine* e) const
 }
 
 void TellStoppedRpcMethod::createEntry(
-    Dict* entryDict, const std::shared_ptr<DownloadResult>& item,
+    StructWriter& writer, const std::shared_ptr<DownloadResult>& item,
     DownloadEngine* e, const std::vector<std::string>& keys) const
 {
-  gatherStoppedDownload(entryDict, item, keys);
+  gatherStoppedDownload(writer, item, keys);
+}
+
+namespace {
+// Status bits of aria2.queryDownloads
+enum {
+  QUERY_ACTIVE = 1,
+  QUERY_WAITING = 1 << 1,
+  QUERY_PAUSED = 1 << 2,
+  QUERY_COMPLETE = 1 << 3,
+  QUERY_ERROR = 1 << 4,
+  QUERY_REMOVED = 1 << 5,
+  QUERY_STOPPED = QUERY_COMPLETE | QUERY_ERROR | QUERY_REMOVED,
+  QUERY_ALL = QUERY_ACTIVE | QUERY_WAITING | QUERY_PAUSED | QUERY_STOPPED
+};
+} // namespace
+
+namespace {
+const char KEY_QUERY_ERROR_CODE[] = "errorCode";
+const char KEY_QUERY_DIR[] = "dir";
+const char KEY_QUERY_OPTION[] = "option";
+const char KEY_QUERY_ORDER[] = "order";
+const char KEY_QUERY_LIMIT[] = "limit";
+const char KEY_QUERY_CURSOR[] = "cursor";
+const char KEY_DOWNLOADS[] = "downloads";
+const char VLB_DESC[] = "desc";
+const char VLB_ASC[] = "asc";
+// The number of downloads returned at most if limit is not given.
+const int64_t DEFAULT_QUERY_LIMIT = 100;
+} // namespace
+
+namespace {
+struct DownloadQuery {
+  int status;
+  bool hasErrorCode;
+  error_code::Value errorCode;
+  bool hasDir;
+  std::string dir;
+  std::vector<std::pair<PrefPtr, std::string>> options;
+  bool desc;
+  int64_t limit;
+  // The cursor where the previous page ended.  cursorSegment is one
+  // of 'a' (active), 'w' (waiting or paused) and 's' (stopped), or 0
+  // if no cursor is given.  For 'a' and 'w', cursorPos is the
+  // position of the last download, and cursorGid is its GID.  For
+  // 's', cursorPos is DownloadResult::seq of the last download.
+  char cursorSegment;
+  uint64_t cursorPos;
+  a2_gid_t cursorGid;
+
+  DownloadQuery()
+      : status(QUERY_ALL),
+        hasErrorCode(false),
+        errorCode(error_code::FINISHED),
+        hasDir(false),
+        desc(false),
+        limit(DEFAULT_QUERY_LIMIT),
+        cursorSegment(0),
+        cursorPos(0),
+        cursorGid(0)
+  {
+  }
+};
+} // namespace
+
+namespace {
+int toQueryStatus(const std::string& s)
+{
+  if (s == VLB_ACTIVE) {
+    return QUERY_ACTIVE;
+  }
+  if (s == VLB_WAITING) {
+    return QUERY_WAITING;
+  }
+  if (s == VLB_PAUSED) {
+    return QUERY_PAUSED;
+  }
+  if (s == VLB_COMPLETE) {
+    return QUERY_COMPLETE;
+  }
+  if (s == VLB_ERROR) {
+    return QUERY_ERROR;
+  }
+  if (s == VLB_REMOVED) {
+    return QUERY_REMOVED;
+  }
+  throw DL_ABORT_EX(fmt("Invalid status %s", s.c_str()));
+}
+} // namespace
+
+namespace {
+const String* getQueryString(const Dict* queryParam, const char* key)
+{
+  const ValueBase* v = queryParam->get(key);
+  if (!v) {
+    return nullptr;
+  }
+  const String* s = downcast<String>(v);
+  if (!s) {
+    throw DL_ABORT_EX(fmt("%s must be a string.", key));
+  }
+  return s;
+}
+} // namespace
+
+namespace {
+void parseQueryCursor(DownloadQuery& query, const std::string& cursor)
+{
+  // The cursor is a:<pos>:<gid>, w:<pos>:<gid> or s:<seq>.
+  auto sep = cursor.find(':', 2);
+  int64_t pos;
+  if (cursor.size() < 3 || cursor[1] != ':' ||
+      !util::parseLLIntNoThrow(
+          pos, cursor.substr(2, sep == std::string::npos ? sep : sep - 2)) ||
+      pos < 0) {
+    throw DL_ABORT_EX(fmt("Invalid cursor %s", cursor.c_str()));
+  }
+  switch (cursor[0]) {
+  case 'a':
+  case 'w':
+    if (sep == std::string::npos ||
+        GroupId::toNumericId(query.cursorGid, cursor.c_str() + sep + 1) != 0) {
+      throw DL_ABORT_EX(fmt("Invalid cursor %s", cursor.c_str()));
+    }
+    break;
+  case 's':
+    if (sep != std::string::npos) {
+      throw DL_ABORT_EX(fmt("Invalid cursor %s", cursor.c_str()));
+    }
+    break;
+  default:
+    throw DL_ABORT_EX(fmt("Invalid cursor %s", cursor.c_str()));
+  }
+  query.cursorSegment = cursor[0];
+  query.cursorPos = pos;
+}
+} // namespace
+
+namespace {
+DownloadQuery parseDownloadQuery(const Dict* queryParam)
+{
+  DownloadQuery query;
+  if (!queryParam) {
+    return query;
+  }
+  const ValueBase* v = queryParam->get(KEY_STATUS);
+  if (v) {
+    const List* statusParam = downcast<List>(v);
+    if (!statusParam) {
+      throw DL_ABORT_EX(fmt("%s must be a list.", KEY_STATUS));
+    }
+    query.status = 0;
+    for (auto& elem : *statusParam) {
+      const String* s = downcast<String>(elem);
+      if (!s) {
+        throw DL_ABORT_EX(fmt("%s must be a list of strings.", KEY_STATUS));
+      }
+      query.status |= toQueryStatus(s->s());
+    }
+  }
+  const String* s = getQueryString(queryParam, KEY_QUERY_ERROR_CODE);
+  if (s) {
+    int32_t code;
+    if (!util::parseIntNoThrow(code, s->s()) || code < 0) {
+      throw DL_ABORT_EX(fmt("Invalid %s %s", KEY_QUERY_ERROR_CODE,
+                            s->s().c_str()));
+    }
+    query.hasErrorCode = true;
+    query.errorCode = static_cast<error_code::Value>(code);
+  }
+  s = getQueryString(queryParam, KEY_QUERY_DIR);
+  if (s) {
+    query.hasDir = true;
+    query.dir = s->s();
+  }
+  v = queryParam->get(KEY_QUERY_OPTION);
+  if (v) {
+    const Dict* optionParam = downcast<Dict>(v);
+    if (!optionParam) {
+      throw DL_ABORT_EX(fmt("%s must be a struct.", KEY_QUERY_OPTION));
+    }
+    for (auto& kv : *optionParam) {
+      PrefPtr pref = option::k2p(kv.first);
+      const String* value = downcast<String>(kv.second);
+      if (pref->i == 0 || !value) {
+        throw DL_ABORT_EX(fmt("Invalid option %s", kv.first.c_str()));
+      }
+      query.options.emplace_back(pref, value->s());
+    }
+  }
+  s = getQueryString(queryParam, KEY_QUERY_ORDER);
+  if (s) {
+    if (s->s() == VLB_DESC) {
+      query.desc = true;
+    }
+    else if (s->s() != VLB_ASC) {
+      throw DL_ABORT_EX(fmt("Invalid %s %s", KEY_QUERY_ORDER, s->s().c_str()));
+    }
+  }
+  v = queryParam->get(KEY_QUERY_LIMIT);
+  if (v) {
+    const Integer* limitParam = downcast<Integer>(v);
+    if (!limitParam || limitParam->i() <= 0) {
+      throw DL_ABORT_EX(
+          fmt("%s must be a positive integer.", KEY_QUERY_LIMIT));
+    }
+    query.limit = limitParam->i();
+  }
+  s = getQueryString(queryParam, KEY_QUERY_CURSOR);
+  if (s) {
+    parseQueryCursor(query, s->s());
+  }
+  return query;
+}
+} // namespace
+
+namespace {
+bool matchQueryOptions(const DownloadQuery& query, const Option* option)
+{
+  for (auto& o : query.options) {
+    if (!option || option->get(o.first) != o.second) {
+      return false;
+    }
+  }
+  return true;
+}
+} // namespace
+
+namespace {
+class DownloadQueryWriter {
+public:
+  DownloadQueryWriter(StructWriter& writer, const DownloadQuery& query,
+                      DownloadEngine* e, const std::vector<std::string>& keys)
+      : writer_(writer),
+        query_(query),
+        e_(e),
+        rgman_(e->getRequestGroupMan().get()),
+        keys_(keys),
+        count_(0)
+  {
+  }
+
+  // Writes the matching downloads in the order of query_, starting
+  // from the cursor.
+  void write()
+  {
+    const char* segments = query_.desc ? "swa" : "aws";
+    size_t i = 0;
+    if (query_.cursorSegment) {
+      for (; segments[i] != query_.cursorSegment; ++i)
+        ;
+    }
+    for (; segments[i]; ++i) {
+      bool full;
+      switch (segments[i]) {
+      case 'a':
+        full = writeGroups('a', rgman_->getRequestGroups());
+        break;
+      case 'w':
+        full = writeGroups('w', rgman_->getReservedGroups());
+        break;
+      default:
+        full = writeStopped();
+        break;
+      }
+      if (full) {
+        break;
+      }
+    }
+  }
+
+  // The cursor of the last download written if the number of them
+  // reaches the limit, or empty string.
+  const std::string& getCursor() const { return cursor_; }
+
+private:
+  int getGroupStatus(char segment, const RequestGroup& group) const
+  {
+    if (segment == 'a') {
+      return QUERY_ACTIVE;
+    }
+    return group.isPauseRequested() ? QUERY_PAUSED : QUERY_WAITING;
+  }
+
+  bool matchGroup(char segment, const RequestGroup& group) const
+  {
+    if (query_.hasErrorCode ||
+        !(query_.status & getGroupStatus(segment, group))) {
+      return false;
+    }
+    const auto& option = group.getOption();
+    if (query_.hasDir && option->get(PREF_DIR) != query_.dir) {
+      return false;
+    }
+    return matchQueryOptions(query_, option.get());
+  }
+
+  bool matchStopped(const DownloadResult& dr) const
+  {
+    int status;
+    if (dr.result == error_code::FINISHED) {
+      status = QUERY_COMPLETE;
+    }
+    else if (dr.result == error_code::REMOVED) {
+      status = QUERY_REMOVED;
+    }
+    else {
+      status = QUERY_ERROR;
+    }
+    if (!(query_.status & status) ||
+        (query_.hasErrorCode && dr.result != query_.errorCode) ||
+        (query_.hasDir && dr.dir != query_.dir)) {
+      return false;
+    }
+    return matchQueryOptions(query_, dr.option.get());
+  }
+
+  // Returns the position in |groups| to resume.  In descending
+  // order, the download just before the returned position is
+  // examined first.
+  size_t getResumePosition(char segment, const RequestGroupList& groups) const
+  {
+    if (query_.cursorSegment != segment) {
+      return query_.desc ? groups.size() : 0;
+    }
+    // The last download is likely at the same position unless the
+    // queue has been changed.
+    size_t pos = query_.cursorPos;
+    if (pos >= groups.size() || groups[pos]->getGID() != query_.cursorGid) {
+      auto i = std::find_if(std::begin(groups), std::end(groups),
+                            [this](const std::shared_ptr<RequestGroup>& g) {
+                              return g->getGID() == query_.cursorGid;
+                            });
+      if (i == std::end(groups)) {
+        // The last download is gone.  The one which took its
+        // position is the next.
+        return std::min(pos, groups.size());
+      }
+      pos = std::distance(std::begin(groups), i);
+    }
+    return query_.desc ? pos : pos + 1;
+  }
+
+  bool writeGroups(char segment, const RequestGroupList& groups)
+  {
+    if (query_.hasErrorCode) {
+      return false;
+    }
+    if (segment == 'a' ? !(query_.status & QUERY_ACTIVE)
+                       : !(query_.status & (QUERY_WAITING | QUERY_PAUSED))) {
+      return false;
+    }
+    size_t pos = getResumePosition(segment, groups);
+    if (query_.desc) {
+      while (pos > 0) {
+        --pos;
+        if (writeGroup(segment, pos, groups[pos])) {
+          return true;
+        }
+      }
+    }
+    else {
+      for (; pos < groups.size(); ++pos) {
+        if (writeGroup(segment, pos, groups[pos])) {
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+
+  // Writes |group| if it matches.  Returns true if the number of
+  // downloads written reaches the limit.
+  bool writeGroup(char segment, size_t pos,
+                  const std::shared_ptr<RequestGroup>& group)
+  {
+    if (!matchGroup(segment, *group)) {
+      return false;
+    }
+    writer_.beginDict();
+    gatherRequestGroupStatus(writer_, group, e_, keys_);
+    writer_.endDict();
+    if (++count_ < query_.limit) {
+      return false;
+    }
+    cursor_ = fmt("%c:%lu:", segment, static_cast<unsigned long>(pos));
+    cursor_ += group->getGroupId()->toHex();
+    return true;
+  }
+
+  // Returns the smallest secondary index which contains all matching
+  // results, or nullptr if no index narrows them down.
+  const DownloadResultIndex::SeqList* selectIndex() const
+  {
+    auto& index = rgman_->getDownloadResultIndex();
+    const DownloadResultIndex::SeqList* res = nullptr;
+    auto select = [&res](const DownloadResultIndex::SeqList& seqs) {
+      if (!res || seqs.size() < res->size()) {
+        res = &seqs;
+      }
+    };
+    if (query_.hasErrorCode) {
+      select(index.findByErrorCode(query_.errorCode));
+    }
+    if (query_.hasDir) {
+      select(index.findByDir(query_.dir));
+    }
+    switch (query_.status & QUERY_STOPPED) {
+    case QUERY_COMPLETE:
+      select(index.findByErrorCode(error_code::FINISHED));
+      break;
+    case QUERY_REMOVED:
+      select(index.findByErrorCode(error_code::REMOVED));
+      break;
+    case QUERY_ERROR:
+      select(index.findErrors());
+      break;
+    }
+    return res;
+  }
+
+  bool writeStopped()
+  {
+    if (!(query_.status & QUERY_STOPPED)) {
+      return false;
+    }
+    // In ascending order, the results whose seq is at least |first|
+    // are examined.  In descending order, the ones less than it.
+    uint64_t first;
+    if (query_.cursorSegment == 's') {
+      first = query_.desc ? query_.cursorPos : query_.cursorPos + 1;
+    }
+    else {
+      first = query_.desc ? std::numeric_limits<uint64_t>::max() : 0;
+    }
+    auto& results = rgman_->getDownloadResults();
+    auto seqs = selectIndex();
+    if (!seqs) {
+      size_t pos = rgman_->findDownloadResultPosition(first);
+      if (query_.desc) {
+        while (pos > 0) {
+          if (writeStopped(results[--pos])) {
+            return true;
+          }
+        }
+      }
+      else {
+        for (; pos < results.size(); ++pos) {
+          if (writeStopped(results[pos])) {
+            return true;
+          }
+        }
+      }
+      return false;
+    }
+    auto i = std::lower_bound(std::begin(*seqs), std::end(*seqs), first);
+    if (query_.desc) {
+      while (i != std::begin(*seqs)) {
+        if (writeStopped(results, *--i)) {
+          return true;
+        }
+      }
+    }
+    else {
+      for (; i != std::end(*seqs); ++i) {
+        if (writeStopped(results, *i)) {
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+
+  bool writeStopped(const DownloadResultList& results, uint64_t seq)
+  {
+    size_t pos = rgman_->findDownloadResultPosition(seq);
+    assert(pos < results.size() && results[pos]->seq == seq);
+    return writeStopped(results[pos]);
+  }
+
+  // Writes |dr| if it matches.  Returns true if the number of
+  // downloads written reaches the limit.
+  bool writeStopped(const std::shared_ptr<DownloadResult>& dr)
+  {
+    if (!matchStopped(*dr)) {
+      return false;
+    }
+    writer_.beginDict();
+    gatherStoppedDownload(writer_, dr, keys_);
+    writer_.endDict();
+    if (++count_ < query_.limit) {
+      return false;
+    }
+    cursor_ = "s:";
+    cursor_ += util::uitos(dr->seq);
+    return true;
+  }
+
+  StructWriter& writer_;
+  const DownloadQuery& query_;
+  DownloadEngine* e_;
+  RequestGroupMan* rgman_;
+  const std::vector<std::string>& keys_;
+  int64_t count_;
+  std::string cursor_;
+};
+} // namespace
+
+void QueryDownloadsRpcMethod::write(StructWriter& writer, const RpcRequest& req,
+                                   DownloadEngine* e)
+{
+  const Dict* queryParam = checkParam<Dict>(req, 0);
+  const List* keysParam = checkParam<List>(req, 1);
+  auto query = parseDownloadQuery(queryParam);
+  std::vector<std::string> keys;
+  toStringList(std::back_inserter(keys), keysParam);
+  DownloadQueryWriter queryWriter(writer, query, e, keys);
+  writer.beginDict();
+  writer.key(KEY_DOWNLOADS);
+  writer.beginList();
+  queryWriter.write();
+  writer.endList();
+  if (!queryWriter.getCursor().empty()) {
+    writer.put(KEY_QUERY_CURSOR, queryWriter.getCursor());
+  }
+  writer.endDict();
 }
 
 std::unique_ptr<ValueBase>
@@ -1341,6 +1948,9 @@ std::unique_ptr<ValueBase> ChangeUriRpcMethod::process(const RpcRequest& req,
       }
     }
   }
+  if (delcount || addcount) {
+    group->updateStatusVersion();
+  }
   if (addcount && group->getPieceStorage()) {
     std::vector<std::unique_ptr<Command>> commands;
     group->createNextCommand(commands, e);
@@ -1390,6 +2000,13 @@ GetGlobalStatRpcMethod::process(const RpcRequest& req, DownloadEngine* e)
   res->put(KEY_NUM_STOPPED, util::uitos(rgman->getDownloadResults().size()));
   res->put(KEY_NUM_STOPPED_TOTAL, util::uitos(rgman->getNumStoppedTotal()));
   res->put(KEY_NUM_ACTIVE, util::uitos(rgman->getRequestGroups().size()));
+#ifdef ENABLE_BITTORRENT
+  size_t numInfoHash, numPeer, memory;
+  DHTRegistry::getPeerAnnounceStat(numInfoHash, numPeer, memory);
+  res->put(KEY_NUM_DHT_ANNOUNCE_INFO_HASHES, util::uitos(numInfoHash));
+  res->put(KEY_NUM_DHT_ANNOUNCE_PEERS, util::uitos(numPeer));
+  res->put(KEY_DHT_ANNOUNCE_MEMORY, util::uitos(memory));
+#endif // ENABLE_BITTORRENT
   return std::move(res);
 }
 
@@ -1410,6 +2027,34 @@ std::unique_ptr<ValueBase> SaveSessionRpcMethod::process(const RpcRequest& req,
       fmt("Failed to serialize session to '%s'.", filename.c_str()));
 }
 
+std::unique_ptr<ValueBase>
+SubscribeStatusRpcMethod::process(const RpcRequest& req, DownloadEngine* e)
+{
+#ifdef ENABLE_WEBSOCKET
+  if (req.wsSession) {
+    const List* keysParam = checkParam<List>(req, 0);
+    std::vector<std::string> keys;
+    toStringList(std::back_inserter(keys), keysParam);
+    req.wsSession->setStatusSubscription(
+        make_unique<StatusSubscription>(std::move(keys)));
+    return createOKResponse();
+  }
+#endif // ENABLE_WEBSOCKET
+  throw DL_ABORT_EX("This method is only available over WebSocket.");
+}
+
+std::unique_ptr<ValueBase>
+UnsubscribeStatusRpcMethod::process(const RpcRequest& req, DownloadEngine* e)
+{
+#ifdef ENABLE_WEBSOCKET
+  if (req.wsSession) {
+    req.wsSession->setStatusSubscription(nullptr);
+    return createOKResponse();
+  }
+#endif // ENABLE_WEBSOCKET
+  throw DL_ABORT_EX("This method is only available over WebSocket.");
+}
+
 std::unique_ptr<ValueBase>
 SystemMulticallRpcMethod::process(const RpcRequest& req, DownloadEngine* e)
 {
@@ -1455,6 +2100,7 @@ RpcResponse SystemMulticallRpcMethod::execute(RpcRequest req, DownloadEngine* e)
       }
       RpcRequest r = {methodName->s(), std::move(paramsList), nullptr,
                       req.jsonRpc};
+      r.wsSession = req.wsSession;
       RpcResponse res = getMethod(methodName->s())->execute(std::move(r), e);
       if (rpc::not_authorized(res)) {
         authorized = RpcResponse::NOTAUTHORIZED;
@@ -1643,6 +2289,7 @@ void changeOption(const std::shared_ptr<RequestGroup>& group,
     }
   }
 #endif // ENABLE_BITTORRENT
+  group->updateStatusVersion();
 }
 
 void changeGlobalOption(const Option& option, DownloadEngine* e)
@@ -49,6 +49,7 @@
 #include "IndexedList.h"
 #include "GroupId.h"
 #include "RequestGroupMan.h"
+#include "StructWriter.h"
 
 namespace aria2 {
 
@@ -248,19 +249,38 @@ public:
   static const char* getMethodName() { return "aria2.removeDownloadResult"; }
 };
 
-class GetUrisRpcMethod : public RpcMethod {
+// Base class of RPC methods which write their result through
+// StructWriter.  process() builds ValueBase from it, and
+// executeJson() encodes it in JSON directly, which avoids building
+// ValueBase for large results.
+class StructWriterRpcMethod : public RpcMethod {
 protected:
+  // Writes the result of req to writer.  Parameters must be checked
+  // before anything is written.
+  virtual void write(StructWriter& writer, const RpcRequest& req,
+                     DownloadEngine* e) = 0;
+
   virtual std::unique_ptr<ValueBase> process(const RpcRequest& req,
                                              DownloadEngine* e) CXX11_OVERRIDE;
 
+public:
+  virtual RpcResponse executeJson(RpcRequest req,
+                                  DownloadEngine* e) CXX11_OVERRIDE;
+};
+
+class GetUrisRpcMethod : public StructWriterRpcMethod {
+protected:
+  virtual void write(StructWriter& writer, const RpcRequest& req,
+                     DownloadEngine* e) CXX11_OVERRIDE;
+
 public:
   static const char* getMethodName() { return "aria2.getUris"; }
 };
 
-class GetFilesRpcMethod : public RpcMethod {
+class GetFilesRpcMethod : public StructWriterRpcMethod {
 protected:
-  virtual std::unique_ptr<ValueBase> process(const RpcRequest& req,
-                                             DownloadEngine* e) CXX11_OVERRIDE;
+  virtual void write(StructWriter& writer, const RpcRequest& req,
+                     DownloadEngine* e) CXX11_OVERRIDE;
 
 public:
   static const char* getMethodName() { return "aria2.getFiles"; }
@@ -286,25 +306,26 @@ public:
   static const char* getMethodName() { return "aria2.getServers"; }
 };
 
-class TellStatusRpcMethod : public RpcMethod {
+class TellStatusRpcMethod : public StructWriterRpcMethod {
 protected:
-  virtual std::unique_ptr<ValueBase> process(const RpcRequest& req,
-                                             DownloadEngine* e) CXX11_OVERRIDE;
+  virtual void write(StructWriter& writer, const RpcRequest& req,
+                     DownloadEngine* e) CXX11_OVERRIDE;
 
 public:
   static const char* getMethodName() { return "aria2.tellStatus"; }
 };
 
-class TellActiveRpcMethod : public RpcMethod {
+class TellActiveRpcMethod : public StructWriterRpcMethod {
 protected:
-  virtual std::unique_ptr<ValueBase> process(const RpcRequest& req,
-                                             DownloadEngine* e) CXX11_OVERRIDE;
+  virtual void write(StructWriter& writer, const RpcRequest& req,
+                     DownloadEngine* e) CXX11_OVERRIDE;
 
 public:
   static const char* getMethodName() { return "aria2.tellActive"; }
 };
 
-template <typename T> class AbstractPaginationRpcMethod : public RpcMethod {
+template <typename T>
+class AbstractPaginationRpcMethod : public StructWriterRpcMethod {
 private:
   template <typename InputIterator>
   std::pair<InputIterator, InputIterator>
@@ -346,8 +367,8 @@ private:
 protected:
   typedef IndexedList<a2_gid_t, std::shared_ptr<T>> ItemListType;
 
-  virtual std::unique_ptr<ValueBase> process(const RpcRequest& req,
-                                             DownloadEngine* e) CXX11_OVERRIDE
+  virtual void write(StructWriter& writer, const RpcRequest& req,
+                     DownloadEngine* e) CXX11_OVERRIDE
   {
     const Integer* offsetParam = checkRequiredParam<Integer>(req, 0);
     const Integer* numParam = checkRequiredInteger(req, 1, IntegerGE(0));
@@ -360,23 +381,39 @@ protected:
     const ItemListType& items = getItems(e);
     auto range =
         getPaginationRange(offset, num, std::begin(items), std::end(items));
-    auto list = List::g();
-    for (; range.first != range.second; ++range.first) {
-      auto entryDict = Dict::g();
-      createEntry(entryDict.get(), *range.first, e, keys);
-      list->append(std::move(entryDict));
-    }
+    writer.beginList();
     if (offset < 0) {
-      std::reverse(list->begin(), list->end());
+      // Negative offset counts from the end, and the result is in
+      // reverse order.
+      while (range.first != range.second) {
+        --range.second;
+        writeEntry(writer, *range.second, e, keys);
+      }
+    }
+    else {
+      for (; range.first != range.second; ++range.first) {
+        writeEntry(writer, *range.first, e, keys);
+      }
     }
-    return std::move(list);
+    writer.endList();
   }
 
   virtual const ItemListType& getItems(DownloadEngine* e) const = 0;
 
-  virtual void createEntry(Dict* entryDict, const std::shared_ptr<T>& item,
+  // Writes the members of the entry for item.  The enclosing dict is
+  // opened and closed by the caller.
+  virtual void createEntry(StructWriter& writer, const std::shared_ptr<T>& item,
                            DownloadEngine* e,
                            const std::vector<std::string>& keys) const = 0;
+
+private:
+  void writeEntry(StructWriter& writer, const std::shared_ptr<T>& item,
+                  DownloadEngine* e, const std::vector<std::string>& keys)
+  {
+    writer.beginDict();
+    createEntry(writer, item, e, keys);
+    writer.endDict();
+  }
 };
 
 class TellWaitingRpcMethod : public AbstractPaginationRpcMethod<RequestGroup> {
@@ -385,7 +422,7 @@ protected:
   getItems(DownloadEngine* e) const CXX11_OVERRIDE;
 
   virtual void
-  createEntry(Dict* entryDict, const std::shared_ptr<RequestGroup>& item,
+  createEntry(StructWriter& writer, const std::shared_ptr<RequestGroup>& item,
               DownloadEngine* e,
               const std::vector<std::string>& keys) const CXX11_OVERRIDE;
 
@@ -400,7 +437,7 @@ protected:
   getItems(DownloadEngine* e) const CXX11_OVERRIDE;
 
   virtual void
-  createEntry(Dict* entryDict, const std::shared_ptr<DownloadResult>& item,
+  createEntry(StructWriter& writer, const std::shared_ptr<DownloadResult>& item,
               DownloadEngine* e,
               const std::vector<std::string>& keys) const CXX11_OVERRIDE;
 
@@ -408,6 +445,21 @@ public:
   static const char* getMethodName() { return "aria2.tellStopped"; }
 };
 
+// Returns the downloads matching the query given as the first
+// parameter, in pages.  The filters on stopped downloads are
+// evaluated using DownloadResultIndex, and the page is resumed from
+// the cursor returned by the previous call, instead of an offset, so
+// that it is cheap even if the queue is very long and is modified
+// between the calls.
+class QueryDownloadsRpcMethod : public StructWriterRpcMethod {
+protected:
+  virtual void write(StructWriter& writer, const RpcRequest& req,
+                     DownloadEngine* e) CXX11_OVERRIDE;
+
+public:
+  static const char* getMethodName() { return "aria2.queryDownloads"; }
+};
+
 class ChangeOptionRpcMethod : public RpcMethod {
 protected:
   virtual std::unique_ptr<ValueBase> process(const RpcRequest& req,
@@ -516,6 +568,27 @@ public:
   static const char* getMethodName() { return "aria2.saveSession"; }
 };
 
+// Subscribes the status changes of active and waiting downloads.
+// While subscribed, aria2.onStatusChange notifications are sent to
+// the WebSocket session.  See StatusSubscription.
+class SubscribeStatusRpcMethod : public RpcMethod {
+protected:
+  virtual std::unique_ptr<ValueBase> process(const RpcRequest& req,
+                                             DownloadEngine* e) CXX11_OVERRIDE;
+
+public:
+  static const char* getMethodName() { return "aria2.subscribeStatus"; }
+};
+
+class UnsubscribeStatusRpcMethod : public RpcMethod {
+protected:
+  virtual std::unique_ptr<ValueBase> process(const RpcRequest& req,
+                                             DownloadEngine* e) CXX11_OVERRIDE;
+
+public:
+  static const char* getMethodName() { return "aria2.unsubscribeStatus"; }
+};
+
 class SystemMulticallRpcMethod : public RpcMethod {
 protected:
   virtual std::unique_ptr<ValueBase> process(const RpcRequest& req,
@@ -555,20 +628,45 @@ protected:
                                              DownloadEngine* e) CXX11_OVERRIDE;
 };
 
-// Helper function to store data to entryDict from ds. This function
-// is used by tellStatus method.
+// Helper function to write data from ds as the members of the
+// current dict of writer. This function is used by tellStatus
+// method.
+void gatherStoppedDownload(StructWriter& writer,
+                           const std::shared_ptr<DownloadResult>& ds,
+                           const std::vector<std::string>& keys);
+
+// Same as above, but stores data to entryDict.
 void gatherStoppedDownload(Dict* entryDict,
                            const std::shared_ptr<DownloadResult>& ds,
                            const std::vector<std::string>& keys);
 
-// Helper function to store data to entryDict from group. This
-// function is used by tellStatus/tellActive/tellWaiting method
+// Helper function to write the status of the active or waiting
+// group as the members of the current dict of writer. This function
+// is used by tellStatus method and StatusSubscription.
+void gatherRequestGroupStatus(StructWriter& writer,
+                              const std::shared_ptr<RequestGroup>& group,
+                              DownloadEngine* e,
+                              const std::vector<std::string>& keys);
+
+// Helper function to write data from group as the members of the
+// current dict of writer. This function is used by
+// tellStatus/tellActive/tellWaiting method
+void gatherProgressCommon(StructWriter& writer,
+                          const std::shared_ptr<RequestGroup>& group,
+                          const std::vector<std::string>& keys);
+
+// Same as above, but stores data to entryDict.
 void gatherProgressCommon(Dict* entryDict,
                           const std::shared_ptr<RequestGroup>& group,
                           const std::vector<std::string>& keys);
 
 #ifdef ENABLE_BITTORRENT
-// Helper function to store BitTorrent metadata from torrentAttrs.
+// Helper function to write BitTorrent metadata from torrentAttrs as
+// the members of the current dict of writer.
+void gatherBitTorrentMetadata(StructWriter& writer,
+                              TorrentAttribute* torrentAttrs);
+
+// Same as above, but stores data to btDict.
 void gatherBitTorrentMetadata(Dict* btDict, TorrentAttribute* torrentAttrs);
 #endif // ENABLE_BITTORRENT
 
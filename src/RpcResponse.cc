@@ -152,23 +152,27 @@ std::string toXml(const RpcResponse& res, bool gzip)
 
 namespace {
 template <typename OutputStream>
-OutputStream& encodeJsonAll(OutputStream& o, int code, const ValueBase* param,
-                            const ValueBase* id,
+OutputStream& encodeJsonAll(OutputStream& o, const RpcResponse& res,
                             const std::string& callback = A2STR::NIL)
 {
   if (!callback.empty()) {
     o << callback << "(";
   }
   o << "{\"id\":";
-  json::encode(o, id);
+  json::encode(o, res.id.get());
   o << ",\"jsonrpc\":\"2.0\",";
-  if (code == 0) {
+  if (res.code == 0) {
     o << "\"result\":";
   }
   else {
     o << "\"error\":";
   }
-  json::encode(o, param);
+  if (res.param) {
+    json::encode(o, res.param.get());
+  }
+  else {
+    o << res.json;
+  }
   o << "}";
   if (!callback.empty()) {
     o << ")";
@@ -184,16 +188,14 @@ std::string toJson(const RpcResponse& res, const std::string& callback,
 #ifdef HAVE_ZLIB
     GZipEncoder o;
     o.init();
-    return encodeJsonAll(o, res.code, res.param.get(), res.id.get(), callback)
-        .str();
+    return encodeJsonAll(o, res, callback).str();
 #else  // !HAVE_ZLIB
     abort();
 #endif // !HAVE_ZLIB
   }
   else {
     std::stringstream o;
-    return encodeJsonAll(o, res.code, res.param.get(), res.id.get(), callback)
-        .str();
+    return encodeJsonAll(o, res, callback).str();
   }
 }
 
@@ -208,13 +210,12 @@ OutputStream& encodeJsonBatchAll(OutputStream& o,
   }
   o << "[";
   if (!results.empty()) {
-    encodeJsonAll(o, results[0].code, results[0].param.get(),
-                  results[0].id.get());
+    encodeJsonAll(o, results[0]);
 
     for (auto i = std::begin(results) + 1, eoi = std::end(results); i != eoi;
          ++i) {
       o << ",";
-      encodeJsonAll(o, (*i).code, (*i).param.get(), (*i).id.get());
+      encodeJsonAll(o, *i);
     }
   }
   o << "]";
@@ -51,6 +51,9 @@ struct RpcResponse {
 
   // 0 for success, non-zero for error
   std::unique_ptr<ValueBase> param;
+  // The result already encoded in JSON.  This is used instead of
+  // param if param is null.  See RpcMethod::executeJson().
+  std::string json;
   std::unique_ptr<ValueBase> id;
   int code;
   authorization_t authorized;
@@ -43,6 +43,7 @@
 #include "fmt.h"
 #include "LogFactory.h"
 #include "a2functional.h"
+#include "DiskAdaptor.h"
 
 namespace aria2 {
 
@@ -102,6 +103,53 @@ const unsigned char* SocketBuffer::StringBufEntry::getData() const
   return reinterpret_cast<const unsigned char*>(str_.c_str());
 }
 
+SocketBuffer::FileBufEntry::FileBufEntry(
+    std::shared_ptr<DiskAdaptor> diskAdaptor, int64_t offset, size_t length,
+    std::unique_ptr<ProgressUpdate> progressUpdate)
+    : BufEntry(std::move(progressUpdate)),
+      diskAdaptor_(std::move(diskAdaptor)),
+      offset_(offset),
+      length_(length)
+{
+}
+
+SocketBuffer::FileBufEntry::~FileBufEntry() = default;
+
+ssize_t
+SocketBuffer::FileBufEntry::send(const std::shared_ptr<SocketCore>& socket,
+                                 size_t offset)
+{
+  // The file descriptor is looked up on each call because
+  // DiskAdaptor may close the file to keep the number of open files
+  // under the limit.
+  size_t len = length_ - offset;
+  int64_t fileOffset;
+  int fd = diskAdaptor_->getReadFd(offset_ + offset, fileOffset, len);
+  ssize_t r = socket->writeFile(fd, fileOffset, len);
+  if (r != -1) {
+    return r;
+  }
+  unsigned char buf[16_k];
+  len = std::min(length_ - offset, sizeof(buf));
+  r = diskAdaptor_->readData(buf, len, offset_ + offset);
+  if (r != static_cast<ssize_t>(len)) {
+    throw DL_ABORT_EX(EX_DATA_READ);
+  }
+  return socket->writeData(buf, len);
+}
+
+bool SocketBuffer::FileBufEntry::final(size_t offset) const
+{
+  return length_ <= offset;
+}
+
+size_t SocketBuffer::FileBufEntry::getLength() const { return length_; }
+
+const unsigned char* SocketBuffer::FileBufEntry::getData() const
+{
+  return nullptr;
+}
+
 SocketBuffer::SocketBuffer(std::shared_ptr<SocketCore> socket)
     : socket_(std::move(socket)), offset_(0)
 {
@@ -127,6 +175,16 @@ void SocketBuffer::pushStr(std::string data,
   }
 }
 
+void SocketBuffer::pushFile(std::shared_ptr<DiskAdaptor> diskAdaptor,
+                            int64_t offset, size_t length,
+                            std::unique_ptr<ProgressUpdate> progressUpdate)
+{
+  if (length > 0) {
+    bufq_.push_back(make_unique<FileBufEntry>(
+        std::move(diskAdaptor), offset, length, std::move(progressUpdate)));
+  }
+}
+
 ssize_t SocketBuffer::send()
 {
   a2iovec iov[A2_IOV_MAX];
@@ -136,27 +194,35 @@ ssize_t SocketBuffer::send()
     size_t bufqlen = bufq_.size();
     ssize_t amount = 24_k;
     ssize_t firstlen = bufq_.front()->getLength() - offset_;
-    amount -= firstlen;
-    iov[0].A2IOVEC_BASE = reinterpret_cast<char*>(
-        const_cast<unsigned char*>(bufq_.front()->getData() + offset_));
-    iov[0].A2IOVEC_LEN = firstlen;
-    num = 1;
-    for (auto i = std::begin(bufq_) + 1, eoi = std::end(bufq_);
-         i != eoi && num < A2_IOV_MAX && num < bufqlen && amount > 0;
-         ++i, ++num) {
-
-      ssize_t len = (*i)->getLength();
-
-      if (amount < len) {
-        break;
-      }
+    ssize_t slen;
+    if (!bufq_.front()->getData()) {
+      // The data are not in memory.  Let the entry send them.
+      num = 1;
+      slen = bufq_.front()->send(socket_, offset_);
+    }
+    else {
+      amount -= firstlen;
+      iov[0].A2IOVEC_BASE = reinterpret_cast<char*>(
+          const_cast<unsigned char*>(bufq_.front()->getData() + offset_));
+      iov[0].A2IOVEC_LEN = firstlen;
+      num = 1;
+      for (auto i = std::begin(bufq_) + 1, eoi = std::end(bufq_);
+           i != eoi && num < A2_IOV_MAX && num < bufqlen && amount > 0;
+           ++i, ++num) {
 
-      amount -= len;
-      iov[num].A2IOVEC_BASE =
-          reinterpret_cast<char*>(const_cast<unsigned char*>((*i)->getData()));
-      iov[num].A2IOVEC_LEN = len;
+        ssize_t len = (*i)->getLength();
+
+        if (amount < len || !(*i)->getData()) {
+          break;
+        }
+
+        amount -= len;
+        iov[num].A2IOVEC_BASE = reinterpret_cast<char*>(
+            const_cast<unsigned char*>((*i)->getData()));
+        iov[num].A2IOVEC_LEN = len;
+      }
+      slen = socket_->writeVector(iov, num);
     }
-    ssize_t slen = socket_->writeVector(iov, num);
     if (slen == 0 && !socket_->wantRead() && !socket_->wantWrite()) {
       throw DL_ABORT_EX(fmt(EX_SOCKET_SEND, "Connection closed."));
     }
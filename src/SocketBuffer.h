@@ -45,6 +45,7 @@
 namespace aria2 {
 
 class SocketCore;
+class DiskAdaptor;
 
 struct ProgressUpdate {
   virtual ~ProgressUpdate() = default;
@@ -105,6 +106,27 @@ private:
     std::string str_;
   };
 
+  // Refers to the data in the file managed by DiskAdaptor.  The data
+  // are not read into memory in advance.  They are sent by
+  // sendfile(2) if possible.
+  class FileBufEntry : public BufEntry {
+  public:
+    FileBufEntry(std::shared_ptr<DiskAdaptor> diskAdaptor, int64_t offset,
+                 size_t length, std::unique_ptr<ProgressUpdate> progressUpdate);
+    virtual ~FileBufEntry();
+    virtual ssize_t send(const std::shared_ptr<SocketCore>& socket,
+                         size_t offset) CXX11_OVERRIDE;
+    virtual bool final(size_t offset) const CXX11_OVERRIDE;
+    virtual size_t getLength() const CXX11_OVERRIDE;
+    // Returns nullptr because the data are not in memory.
+    virtual const unsigned char* getData() const CXX11_OVERRIDE;
+
+  private:
+    std::shared_ptr<DiskAdaptor> diskAdaptor_;
+    int64_t offset_;
+    size_t length_;
+  };
+
   std::shared_ptr<SocketCore> socket_;
 
   std::deque<std::unique_ptr<BufEntry>> bufq_;
@@ -137,6 +159,15 @@ public:
   void pushStr(std::string data,
                std::unique_ptr<ProgressUpdate> progressUpdate = nullptr);
 
+  // Feeds |length| bytes of data at |offset| in |diskAdaptor| into
+  // queue. This function doesn't read nor send data.  The data must
+  // not be changed until they are sent.  If progressUpdate is not
+  // null, its update() function will be called each time the data is
+  // sent. It will be deleted by this object. It can be null.
+  void pushFile(std::shared_ptr<DiskAdaptor> diskAdaptor, int64_t offset,
+                size_t length,
+                std::unique_ptr<ProgressUpdate> progressUpdate = nullptr);
+
   // Sends data in queue.  Returns the number of bytes sent.
   ssize_t send();
 
@@ -42,6 +42,9 @@
 #ifdef HAVE_IFADDRS_H
 #  include <ifaddrs.h>
 #endif // HAVE_IFADDRS_H
+#ifdef HAVE_SENDFILE
+#  include <sys/sendfile.h>
+#endif // HAVE_SENDFILE
 
 #include <cerrno>
 #include <cstring>
@@ -838,6 +841,35 @@ ssize_t SocketCore::writeData(const void* data, size_t len)
   return ret;
 }
 
+ssize_t SocketCore::writeFile(int fd, int64_t offset, size_t len)
+{
+  wantRead_ = false;
+  wantWrite_ = false;
+#ifdef HAVE_SENDFILE
+  if (secure_ || fd < 0) {
+    return -1;
+  }
+  ssize_t ret;
+  a2_off_t off = offset;
+  while ((ret = a2sendfile(sockfd_, fd, &off, len)) == -1 && errno == EINTR)
+    ;
+  int errNum = errno;
+  if (ret == -1) {
+    if (errNum == EINVAL || errNum == ENOSYS) {
+      return -1;
+    }
+    if (!A2_WOULDBLOCK(errNum)) {
+      throw DL_RETRY_EX(fmt(EX_SOCKET_SEND, errorMsg(errNum).c_str()));
+    }
+    wantWrite_ = true;
+    ret = 0;
+  }
+  return ret;
+#else  // !HAVE_SENDFILE
+  return -1;
+#endif // !HAVE_SENDFILE
+}
+
 void SocketCore::readData(void* data, size_t& len)
 {
   ssize_t ret = 0;
@@ -1252,6 +1284,153 @@ ssize_t SocketCore::readDataFrom(void* data, size_t len, Endpoint& sender)
   return r;
 }
 
+#if defined(HAVE_RECVMMSG) || defined(HAVE_SENDMMSG)
+namespace {
+// The maximum number of datagrams passed to recvmmsg(2) and
+// sendmmsg(2) in one call.
+constexpr size_t MAX_MMSG = 64;
+} // namespace
+#endif // HAVE_RECVMMSG || HAVE_SENDMMSG
+
+size_t SocketCore::readDataFrom(Datagram* msgs, size_t n)
+{
+#ifdef HAVE_RECVMMSG
+  wantRead_ = false;
+  wantWrite_ = false;
+  n = std::min(n, MAX_MMSG);
+  std::array<mmsghdr, MAX_MMSG> hdrs;
+  std::array<iovec, MAX_MMSG> iov;
+  std::array<sockaddr_union, MAX_MMSG> addrs;
+  for (size_t i = 0; i < n; ++i) {
+    iov[i].iov_base = msgs[i].data;
+    iov[i].iov_len = msgs[i].length;
+    memset(&hdrs[i], 0, sizeof(hdrs[i]));
+    hdrs[i].msg_hdr.msg_name = &addrs[i].sa;
+    hdrs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+    hdrs[i].msg_hdr.msg_iov = &iov[i];
+    hdrs[i].msg_hdr.msg_iovlen = 1;
+  }
+  int r;
+  while ((r = recvmmsg(sockfd_, hdrs.data(), n, 0, nullptr)) == -1 &&
+         A2_EINTR == SOCKET_ERRNO)
+    ;
+  int errNum = SOCKET_ERRNO;
+  if (r == -1) {
+    if (!A2_WOULDBLOCK(errNum)) {
+      throw DL_RETRY_EX(fmt(EX_SOCKET_RECV, errorMsg(errNum).c_str()));
+    }
+    wantRead_ = true;
+    return 0;
+  }
+  for (int i = 0; i < r; ++i) {
+    msgs[i].length = hdrs[i].msg_len;
+    msgs[i].endpoint =
+        util::getNumericNameInfo(&addrs[i].sa, hdrs[i].msg_hdr.msg_namelen);
+  }
+  return r;
+#else  // !HAVE_RECVMMSG
+  size_t i = 0;
+  try {
+    for (; i < n; ++i) {
+      ssize_t r = readDataFrom(msgs[i].data, msgs[i].length, msgs[i].endpoint);
+      if (wantRead_) {
+        break;
+      }
+      msgs[i].length = r;
+    }
+  }
+  catch (RecoverableException& e) {
+    if (i == 0) {
+      throw;
+    }
+  }
+  wantRead_ = i == 0 && wantRead_;
+  return i;
+#endif // !HAVE_RECVMMSG
+}
+
+size_t SocketCore::writeData(const Datagram* msgs, size_t n)
+{
+#ifdef HAVE_SENDMMSG
+  wantRead_ = false;
+  wantWrite_ = false;
+  n = std::min(n, MAX_MMSG);
+  std::array<mmsghdr, MAX_MMSG> hdrs;
+  std::array<iovec, MAX_MMSG> iov;
+  std::array<SockAddr, MAX_MMSG> addrs;
+  for (size_t i = 0; i < n; ++i) {
+    memset(&hdrs[i], 0, sizeof(hdrs[i]));
+    const auto& endpoint = msgs[i].endpoint;
+    // Each endpoint is resolved only once in a batch.  For example,
+    // the requests to a UDP tracker are often sent together.
+    size_t j = 0;
+    for (; j < i && (msgs[j].endpoint.port != endpoint.port ||
+                     msgs[j].endpoint.addr != endpoint.addr);
+         ++j)
+      ;
+    if (j < i) {
+      hdrs[i].msg_hdr.msg_name = hdrs[j].msg_hdr.msg_name;
+      hdrs[i].msg_hdr.msg_namelen = hdrs[j].msg_hdr.msg_namelen;
+    }
+    else {
+      struct addrinfo* res;
+      int s = callGetaddrinfo(&res, endpoint.addr.c_str(),
+                              util::uitos(endpoint.port).c_str(),
+                              protocolFamily_, sockType_, 0, 0);
+      if (s) {
+        if (i == 0) {
+          throw DL_ABORT_EX(fmt(EX_SOCKET_SEND, gai_strerror(s)));
+        }
+        // Send the datagrams before this one now.  This one is
+        // reported to the caller in the next call.
+        n = i;
+        break;
+      }
+      memcpy(&addrs[i].su, res->ai_addr, res->ai_addrlen);
+      addrs[i].suLength = res->ai_addrlen;
+      freeaddrinfo(res);
+      hdrs[i].msg_hdr.msg_name = &addrs[i].su.sa;
+      hdrs[i].msg_hdr.msg_namelen = addrs[i].suLength;
+    }
+    iov[i].iov_base = msgs[i].data;
+    iov[i].iov_len = msgs[i].length;
+    hdrs[i].msg_hdr.msg_iov = &iov[i];
+    hdrs[i].msg_hdr.msg_iovlen = 1;
+  }
+  int r;
+  while ((r = sendmmsg(sockfd_, hdrs.data(), n, 0)) == -1 &&
+         A2_EINTR == SOCKET_ERRNO)
+    ;
+  int errNum = SOCKET_ERRNO;
+  if (r == -1) {
+    if (!A2_WOULDBLOCK(errNum)) {
+      throw DL_ABORT_EX(fmt(EX_SOCKET_SEND, errorMsg(errNum).c_str()));
+    }
+    wantWrite_ = true;
+    return 0;
+  }
+  return r;
+#else  // !HAVE_SENDMMSG
+  size_t i = 0;
+  try {
+    for (; i < n; ++i) {
+      writeData(msgs[i].data, msgs[i].length, msgs[i].endpoint.addr,
+                msgs[i].endpoint.port);
+      if (wantWrite_) {
+        break;
+      }
+    }
+  }
+  catch (RecoverableException& e) {
+    if (i == 0) {
+      throw;
+    }
+  }
+  wantWrite_ = i == 0 && wantWrite_;
+  return i;
+#endif // !HAVE_SENDMMSG
+}
+
 std::string SocketCore::getSocketError() const
 {
   int error;
@@ -262,8 +262,23 @@ public:
   ssize_t writeData(const void* data, size_t len, const std::string& host,
                     uint16_t port);
 
+  // Sends at most |n| datagrams at once, using sendmmsg(2) if
+  // available.  Returns the number of datagrams sent, which may be
+  // less than |n|.  If underlying socket gets EAGAIN before sending
+  // anything, wantWrite_ is set and 0 is returned.  Throws exception
+  // only if the first datagram cannot be sent.
+  size_t writeData(const Datagram* msgs, size_t n);
+
   ssize_t writeVector(a2iovec* iov, size_t iovcnt);
 
+  // Sends at most |len| bytes of the file |fd| starting at |offset|
+  // without copying them to the user space.  Returns the number of
+  // bytes sent.  If underlying socket gets EAGAIN, wantWrite_ is set
+  // and 0 is returned.  If the data cannot be sent this way, for
+  // example, because TLS is used or the file does not support it,
+  // returns -1 and the caller should send the data with writeData().
+  ssize_t writeFile(int fd, int64_t offset, size_t len);
+
   /**
    * Reads up to len bytes from this socket.
    * data is a pointer pointing the first
@@ -285,6 +300,15 @@ public:
   // sender.addr will be numerihost assigned.
   ssize_t readDataFrom(void* data, size_t len, Endpoint& sender);
 
+  // Receives at most |n| datagrams at once, using recvmmsg(2) if
+  // available.  The data and length fields of each element of |msgs|
+  // must be set to the buffer and its capacity.  For each received
+  // datagram, length is replaced by the received length and endpoint
+  // is set to the numeric address of the sender.  Returns the number
+  // of datagrams received.  If underlying socket gets EAGAIN before
+  // receiving anything, wantRead_ is set and 0 is returned.
+  size_t readDataFrom(Datagram* msgs, size_t n);
+
 #ifdef ENABLE_SSL
   // Performs TLS server side handshake. If handshake is completed,
   // returns true. If handshake has not been done yet, returns false.
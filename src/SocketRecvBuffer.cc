@@ -35,6 +35,7 @@
 #include "SocketRecvBuffer.h"
 
 #include <cstring>
+#include <algorithm>
 #include <cassert>
 
 #include "SocketCore.h"
@@ -49,9 +50,9 @@ SocketRecvBuffer::SocketRecvBuffer(std::shared_ptr<SocketCore> socket)
 
 SocketRecvBuffer::~SocketRecvBuffer() = default;
 
-ssize_t SocketRecvBuffer::recv()
+ssize_t SocketRecvBuffer::recv(size_t max)
 {
-  size_t n = std::end(buf_) - last_;
+  size_t n = std::min(static_cast<size_t>(std::end(buf_) - last_), max);
   if (n == 0) {
     A2_LOG_DEBUG("Buffer full");
     return 0;
@@ -39,6 +39,7 @@
 
 #include <memory>
 #include <array>
+#include <limits>
 
 #include "a2functional.h"
 
@@ -50,9 +51,9 @@ class SocketRecvBuffer {
 public:
   SocketRecvBuffer(std::shared_ptr<SocketCore> socket);
   ~SocketRecvBuffer();
-  // Reads data from socket as much as capacity allows. Returns the
-  // number of bytes read.
-  ssize_t recv();
+  // Reads data from socket as much as capacity allows, but at most
+  // |max| bytes. Returns the number of bytes read.
+  ssize_t recv(size_t max = std::numeric_limits<size_t>::max());
   // Truncates the contents of buffer to 0.
   void truncateBuffer();
   // Drains first n bytes of data from buffer.  It is an programmer's
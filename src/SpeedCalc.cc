@@ -35,96 +35,150 @@
 #include "SpeedCalc.h"
 
 #include <algorithm>
-#include <functional>
 
 #include "wallclock.h"
 
 namespace aria2 {
 
+const int SpeedCalc::WINDOW_SECONDS;
+
 namespace {
-constexpr auto WINDOW_TIME = 10_s;
+// A slot holds the second, modulo 2**SECOND_BITS, in the upper bits
+// and the number of bytes counted in that second in the rest, so that
+// both are updated together by one compare-and-swap.
+constexpr int SECOND_BITS = 24;
+constexpr int BYTES_BITS = 64 - SECOND_BITS;
+constexpr uint64_t SECOND_MASK = (1ULL << SECOND_BITS) - 1;
+constexpr uint64_t BYTES_MASK = (1ULL << BYTES_BITS) - 1;
+
+int64_t toMillis(const Timer& t)
+{
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             t.getTime().time_since_epoch())
+      .count();
+}
+
+uint64_t slotSecond(uint64_t slot) { return slot >> BYTES_BITS; }
+
+uint64_t slotBytes(uint64_t slot) { return slot & BYTES_MASK; }
+
+uint64_t makeSlot(uint64_t second, uint64_t bytes)
+{
+  return ((second & SECOND_MASK) << BYTES_BITS) | bytes;
+}
 } // namespace
 
-SpeedCalc::SpeedCalc() : accumulatedLength_(0), bytesWindow_(0), maxSpeed_(0) {}
+SpeedCalc::SpeedCalc()
+    : slots_{}, firstSamples_{}, accumulatedLength_(0), maxSpeed_(0)
+{
+}
 
 void SpeedCalc::reset()
 {
-  timeSlots_.clear();
+  for (auto& slot : slots_) {
+    slot.store(0, std::memory_order_relaxed);
+  }
+  for (auto& first : firstSamples_) {
+    first.store(0, std::memory_order_relaxed);
+  }
   start_ = global::wallclock();
-  accumulatedLength_ = 0;
-  bytesWindow_ = 0;
+  accumulatedLength_.store(0, std::memory_order_relaxed);
   maxSpeed_ = 0;
 }
 
-void SpeedCalc::removeStaleTimeSlot(const Timer& now)
+int64_t SpeedCalc::sumBytes(int seconds, const Timer& now,
+                            int64_t& elapsed) const
 {
-  while (!timeSlots_.empty()) {
-    if (timeSlots_[0].first.difference(now) <= WINDOW_TIME) {
+  auto nowMillis = toMillis(now);
+  auto nowSecond = nowMillis / 1000;
+  int64_t bytes = 0;
+  int64_t oldest = -1;
+  for (int i = 0; i < seconds; ++i) {
+    auto second = nowSecond - i;
+    if (second < 0) {
       break;
     }
-    bytesWindow_ -= timeSlots_[0].second;
-    timeSlots_.pop_front();
+    auto slot = slots_[second % slots_.size()].load(std::memory_order_relaxed);
+    auto n = slotBytes(slot);
+    if (n == 0 ||
+        slotSecond(slot) != (static_cast<uint64_t>(second) & SECOND_MASK)) {
+      continue;
+    }
+    bytes += n;
+    oldest = second;
+  }
+  if (oldest == -1) {
+    elapsed = 0;
+    return 0;
+  }
+  auto first =
+      firstSamples_[oldest % slots_.size()].load(std::memory_order_relaxed);
+  // update() may not have stored the time of the first sample yet.
+  if (first / 1000 != oldest) {
+    first = oldest * 1000;
   }
+  elapsed = std::max(nowMillis - first, static_cast<int64_t>(1));
+  return bytes;
 }
 
 int SpeedCalc::calculateSpeed()
 {
-  const auto& now = global::wallclock();
-  removeStaleTimeSlot(now);
-  if (timeSlots_.empty()) {
+  return calculateSpeed(global::wallclock());
+}
+
+int SpeedCalc::calculateSpeed(const Timer& now)
+{
+  int64_t elapsed;
+  auto bytes = sumBytes(WINDOW_SECONDS, now, elapsed);
+  if (bytes == 0) {
     return 0;
   }
-  auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
-                     timeSlots_[0].first.difference(now))
-                     .count();
-  if (elapsed <= 0) {
-    elapsed = 1;
-  }
-  int speed = bytesWindow_ * 1000 / elapsed;
+  int speed = bytes * 1000 / elapsed;
   maxSpeed_ = std::max(speed, maxSpeed_);
   return speed;
 }
 
 int SpeedCalc::calculateNewestSpeed(int seconds)
 {
-  const auto& now = global::wallclock();
-  removeStaleTimeSlot(now);
+  return calculateNewestSpeed(seconds, global::wallclock());
+}
 
-  int64_t bytesCount(0);
-  auto it = timeSlots_.rbegin();
-  while (it != timeSlots_.rend()) {
-    if (it->first.difference(now) > seconds * 1_s) {
-      break;
-    }
-    bytesCount += (*it++).second;
-  }
-  if (it == timeSlots_.rbegin()) {
+int SpeedCalc::calculateNewestSpeed(int seconds, const Timer& now)
+{
+  int64_t elapsed;
+  auto bytes = sumBytes(std::min(seconds, WINDOW_SECONDS), now, elapsed);
+  if (bytes == 0) {
     return 0;
   }
-
-  auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
-                     (*--it).first.difference(now))
-                     .count();
-  if (elapsed <= 0) {
-    elapsed = 1;
-  }
-  return bytesCount * (1000. / elapsed);
+  return bytes * 1000 / elapsed;
 }
 
-void SpeedCalc::update(size_t bytes)
+void SpeedCalc::update(size_t bytes) { update(bytes, global::wallclock()); }
+
+void SpeedCalc::update(size_t bytes, const Timer& now)
 {
-  const auto& now = global::wallclock();
-  removeStaleTimeSlot(now);
-  if (timeSlots_.empty() ||
-      std::chrono::duration_cast<std::chrono::seconds>(
-          timeSlots_.back().first.difference(now)) >= 1_s) {
-    timeSlots_.push_back(std::make_pair(now, bytes));
-  }
-  else {
-    timeSlots_.back().second += bytes;
+  auto nowMillis = toMillis(now);
+  auto second = static_cast<uint64_t>(nowMillis / 1000);
+  auto& slot = slots_[second % slots_.size()];
+  auto cur = slot.load(std::memory_order_relaxed);
+  uint64_t next;
+  bool started;
+  do {
+    started = slotSecond(cur) != (second & SECOND_MASK);
+    if (!started) {
+      next = cur + bytes;
+    }
+    else {
+      // The slot holds the bytes of WINDOW_SECONDS + 1 seconds ago or
+      // earlier.  Start over.
+      next = makeSlot(second, bytes);
+    }
+  } while (!slot.compare_exchange_weak(cur, next, std::memory_order_relaxed));
+  if (started) {
+    firstSamples_[second % slots_.size()].store(nowMillis,
+                                                std::memory_order_relaxed);
   }
-  bytesWindow_ += bytes;
-  accumulatedLength_ += bytes;
+  accumulatedLength_.fetch_add(bytes, std::memory_order_relaxed);
 }
 
 int SpeedCalc::calculateAvgSpeed() const
@@ -135,7 +189,8 @@ int SpeedCalc::calculateAvgSpeed() const
   // if milliElapsed is too small, the average speed is rubbish, better
   // return 0
   if (milliElapsed > 4) {
-    int speed = accumulatedLength_ * 1000 / milliElapsed;
+    int speed = accumulatedLength_.load(std::memory_order_relaxed) * 1000 /
+                milliElapsed;
     return speed;
   }
   else {
@@ -37,21 +37,41 @@
 
 #include "common.h"
 
-#include <deque>
+#include <array>
+#include <atomic>
 
 #include "TimerA2.h"
 
 namespace aria2 {
 
+// Calculates transfer speed over the last WINDOW_SECONDS seconds.
+// Bytes are counted in a ring of per second slots, so that neither
+// update() nor calculateSpeed() allocates memory or takes time
+// proportional to the number of updates.  update() only touches
+// atomic variables and may be called from any thread, but the
+// overloads without a time argument read global::wallclock(), which
+// only the main thread may do.  Worker threads pass a live clock,
+// Timer(), to update(bytes, now).  The other functions must be called
+// from the main thread.
 class SpeedCalc {
+public:
+  static const int WINDOW_SECONDS = 10;
+
 private:
-  std::deque<std::pair<Timer, size_t>> timeSlots_;
+  // Each slot packs a second and the number of bytes counted in that
+  // second.
+  std::array<std::atomic<uint64_t>, WINDOW_SECONDS + 1> slots_;
+  // The time, in milliseconds, of the first update counted in each
+  // slot.
+  std::array<std::atomic<int64_t>, WINDOW_SECONDS + 1> firstSamples_;
   Timer start_;
-  int64_t accumulatedLength_;
-  int64_t bytesWindow_;
+  std::atomic<int64_t> accumulatedLength_;
   int maxSpeed_;
 
-  void removeStaleTimeSlot(const Timer& now);
+  // Sums up the bytes counted in the last |seconds| seconds
+  // including the current one, and stores the elapsed time since the
+  // first update counted in them in |elapsed| in milliseconds.
+  int64_t sumBytes(int seconds, const Timer& now, int64_t& elapsed) const;
 
 public:
   SpeedCalc();
@@ -60,14 +80,17 @@ public:
    * Returns download/upload speed in byte per sec
    */
   int calculateSpeed();
+  int calculateSpeed(const Timer& now);
 
   int calculateNewestSpeed(int seconds);
+  int calculateNewestSpeed(int seconds, const Timer& now);
 
   int getMaxSpeed() const { return maxSpeed_; }
 
   int calculateAvgSpeed() const;
 
   void update(size_t bytes);
+  void update(size_t bytes, const Timer& now);
 
   void reset();
 };
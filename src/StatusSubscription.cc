@@ -0,0 +1,300 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2018 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#include "StatusSubscription.h"
+
+#include <algorithm>
+#include <functional>
+
+#include "DownloadEngine.h"
+#include "RequestGroupMan.h"
+#include "RequestGroup.h"
+#include "DownloadContext.h"
+#include "CheckIntegrityMan.h"
+#include "CheckIntegrityEntry.h"
+#include "StructWriter.h"
+#include "JsonStructWriter.h"
+#include "RpcMethodImpl.h"
+#include "json.h"
+
+namespace aria2 {
+
+namespace rpc {
+
+namespace {
+// StructWriter which receives the members of the status of a
+// download.  The hash of the JSON text of each member is compared
+// with the last one in |fields|, and the changed members are appended
+// to |out| as ,"key":value.  "gid" is not reported since the caller
+// writes it.
+class DeltaWriter : public StructWriter {
+public:
+  DeltaWriter(std::vector<StatusSubscription::Field>& fields,
+              std::string& out)
+      : fields_(fields),
+        out_(out),
+        json_(value_),
+        depth_(0),
+        next_(0),
+        changed_(false)
+  {
+    for (auto& field : fields_) {
+      field.written = false;
+    }
+  }
+
+  virtual void beginDict() CXX11_OVERRIDE
+  {
+    ++depth_;
+    json_.beginDict();
+  }
+
+  virtual void endDict() CXX11_OVERRIDE
+  {
+    --depth_;
+    json_.endDict();
+  }
+
+  virtual void beginList() CXX11_OVERRIDE
+  {
+    ++depth_;
+    json_.beginList();
+  }
+
+  virtual void endList() CXX11_OVERRIDE
+  {
+    --depth_;
+    json_.endList();
+  }
+
+  virtual void key(const std::string& k) CXX11_OVERRIDE
+  {
+    if (depth_ == 0) {
+      commit();
+      key_ = k;
+    }
+    else {
+      json_.key(k);
+    }
+  }
+
+  virtual void value(const std::string& s) CXX11_OVERRIDE { json_.value(s); }
+
+  virtual void value(int64_t i) CXX11_OVERRIDE { json_.value(i); }
+
+  // Commits the last member, and reports the members which were not
+  // written this time as null.  Returns true if any member changed.
+  bool finish()
+  {
+    commit();
+    for (auto i = std::begin(fields_); i != std::end(fields_);) {
+      if ((*i).written) {
+        ++i;
+        continue;
+      }
+      appendKey((*i).key);
+      out_ += "null";
+      changed_ = true;
+      i = fields_.erase(i);
+    }
+    return changed_;
+  }
+
+private:
+  void appendKey(const std::string& k)
+  {
+    out_ += ",\"";
+    json::jsonEscape(out_, k);
+    out_ += "\":";
+  }
+
+  void commit()
+  {
+    if (key_.empty()) {
+      return;
+    }
+    if (key_ != "gid") {
+      // The members are written in the same order every time, so
+      // the next field is likely the one.
+      size_t i = next_;
+      if (i >= fields_.size() || fields_[i].key != key_) {
+        i = std::find_if(std::begin(fields_), std::end(fields_),
+                         [this](const StatusSubscription::Field& field) {
+                           return field.key == key_;
+                         }) -
+            std::begin(fields_);
+      }
+      auto hash = std::hash<std::string>()(value_);
+      if (i == fields_.size()) {
+        // ~hash never equals hash, so the new field is reported.
+        fields_.push_back({key_, ~hash, false});
+      }
+      auto& field = fields_[i];
+      field.written = true;
+      next_ = i + 1;
+      if (field.hash != hash) {
+        field.hash = hash;
+        appendKey(field.key);
+        out_ += value_;
+        changed_ = true;
+      }
+    }
+    key_.clear();
+    value_.clear();
+  }
+
+  std::vector<StatusSubscription::Field>& fields_;
+  std::string& out_;
+  std::string key_;
+  // JSON text of the current member
+  std::string value_;
+  json::JsonStructWriter json_;
+  int depth_;
+  size_t next_;
+  bool changed_;
+};
+// Returns true if |group| is transferring data or being verified.
+// Its status changes without updating its status version then.
+bool isBusy(const std::shared_ptr<RequestGroup>& group, DownloadEngine* e)
+{
+  auto& netStat = group->getDownloadContext()->getNetStat();
+  if (netStat.calculateDownloadSpeed() > 0 ||
+      netStat.calculateUploadSpeed() > 0) {
+    return true;
+  }
+  auto& checkIntegrityMan = e->getCheckIntegrityMan();
+  return checkIntegrityMan &&
+         checkIntegrityMan->findPickedEntry(
+             [&group](const CheckIntegrityEntry& ent) {
+               return ent.getRequestGroup() == group.get();
+             });
+}
+} // namespace
+
+StatusSubscription::StatusSubscription(std::vector<std::string> keys)
+    : keys_(std::move(keys)), round_(0), lastStatusVersion_(0)
+{
+}
+
+StatusSubscription::~StatusSubscription() = default;
+
+std::string StatusSubscription::createNotification(DownloadEngine* e)
+{
+  ++round_;
+  auto lastStatusVersion = RequestGroup::getLastStatusVersion();
+  // The waiting downloads neither transfer data nor change the
+  // number of connections, so they need to be visited only when the
+  // status version of some download changed.  This also covers the
+  // downloads added or removed since the last time.
+  auto all = round_ == 1 || lastStatusVersion_ != lastStatusVersion;
+  lastStatusVersion_ = lastStatusVersion;
+  std::string changed;
+  auto& rgman = e->getRequestGroupMan();
+  for (auto groups :
+       {&rgman->getRequestGroups(), &rgman->getReservedGroups()}) {
+    if (!all && groups == &rgman->getReservedGroups()) {
+      break;
+    }
+    for (auto& group : *groups) {
+      auto gid = group->getGID();
+      auto r = entries_.emplace(gid, Entry());
+      auto& entry = (*r.first).second;
+      entry.round = round_;
+      auto statusVersion = group->getStatusVersion();
+      auto numConnection = group->getNumConnection();
+      // Only active downloads transfer data or are verified.
+      auto busy = group->getState() == RequestGroup::STATE_ACTIVE &&
+                  isBusy(group, e);
+      // A download which has just stopped transferring is gathered
+      // once more, so that its speed drops to 0.
+      if (!r.second && entry.statusVersion == statusVersion &&
+          entry.numConnection == numConnection && !entry.busy && !busy) {
+        continue;
+      }
+      entry.statusVersion = statusVersion;
+      entry.numConnection = numConnection;
+      entry.busy = busy;
+      auto mark = changed.size();
+      if (!changed.empty()) {
+        changed += ',';
+      }
+      changed += "{\"gid\":\"";
+      changed += GroupId::toHex(gid);
+      changed += '"';
+      DeltaWriter writer(entry.fields, changed);
+      gatherRequestGroupStatus(writer, group, e, keys_);
+      // A new download is reported even if it has no field other
+      // than "gid".
+      if (writer.finish() || r.second) {
+        changed += '}';
+      }
+      else {
+        changed.resize(mark);
+      }
+    }
+  }
+  std::string removed;
+  // Without visiting the waiting downloads, it is unknown which
+  // downloads were removed, but nothing was removed then.
+  if (all) {
+    for (auto i = std::begin(entries_); i != std::end(entries_);) {
+      if ((*i).second.round == round_) {
+        ++i;
+        continue;
+      }
+      if (!removed.empty()) {
+        removed += ',';
+      }
+      removed += '"';
+      removed += GroupId::toHex((*i).first);
+      removed += '"';
+      i = entries_.erase(i);
+    }
+  }
+  if (changed.empty() && removed.empty()) {
+    return "";
+  }
+  std::string res = "{\"jsonrpc\":\"2.0\","
+                    "\"method\":\"aria2.onStatusChange\","
+                    "\"params\":[{\"changed\":[";
+  res += changed;
+  res += "],\"removed\":[";
+  res += removed;
+  res += "]}]}";
+  return res;
+}
+
+} // namespace rpc
+
+} // namespace aria2
@@ -0,0 +1,115 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2018 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#ifndef D_STATUS_SUBSCRIPTION_H
+#define D_STATUS_SUBSCRIPTION_H
+
+#include "common.h"
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include "GroupId.h"
+
+namespace aria2 {
+
+class DownloadEngine;
+
+namespace rpc {
+
+// Tracks the status of active and waiting downloads for a client
+// which called aria2.subscribeStatus, and creates
+// aria2.onStatusChange notification which contains only the fields
+// changed since the last one.  The notification looks like:
+//
+//   {"jsonrpc":"2.0","method":"aria2.onStatusChange",
+//    "params":[{"changed":[{"gid":"2089b05ecca3d829",
+//                           "completedLength":"34896138"}],
+//               "removed":["d2703803b52216d1"]}]}
+//
+// The status is gathered only for the downloads whose status version
+// (see RequestGroup::getStatusVersion()) or number of connections
+// changed, or which transfer data or are verified.  The waiting
+// downloads are not visited at all unless the status version of some
+// download changed.  Each gathered field is compared with the hash
+// of its last value, and only the changed fields are reported.  The
+// first notification for a download contains all fields, and a field
+// which is no longer available is reported as null.  "removed" has
+// the GIDs of the downloads which are neither active nor waiting
+// anymore.
+class StatusSubscription {
+public:
+  // |keys| are the keys to report, same as the keys parameter of
+  // aria2.tellStatus.  If it is empty, all keys are reported.  "gid"
+  // is always reported.
+  explicit StatusSubscription(std::vector<std::string> keys);
+
+  ~StatusSubscription();
+
+  // Returns aria2.onStatusChange notification for the changes since
+  // the last call, or empty string if nothing has changed.
+  std::string createNotification(DownloadEngine* e);
+
+  struct Field {
+    std::string key;
+    // The hash of the value in JSON text.
+    size_t hash;
+    bool written;
+  };
+
+private:
+  struct Entry {
+    std::vector<Field> fields;
+    uint64_t statusVersion;
+    int numConnection;
+    // True if the download was transferring data or being verified.
+    bool busy;
+    // The value of round_ when the download is seen last time.
+    uint64_t round;
+  };
+
+  std::vector<std::string> keys_;
+  std::unordered_map<a2_gid_t, Entry> entries_;
+  uint64_t round_;
+  // RequestGroup::getLastStatusVersion() when the waiting downloads
+  // were visited last time.
+  uint64_t lastStatusVersion_;
+};
+
+} // namespace rpc
+
+} // namespace aria2
+
+#endif // D_STATUS_SUBSCRIPTION_H
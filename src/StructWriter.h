@@ -0,0 +1,81 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2018 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#ifndef D_STRUCT_WRITER_H
+#define D_STRUCT_WRITER_H
+
+#include "common.h"
+
+#include <string>
+
+namespace aria2 {
+
+// Interface to write structured data (dicts, lists, strings and
+// integers) piece by piece.  Inside a dict, key() must be called
+// before each value.
+class StructWriter {
+public:
+  virtual ~StructWriter() = default;
+
+  virtual void beginDict() = 0;
+
+  virtual void endDict() = 0;
+
+  virtual void beginList() = 0;
+
+  virtual void endList() = 0;
+
+  // Sets the key of the next value in the current dict.
+  virtual void key(const std::string& k) = 0;
+
+  virtual void value(const std::string& s) = 0;
+
+  virtual void value(int64_t i) = 0;
+
+  void put(const std::string& k, const std::string& s)
+  {
+    key(k);
+    value(s);
+  }
+
+  void put(const std::string& k, int64_t i)
+  {
+    key(k);
+    value(i);
+  }
+};
+
+} // namespace aria2
+
+#endif // D_STRUCT_WRITER_H
@@ -0,0 +1,81 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2018 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#ifndef D_THREAD_POOL_H
+#define D_THREAD_POOL_H
+
+#include "common.h"
+
+#include <deque>
+#include <vector>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+
+namespace aria2 {
+
+// Fixed size pool of worker threads.  Submitted tasks are executed in
+// FIFO order.  Tasks run outside of DownloadEngine's thread, so they
+// must not touch objects shared with it unless they are protected by
+// other means.
+class ThreadPool {
+public:
+  explicit ThreadPool(size_t numThreads);
+
+  // Waits for the running tasks to finish and joins worker threads.
+  // Tasks which have not been started yet are discarded; their
+  // futures become ready with std::future_error.
+  ~ThreadPool();
+
+  // Queues |task|.  The returned future becomes ready when |task|
+  // returns or throws exception.
+  std::future<void> submit(std::function<void()> task);
+
+  size_t getNumThreads() const { return workers_.size(); }
+
+private:
+  void run();
+
+  std::vector<std::thread> workers_;
+  std::deque<std::packaged_task<void()>> tasks_;
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  bool stop_;
+};
+
+} // namespace aria2
+
+#endif // D_THREAD_POOL_H
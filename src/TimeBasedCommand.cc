@@ -73,6 +73,9 @@ bool TimeBasedCommand::execute()
     e_->addRoutineCommand(std::unique_ptr<Command>(this));
   }
   else {
+    auto deadline = checkPoint_;
+    deadline.advance(interval_);
+    e_->addTimer(deadline, this);
     e_->addCommand(std::unique_ptr<Command>(this));
   }
   return false;
@@ -0,0 +1,157 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2018 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#include "TimerWheel.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace aria2 {
+
+constexpr size_t TimerWheel::LEVEL_BITS;
+constexpr size_t TimerWheel::SLOTS;
+constexpr size_t TimerWheel::LEVELS;
+
+TimerWheel::TimerWheel(std::chrono::milliseconds tick, const Timer& origin)
+    : tick_(std::chrono::duration_cast<Timer::Clock::duration>(tick)),
+      origin_(origin),
+      current_(0),
+      size_(0)
+{
+}
+
+Timer::Clock::duration TimerWheel::elapsed(const Timer& t) const
+{
+  if (t <= origin_) {
+    return Timer::Clock::duration::zero();
+  }
+  return t.getTime() - origin_.getTime();
+}
+
+void TimerWheel::add(const Timer& deadline, Command* command)
+{
+  // Round up so that the entry never expires before deadline.
+  auto expiry = (elapsed(deadline).count() + tick_.count() - 1) /
+                tick_.count();
+  insert({static_cast<uint64_t>(expiry), command});
+  ++size_;
+}
+
+void TimerWheel::insert(Entry e)
+{
+  // Expired entries are processed in the next tick.
+  e.expiry = std::max(e.expiry, current_);
+  auto delta = e.expiry - current_;
+  constexpr uint64_t maxDelta = (1ULL << (LEVEL_BITS * LEVELS)) - 1;
+  if (delta > maxDelta) {
+    e.expiry = current_ + maxDelta;
+    delta = maxDelta;
+  }
+  size_t level = 0;
+  while (delta >> (LEVEL_BITS * (level + 1))) {
+    ++level;
+  }
+  auto index = (e.expiry >> (LEVEL_BITS * level)) & (SLOTS - 1);
+  wheel_[level][index].push_back(e);
+}
+
+size_t TimerWheel::cascade(size_t level, size_t index)
+{
+  std::vector<Entry> entries;
+  entries.swap(wheel_[level][index]);
+  for (auto& e : entries) {
+    insert(e);
+  }
+  return index;
+}
+
+void TimerWheel::expire(const Timer& now, std::vector<Command*>& commands)
+{
+  uint64_t nowTick = elapsed(now).count() / tick_.count();
+  while (current_ <= nowTick) {
+    if (size_ == 0) {
+      current_ = nowTick + 1;
+      break;
+    }
+    auto index = current_ & (SLOTS - 1);
+    for (size_t level = 1; index == 0 && level < LEVELS; ++level) {
+      index =
+          cascade(level, (current_ >> (LEVEL_BITS * level)) & (SLOTS - 1));
+    }
+    auto& slot = wheel_[0][current_ & (SLOTS - 1)];
+    for (auto& e : slot) {
+      commands.push_back(e.command);
+    }
+    size_ -= slot.size();
+    slot.clear();
+    ++current_;
+  }
+}
+
+std::chrono::milliseconds TimerWheel::nextTimeout(const Timer& now) const
+{
+  if (size_ == 0) {
+    return std::chrono::milliseconds::max();
+  }
+  auto next = std::numeric_limits<uint64_t>::max();
+  for (size_t i = 0; i < SLOTS; ++i) {
+    if (!wheel_[0][(current_ + i) & (SLOTS - 1)].empty()) {
+      next = current_ + i;
+      break;
+    }
+  }
+  for (size_t level = 1; level < LEVELS; ++level) {
+    auto shift = LEVEL_BITS * level;
+    auto base = current_ >> shift;
+    // The slot of the current block has already been cascaded, so
+    // start with the next one.
+    for (size_t i = 1; i <= SLOTS; ++i) {
+      if (!wheel_[level][(base + i) & (SLOTS - 1)].empty()) {
+        next = std::min(next, (base + i) << shift);
+        break;
+      }
+    }
+  }
+  auto deadline = tick_ * next;
+  auto d = elapsed(now);
+  if (deadline <= d) {
+    return std::chrono::milliseconds(0);
+  }
+  // Round up so that the caller does not wake up too early.
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+      deadline - d + std::chrono::milliseconds(1) -
+      Timer::Clock::duration(1));
+}
+
+} // namespace aria2
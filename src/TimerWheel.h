@@ -0,0 +1,114 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2018 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#ifndef D_TIMER_WHEEL_H
+#define D_TIMER_WHEEL_H
+
+#include "common.h"
+
+#include <array>
+#include <chrono>
+#include <vector>
+
+#include "TimerA2.h"
+
+namespace aria2 {
+
+class Command;
+
+// Hierarchical timing wheel which holds the deadlines of Commands.
+// Time is divided into ticks of the given length.  The wheel consists
+// of LEVELS levels of SLOTS slots each; a slot at level n covers
+// SLOTS^n ticks.  Entries in upper levels are cascaded into lower
+// levels when the wheel reaches their slot, so adding an entry and
+// expiring an entry are both O(1).  Deadlines are rounded up to the
+// next tick and never expire early, except for deadlines beyond the
+// range of the top level, which are clamped to it.
+class TimerWheel {
+public:
+  TimerWheel(std::chrono::milliseconds tick, const Timer& origin);
+
+  // Arranges that command is returned by expire() once deadline is
+  // reached.  The wheel does not own command and never dereferences
+  // it.
+  void add(const Timer& deadline, Command* command);
+
+  // Advances the wheel to now and appends the Commands whose
+  // deadlines have been reached to commands.
+  void expire(const Timer& now, std::vector<Command*>& commands);
+
+  // Returns the time from now until the wheel has to be advanced
+  // next.  This is the exact deadline of the earliest entry if it is
+  // in the lowest level; otherwise it is the time at which the
+  // earliest entry is cascaded.  Returns
+  // std::chrono::milliseconds::max() if the wheel is empty.
+  std::chrono::milliseconds nextTimeout(const Timer& now) const;
+
+  size_t size() const { return size_; }
+
+private:
+  static constexpr size_t LEVEL_BITS = 6;
+  static constexpr size_t SLOTS = 1 << LEVEL_BITS;
+  static constexpr size_t LEVELS = 4;
+
+  struct Entry {
+    uint64_t expiry;
+    Command* command;
+  };
+
+  // Returns the time elapsed from origin_ to t, or 0 if t is before
+  // origin_.
+  Timer::Clock::duration elapsed(const Timer& t) const;
+
+  void insert(Entry e);
+
+  // Moves the entries in the given slot at level to the lower levels
+  // and returns index.
+  size_t cascade(size_t level, size_t index);
+
+  Timer::Clock::duration tick_;
+
+  Timer origin_;
+
+  // The next tick to be processed.
+  uint64_t current_;
+
+  size_t size_;
+
+  std::array<std::array<std::vector<Entry>, SLOTS>, LEVELS> wheel_;
+};
+
+} // namespace aria2
+
+#endif // D_TIMER_WHEEL_H
@@ -0,0 +1,139 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2018 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#include "TokenBucket.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace aria2 {
+
+constexpr std::chrono::milliseconds TokenBucket::BURST_DURATION;
+const int64_t TokenBucket::MIN_AVAILABLE;
+
+TokenBucket::TokenBucket(int rate, TokenBucket* parent)
+    : parent_(parent), rate_(rate), tokens_(0), last_(Timer::zero())
+{
+}
+
+void TokenBucket::setRate(int rate)
+{
+  rate_ = rate;
+  tokens_ = 0;
+  last_ = Timer::zero();
+}
+
+int64_t TokenBucket::capacity() const
+{
+  return std::max(static_cast<int64_t>(rate_) * BURST_DURATION.count() / 1000,
+                  static_cast<int64_t>(1));
+}
+
+int64_t TokenBucket::threshold() const
+{
+  return std::min(capacity(), MIN_AVAILABLE);
+}
+
+void TokenBucket::refill(const Timer& now)
+{
+  using namespace std::chrono;
+  if (last_.isZero()) {
+    last_ = now;
+    return;
+  }
+  auto elapsed = duration_cast<microseconds>(last_.difference(now)).count();
+  if (elapsed >= 60000000) {
+    // Idle for a long time.  Don't let the multiplication below
+    // overflow.
+    tokens_ =
+        std::min(capacity(), tokens_ + static_cast<int64_t>(rate_) * 60);
+    last_ = now;
+    return;
+  }
+  auto n = static_cast<int64_t>(rate_) * elapsed / 1000000;
+  if (n == 0) {
+    return;
+  }
+  if (tokens_ + n >= capacity()) {
+    tokens_ = capacity();
+    last_ = now;
+    return;
+  }
+  tokens_ += n;
+  // Round up, so that the fraction of a token is not given twice.
+  last_.advance(microseconds((n * 1000000 + rate_ - 1) / rate_));
+}
+
+size_t TokenBucket::available(const Timer& now)
+{
+  auto n = std::numeric_limits<size_t>::max();
+  if (rate_ > 0) {
+    refill(now);
+    n = tokens_ >= threshold() ? tokens_ : 0;
+  }
+  if (parent_) {
+    n = std::min(n, parent_->available(now));
+  }
+  return n;
+}
+
+void TokenBucket::consume(size_t n, const Timer& now)
+{
+  if (rate_ > 0) {
+    refill(now);
+    tokens_ -= n;
+  }
+  if (parent_) {
+    parent_->consume(n, now);
+  }
+}
+
+std::chrono::milliseconds TokenBucket::timeToAvailable(const Timer& now)
+{
+  using namespace std::chrono;
+  milliseconds t(0);
+  if (rate_ > 0) {
+    refill(now);
+    if (tokens_ < threshold()) {
+      // Round up so that enough tokens are available then.
+      t = milliseconds(((threshold() - tokens_) * 1000 + rate_ - 1) / rate_);
+    }
+  }
+  if (parent_) {
+    t = std::max(t, parent_->timeToAvailable(now));
+  }
+  return t;
+}
+
+} // namespace aria2
@@ -0,0 +1,107 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2018 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#ifndef D_TOKEN_BUCKET_H
+#define D_TOKEN_BUCKET_H
+
+#include "common.h"
+
+#include <chrono>
+
+#include "TimerA2.h"
+#include "a2functional.h"
+
+namespace aria2 {
+
+// Limits the number of bytes transferred per second.  Tokens, each of
+// which permits 1 byte, accumulate at the rate up to the amount of
+// BURST_DURATION worth.  Transfers take tokens and may leave the
+// bucket in debt, which is paid back before further transfers are
+// permitted, so that the average rate is kept even if data come in
+// chunks.  To avoid waking up for a few bytes at a time, tokens are
+// made available only in units of MIN_AVAILABLE bytes, or the whole
+// bucket if it is smaller.  A bucket may have a parent: available()
+// is capped by the parent and consume() takes tokens from the parent
+// as well.  This is how the overall limit and the limit of each
+// download are applied together.
+class TokenBucket {
+public:
+  // The bucket holds at most this duration worth of tokens.
+  static constexpr std::chrono::milliseconds BURST_DURATION{100};
+
+  static const int64_t MIN_AVAILABLE = 16_k;
+
+  // rate is in bytes per second.  0 means unlimited.
+  explicit TokenBucket(int rate = 0, TokenBucket* parent = nullptr);
+
+  // Changes the rate.  Tokens accumulated so far are discarded.
+  void setRate(int rate);
+
+  int getRate() const { return rate_; }
+
+  void setParent(TokenBucket* parent) { parent_ = parent; }
+
+  TokenBucket* getParent() const { return parent_; }
+
+  // Returns the number of bytes which can be transferred at |now|.
+  // Returns std::numeric_limits<size_t>::max() if neither this bucket
+  // nor its parents limit the rate.
+  size_t available(const Timer& now);
+
+  // Takes |n| tokens from this bucket and its parents.
+  void consume(size_t n, const Timer& now);
+
+  // Returns the time from |now| until available() becomes nonzero.
+  std::chrono::milliseconds timeToAvailable(const Timer& now);
+
+private:
+  void refill(const Timer& now);
+
+  int64_t capacity() const;
+
+  // The number of tokens which must be accumulated before available()
+  // returns nonzero.
+  int64_t threshold() const;
+
+  TokenBucket* parent_;
+  int rate_;
+  // Negative if the bucket is in debt.
+  int64_t tokens_;
+  // The time up to which tokens have been added.
+  Timer last_;
+};
+
+} // namespace aria2
+
+#endif // D_TOKEN_BUCKET_H
@@ -67,6 +67,7 @@
 #include "UDPTrackerClient.h"
 #include "BtRegistry.h"
 #include "NameResolveCommand.h"
+#include "wallclock.h"
 
 namespace aria2 {
 
@@ -267,6 +268,12 @@ bool TrackerWatcherCommand::execute()
     return true;
   }
 
+  // The announce interval and the HTTP tracker request are checked
+  // once per second.  A UDP tracker response activates this command
+  // immediately.
+  auto deadline = global::wallclock();
+  deadline.advance(1_s);
+  e_->addTimer(deadline, this);
   e_->addCommand(std::unique_ptr<Command>(this));
   return false;
 }
@@ -368,6 +368,29 @@ void UDPTrackerClient::requestFail(int error)
   pendingRequests_.pop_front();
 }
 
+void UDPTrackerClient::requestFail(const std::string& remoteAddr,
+                                   uint16_t remotePort, int error)
+{
+  std::vector<std::shared_ptr<UDPTrackerRequest>> reqs;
+  inflightRequests_.erase(
+      std::remove_if(inflightRequests_.begin(), inflightRequests_.end(),
+                     CollectAddrPortMatch(reqs, remoteAddr, remotePort)),
+      inflightRequests_.end());
+  bool connect = false;
+  for (auto& req : reqs) {
+    A2_LOG_INFO(fmt("UDPT fail %s to %s:%u transaction_id=%08x",
+                    getUDPTrackerActionStr(req->action),
+                    req->remoteAddr.c_str(), req->remotePort,
+                    req->transactionId));
+    req->state = UDPT_STA_COMPLETE;
+    req->error = error;
+    connect |= req->action == UDPT_ACT_CONNECT;
+  }
+  if (connect) {
+    failConnect(remoteAddr, remotePort, error);
+  }
+}
+
 void UDPTrackerClient::addRequest(const std::shared_ptr<UDPTrackerRequest>& req)
 {
   req->state = UDPT_STA_PENDING;
@@ -375,13 +398,22 @@ void UDPTrackerClient::addRequest(const std::shared_ptr<UDPTrackerRequest>& req)
   pendingRequests_.push_back(req);
 }
 
+namespace {
+// Returns the time after which the inflight request |req| is resent
+// or failed.
+std::chrono::seconds getTimeout(const UDPTrackerRequest& req)
+{
+  return req.failCount == 0 ? 5_s : 10_s;
+}
+} // namespace
+
 namespace {
 struct TimeoutCheck {
   bool operator()(const std::shared_ptr<UDPTrackerRequest>& req) const
   {
     auto t = req->dispatched.difference(now);
     if (req->failCount == 0) {
-      if (t >= 5_s) {
+      if (t >= getTimeout(*req)) {
         switch (req->action) {
         case UDPT_ACT_CONNECT:
           A2_LOG_INFO(fmt("UDPT resend CONNECT to %s:%u transaction_id=%08x",
@@ -409,7 +441,7 @@ struct TimeoutCheck {
       }
     }
     else {
-      if (t >= 10_s) {
+      if (t >= getTimeout(*req)) {
         switch (req->action) {
         case UDPT_ACT_CONNECT:
           A2_LOG_INFO(fmt("UDPT timeout CONNECT to %s:%u transaction_id=%08x",
@@ -461,6 +493,20 @@ void UDPTrackerClient::handleTimeout(const Timer& now)
   pendingRequests_.insert(pendingRequests_.begin(), dest.begin(), dest.end());
 }
 
+bool UDPTrackerClient::getNextDeadline(Timer& deadline) const
+{
+  bool found = false;
+  for (auto& req : inflightRequests_) {
+    auto t = req->dispatched;
+    t.advance(getTimeout(*req));
+    if (!found || t < deadline) {
+      deadline = t;
+      found = true;
+    }
+  }
+  return found;
+}
+
 std::shared_ptr<UDPTrackerRequest>
 UDPTrackerClient::findInflightRequest(const std::string& remoteAddr,
                                       uint16_t remotePort,
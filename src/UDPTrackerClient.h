@@ -93,12 +93,22 @@ public:
   // Tells this object that first entry of pendingRequests_ is not
   // successfully sent. The |error| should indicate error situation.
   void requestFail(int error);
+  // Tells this object that the requests to remoteAddr:remotePort,
+  // which requestSent() was called for, were not actually sent.  This
+  // is used when the data are queued and sent later.
+  void requestFail(const std::string& remoteAddr, uint16_t remotePort,
+                   int error);
 
   void addRequest(const std::shared_ptr<UDPTrackerRequest>& req);
 
   // Handles timeout for inflight requests.
   void handleTimeout(const Timer& now);
 
+  // Stores the earliest time when handleTimeout() resends or fails an
+  // inflight request in |deadline|.  Returns false if there is no
+  // inflight request.
+  bool getNextDeadline(Timer& deadline) const;
+
   const std::deque<std::shared_ptr<UDPTrackerRequest>>&
   getPendingRequests() const
   {
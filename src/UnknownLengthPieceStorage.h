@@ -216,6 +216,8 @@ public:
 
   virtual WrDiskCache* getWrDiskCache() CXX11_OVERRIDE { return nullptr; }
 
+  virtual RdDiskCache* getRdDiskCache() CXX11_OVERRIDE { return nullptr; }
+
   virtual void flushWrDiskCacheEntry() CXX11_OVERRIDE {}
 
   virtual int32_t getPieceLength(size_t index) CXX11_OVERRIDE;
@@ -236,6 +238,8 @@ public:
     throw FATAL_EXCEPTION("Not Implemented!");
   }
 
+  virtual uint64_t getLastHaveIndex() const CXX11_OVERRIDE { return 0; }
+
   virtual void removeAdvertisedPiece(const Timer& expiry) CXX11_OVERRIDE {}
 
   /**
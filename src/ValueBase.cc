@@ -162,10 +162,14 @@ Dict::Dict() {}
 
 void Dict::put(std::string key, std::unique_ptr<ValueBase> vlb)
 {
-  auto p = std::make_pair(std::move(key), std::move(vlb));
-  auto r = dict_.insert(std::move(p));
-  if (!r.second) {
-    (*r.first).second = std::move(p.second);
+  // std::map::insert() may move from its argument even if the key
+  // exists, so look up the key first.
+  auto i = dict_.lower_bound(key);
+  if (i != dict_.end() && (*i).first == key) {
+    (*i).second = std::move(vlb);
+  }
+  else {
+    dict_.insert(i, std::make_pair(std::move(key), std::move(vlb)));
   }
 }
 
@@ -0,0 +1,100 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2018 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#include "ValueBaseStructWriter.h"
+
+#include <cassert>
+
+#include "ValueBase.h"
+
+namespace aria2 {
+
+ValueBaseStructWriter::ValueBaseStructWriter() {}
+
+ValueBaseStructWriter::ValueBaseStructWriter(ValueBase* container)
+    : stack_{container}
+{
+}
+
+ValueBaseStructWriter::~ValueBaseStructWriter() = default;
+
+void ValueBaseStructWriter::add(std::unique_ptr<ValueBase> v)
+{
+  if (stack_.empty()) {
+    result_ = std::move(v);
+    return;
+  }
+  auto dict = downcast<Dict>(stack_.back());
+  if (dict) {
+    dict->put(key_, std::move(v));
+  }
+  else {
+    auto list = downcast<List>(stack_.back());
+    assert(list);
+    list->append(std::move(v));
+  }
+}
+
+void ValueBaseStructWriter::beginDict()
+{
+  auto dict = Dict::g();
+  auto p = dict.get();
+  add(std::move(dict));
+  stack_.push_back(p);
+}
+
+void ValueBaseStructWriter::endDict() { stack_.pop_back(); }
+
+void ValueBaseStructWriter::beginList()
+{
+  auto list = List::g();
+  auto p = list.get();
+  add(std::move(list));
+  stack_.push_back(p);
+}
+
+void ValueBaseStructWriter::endList() { stack_.pop_back(); }
+
+void ValueBaseStructWriter::key(const std::string& k) { key_ = k; }
+
+void ValueBaseStructWriter::value(const std::string& s) { add(String::g(s)); }
+
+void ValueBaseStructWriter::value(int64_t i) { add(Integer::g(i)); }
+
+std::unique_ptr<ValueBase> ValueBaseStructWriter::getResult()
+{
+  return std::move(result_);
+}
+
+} // namespace aria2
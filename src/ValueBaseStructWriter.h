@@ -0,0 +1,85 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2018 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#ifndef D_VALUE_BASE_STRUCT_WRITER_H
+#define D_VALUE_BASE_STRUCT_WRITER_H
+
+#include "StructWriter.h"
+
+#include <vector>
+#include <memory>
+
+namespace aria2 {
+
+class ValueBase;
+
+// Implementation of StructWriter which builds a ValueBase tree.
+class ValueBaseStructWriter : public StructWriter {
+public:
+  // The first value written becomes the result.
+  ValueBaseStructWriter();
+
+  // Values are written into container, which must be Dict or List.
+  explicit ValueBaseStructWriter(ValueBase* container);
+
+  virtual ~ValueBaseStructWriter();
+
+  virtual void beginDict() CXX11_OVERRIDE;
+
+  virtual void endDict() CXX11_OVERRIDE;
+
+  virtual void beginList() CXX11_OVERRIDE;
+
+  virtual void endList() CXX11_OVERRIDE;
+
+  virtual void key(const std::string& k) CXX11_OVERRIDE;
+
+  virtual void value(const std::string& s) CXX11_OVERRIDE;
+
+  virtual void value(int64_t i) CXX11_OVERRIDE;
+
+  std::unique_ptr<ValueBase> getResult();
+
+private:
+  void add(std::unique_ptr<ValueBase> v);
+
+  std::unique_ptr<ValueBase> result_;
+  // Dicts and lists which are not closed yet.
+  std::vector<ValueBase*> stack_;
+  std::string key_;
+};
+
+} // namespace aria2
+
+#endif // D_VALUE_BASE_STRUCT_WRITER_H
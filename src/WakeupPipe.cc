@@ -0,0 +1,154 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2018 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#include "WakeupPipe.h"
+
+#include <cerrno>
+#include <cstring>
+
+#include "a2io.h"
+#include "DlAbortEx.h"
+#include "util.h"
+#include "fmt.h"
+
+namespace aria2 {
+
+#ifndef __MINGW32__
+
+namespace {
+void setNonBlocking(int fd)
+{
+  int flags;
+  while ((flags = fcntl(fd, F_GETFL, 0)) == -1 && errno == EINTR)
+    ;
+  while (fcntl(fd, F_SETFL, flags | O_NONBLOCK) == -1 && errno == EINTR)
+    ;
+}
+} // namespace
+
+WakeupPipe::WakeupPipe()
+{
+  int fds[2];
+  if (pipe(fds) == -1) {
+    int errNum = errno;
+    throw DL_ABORT_EX(fmt("Failed to create pipe: %s",
+                          util::safeStrerror(errNum).c_str()));
+  }
+  readFd_ = fds[0];
+  writeFd_ = fds[1];
+  for (auto fd : fds) {
+    setNonBlocking(fd);
+    util::make_fd_cloexec(fd);
+  }
+}
+
+WakeupPipe::~WakeupPipe()
+{
+  close(readFd_);
+  close(writeFd_);
+}
+
+void WakeupPipe::notify()
+{
+  unsigned char c = 0;
+  // If the pipe is full, the reader is already woken up.
+  while (write(writeFd_, &c, 1) == -1 && errno == EINTR)
+    ;
+}
+
+bool WakeupPipe::drain()
+{
+  bool notified = false;
+  unsigned char buf[64];
+  for (;;) {
+    auto n = read(readFd_, buf, sizeof(buf));
+    if (n > 0) {
+      notified = true;
+      continue;
+    }
+    if (n == -1 && errno == EINTR) {
+      continue;
+    }
+    return notified;
+  }
+}
+
+#else // __MINGW32__
+
+WakeupPipe::WakeupPipe() : readFd_(-1), writeFd_(-1)
+{
+  sockaddr_in addr;
+  int addrlen = sizeof(addr);
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = 0;
+  auto fd = socket(AF_INET, SOCK_DGRAM, 0);
+  if (fd == (sock_t)-1 ||
+      ::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == -1 ||
+      getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &addrlen) == -1 ||
+      connect(fd, reinterpret_cast<sockaddr*>(&addr), addrlen) == -1) {
+    int errNum = WSAGetLastError();
+    if (fd != (sock_t)-1) {
+      ::closesocket(fd);
+    }
+    throw DL_ABORT_EX(fmt("Failed to create loopback socket: %s",
+                          util::safeStrerror(errNum).c_str()));
+  }
+  u_long flag = 1;
+  ::ioctlsocket(fd, FIONBIO, &flag);
+  readFd_ = writeFd_ = fd;
+}
+
+WakeupPipe::~WakeupPipe() { ::closesocket(readFd_); }
+
+void WakeupPipe::notify()
+{
+  char c = 0;
+  ::send(writeFd_, &c, 1, 0);
+}
+
+bool WakeupPipe::drain()
+{
+  bool notified = false;
+  char buf[64];
+  while (::recv(readFd_, buf, sizeof(buf), 0) > 0) {
+    notified = true;
+  }
+  return notified;
+}
+
+#endif // __MINGW32__
+
+} // namespace aria2
@@ -89,6 +89,7 @@ bool WebSocketInteractionCommand::execute()
   if (e_->isHaltRequested()) {
     return true;
   }
+  wsSession_->notifyStatusChange();
   if (wsSession_->onReadEvent() == -1 || wsSession_->onWriteEvent() == -1) {
     if (wsSession_->closeSent() || wsSession_->closeReceived()) {
       A2_LOG_INFO(
@@ -105,6 +106,10 @@ bool WebSocketInteractionCommand::execute()
     return true;
   }
   updateWriteCheck();
+  Timer deadline;
+  if (wsSession_->getNextStatusNotification(deadline)) {
+    e_->addTimer(deadline, this);
+  }
   e_->addCommand(std::unique_ptr<Command>(this));
   return false;
 }
@@ -48,8 +48,10 @@
 #include "rpc_helper.h"
 #include "RpcResponse.h"
 #include "json.h"
+#include "JsonParser.h"
 #include "prefs.h"
 #include "Option.h"
+#include "wallclock.h"
 
 namespace aria2 {
 
@@ -149,8 +151,7 @@ void onFrameRecvChunkCallback(
 {
   WebSocketSession* wsSession = reinterpret_cast<WebSocketSession*>(userData);
   if (!wsSession->getIgnorePayload()) {
-    // The return value is ignored here. It will be evaluated in
-    // onMsgRecvCallback.
+    // Oversized body is detected in onMsgRecvCallback.
     wsSession->parseUpdate(arg->data, arg->data_length);
   }
 }
@@ -164,8 +165,7 @@ void onMsgRecvCallback(wslay_event_context_ptr wsctx,
   WebSocketSession* wsSession = reinterpret_cast<WebSocketSession*>(userData);
   if (!wslay_is_ctrl_frame(arg->opcode)) {
     // TODO Only process text frame
-    ssize_t error = 0;
-    auto json = wsSession->parseFinal(nullptr, 0, error);
+    int error = wsSession->parseFinal(nullptr, 0);
     if (error < 0) {
       A2_LOG_INFO("Failed to parse JSON-RPC request");
       RpcResponse res(
@@ -173,33 +173,23 @@ void onMsgRecvCallback(wslay_event_context_ptr wsctx,
       addResponse(wsSession, res);
       return;
     }
-    Dict* jsondict = downcast<Dict>(json);
+    auto& parser = wsSession->getParser();
+    auto& calls = parser.getCalls();
     auto e = wsSession->getDownloadEngine();
-    if (jsondict) {
-      RpcResponse res = processJsonRpcRequest(jsondict, e);
-      addResponse(wsSession, res);
+    if (parser.isBatch()) {
+      // This is batch call
+      std::vector<RpcResponse> results;
+      results.reserve(calls.size());
+      for (auto& call : calls) {
+        call.req.wsSession = wsSession;
+        results.push_back(processJsonRpcCall(std::move(call), e));
+      }
+      addResponse(wsSession, results);
     }
     else {
-      List* jsonlist = downcast<List>(json);
-      if (jsonlist) {
-        // This is batch call
-        std::vector<RpcResponse> results;
-        for (List::ValueType::const_iterator i = jsonlist->begin(),
-                                             eoi = jsonlist->end();
-             i != eoi; ++i) {
-          Dict* jsondict = downcast<Dict>(*i);
-          if (jsondict) {
-            auto resp = processJsonRpcRequest(jsondict, e);
-            results.push_back(std::move(resp));
-          }
-        }
-        addResponse(wsSession, results);
-      }
-      else {
-        RpcResponse res(
-            createJsonRpcErrorResponse(-32600, "Invalid Request.", Null::g()));
-        addResponse(wsSession, res);
-      }
+      calls[0].req.wsSession = wsSession;
+      RpcResponse res = processJsonRpcCall(std::move(calls[0]), e);
+      addResponse(wsSession, res);
     }
   }
   else {
@@ -215,8 +205,9 @@ WebSocketSession::WebSocketSession(const std::shared_ptr<SocketCore>& socket,
     : socket_(socket),
       e_(e),
       ignorePayload_(false),
-      receivedLength_(0),
-      command_(nullptr)
+      tooLarge_(false),
+      command_(nullptr),
+      lastStatusNotification_(Timer::zero())
 {
   wslay_event_callbacks callbacks;
   memset(&callbacks, 0, sizeof(wslay_event_callbacks));
@@ -274,6 +265,7 @@ public:
   virtual bool execute() CXX11_OVERRIDE
   {
     session_->addTextMessage(msg_, false);
+    session_->getCommand()->updateWriteCheck();
     return true;
   }
 };
@@ -308,26 +300,68 @@ bool WebSocketSession::closeSent()
   return wslay_event_get_close_sent(wsctx_);
 }
 
-ssize_t WebSocketSession::parseUpdate(const uint8_t* data, size_t len)
+void WebSocketSession::parseUpdate(const uint8_t* data, size_t len)
 {
-  // Cap the number of bytes to feed the parser
+  // Cap the number of bytes to buffer
   size_t maxlen = e_->getOption()->getAsInt(PREF_RPC_MAX_REQUEST_SIZE);
-  if (receivedLength_ + len <= maxlen) {
-    receivedLength_ += len;
+  if (buf_.size() + len <= maxlen) {
+    buf_.append(reinterpret_cast<const char*>(data), len);
   }
   else {
-    len = 0;
+    tooLarge_ = true;
+  }
+}
+
+int WebSocketSession::parseFinal(const uint8_t* data, size_t len)
+{
+  parseUpdate(data, len);
+  int rv = tooLarge_ ? static_cast<int>(json::ERR_PREMATURE_DATA)
+                     : parser_.parse(buf_.data(), buf_.size());
+  buf_.clear();
+  tooLarge_ = false;
+  return rv;
+}
+
+void WebSocketSession::setStatusSubscription(
+    std::unique_ptr<StatusSubscription> subscription)
+{
+  statusSubscription_ = std::move(subscription);
+  lastStatusNotification_ = Timer::zero();
+}
+
+void WebSocketSession::notifyStatusChange()
+{
+  if (!statusSubscription_ ||
+      lastStatusNotification_.difference(global::wallclock()) +
+              A2_DELTA_MILLIS <
+          1_s) {
+    return;
+  }
+  // Wait until the previous notification is sent, so that a slow
+  // client gets the changes merged into one notification.
+  if (wslay_event_get_queued_msg_count(wsctx_) > 0) {
+    return;
+  }
+  lastStatusNotification_ = global::wallclock();
+  auto msg = statusSubscription_->createNotification(e_);
+  if (!msg.empty()) {
+    addTextMessage(msg, false);
   }
-  return parser_.parseUpdate(reinterpret_cast<const char*>(data), len);
 }
 
-std::unique_ptr<ValueBase>
-WebSocketSession::parseFinal(const uint8_t* data, size_t len, ssize_t& error)
+bool WebSocketSession::getNextStatusNotification(Timer& deadline) const
 {
-  auto res =
-      parser_.parseFinal(reinterpret_cast<const char*>(data), len, error);
-  receivedLength_ = 0;
-  return res;
+  if (!statusSubscription_) {
+    return false;
+  }
+  deadline = lastStatusNotification_;
+  deadline.advance(1_s);
+  if (deadline <= global::wallclock()) {
+    // The notification is waiting for the queued messages to be sent.
+    deadline = global::wallclock();
+    deadline.advance(1_s);
+  }
+  return true;
 }
 
 } // namespace rpc
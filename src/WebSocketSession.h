@@ -38,10 +38,13 @@
 #include "common.h"
 
 #include <memory>
+#include <string>
 
 #include <wslay/wslay.h>
 
-#include "ValueBaseJsonParser.h"
+#include "JsonRpcRequestParser.h"
+#include "StatusSubscription.h"
+#include "TimerA2.h"
 
 namespace aria2 {
 
@@ -79,15 +82,30 @@ public:
   bool closeReceived();
   // Returns true if the close frame is sent.
   bool closeSent();
-  // Parses partial request body. This function returns the number of
-  // bytes processed if it succeeds, or negative error code.
-  ssize_t parseUpdate(const uint8_t* data, size_t len);
-  // Parses final part of request body and returns result.  The
-  // |error| will be the number of bytes processed if this function
-  // succeeds, or negative error code. Whether success or failure,
-  // this function resets parser state and receivedLength_.
-  std::unique_ptr<ValueBase> parseFinal(const uint8_t* data, size_t len,
-                                        ssize_t& error);
+  // Buffers partial request body.  The body exceeding
+  // --rpc-max-request-size is discarded, which makes parseFinal()
+  // fail.
+  void parseUpdate(const uint8_t* data, size_t len);
+  // Parses the whole request body buffered so far plus |data|.  This
+  // function returns 0 if it succeeds, or negative error code.  The
+  // calls are available from getParser().getCalls().  Whether success
+  // or failure, this function clears the buffered body.
+  int parseFinal(const uint8_t* data, size_t len);
+
+  JsonRpcRequestParser& getParser() { return parser_; }
+  // Replaces the status subscription of this session with
+  // |subscription|.  If it is nullptr, the subscription is cancelled.
+  // The first notification is sent on next notifyStatusChange().
+  void
+  setStatusSubscription(std::unique_ptr<StatusSubscription> subscription);
+  // Queues aria2.onStatusChange notification if this session has a
+  // status subscription, at least 1 second has passed since the last
+  // check and the status has changed.
+  void notifyStatusChange();
+  // Stores the time when notifyStatusChange() should be called next
+  // in |deadline|.  Returns false if this session has no status
+  // subscription.
+  bool getNextStatusNotification(Timer& deadline) const;
 
   const std::shared_ptr<SocketCore>& getSocket() const { return socket_; }
 
@@ -106,9 +124,13 @@ private:
   DownloadEngine* e_;
   wslay_event_context_ptr wsctx_;
   bool ignorePayload_;
-  int32_t receivedLength_;
-  json::ValueBaseJsonParser parser_;
+  // True if the request body exceeds --rpc-max-request-size.
+  bool tooLarge_;
+  std::string buf_;
+  JsonRpcRequestParser parser_;
   WebSocketInteractionCommand* command_;
+  std::unique_ptr<StatusSubscription> statusSubscription_;
+  Timer lastStatusNotification_;
 };
 
 } // namespace rpc
@@ -156,6 +156,11 @@
 #  define a2rmdir(path) rmdir(path)
 #  define a2open(path, flags, mode) open(path, flags, mode)
 #  define a2fopen(path, mode) fopen(path, mode)
+#  define a2pread(fd, buf, count, offset) pread64(fd, buf, count, offset)
+#  define a2pwrite(fd, buf, count, offset) pwrite64(fd, buf, count, offset)
+#  define a2pwritev(fd, iov, iovcnt, offset) pwritev64(fd, iov, iovcnt, offset)
+#  define a2sendfile(outfd, infd, offset, count)                             \
+    sendfile64(outfd, infd, offset, count)
 // Android NDK R8e does not provide ftruncate64 prototype, so let's
 // define it here.
 #  ifdef __cplusplus
@@ -184,6 +189,11 @@ extern int ftruncate64(int fd, off64_t length);
 #  define a2open(path, flags, mode) open(path, flags, mode)
 #  define a2fopen(path, mode) fopen(path, mode)
 #  define a2ftruncate(fd, length) ftruncate(fd, length)
+#  define a2pread(fd, buf, count, offset) pread(fd, buf, count, offset)
+#  define a2pwrite(fd, buf, count, offset) pwrite(fd, buf, count, offset)
+#  define a2pwritev(fd, iov, iovcnt, offset) pwritev(fd, iov, iovcnt, offset)
+#  define a2sendfile(outfd, infd, offset, count)                             \
+    sendfile(outfd, infd, offset, count)
 #  define a2_off_t off_t
 #endif
 
@@ -133,6 +133,15 @@ struct Endpoint {
   uint16_t port;
 };
 
+// A datagram and its remote endpoint.  Used to send or receive
+// several datagrams in one call.  data points to the buffer of length
+// bytes.
+struct Datagram {
+  unsigned char* data;
+  size_t length;
+  Endpoint endpoint;
+};
+
 #define A2_DEFAULT_IOV_MAX 128
 
 #if defined(IOV_MAX) && IOV_MAX < A2_DEFAULT_IOV_MAX
@@ -61,7 +61,11 @@ public:
   size_t size() const { return N; }
 };
 
-// Expression Template for array
+// Expression Template for array.  In addition to operator[], the
+// expressions provide word(i), which evaluates 8 elements starting at
+// i * 8 at once.  The elements must be bytes; the first one is stored
+// in the most significant byte of the result, so that bit order
+// matches the one in bitfield.h.
 
 namespace expr {
 
@@ -75,20 +79,30 @@ template <typename L, typename R, typename Op> struct BinExpr {
 
   value_type operator[](size_t i) const { return op(lhs[i], rhs[i]); }
 
+  uint64_t word(size_t i) const { return op(lhs.word(i), rhs.word(i)); }
+
   L lhs;
   R rhs;
   Op op;
 };
 
-template <typename L, typename R,
-          typename Op = std::bit_and<typename L::value_type>>
+template <typename T> struct bit_and {
+  typedef T result_type;
+  template <typename U> U operator()(U a, U b) const { return a & b; }
+};
+
+template <typename T> struct bit_or {
+  typedef T result_type;
+  template <typename U> U operator()(U a, U b) const { return a | b; }
+};
+
+template <typename L, typename R, typename Op = bit_and<typename L::value_type>>
 BinExpr<L, R, Op> operator&(L lhs, R rhs)
 {
   return BinExpr<L, R, Op>(std::forward<L>(lhs), std::forward<R>(rhs), Op());
 }
 
-template <typename L, typename R,
-          typename Op = std::bit_or<typename L::value_type>>
+template <typename L, typename R, typename Op = bit_or<typename L::value_type>>
 BinExpr<L, R, Op> operator|(L lhs, R rhs)
 {
   return BinExpr<L, R, Op>(std::forward<L>(lhs), std::forward<R>(rhs), Op());
@@ -101,12 +115,15 @@ template <typename Arg, typename Op> struct UnExpr {
 
   value_type operator[](size_t i) const { return op(arg[i]); }
 
+  uint64_t word(size_t i) const { return op(arg.word(i)); }
+
   Arg arg;
   Op op;
 };
 
-template <typename T> struct bit_neg : std::function<T(T)> {
-  T operator()(T t) const { return ~t; }
+template <typename T> struct bit_neg {
+  typedef T result_type;
+  template <typename U> U operator()(U t) const { return ~t; }
 };
 
 template <typename Arg, typename Op = bit_neg<typename Arg::value_type>>
@@ -122,6 +139,18 @@ template <typename T> struct Array {
 
   T operator[](size_t i) const { return t[i]; }
 
+  uint64_t word(size_t i) const
+  {
+    const T* p = t + i * 8;
+    return static_cast<uint64_t>(p[0]) << 56 |
+           static_cast<uint64_t>(p[1]) << 48 |
+           static_cast<uint64_t>(p[2]) << 40 |
+           static_cast<uint64_t>(p[3]) << 32 |
+           static_cast<uint64_t>(p[4]) << 24 |
+           static_cast<uint64_t>(p[5]) << 16 |
+           static_cast<uint64_t>(p[6]) << 8 | static_cast<uint64_t>(p[7]);
+  }
+
   T* t;
 };
 
@@ -34,10 +34,105 @@
 /* copyright --> */
 #include "bitfield.h"
 
+#if defined(__GNUG__) && (defined(__x86_64__) || defined(__i386__))
+#  define A2_BITFIELD_POPCNT_DISPATCH 1
+#endif // defined(__GNUG__) && (defined(__x86_64__) || defined(__i386__))
+
 namespace aria2 {
 
 namespace bitfield {
 
+namespace {
+size_t countSetBitWords(const unsigned char* bitfield, size_t nwords)
+{
+  size_t count = 0;
+  for (size_t i = 0; i < nwords; ++i) {
+    uint64_t v;
+    memcpy(&v, bitfield + i * 8, sizeof(v));
+    count += countBit64(v);
+  }
+  return count;
+}
+} // namespace
+
+#ifdef A2_BITFIELD_POPCNT_DISPATCH
+namespace {
+// Same as countSetBitWords, but compiled with the POPCNT instruction
+// enabled.  Only called if the CPU supports it.
+__attribute__((target("popcnt"))) size_t
+countSetBitWordsPopcnt(const unsigned char* bitfield, size_t nwords)
+{
+  size_t count = 0;
+  for (size_t i = 0; i < nwords; ++i) {
+    uint64_t v;
+    memcpy(&v, bitfield + i * 8, sizeof(v));
+    count += __builtin_popcountll(v);
+  }
+  return count;
+}
+} // namespace
+#endif // A2_BITFIELD_POPCNT_DISPATCH
+
+namespace {
+typedef size_t (*CountSetBitWordsFunc)(const unsigned char*, size_t);
+
+CountSetBitWordsFunc selectCountSetBitWords()
+{
+#ifdef A2_BITFIELD_POPCNT_DISPATCH
+  if (__builtin_cpu_supports("popcnt")) {
+    return countSetBitWordsPopcnt;
+  }
+#endif // A2_BITFIELD_POPCNT_DISPATCH
+  return countSetBitWords;
+}
+} // namespace
+
+size_t countSetBit(const unsigned char* bitfield, size_t nbits)
+{
+  static const auto countWords = selectCountSetBitWords();
+  if (nbits == 0) {
+    return 0;
+  }
+  size_t len = (nbits + 7) / 8;
+  size_t nwords = (len - 1) / 8;
+  size_t count = countWords(bitfield, nwords);
+  for (size_t i = nwords * 8; i < len - 1; ++i) {
+    count += cntbits[bitfield[i]];
+  }
+  count += cntbits[bitfield[len - 1] & lastByteMask(nbits)];
+  return count;
+}
+
+bool isBitRangeSet(const unsigned char* bitfield, size_t first, size_t last)
+{
+  size_t firstByte = first / 8;
+  size_t lastByte = last / 8;
+  unsigned char firstMask = 0xffu >> (first % 8);
+  unsigned char lastMask = 0xffu << (7 - last % 8);
+  if (firstByte == lastByte) {
+    unsigned char mask = firstMask & lastMask;
+    return (bitfield[firstByte] & mask) == mask;
+  }
+  if ((bitfield[firstByte] & firstMask) != firstMask ||
+      (bitfield[lastByte] & lastMask) != lastMask) {
+    return false;
+  }
+  size_t i = firstByte + 1;
+  for (; i + 8 <= lastByte; i += 8) {
+    uint64_t v;
+    memcpy(&v, bitfield + i, sizeof(v));
+    if (v != UINT64_MAX) {
+      return false;
+    }
+  }
+  for (; i < lastByte; ++i) {
+    if (bitfield[i] != 0xffu) {
+      return false;
+    }
+  }
+  return true;
+}
+
 void flipBit(unsigned char* data, size_t length, size_t bitIndex)
 {
   size_t byteIndex = bitIndex / 8;
@@ -94,33 +94,74 @@ inline size_t countBit32(uint32_t n)
          cntbits[(n >> 16) & 0xffu] + cntbits[(n >> 24) & 0xffu];
 }
 
-// Counts set bit in bitfield.
-inline size_t countSetBit(const unsigned char* bitfield, size_t nbits)
+inline size_t countBit64(uint64_t n)
 {
-  if (nbits == 0) {
-    return 0;
-  }
-  size_t count = 0;
-  size_t size = sizeof(uint32_t);
-  size_t len = (nbits + 7) / 8;
-  if (nbits % 32 != 0) {
-    --len;
-    count +=
-        countBit32(static_cast<uint32_t>(bitfield[len] & lastByteMask(nbits)));
-  }
-  size_t to = len / size;
-  for (size_t i = 0; i < to; ++i) {
-    uint32_t v;
-    memcpy(&v, &bitfield[i * size], sizeof(v));
-    count += countBit32(v);
+#ifdef __GNUG__
+  return __builtin_popcountll(n);
+#else  // !__GNUG__
+  n = n - ((n >> 1) & 0x5555555555555555ULL);
+  n = (n & 0x3333333333333333ULL) + ((n >> 2) & 0x3333333333333333ULL);
+  n = (n + (n >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+  return (n * 0x0101010101010101ULL) >> 56;
+#endif // !__GNUG__
+}
+
+// Returns the number of leading 0 bits in n.  n must not be 0.
+inline size_t countLeadingZero64(uint64_t n)
+{
+  assert(n);
+#ifdef __GNUG__
+  return __builtin_clzll(n);
+#else  // !__GNUG__
+  size_t c = 0;
+  for (; !(n & 0xff00000000000000ULL); n <<= 8, c += 8)
+    ;
+  for (; !(n & 0x8000000000000000ULL); n <<= 1, ++c)
+    ;
+  return c;
+#endif // !__GNUG__
+}
+
+// Loads 8 bytes of bitfield starting at i * 8 into a word so that the
+// first bit of bitfield becomes the most significant bit.  The
+// expressions in array_fun.h evaluate themselves a word at a time.
+template <typename Array>
+inline auto loadWord(const Array& bitfield, size_t i, int)
+    -> decltype(bitfield.word(i))
+{
+  return bitfield.word(i);
+}
+
+template <typename Array>
+inline uint64_t loadWord(const Array& bitfield, size_t i, long)
+{
+  uint64_t w = 0;
+  for (size_t j = i * 8; j < i * 8 + 8; ++j) {
+    w = (w << 8) | static_cast<unsigned char>(bitfield[j]);
   }
-  for (size_t i = len - len % size; i < len; ++i) {
-    count += countBit32(static_cast<uint32_t>(bitfield[i]));
+  return w;
+}
+
+template <typename Array>
+inline uint64_t loadWord(const Array& bitfield, size_t i)
+{
+  return loadWord(bitfield, i, 0);
+}
+
+// Stores w to bitfield starting at i * 8.  This is the inverse of
+// loadWord().
+inline void storeWord(unsigned char* bitfield, size_t i, uint64_t w)
+{
+  for (size_t j = 0; j < 8; ++j) {
+    bitfield[i * 8 + j] = w >> (56 - j * 8);
   }
-  return count;
 }
 
-// Counts set bit in bitfield. This is a bit slower than countSetBit
+// Counts set bit in bitfield.  Uses the POPCNT instruction if the CPU
+// supports it.
+size_t countSetBit(const unsigned char* bitfield, size_t nbits);
+
+// Counts set bit in bitfield.  This is a bit slower than countSetBit
 // but can accept array template expression as bitfield.
 template <typename Array>
 size_t countSetBitSlow(const Array& bitfield, size_t nbits)
@@ -129,31 +170,64 @@ size_t countSetBitSlow(const Array& bitfield, size_t nbits)
     return 0;
   }
   size_t count = 0;
-  size_t to = (nbits + 7) / 8;
-  if (to > 1) {
-    for (size_t i = 0; i < to - 1; ++i) {
-      count += cntbits[static_cast<unsigned char>(bitfield[i])];
-    }
+  size_t len = (nbits + 7) / 8;
+  size_t nwords = (len - 1) / 8;
+  for (size_t i = 0; i < nwords; ++i) {
+    count += countBit64(loadWord(bitfield, i));
+  }
+  for (size_t i = nwords * 8; i < len - 1; ++i) {
+    count += cntbits[static_cast<unsigned char>(bitfield[i])];
   }
-  count += cntbits[static_cast<unsigned char>(bitfield[to - 1]) &
+  count += cntbits[static_cast<unsigned char>(bitfield[len - 1]) &
                    lastByteMask(nbits)];
   return count;
 }
 
 void flipBit(unsigned char* data, size_t length, size_t bitIndex);
 
+// Calls f(index) for each set bit in bitfield in ascending order, until
+// f returns false.  bitfield contains nbits bits.  Returns false if f
+// returned false.  Otherwise returns true.
+template <typename Array, typename F>
+bool forEachSetBit(const Array& bitfield, size_t nbits, F f)
+{
+  if (nbits == 0) {
+    return true;
+  }
+  size_t len = (nbits + 7) / 8;
+  size_t nwords = (len - 1) / 8;
+  for (size_t i = 0; i < nwords; ++i) {
+    for (auto w = loadWord(bitfield, i); w;) {
+      size_t n = countLeadingZero64(w);
+      if (!f(i * 64 + n)) {
+        return false;
+      }
+      w &= ~(0x8000000000000000ULL >> n);
+    }
+  }
+  for (size_t i = nwords * 8; i < len; ++i) {
+    unsigned char b = bitfield[i];
+    if (i == len - 1) {
+      b &= lastByteMask(nbits);
+    }
+    for (size_t j = 0; b; ++j, b <<= 1) {
+      if ((b & 0x80u) && !f(i * 8 + j)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
 // Stores first set bit index of bitfield to index.  bitfield contains
 // nbits. Returns true if set bit is found. Otherwise returns false.
 template <typename Array>
 bool getFirstSetBitIndex(size_t& index, const Array& bitfield, size_t nbits)
 {
-  for (size_t i = 0; i < nbits; ++i) {
-    if (bitfield::test(bitfield, nbits, i)) {
-      index = i;
-      return true;
-    }
-  }
-  return false;
+  return !forEachSetBit(bitfield, nbits, [&index](size_t i) {
+    index = i;
+    return false;
+  });
 }
 
 // Appends first at most n set bit index in bitfield to out.  bitfield
@@ -166,17 +240,17 @@ size_t getFirstNSetBitIndex(OutputIterator out, size_t n, const Array& bitfield,
     return 0;
   }
   const size_t origN = n;
-  for (size_t i = 0; i < nbits; ++i) {
-    if (bitfield::test(bitfield, nbits, i)) {
-      *out++ = i;
-      if (--n == 0) {
-        break;
-      }
-    }
-  }
+  forEachSetBit(bitfield, nbits, [&out, &n](size_t i) {
+    *out++ = i;
+    return --n != 0;
+  });
   return origN - n;
 }
 
+// Returns true if all bits in [first, last] are set.  Both first and
+// last must be less than the number of bits in bitfield.
+bool isBitRangeSet(const unsigned char* bitfield, size_t first, size_t last);
+
 } // namespace bitfield
 
 } // namespace aria2
@@ -100,13 +100,8 @@ void extractPieceHash(const std::shared_ptr<DownloadContext>& ctx,
                       const std::string& hashData, size_t hashLength,
                       size_t numPieces)
 {
-  std::vector<std::string> pieceHashes;
-  pieceHashes.reserve(numPieces);
-  for (size_t i = 0; i < numPieces; ++i) {
-    const char* p = hashData.data() + i * hashLength;
-    pieceHashes.push_back(std::string(p, p + hashLength));
-  }
-  ctx->setPieceHashes("sha-1", pieceHashes.begin(), pieceHashes.end());
+  ctx->setPieceHashes("sha-1", hashData.substr(0, numPieces * hashLength),
+                      hashLength);
 }
 } // namespace
 
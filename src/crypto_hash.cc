@@ -10,6 +10,14 @@
 #include <stdexcept>
 #include <unordered_map>
 
+// SHA extensions (SHA-NI) are used if the CPU supports them.
+#if (defined(__x86_64__) || defined(__i386__)) &&                              \
+    (defined(__clang__) || (defined(__GNUG__) && __GNUC__ >= 5))
+#  define __hash_sha_ni 1
+#  include <cpuid.h>
+#  include <immintrin.h>
+#endif // (defined(__x86_64__) || defined(__i386__)) && ...
+
 // Compiler hints
 #if defined(__GNUG__)
 #  define likely(x) __builtin_expect(!!(x), 1)
@@ -51,6 +59,156 @@ template <typename T> static forceinline T par(T b, T c, T d)
   return b ^ c ^ d;
 }
 
+#ifdef __hash_sha_ni
+static bool detect_sha_ni()
+{
+  unsigned int a, b, c, d;
+  if (!__get_cpuid(1, &a, &b, &c, &d) || !(c & bit_SSSE3) ||
+      !(c & bit_SSE4_1)) {
+    return false;
+  }
+  if (__get_cpuid_max(0, nullptr) < 7) {
+    return false;
+  }
+  __cpuid_count(7, 0, a, b, c, d);
+  // EBX bit 29: SHA
+  return (b & (1u << 29)) != 0;
+}
+
+static bool use_sha_ni()
+{
+  static const bool rv = detect_sha_ni();
+  return rv;
+}
+
+// Processes one 64 bytes block.  |state| is in host byte order, just
+// like SHA1::state_.
+__attribute__((target("sha,sse4.1,ssse3"))) static void
+sha1_transform_ni(uint32_t* state, const uint8_t* data)
+{
+  const __m128i mask =
+      _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+  __m128i abcd = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state));
+  abcd = _mm_shuffle_epi32(abcd, 0x1b);
+  const __m128i e_save = _mm_set_epi32(state[4], 0, 0, 0);
+  const __m128i abcd_save = abcd;
+
+  __m128i msg[4];
+  for (int i = 0; i < 4; ++i) {
+    msg[i] = _mm_shuffle_epi8(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * 16)),
+        mask);
+  }
+
+  __m128i e, prev;
+  // 4 rounds per step.  msg[k & 3] holds W[4k..4k+3].  The round
+  // function has to be an immediate, and the steps have to be unrolled
+  // to keep msg in registers, hence the macro.
+#define __hash_sha1_ni_step(k, func)                                           \
+  if (k >= 4) {                                                                \
+    msg[k & 3] = _mm_sha1msg2_epu32(                                           \
+        _mm_xor_si128(_mm_sha1msg1_epu32(msg[k & 3], msg[(k + 1) & 3]),        \
+                      msg[(k + 2) & 3]),                                       \
+        msg[(k + 3) & 3]);                                                     \
+  }                                                                            \
+  e = k == 0 ? _mm_add_epi32(e_save, msg[0])                                   \
+             : _mm_sha1nexte_epu32(prev, msg[k & 3]);                          \
+  prev = abcd;                                                                 \
+  abcd = _mm_sha1rnds4_epu32(abcd, e, func);
+
+  __hash_sha1_ni_step(0, 0) __hash_sha1_ni_step(1, 0);
+  __hash_sha1_ni_step(2, 0) __hash_sha1_ni_step(3, 0);
+  __hash_sha1_ni_step(4, 0) __hash_sha1_ni_step(5, 1);
+  __hash_sha1_ni_step(6, 1) __hash_sha1_ni_step(7, 1);
+  __hash_sha1_ni_step(8, 1) __hash_sha1_ni_step(9, 1);
+  __hash_sha1_ni_step(10, 2) __hash_sha1_ni_step(11, 2);
+  __hash_sha1_ni_step(12, 2) __hash_sha1_ni_step(13, 2);
+  __hash_sha1_ni_step(14, 2) __hash_sha1_ni_step(15, 3);
+  __hash_sha1_ni_step(16, 3) __hash_sha1_ni_step(17, 3);
+  __hash_sha1_ni_step(18, 3) __hash_sha1_ni_step(19, 3);
+
+#undef __hash_sha1_ni_step
+
+  e = _mm_sha1nexte_epu32(prev, e_save);
+  abcd = _mm_add_epi32(abcd, abcd_save);
+  abcd = _mm_shuffle_epi32(abcd, 0x1b);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(state), abcd);
+  state[4] = _mm_extract_epi32(e, 3);
+}
+
+static const uint32_t sha256_k[] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+    0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+    0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+    0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+    0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+    0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+// Processes one 64 bytes block.  |state| is in host byte order, just
+// like SHA256::state_.
+__attribute__((target("sha,sse4.1,ssse3"))) static void
+sha256_transform_ni(uint32_t* state, const uint8_t* data)
+{
+  const __m128i mask =
+      _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+  // The instructions want the state as ABEF and CDGH.
+  __m128i tmp = _mm_shuffle_epi32(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(state)), 0xb1);
+  __m128i state1 = _mm_shuffle_epi32(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(state + 4)), 0x1b);
+  __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);
+  state1 = _mm_blend_epi16(state1, tmp, 0xf0);
+  const __m128i abef_save = state0;
+  const __m128i cdgh_save = state1;
+
+  __m128i msg[4];
+  for (int i = 0; i < 4; ++i) {
+    msg[i] = _mm_shuffle_epi8(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * 16)),
+        mask);
+  }
+
+  // 4 rounds per step.  msg[k & 3] holds W[4k..4k+3].
+#define __hash_sha256_ni_step(k)                                               \
+  if (k >= 4) {                                                                \
+    msg[k & 3] = _mm_sha256msg2_epu32(                                         \
+        _mm_add_epi32(_mm_sha256msg1_epu32(msg[k & 3], msg[(k + 1) & 3]),      \
+                      _mm_alignr_epi8(msg[(k + 3) & 3], msg[(k + 2) & 3], 4)), \
+        msg[(k + 3) & 3]);                                                     \
+  }                                                                            \
+  wk = _mm_add_epi32(msg[k & 3], _mm_loadu_si128(reinterpret_cast<           \
+                                     const __m128i*>(&sha256_k[k * 4])));      \
+  state1 = _mm_sha256rnds2_epu32(state1, state0, wk);                          \
+  state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(wk, 0x0e));
+
+  __m128i wk;
+  __hash_sha256_ni_step(0) __hash_sha256_ni_step(1);
+  __hash_sha256_ni_step(2) __hash_sha256_ni_step(3);
+  __hash_sha256_ni_step(4) __hash_sha256_ni_step(5);
+  __hash_sha256_ni_step(6) __hash_sha256_ni_step(7);
+  __hash_sha256_ni_step(8) __hash_sha256_ni_step(9);
+  __hash_sha256_ni_step(10) __hash_sha256_ni_step(11);
+  __hash_sha256_ni_step(12) __hash_sha256_ni_step(13);
+  __hash_sha256_ni_step(14) __hash_sha256_ni_step(15);
+
+#undef __hash_sha256_ni_step
+
+  state0 = _mm_add_epi32(state0, abef_save);
+  state1 = _mm_add_epi32(state1, cdgh_save);
+  tmp = _mm_shuffle_epi32(state0, 0x1b);
+  state1 = _mm_shuffle_epi32(state1, 0xb1);
+  state0 = _mm_blend_epi16(tmp, state1, 0xf0);
+  state1 = _mm_alignr_epi8(state1, tmp, 8);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(state), state0);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(state + 4), state1);
+}
+#endif // __hash_sha_ni
+
 #ifdef __GNUG__
 #  define __hash_maybe_memfence __asm__("" ::: "memory")
 #else // __GNUG__
@@ -373,6 +531,12 @@ private:
 protected:
   virtual void transform(const word_t* buffer)
   {
+#ifdef __hash_sha_ni
+    if (likely(use_sha_ni())) {
+      sha1_transform_ni(state_.words, reinterpret_cast<const uint8_t*>(buffer));
+      return;
+    }
+#endif // __hash_sha_ni
     __hash_assign_words(__crypto_be);
     __hash_maybe_memfence;
 
@@ -538,6 +702,13 @@ private:
 protected:
   virtual void transform(const word_t* buffer)
   {
+#ifdef __hash_sha_ni
+    if (likely(use_sha_ni())) {
+      sha256_transform_ni(state_.words,
+                          reinterpret_cast<const uint8_t*>(buffer));
+      return;
+    }
+#endif // __hash_sha_ni
     __hash_assign_words(__crypto_be);
     __hash_maybe_memfence;
 
@@ -45,9 +45,8 @@ namespace aria2 {
 
 namespace json {
 
-std::string jsonEscape(const std::string& s)
+void jsonEscape(std::string& t, const std::string& s)
 {
-  std::string t;
   for (std::string::const_iterator i = s.begin(), eoi = s.end(); i != eoi;
        ++i) {
     if (*i == '"' || *i == '\\' || *i == '/') {
@@ -86,9 +85,15 @@ std::string jsonEscape(const std::string& s)
       t += temp;
     }
     else {
-      t.append(i, i + 1);
+      t += *i;
     }
   }
+}
+
+std::string jsonEscape(const std::string& s)
+{
+  std::string t;
+  jsonEscape(t, s);
   return t;
 }
 
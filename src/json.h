@@ -44,6 +44,9 @@ namespace json {
 
 std::string jsonEscape(const std::string& s);
 
+// Appends JSON escaped s to t.
+void jsonEscape(std::string& t, const std::string& s);
+
 template <typename OutputStream>
 OutputStream& encode(OutputStream& out, const ValueBase* vlb)
 {
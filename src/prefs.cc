@@ -376,6 +376,12 @@ PrefPtr PREF_STDERR = makePref("stderr");
 // value: true | false
 PrefPtr PREF_KEEP_UNFINISHED_DOWNLOAD_RESULT =
     makePref("keep-unfinished-download-result");
+// value: 1*digit
+PrefPtr PREF_CHECK_INTEGRITY_THREADS = makePref("check-integrity-threads");
+// value: true | false
+PrefPtr PREF_ASYNC_DISK_WRITE = makePref("async-disk-write");
+// value: 1*digit
+PrefPtr PREF_DISK_READ_CACHE = makePref("disk-read-cache");
 
 /**
  * FTP related preferences
@@ -551,6 +557,8 @@ PrefPtr PREF_BT_TRACKER_CONNECT_TIMEOUT =
     makePref("bt-tracker-connect-timeout");
 // values: 1*digit
 PrefPtr PREF_DHT_MESSAGE_TIMEOUT = makePref("dht-message-timeout");
+// values: 1*digit
+PrefPtr PREF_DHT_LOOKUP_CONCURRENCY = makePref("dht-lookup-concurrency");
 // values: string
 PrefPtr PREF_ON_BT_DOWNLOAD_COMPLETE = makePref("on-bt-download-complete");
 // values: string
@@ -329,6 +329,12 @@ extern PrefPtr PREF_MAX_MMAP_LIMIT;
 extern PrefPtr PREF_STDERR;
 // value: true | false
 extern PrefPtr PREF_KEEP_UNFINISHED_DOWNLOAD_RESULT;
+// value: 1*digit
+extern PrefPtr PREF_CHECK_INTEGRITY_THREADS;
+// value: true | false
+extern PrefPtr PREF_ASYNC_DISK_WRITE;
+// value: 1*digit
+extern PrefPtr PREF_DISK_READ_CACHE;
 
 /**
  * FTP related preferences
@@ -501,6 +507,8 @@ extern PrefPtr PREF_BT_TRACKER_TIMEOUT;
 extern PrefPtr PREF_BT_TRACKER_CONNECT_TIMEOUT;
 // values: 1*digit
 extern PrefPtr PREF_DHT_MESSAGE_TIMEOUT;
+// values: 1*digit
+extern PrefPtr PREF_DHT_LOOKUP_CONCURRENCY;
 // values: string
 extern PrefPtr PREF_ON_BT_DOWNLOAD_COMPLETE;
 // values: string
@@ -42,6 +42,7 @@
 #include "RpcMethod.h"
 #include "RpcResponse.h"
 #include "RpcMethodFactory.h"
+#include "JsonRpcRequestParser.h"
 #include "LogFactory.h"
 #include "fmt.h"
 
@@ -77,32 +78,22 @@ RpcResponse createJsonRpcErrorResponse(int code, const std::string& msg,
                           std::move(id)};
 }
 
-RpcResponse processJsonRpcRequest(Dict* jsondict, DownloadEngine* e)
+RpcResponse processJsonRpcCall(JsonRpcCall call, DownloadEngine* e)
 {
-  auto id = jsondict->popValue("id");
-  if (!id) {
-    return createJsonRpcErrorResponse(-32600, "Invalid Request.", Null::g());
+  switch (call.error) {
+  case 0:
+    break;
+  case -32602:
+    return createJsonRpcErrorResponse(call.error, "Invalid params.",
+                                      std::move(call.req.id));
+  default:
+    return createJsonRpcErrorResponse(
+        call.error, "Invalid Request.",
+        call.req.id ? std::move(call.req.id) : Null::g());
   }
-  const String* methodName = downcast<String>(jsondict->get("method"));
-  if (!methodName) {
-    return createJsonRpcErrorResponse(-32600, "Invalid Request.",
-                                      std::move(id));
-  }
-  std::unique_ptr<List> params;
-  auto tempParams = jsondict->popValue("params");
-  if (downcast<List>(tempParams)) {
-    params.reset(static_cast<List*>(tempParams.release()));
-  }
-  else if (!tempParams) {
-    params = List::g();
-  }
-  else {
-    // TODO No support for Named params
-    return createJsonRpcErrorResponse(-32602, "Invalid params.", std::move(id));
-  }
-  A2_LOG_INFO(fmt("Executing RPC method %s", methodName->s().c_str()));
-  RpcRequest req = {methodName->s(), std::move(params), std::move(id), true};
-  return getMethod(methodName->s())->execute(std::move(req), e);
+  A2_LOG_INFO(fmt("Executing RPC method %s", call.req.methodName.c_str()));
+  auto method = getMethod(call.req.methodName);
+  return method->executeJson(std::move(call.req), e);
 }
 
 } // namespace rpc
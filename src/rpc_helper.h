@@ -52,6 +52,7 @@ class DownloadEngine;
 namespace rpc {
 
 struct RpcResponse;
+struct JsonRpcCall;
 
 #ifdef ENABLE_XML_RPC
 RpcRequest xmlParseMemory(const char* xml, size_t size);
@@ -62,8 +63,9 @@ RpcRequest xmlParseMemory(const char* xml, size_t size);
 RpcResponse createJsonRpcErrorResponse(int code, const std::string& msg,
                                        std::unique_ptr<ValueBase> id);
 
-// Processes JSON-RPC request |jsondict| and returns the result.
-RpcResponse processJsonRpcRequest(Dict* jsondict, DownloadEngine* e);
+// Processes JSON-RPC call |call| read by JsonRpcRequestParser and
+// returns the result.
+RpcResponse processJsonRpcCall(JsonRpcCall call, DownloadEngine* e);
 
 } // namespace rpc
 
@@ -206,6 +206,17 @@
     "                              re-downloaded from scratch. If both piece hashes\n" \
     "                              and a hash of entire file are provided, only\n" \
     "                              piece hashes are used.")
+#define TEXT_ASYNC_DISK_WRITE                                           \
+  _(" --async-disk-write[=true|false] Write downloaded data to disk in a\n" \
+    "                              separate thread, so that downloads are not\n" \
+    "                              blocked by slow disks. Write errors may be\n" \
+    "                              reported later than the write request.")
+#define TEXT_CHECK_INTEGRITY_THREADS                                    \
+  _(" --check-integrity-threads=NUM Set the number of worker threads which\n" \
+    "                              validate files. Up to NUM downloads are\n" \
+    "                              validated in parallel without blocking other\n" \
+    "                              downloads. If 0 is given, files are validated\n" \
+    "                              one download at a time in the main thread.")
 #define TEXT_BT_HASH_CHECK_SEED                                         \
   _(" --bt-hash-check-seed[=true|false] If true is given, after hash check using\n" \
     "                              --check-integrity option and file is complete,\n" \
@@ -721,7 +732,13 @@
     "                              effect and --bt-tracker-timeout option is used\n" \
     "                              instead.")
 #define TEXT_DHT_MESSAGE_TIMEOUT                \
-  _(" --dht-message-timeout=SEC    Set timeout in seconds.")
+  _(" --dht-message-timeout=SEC    Set timeout in seconds. For nodes whose\n" \
+    "                              round-trip time is known, a shorter timeout\n" \
+    "                              computed from it is used.")
+#define TEXT_DHT_LOOKUP_CONCURRENCY                                     \
+  _(" --dht-lookup-concurrency=NUM Set the number of nodes queried in parallel\n" \
+    "                              in a DHT node or peer lookup. Nodes which do\n" \
+    "                              not reply in time are not counted.")
 #define TEXT_HTTP_ACCEPT_GZIP                   \
   _(" --http-accept-gzip[=true|false] Send 'Accept: deflate, gzip' request header\n" \
     "                              and inflate response if remote server responds\n" \
@@ -999,6 +1016,17 @@
     "                              cached in memory, we don't need to read them\n" \
     "                              from the disk.\n"                    \
     "                              SIZE can include K or M(1K = 1024, 1M = 1024K).")
+#define TEXT_DISK_READ_CACHE                    \
+  _(" --disk-read-cache=SIZE       Enable read cache for uploading pieces to\n" \
+    "                              BitTorrent peers. If SIZE is 0, the read cache\n" \
+    "                              is disabled. When a peer requests a block, the\n" \
+    "                              whole piece is read from the disk and kept in\n" \
+    "                              memory, so that requests for the same piece from\n" \
+    "                              other peers do not touch the disk. The least\n" \
+    "                              recently used pieces are evicted to keep the\n" \
+    "                              cache under SIZE bytes. The data cached by\n" \
+    "                              --disk-cache count against SIZE as well.\n" \
+    "                              SIZE can include K or M(1K = 1024, 1M = 1024K).")
 #define TEXT_GID                                \
   _(" --gid=GID                    Set GID manually. aria2 identifies each\n" \
     "                              download by the ID called GID. The GID must be\n" \
@@ -152,13 +152,10 @@ void BittorrentHelperTest::testGetPieceHash()
   std::shared_ptr<DownloadContext> dctx(new DownloadContext());
   load(A2_TEST_DIR "/test.torrent", dctx, option_);
 
-  CPPUNIT_ASSERT_EQUAL(std::string("AAAAAAAAAAAAAAAAAAAA"),
-                       dctx->getPieceHash(0));
-  CPPUNIT_ASSERT_EQUAL(std::string("BBBBBBBBBBBBBBBBBBBB"),
-                       dctx->getPieceHash(1));
-  CPPUNIT_ASSERT_EQUAL(std::string("CCCCCCCCCCCCCCCCCCCC"),
-                       dctx->getPieceHash(2));
-  CPPUNIT_ASSERT_EQUAL(std::string(""), dctx->getPieceHash(3));
+  CPPUNIT_ASSERT(dctx->matchPieceHash(0, "AAAAAAAAAAAAAAAAAAAA"));
+  CPPUNIT_ASSERT(dctx->matchPieceHash(1, "BBBBBBBBBBBBBBBBBBBB"));
+  CPPUNIT_ASSERT(dctx->matchPieceHash(2, "CCCCCCCCCCCCCCCCCCCC"));
+  CPPUNIT_ASSERT(!dctx->getPieceHash(3));
 
   CPPUNIT_ASSERT_EQUAL(std::string("sha-1"), dctx->getPieceHashType());
 }
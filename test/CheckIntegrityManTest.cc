@@ -0,0 +1,143 @@
+#include "CheckIntegrityMan.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "CheckIntegrityEntry.h"
+#include "Command.h"
+#include "RequestGroup.h"
+#include "GroupId.h"
+#include "Option.h"
+#include "a2functional.h"
+#ifdef ENABLE_THREADS
+#  include "ThreadPool.h"
+#endif // ENABLE_THREADS
+
+namespace aria2 {
+
+class CheckIntegrityManTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(CheckIntegrityManTest);
+  CPPUNIT_TEST(testPick);
+#ifdef ENABLE_THREADS
+  CPPUNIT_TEST(testPick_threadPool);
+#endif // ENABLE_THREADS
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  std::shared_ptr<Option> option_;
+
+public:
+  void setUp() { option_ = std::make_shared<Option>(); }
+
+  void testPick();
+#ifdef ENABLE_THREADS
+  void testPick_threadPool();
+#endif // ENABLE_THREADS
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(CheckIntegrityManTest);
+
+namespace {
+class MockCheckIntegrityEntry : public CheckIntegrityEntry {
+public:
+  MockCheckIntegrityEntry(RequestGroup* requestGroup)
+      : CheckIntegrityEntry(requestGroup)
+  {
+  }
+
+  virtual bool isValidationReady() CXX11_OVERRIDE { return true; }
+
+  virtual void initValidator() CXX11_OVERRIDE {}
+
+  virtual void
+  onDownloadFinished(std::vector<std::unique_ptr<Command>>& commands,
+                     DownloadEngine* e) CXX11_OVERRIDE
+  {
+  }
+
+  virtual void
+  onDownloadIncomplete(std::vector<std::unique_ptr<Command>>& commands,
+                       DownloadEngine* e) CXX11_OVERRIDE
+  {
+  }
+};
+} // namespace
+
+namespace {
+std::function<bool(const CheckIntegrityEntry&)> byGroup(RequestGroup* rg)
+{
+  return [rg](const CheckIntegrityEntry& ent) {
+    return ent.getRequestGroup() == rg;
+  };
+}
+} // namespace
+
+void CheckIntegrityManTest::testPick()
+{
+  RequestGroup rg1(GroupId::create(), option_);
+  RequestGroup rg2(GroupId::create(), option_);
+  CheckIntegrityMan man;
+
+  CPPUNIT_ASSERT(!man.isPicked());
+  CPPUNIT_ASSERT(!man.hasNext());
+  CPPUNIT_ASSERT(!man.canPickNext());
+
+  man.pushEntry(make_unique<MockCheckIntegrityEntry>(&rg1));
+  man.pushEntry(make_unique<MockCheckIntegrityEntry>(&rg2));
+
+  CPPUNIT_ASSERT_EQUAL((size_t)2, man.countEntryInQueue());
+  CPPUNIT_ASSERT(man.canPickNext());
+  CPPUNIT_ASSERT(man.isQueued(byGroup(&rg1)));
+
+  auto entry1 = man.pickNext();
+
+  CPPUNIT_ASSERT(man.isPicked());
+  CPPUNIT_ASSERT(&rg1 == entry1->getRequestGroup());
+  CPPUNIT_ASSERT(!man.isQueued(byGroup(&rg1)));
+  CPPUNIT_ASSERT(entry1 == man.findPickedEntry(byGroup(&rg1)));
+  CPPUNIT_ASSERT(!man.findPickedEntry(byGroup(&rg2)));
+  // Only one entry is validated at a time without ThreadPool.
+  CPPUNIT_ASSERT(man.hasNext());
+  CPPUNIT_ASSERT(!man.canPickNext());
+
+  man.dropPickedEntry(entry1);
+
+  CPPUNIT_ASSERT(!man.isPicked());
+  CPPUNIT_ASSERT(man.canPickNext());
+
+  auto entry2 = man.pickNext();
+
+  CPPUNIT_ASSERT(&rg2 == entry2->getRequestGroup());
+  CPPUNIT_ASSERT(!man.hasNext());
+  CPPUNIT_ASSERT(!man.canPickNext());
+}
+
+#ifdef ENABLE_THREADS
+void CheckIntegrityManTest::testPick_threadPool()
+{
+  RequestGroup rg1(GroupId::create(), option_);
+  RequestGroup rg2(GroupId::create(), option_);
+  RequestGroup rg3(GroupId::create(), option_);
+  CheckIntegrityMan man;
+  man.setThreadPool(make_unique<ThreadPool>(2));
+
+  man.pushEntry(make_unique<MockCheckIntegrityEntry>(&rg1));
+  man.pushEntry(make_unique<MockCheckIntegrityEntry>(&rg2));
+  man.pushEntry(make_unique<MockCheckIntegrityEntry>(&rg3));
+
+  auto entry1 = man.pickNext();
+  CPPUNIT_ASSERT(man.canPickNext());
+  auto entry2 = man.pickNext();
+  // Up to the number of threads entries are picked.
+  CPPUNIT_ASSERT_EQUAL((size_t)2, man.getPickedEntries().size());
+  CPPUNIT_ASSERT(!man.canPickNext());
+
+  man.dropPickedEntry(entry1);
+
+  CPPUNIT_ASSERT(entry2 == man.findPickedEntry(byGroup(&rg2)));
+  CPPUNIT_ASSERT(man.canPickNext());
+  CPPUNIT_ASSERT(&rg3 == man.pickNext()->getRequestGroup());
+}
+#endif // ENABLE_THREADS
+
+} // namespace aria2
@@ -0,0 +1,101 @@
+#include "Command.h"
+
+#include <vector>
+#include <memory>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "a2functional.h"
+
+namespace aria2 {
+
+class CommandTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(CommandTest);
+  CPPUNIT_TEST(testSetStatus_scheduler);
+  CPPUNIT_TEST(testSetStatus_noScheduler);
+  CPPUNIT_TEST(testDestructor_timerScheduler);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void testSetStatus_scheduler();
+  void testSetStatus_noScheduler();
+  void testDestructor_timerScheduler();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(CommandTest);
+
+namespace {
+class MockCommand : public Command {
+public:
+  MockCommand() : Command(1) {}
+
+  virtual bool execute() CXX11_OVERRIDE { return true; }
+};
+
+class MockCommandScheduler : public CommandScheduler {
+public:
+  std::vector<Command*> readyCommands;
+  std::vector<Command*> canceledCommands;
+
+  virtual void commandReady(Command* command) CXX11_OVERRIDE
+  {
+    readyCommands.push_back(command);
+  }
+
+  virtual void cancelTimer(Command* command) CXX11_OVERRIDE
+  {
+    canceledCommands.push_back(command);
+  }
+};
+} // namespace
+
+void CommandTest::testSetStatus_scheduler()
+{
+  MockCommand command;
+  MockCommandScheduler scheduler;
+  command.setScheduler(&scheduler);
+
+  command.setStatusInactive();
+  CPPUNIT_ASSERT(scheduler.readyCommands.empty());
+
+  command.setStatusActive();
+  CPPUNIT_ASSERT_EQUAL((size_t)1, scheduler.readyCommands.size());
+  CPPUNIT_ASSERT(&command == scheduler.readyCommands[0]);
+
+  // scheduler is notified only once
+  command.setStatus(Command::STATUS_ONESHOT_REALTIME);
+  CPPUNIT_ASSERT_EQUAL((size_t)1, scheduler.readyCommands.size());
+
+  command.setScheduler(&scheduler);
+  command.setStatusRealtime();
+  CPPUNIT_ASSERT_EQUAL((size_t)2, scheduler.readyCommands.size());
+}
+
+void CommandTest::testSetStatus_noScheduler()
+{
+  MockCommand command;
+  command.setStatusActive();
+  CPPUNIT_ASSERT(command.statusMatch(Command::STATUS_ACTIVE));
+  command.transitStatus();
+  CPPUNIT_ASSERT(!command.statusMatch(Command::STATUS_ACTIVE));
+}
+
+void CommandTest::testDestructor_timerScheduler()
+{
+  MockCommandScheduler scheduler;
+  auto command = make_unique<MockCommand>();
+  auto ptr = command.get();
+  command->setTimerScheduler(&scheduler);
+  command.reset();
+  CPPUNIT_ASSERT_EQUAL((size_t)1, scheduler.canceledCommands.size());
+  CPPUNIT_ASSERT(ptr == scheduler.canceledCommands[0]);
+
+  command = make_unique<MockCommand>();
+  command->setTimerScheduler(&scheduler);
+  command->setTimerScheduler(nullptr);
+  command.reset();
+  CPPUNIT_ASSERT_EQUAL((size_t)1, scheduler.canceledCommands.size());
+}
+
+} // namespace aria2
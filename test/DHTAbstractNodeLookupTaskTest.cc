@@ -0,0 +1,230 @@
+#include "DHTAbstractNodeLookupTask.h"
+
+#include <cstring>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "DHTNodeLookupTask.h"
+#include "DHTMessageTracker.h"
+#include "DHTMessageTrackerEntry.h"
+#include "DHTRoutingTable.h"
+#include "DHTFindNodeMessage.h"
+#include "DHTFindNodeReplyMessage.h"
+#include "MockDHTMessageDispatcher.h"
+#include "MockDHTMessageFactory.h"
+#include "a2netcompat.h"
+#include "fmt.h"
+#include "wallclock.h"
+
+namespace aria2 {
+
+class DHTAbstractNodeLookupTaskTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(DHTAbstractNodeLookupTaskTest);
+  CPPUNIT_TEST(testOnStall);
+  CPPUNIT_TEST(testUpdateRTT);
+  CPPUNIT_TEST(testFinish_stalledNodeTimeout);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  class MessageFactory : public MockDHTMessageFactory {
+  public:
+    std::vector<std::shared_ptr<DHTNode>> nodes_;
+
+    virtual std::unique_ptr<DHTResponseMessage>
+    createResponseMessage(const std::string& messageType, const Dict* dict,
+                          const std::string& ipaddr,
+                          uint16_t port) CXX11_OVERRIDE
+    {
+      for (auto& node : nodes_) {
+        if (node->getIPAddress() == ipaddr && node->getPort() == port) {
+          return make_unique<DHTFindNodeReplyMessage>(
+              AF_INET, localNode_, node,
+              downcast<String>(dict->get("t"))->s());
+        }
+      }
+      return nullptr;
+    }
+
+    virtual std::unique_ptr<DHTFindNodeMessage>
+    createFindNodeMessage(const std::shared_ptr<DHTNode>& remoteNode,
+                          const unsigned char* targetNodeID,
+                          const std::string& transactionID = "")
+        CXX11_OVERRIDE
+    {
+      return make_unique<DHTFindNodeMessage>(localNode_, remoteNode,
+                                             targetNodeID, transactionID);
+    }
+  };
+
+  std::shared_ptr<DHTNode> localNode_;
+  std::unique_ptr<DHTRoutingTable> routingTable_;
+  std::unique_ptr<MockDHTMessageDispatcher> dispatcher_;
+  std::unique_ptr<MessageFactory> factory_;
+  std::unique_ptr<DHTMessageTracker> tracker_;
+  std::vector<std::unique_ptr<DHTMessage>> messages_;
+
+public:
+  void setUp()
+  {
+    global::wallclock().reset();
+    localNode_ = std::make_shared<DHTNode>();
+    routingTable_ = make_unique<DHTRoutingTable>(localNode_);
+    dispatcher_ = make_unique<MockDHTMessageDispatcher>();
+    factory_ = make_unique<MessageFactory>();
+    factory_->setLocalNode(localNode_);
+    tracker_ = make_unique<DHTMessageTracker>();
+    tracker_->setRoutingTable(routingTable_.get());
+    tracker_->setMessageFactory(factory_.get());
+    messages_.clear();
+  }
+
+  void tearDown()
+  {
+    // Callbacks held by tracker_ refer to the task.
+    tracker_.reset();
+    global::wallclock().reset();
+  }
+
+  void testOnStall();
+  void testUpdateRTT();
+  void testFinish_stalledNodeTimeout();
+
+  void addNodes(size_t n)
+  {
+    for (size_t i = 0; i < n; ++i) {
+      auto node = std::make_shared<DHTNode>();
+      node->setIPAddress(
+          fmt("192.168.0.%u", static_cast<unsigned int>(i + 1)));
+      node->setPort(6881 + i);
+      routingTable_->addNode(node);
+      factory_->nodes_.push_back(node);
+    }
+  }
+
+  std::unique_ptr<DHTNodeLookupTask> createTask(size_t concurrency)
+  {
+    unsigned char targetID[DHT_ID_LENGTH];
+    memset(targetID, 0, DHT_ID_LENGTH);
+    auto task = make_unique<DHTNodeLookupTask>(targetID);
+    task->setRoutingTable(routingTable_.get());
+    task->setMessageDispatcher(dispatcher_.get());
+    task->setMessageFactory(factory_.get());
+    task->setLocalNode(localNode_);
+    task->setConcurrency(concurrency);
+    return task;
+  }
+
+  // Moves the messages queued by the task to tracker_, as
+  // DHTMessageDispatcherImpl does when they are sent.  Returns the
+  // number of the messages moved.
+  size_t sendMessages()
+  {
+    size_t n = dispatcher_->messageQueue_.size();
+    for (auto& e : dispatcher_->messageQueue_) {
+      tracker_->addMessage(e.message_.get(), e.timeout_,
+                           std::move(e.callback_));
+      messages_.push_back(std::move(e.message_));
+    }
+    dispatcher_->messageQueue_.clear();
+    return n;
+  }
+
+  // Delivers the reply to messages_[i] through tracker_.
+  void reply(size_t i)
+  {
+    auto& remoteNode = messages_[i]->getRemoteNode();
+    Dict dict;
+    dict.put("t", messages_[i]->getTransactionID());
+    dict.put("y", "r");
+    auto p = tracker_->messageArrived(&dict, remoteNode->getIPAddress(),
+                                      remoteNode->getPort());
+    CPPUNIT_ASSERT(p.first);
+    CPPUNIT_ASSERT(p.second);
+    p.second->onReceived(p.first.get());
+  }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(DHTAbstractNodeLookupTaskTest);
+
+void DHTAbstractNodeLookupTaskTest::testOnStall()
+{
+  addNodes(4);
+  auto task = createTask(2);
+  task->startup();
+  CPPUNIT_ASSERT_EQUAL((size_t)2, sendMessages());
+
+  global::wallclock().advance(DHT_MESSAGE_STALL_TIMEOUT);
+  tracker_->handleTimeout();
+  // Stalled nodes don't occupy the slots, so the rest are queried.
+  CPPUNIT_ASSERT_EQUAL((size_t)2, sendMessages());
+  CPPUNIT_ASSERT_EQUAL((size_t)4, tracker_->countEntry());
+  CPPUNIT_ASSERT(!task->finished());
+
+  // A stalled node is reported only once.
+  global::wallclock().advance(100_ms);
+  tracker_->handleTimeout();
+  CPPUNIT_ASSERT_EQUAL((size_t)0, sendMessages());
+
+  // The lookup converges without waiting for the stalled nodes, but
+  // the task is kept until they reply.
+  reply(2);
+  reply(3);
+  CPPUNIT_ASSERT(!task->finished());
+  reply(0);
+  reply(1);
+  CPPUNIT_ASSERT(task->finished());
+}
+
+void DHTAbstractNodeLookupTaskTest::testUpdateRTT()
+{
+  addNodes(2);
+  auto task = createTask(2);
+  task->startup();
+  CPPUNIT_ASSERT_EQUAL((size_t)2, sendMessages());
+  auto& node = messages_[0]->getRemoteNode();
+  CPPUNIT_ASSERT(!node->isRTTMeasured());
+
+  global::wallclock().advance(200_ms);
+  reply(0);
+  CPPUNIT_ASSERT(node->isRTTMeasured());
+  CPPUNIT_ASSERT_EQUAL((int64_t)200, (int64_t)node->getRTT().count());
+  CPPUNIT_ASSERT(!task->finished());
+
+  // The next message to the measured node stalls earlier than
+  // DHT_MESSAGE_STALL_TIMEOUT.
+  auto msg =
+      factory_->createFindNodeMessage(node, localNode_->getID(), "tid");
+  tracker_->addMessage(msg.get(), DHT_MESSAGE_TIMEOUT);
+  auto deadline = global::wallclock();
+  deadline.advance(DHT_MESSAGE_STALL_TIMEOUT);
+  CPPUNIT_ASSERT(tracker_->getEntryFor(msg.get())->getDeadline() < deadline);
+
+  reply(1);
+  CPPUNIT_ASSERT(task->finished());
+}
+
+void DHTAbstractNodeLookupTaskTest::testFinish_stalledNodeTimeout()
+{
+  addNodes(2);
+  auto task = createTask(2);
+  task->startup();
+  CPPUNIT_ASSERT_EQUAL((size_t)2, sendMessages());
+
+  global::wallclock().advance(100_ms);
+  reply(1);
+  CPPUNIT_ASSERT(!task->finished());
+
+  global::wallclock().advance(DHT_MESSAGE_STALL_TIMEOUT);
+  tracker_->handleTimeout();
+  // Nothing is left to query.
+  CPPUNIT_ASSERT_EQUAL((size_t)0, sendMessages());
+  CPPUNIT_ASSERT(!task->finished());
+
+  global::wallclock().advance(DHT_MESSAGE_TIMEOUT);
+  tracker_->handleTimeout();
+  CPPUNIT_ASSERT_EQUAL((size_t)0, tracker_->countEntry());
+  CPPUNIT_ASSERT(task->finished());
+}
+
+} // namespace aria2
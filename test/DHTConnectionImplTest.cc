@@ -1,6 +1,8 @@
 #include "DHTConnectionImpl.h"
 
 #include <iostream>
+#include <array>
+#include <vector>
 #include <cppunit/extensions/HelperMacros.h>
 
 #include "Exception.h"
@@ -13,6 +15,8 @@ class DHTConnectionImplTest : public CppUnit::TestFixture {
 
   CPPUNIT_TEST_SUITE(DHTConnectionImplTest);
   CPPUNIT_TEST(testWriteAndReadData);
+  CPPUNIT_TEST(testWriteAndReadMessages);
+  CPPUNIT_TEST(testFlush_fail);
   CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -21,6 +25,8 @@ public:
   void tearDown() {}
 
   void testWriteAndReadData();
+  void testWriteAndReadMessages();
+  void testFlush_fail();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(DHTConnectionImplTest);
@@ -40,6 +46,9 @@ void DHTConnectionImplTest::testWriteAndReadData()
     // hostname should be "localhost", not 127.0.0.1. Test failed on Mac OSX10.5
     con1.sendMessage(reinterpret_cast<const unsigned char*>(message1.c_str()),
                      message1.size(), "localhost", con2port);
+    std::vector<Endpoint> failed;
+    con1.flush(failed);
+    CPPUNIT_ASSERT(failed.empty());
 
     unsigned char readbuffer[100];
     std::string remoteHost;
@@ -59,4 +68,88 @@ void DHTConnectionImplTest::testWriteAndReadData()
   }
 }
 
+void DHTConnectionImplTest::testWriteAndReadMessages()
+{
+  try {
+    DHTConnectionImpl con1(AF_INET);
+    uint16_t con1port = 0;
+    CPPUNIT_ASSERT(con1.bind(con1port, A2STR::NIL));
+
+    DHTConnectionImpl con2(AF_INET);
+    uint16_t con2port = 0;
+    CPPUNIT_ASSERT(con2.bind(con2port, A2STR::NIL));
+
+    std::vector<std::string> messages{"alpha", "bravo", "charlie"};
+    for (auto& m : messages) {
+      con1.sendMessage(reinterpret_cast<const unsigned char*>(m.c_str()),
+                       m.size(), "127.0.0.1", con2port);
+    }
+    // Nothing is sent until flush() is called.
+    CPPUNIT_ASSERT(!con2.getSocket()->isReadable(0));
+    std::vector<Endpoint> failed;
+    con1.flush(failed);
+    CPPUNIT_ASSERT(failed.empty());
+
+    unsigned char readbuffer[4][100];
+    std::array<Datagram, 4> msgs;
+    size_t nread = 0;
+    while (nread < messages.size()) {
+      while (!con2.getSocket()->isReadable(0))
+        ;
+      for (size_t i = nread; i < msgs.size(); ++i) {
+        msgs[i].data = readbuffer[i];
+        msgs[i].length = sizeof(readbuffer[i]);
+      }
+      nread += con2.receiveMessages(msgs.data() + nread, msgs.size() - nread);
+    }
+    CPPUNIT_ASSERT_EQUAL((size_t)3, nread);
+    for (size_t i = 0; i < messages.size(); ++i) {
+      CPPUNIT_ASSERT_EQUAL(
+          messages[i],
+          std::string(msgs[i].data, msgs[i].data + msgs[i].length));
+      CPPUNIT_ASSERT_EQUAL(std::string("127.0.0.1"), msgs[i].endpoint.addr);
+      CPPUNIT_ASSERT_EQUAL(con1port, msgs[i].endpoint.port);
+    }
+  }
+  catch (Exception& e) {
+    CPPUNIT_FAIL(e.stackTrace());
+  }
+}
+
+void DHTConnectionImplTest::testFlush_fail()
+{
+  try {
+    DHTConnectionImpl con1(AF_INET);
+    uint16_t con1port = 0;
+    CPPUNIT_ASSERT(con1.bind(con1port, A2STR::NIL));
+
+    DHTConnectionImpl con2(AF_INET);
+    uint16_t con2port = 0;
+    CPPUNIT_ASSERT(con2.bind(con2port, A2STR::NIL));
+
+    std::string message = "hello world.";
+    auto data = reinterpret_cast<const unsigned char*>(message.c_str());
+    // IPv6 address cannot be resolved for IPv4 socket.
+    con1.sendMessage(data, message.size(), "::1", con2port);
+    con1.sendMessage(data, message.size(), "127.0.0.1", con2port);
+    std::vector<Endpoint> failed;
+    con1.flush(failed);
+    CPPUNIT_ASSERT_EQUAL((size_t)1, failed.size());
+    CPPUNIT_ASSERT_EQUAL(std::string("::1"), failed[0].addr);
+    CPPUNIT_ASSERT_EQUAL(con2port, failed[0].port);
+
+    unsigned char readbuffer[100];
+    std::string remoteHost;
+    uint16_t remotePort;
+    while (!con2.getSocket()->isReadable(0))
+      ;
+    ssize_t rlength = con2.receiveMessage(readbuffer, sizeof(readbuffer),
+                                          remoteHost, remotePort);
+    CPPUNIT_ASSERT_EQUAL((ssize_t)message.size(), rlength);
+  }
+  catch (Exception& e) {
+    CPPUNIT_FAIL(e.stackTrace());
+  }
+}
+
 } // namespace aria2
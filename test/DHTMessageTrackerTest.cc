@@ -10,6 +10,7 @@
 #include "DHTMessageTrackerEntry.h"
 #include "DHTRoutingTable.h"
 #include "MockDHTMessageFactory.h"
+#include "wallclock.h"
 
 namespace aria2 {
 
@@ -18,6 +19,7 @@ class DHTMessageTrackerTest : public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(DHTMessageTrackerTest);
   CPPUNIT_TEST(testMessageArrived);
   CPPUNIT_TEST(testHandleTimeout);
+  CPPUNIT_TEST(testHandleSendFailure);
   CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -28,6 +30,8 @@ public:
   void testMessageArrived();
 
   void testHandleTimeout();
+
+  void testHandleSendFailure();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(DHTMessageTrackerTest);
@@ -95,6 +99,120 @@ void DHTMessageTrackerTest::testMessageArrived()
   }
 }
 
-void DHTMessageTrackerTest::testHandleTimeout() {}
+namespace {
+struct CallbackCount {
+  int stall;
+  int timeout;
+};
+
+class CountingCallback : public MockDHTMessageCallback {
+public:
+  CountingCallback(CallbackCount* count) : count_(count) {}
+
+  virtual void
+  onTimeout(const std::shared_ptr<DHTNode>& remoteNode) CXX11_OVERRIDE
+  {
+    ++count_->timeout;
+  }
+
+  virtual void
+  onStall(const std::shared_ptr<DHTNode>& remoteNode) CXX11_OVERRIDE
+  {
+    ++count_->stall;
+  }
+
+private:
+  CallbackCount* count_;
+};
+} // namespace
+
+void DHTMessageTrackerTest::testHandleTimeout()
+{
+  auto localNode = std::make_shared<DHTNode>();
+  auto routingTable = make_unique<DHTRoutingTable>(localNode);
+
+  // r1 is unknown, and r2 replied in 100ms before.
+  auto r1 = std::make_shared<DHTNode>();
+  r1->setIPAddress("192.168.0.1");
+  r1->setPort(6881);
+  auto r2 = std::make_shared<DHTNode>();
+  r2->setIPAddress("192.168.0.2");
+  r2->setPort(6882);
+  r2->updateRTT(100_ms);
+
+  auto m1 = make_unique<MockDHTMessage>(localNode, r1);
+  auto m2 = make_unique<MockDHTMessage>(localNode, r2);
+
+  CallbackCount c1{0, 0}, c2{0, 0};
+  DHTMessageTracker tracker;
+  tracker.setRoutingTable(routingTable.get());
+  global::wallclock().reset();
+  tracker.addMessage(m1.get(), DHT_MESSAGE_TIMEOUT,
+                     make_unique<CountingCallback>(&c1));
+  tracker.addMessage(m2.get(), DHT_MESSAGE_TIMEOUT,
+                     make_unique<CountingCallback>(&c2));
+
+  Timer deadline;
+  CPPUNIT_ASSERT(tracker.getNextDeadline(deadline));
+  // The stall timeout of r2 is max(100 + 4 * 50, 500) ms.
+  auto expected = global::wallclock();
+  expected.advance(500_ms);
+  CPPUNIT_ASSERT(!(deadline < expected) && !(expected < deadline));
+
+  global::wallclock().advance(600_ms);
+  tracker.handleTimeout();
+  CPPUNIT_ASSERT_EQUAL(0, c1.stall);
+  CPPUNIT_ASSERT_EQUAL(1, c2.stall);
+
+  global::wallclock().advance(500_ms);
+  tracker.handleTimeout();
+  CPPUNIT_ASSERT_EQUAL(1, c1.stall);
+  CPPUNIT_ASSERT_EQUAL(1, c2.stall);
+  CPPUNIT_ASSERT_EQUAL((size_t)2, tracker.countEntry());
+
+  // The timeout of r2 is max(2 * 300, 2000) ms.
+  global::wallclock().advance(1_s);
+  tracker.handleTimeout();
+  CPPUNIT_ASSERT_EQUAL(0, c1.timeout);
+  CPPUNIT_ASSERT_EQUAL(1, c2.timeout);
+  CPPUNIT_ASSERT_EQUAL((size_t)1, tracker.countEntry());
+
+  global::wallclock().advance(8_s);
+  tracker.handleTimeout();
+  CPPUNIT_ASSERT_EQUAL(1, c1.timeout);
+  CPPUNIT_ASSERT_EQUAL((size_t)0, tracker.countEntry());
+  CPPUNIT_ASSERT(!tracker.getNextDeadline(deadline));
+  global::wallclock().reset();
+}
+
+void DHTMessageTrackerTest::testHandleSendFailure()
+{
+  auto localNode = std::make_shared<DHTNode>();
+  auto routingTable = make_unique<DHTRoutingTable>(localNode);
+
+  auto r1 = std::make_shared<DHTNode>();
+  r1->setIPAddress("192.168.0.1");
+  r1->setPort(6881);
+  auto r2 = std::make_shared<DHTNode>();
+  r2->setIPAddress("192.168.0.1");
+  r2->setPort(6882);
+
+  auto m1 = make_unique<MockDHTMessage>(localNode, r1);
+  auto m2 = make_unique<MockDHTMessage>(localNode, r2);
+
+  CallbackCount c1{0, 0}, c2{0, 0};
+  DHTMessageTracker tracker;
+  tracker.setRoutingTable(routingTable.get());
+  tracker.addMessage(m1.get(), DHT_MESSAGE_TIMEOUT,
+                     make_unique<CountingCallback>(&c1));
+  tracker.addMessage(m2.get(), DHT_MESSAGE_TIMEOUT,
+                     make_unique<CountingCallback>(&c2));
+
+  tracker.handleSendFailure("192.168.0.1", 6881);
+  CPPUNIT_ASSERT_EQUAL(1, c1.timeout);
+  CPPUNIT_ASSERT_EQUAL(0, c2.timeout);
+  CPPUNIT_ASSERT_EQUAL((size_t)1, tracker.countEntry());
+  CPPUNIT_ASSERT(tracker.getEntryFor(m2.get()));
+}
 
 } // namespace aria2
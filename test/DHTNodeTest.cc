@@ -10,6 +10,7 @@ class DHTNodeTest : public CppUnit::TestFixture {
 
   CPPUNIT_TEST_SUITE(DHTNodeTest);
   CPPUNIT_TEST(testGenerateID);
+  CPPUNIT_TEST(testUpdateRTT);
   CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -18,6 +19,7 @@ public:
   void tearDown() {}
 
   void testGenerateID();
+  void testUpdateRTT();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(DHTNodeTest);
@@ -28,4 +30,26 @@ void DHTNodeTest::testGenerateID()
   std::cerr << util::toHex(node.getID(), DHT_ID_LENGTH) << std::endl;
 }
 
+void DHTNodeTest::testUpdateRTT()
+{
+  DHTNode node;
+  CPPUNIT_ASSERT(!node.isRTTMeasured());
+  CPPUNIT_ASSERT_EQUAL((int64_t)10000,
+                       (int64_t)node.getReplyTimeout(10_s).count());
+
+  node.updateRTT(100_ms);
+  CPPUNIT_ASSERT(node.isRTTMeasured());
+  CPPUNIT_ASSERT_EQUAL((int64_t)100, (int64_t)node.getRTT().count());
+  // 100 + 4 * 50
+  CPPUNIT_ASSERT_EQUAL((int64_t)300,
+                       (int64_t)node.getReplyTimeout(10_s).count());
+
+  node.updateRTT(200_ms);
+  // (7 * 100 + 200) / 8
+  CPPUNIT_ASSERT_EQUAL((int64_t)112, (int64_t)node.getRTT().count());
+  // 112 + 4 * ((3 * 50 + 100) / 4)
+  CPPUNIT_ASSERT_EQUAL((int64_t)360,
+                       (int64_t)node.getReplyTimeout(10_s).count());
+}
+
 } // namespace aria2
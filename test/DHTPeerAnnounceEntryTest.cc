@@ -8,6 +8,7 @@
 #include "util.h"
 #include "FileEntry.h"
 #include "Peer.h"
+#include "fmt.h"
 
 namespace aria2 {
 
@@ -17,6 +18,7 @@ class DHTPeerAnnounceEntryTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(testRemoveStalePeerAddrEntry);
   CPPUNIT_TEST(testEmpty);
   CPPUNIT_TEST(testAddPeerAddrEntry);
+  CPPUNIT_TEST(testAddPeerAddrEntry_max);
   CPPUNIT_TEST(testGetPeers);
   CPPUNIT_TEST_SUITE_END();
 
@@ -24,6 +26,7 @@ public:
   void testRemoveStalePeerAddrEntry();
   void testEmpty();
   void testAddPeerAddrEntry();
+  void testAddPeerAddrEntry_max();
   void testGetPeers();
 };
 
@@ -84,6 +87,36 @@ void DHTPeerAnnounceEntryTest::testAddPeerAddrEntry()
   CPPUNIT_ASSERT(!entry.getPeerAddrEntries()[0].getLastUpdated().isZero());
 }
 
+void DHTPeerAnnounceEntryTest::testAddPeerAddrEntry_max()
+{
+  unsigned char infohash[DHT_ID_LENGTH];
+  memset(infohash, 0xff, DHT_ID_LENGTH);
+
+  DHTPeerAnnounceEntry entry(infohash);
+  CPPUNIT_ASSERT(entry.addPeerAddrEntry(
+      PeerAddrEntry("2001:db8::1", 6881, Timer::zero())));
+  for (size_t i = 1; i < DHT_PEER_ANNOUNCE_MAX_PEERS; ++i) {
+    CPPUNIT_ASSERT(entry.addPeerAddrEntry(PeerAddrEntry(
+        fmt("10.0.%u.%u", static_cast<unsigned int>(i / 256),
+            static_cast<unsigned int>(i % 256)),
+        6881)));
+  }
+  CPPUNIT_ASSERT_EQUAL((size_t)DHT_PEER_ANNOUNCE_MAX_PEERS,
+                       entry.countPeerAddrEntry());
+  CPPUNIT_ASSERT_EQUAL(std::string("2001:db8::1"),
+                       entry.getPeerAddrEntries()[0].getIPAddress());
+  CPPUNIT_ASSERT(!entry.addPeerAddrEntry(PeerAddrEntry("10.0.0.1", 6881)));
+
+  // The least recently updated entry is replaced.
+  CPPUNIT_ASSERT(entry.addPeerAddrEntry(PeerAddrEntry("192.168.0.1", 6882)));
+  CPPUNIT_ASSERT_EQUAL((size_t)DHT_PEER_ANNOUNCE_MAX_PEERS,
+                       entry.countPeerAddrEntry());
+  CPPUNIT_ASSERT(!entry.findPeerAddrEntry(PeerAddrEntry("2001:db8::1", 6881)));
+  auto p = entry.findPeerAddrEntry(PeerAddrEntry("192.168.0.1", 6882));
+  CPPUNIT_ASSERT(p);
+  CPPUNIT_ASSERT_EQUAL((uint16_t)6882, p->getPort());
+}
+
 void DHTPeerAnnounceEntryTest::testGetPeers()
 {
   unsigned char infohash[DHT_ID_LENGTH];
@@ -11,6 +11,7 @@
 #include "Peer.h"
 #include "FileEntry.h"
 #include "bittorrent_helper.h"
+#include "wallclock.h"
 
 namespace aria2 {
 
@@ -18,10 +19,16 @@ class DHTPeerAnnounceStorageTest : public CppUnit::TestFixture {
 
   CPPUNIT_TEST_SUITE(DHTPeerAnnounceStorageTest);
   CPPUNIT_TEST(testAddAnnounce);
+  CPPUNIT_TEST(testHandleTimeout);
+  CPPUNIT_TEST(testHandleTimeout_reannounced);
+  CPPUNIT_TEST(testSetMaxPeer);
   CPPUNIT_TEST_SUITE_END();
 
 public:
   void testAddAnnounce();
+  void testHandleTimeout();
+  void testHandleTimeout_reannounced();
+  void testSetMaxPeer();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(DHTPeerAnnounceStorageTest);
@@ -47,4 +54,99 @@ void DHTPeerAnnounceStorageTest::testAddAnnounce()
   CPPUNIT_ASSERT_EQUAL(std::string("192.168.0.4"), peers[1]->getIPAddress());
 }
 
+void DHTPeerAnnounceStorageTest::testHandleTimeout()
+{
+  unsigned char infohash1[DHT_ID_LENGTH];
+  memset(infohash1, 0xff, DHT_ID_LENGTH);
+  unsigned char infohash2[DHT_ID_LENGTH];
+  memset(infohash2, 0xf0, DHT_ID_LENGTH);
+  DHTPeerAnnounceStorage storage;
+
+  global::wallclock().reset();
+  storage.addPeerAnnounce(infohash1, "192.168.0.1", 6881);
+  storage.addPeerAnnounce(infohash2, "192.168.0.2", 6882);
+  global::wallclock().advance(20_min);
+  storage.addPeerAnnounce(infohash1, "192.168.0.1", 6881);
+  storage.addPeerAnnounce(infohash1, "192.168.0.3", 6883);
+  CPPUNIT_ASSERT_EQUAL((size_t)2, storage.countInfoHash());
+  CPPUNIT_ASSERT_EQUAL((size_t)3, storage.countPeer());
+
+  global::wallclock().advance(11_min);
+  storage.handleTimeout();
+  CPPUNIT_ASSERT(storage.contains(infohash1));
+  CPPUNIT_ASSERT(!storage.contains(infohash2));
+  CPPUNIT_ASSERT_EQUAL((size_t)2, storage.countPeer());
+
+  global::wallclock().advance(20_min);
+  storage.handleTimeout();
+  CPPUNIT_ASSERT(!storage.contains(infohash1));
+  CPPUNIT_ASSERT_EQUAL((size_t)0, storage.countInfoHash());
+  CPPUNIT_ASSERT_EQUAL((size_t)0, storage.countPeer());
+  global::wallclock().reset();
+}
+
+void DHTPeerAnnounceStorageTest::testHandleTimeout_reannounced()
+{
+  unsigned char infohash1[DHT_ID_LENGTH];
+  memset(infohash1, 0xff, DHT_ID_LENGTH);
+  unsigned char infohash2[DHT_ID_LENGTH];
+  memset(infohash2, 0xf0, DHT_ID_LENGTH);
+  DHTPeerAnnounceStorage storage;
+
+  global::wallclock().reset();
+  storage.addPeerAnnounce(infohash1, "192.168.0.1", 6881);
+  storage.addPeerAnnounce(infohash2, "192.168.0.2", 6882);
+  global::wallclock().advance(20_min);
+  storage.addPeerAnnounce(infohash1, "192.168.0.1", 6881);
+  storage.addPeerAnnounce(infohash1, "192.168.0.1", 6881);
+  global::wallclock().advance(5_min);
+  storage.addPeerAnnounce(infohash2, "192.168.0.3", 6883);
+
+  global::wallclock().advance(6_min);
+  storage.handleTimeout();
+  CPPUNIT_ASSERT_EQUAL((size_t)2, storage.countPeer());
+
+  // The peer announced again 20 minutes later expires before the one
+  // announced 25 minutes later.
+  global::wallclock().advance(20_min);
+  storage.handleTimeout();
+  CPPUNIT_ASSERT(!storage.contains(infohash1));
+  CPPUNIT_ASSERT(storage.contains(infohash2));
+  CPPUNIT_ASSERT_EQUAL((size_t)1, storage.countPeer());
+  global::wallclock().reset();
+}
+
+void DHTPeerAnnounceStorageTest::testSetMaxPeer()
+{
+  unsigned char infohash1[DHT_ID_LENGTH];
+  memset(infohash1, 0xff, DHT_ID_LENGTH);
+  unsigned char infohash2[DHT_ID_LENGTH];
+  memset(infohash2, 0xf0, DHT_ID_LENGTH);
+  DHTPeerAnnounceStorage storage;
+  storage.setMaxPeer(2);
+
+  global::wallclock().reset();
+  storage.addPeerAnnounce(infohash1, "192.168.0.1", 6881);
+  global::wallclock().advance(1_s);
+  storage.addPeerAnnounce(infohash2, "192.168.0.2", 6882);
+  global::wallclock().advance(1_s);
+  // Updating the peer makes it the most recently announced one.
+  storage.addPeerAnnounce(infohash1, "192.168.0.1", 6881);
+  storage.addPeerAnnounce(infohash1, "192.168.0.3", 6883);
+  CPPUNIT_ASSERT_EQUAL((size_t)2, storage.countPeer());
+  CPPUNIT_ASSERT(!storage.contains(infohash2));
+
+  std::vector<std::shared_ptr<Peer>> peers;
+  storage.getPeers(peers, infohash1);
+  CPPUNIT_ASSERT_EQUAL((size_t)2, peers.size());
+  CPPUNIT_ASSERT_EQUAL(std::string("192.168.0.1"), peers[0]->getIPAddress());
+  CPPUNIT_ASSERT_EQUAL(std::string("192.168.0.3"), peers[1]->getIPAddress());
+  CPPUNIT_ASSERT(storage.estimateMemory() > 0);
+
+  // Not a numeric address
+  storage.addPeerAnnounce(infohash1, "localhost", 6884);
+  CPPUNIT_ASSERT_EQUAL((size_t)2, storage.countPeer());
+  global::wallclock().reset();
+}
+
 } // namespace aria2
@@ -2,6 +2,10 @@
 #include <cppunit/extensions/HelperMacros.h>
 
 #include "a2functional.h"
+#include "File.h"
+#ifdef ENABLE_THREADS
+#  include "ThreadPool.h"
+#endif // ENABLE_THREADS
 
 namespace aria2 {
 
@@ -9,6 +13,10 @@ class DefaultDiskWriterTest : public CppUnit::TestFixture {
 
   CPPUNIT_TEST_SUITE(DefaultDiskWriterTest);
   CPPUNIT_TEST(testSize);
+  CPPUNIT_TEST(testWriteDataVector);
+#ifdef ENABLE_THREADS
+  CPPUNIT_TEST(testWriteData_async);
+#endif // ENABLE_THREADS
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -16,6 +24,10 @@ public:
   void setUp() {}
 
   void testSize();
+  void testWriteDataVector();
+#ifdef ENABLE_THREADS
+  void testWriteData_async();
+#endif // ENABLE_THREADS
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(DefaultDiskWriterTest);
@@ -28,4 +40,51 @@ void DefaultDiskWriterTest::testSize()
   CPPUNIT_ASSERT_EQUAL((int64_t)4_k, dw.size());
 }
 
+void DefaultDiskWriterTest::testWriteDataVector()
+{
+  std::string filename =
+      A2_TEST_OUT_DIR "/aria2_DefaultDiskWriterTest_writeDataVector";
+  File(filename).remove();
+  DefaultDiskWriter dw(filename);
+  dw.initAndOpenFile();
+  std::string s1 = "hello", s2 = " ", s3 = "world", empty;
+  DataBuffers bufs;
+  for (auto s : {&s1, &empty, &s2, &s3, &empty}) {
+    bufs.emplace_back(reinterpret_cast<const unsigned char*>(s->data()),
+                      s->size());
+  }
+  dw.writeDataVector(bufs, 3);
+  CPPUNIT_ASSERT_EQUAL((int64_t)14, dw.size());
+  unsigned char buf[11];
+  CPPUNIT_ASSERT_EQUAL((ssize_t)11, dw.readData(buf, sizeof(buf), 3));
+  CPPUNIT_ASSERT_EQUAL(std::string("hello world"),
+                       std::string(&buf[0], &buf[sizeof(buf)]));
+  dw.closeFile();
+}
+
+#ifdef ENABLE_THREADS
+void DefaultDiskWriterTest::testWriteData_async()
+{
+  std::string filename = A2_TEST_OUT_DIR "/aria2_DefaultDiskWriterTest_async";
+  File(filename).remove();
+  DefaultDiskWriter dw(filename);
+  dw.enableAsyncWrite(std::make_shared<ThreadPool>(1));
+  dw.initAndOpenFile();
+  std::string data(1_m, 'a');
+  for (int i = 0; i < 10; ++i) {
+    // The buffer can be reused as soon as writeData() returns.
+    data.assign(data.size(), 'a' + i);
+    dw.writeData(reinterpret_cast<const unsigned char*>(data.data()),
+                 data.size(), i * data.size());
+  }
+  // size() and readData() wait for the pending writes.
+  CPPUNIT_ASSERT_EQUAL((int64_t)10_m, dw.size());
+  unsigned char buf[4];
+  CPPUNIT_ASSERT_EQUAL((ssize_t)4, dw.readData(buf, sizeof(buf), 9_m - 2));
+  CPPUNIT_ASSERT_EQUAL(std::string("iijj"),
+                       std::string(&buf[0], &buf[sizeof(buf)]));
+  dw.closeFile();
+}
+#endif // ENABLE_THREADS
+
 } // namespace aria2
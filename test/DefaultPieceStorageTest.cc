@@ -416,6 +416,8 @@ void DefaultPieceStorageTest::testAdvertisePiece()
   std::vector<size_t> res, ans;
   uint64_t lastHaveIndex;
 
+  CPPUNIT_ASSERT_EQUAL((uint64_t)5, ps.getLastHaveIndex());
+
   lastHaveIndex = ps.getAdvertisedPieceIndexes(res, 1, 0);
   ans = std::vector<size_t>{100, 101, 102, 103, 104};
 
@@ -448,6 +450,13 @@ void DefaultPieceStorageTest::testAdvertisePiece()
   CPPUNIT_ASSERT_EQUAL((size_t)2, res.size());
   CPPUNIT_ASSERT(ans == res);
 
+  res.clear();
+  lastHaveIndex = ps.getAdvertisedPieceIndexes(res, 1, 4);
+  ans = std::vector<size_t>{104};
+
+  CPPUNIT_ASSERT_EQUAL((uint64_t)5, lastHaveIndex);
+  CPPUNIT_ASSERT(ans == res);
+
   ps.removeAdvertisedPiece(Timer(300_s));
 
   res.clear();
@@ -455,6 +464,7 @@ void DefaultPieceStorageTest::testAdvertisePiece()
 
   CPPUNIT_ASSERT_EQUAL((uint64_t)0, lastHaveIndex);
   CPPUNIT_ASSERT_EQUAL((size_t)0, res.size());
+  CPPUNIT_ASSERT_EQUAL((uint64_t)5, ps.getLastHaveIndex());
 }
 
 } // namespace aria2
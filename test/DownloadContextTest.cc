@@ -12,6 +12,7 @@ class DownloadContextTest : public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(DownloadContextTest);
   CPPUNIT_TEST(testFindFileEntryByOffset);
   CPPUNIT_TEST(testGetPieceHash);
+  CPPUNIT_TEST(testSetPieceHashes_differentLength);
   CPPUNIT_TEST(testGetNumPieces);
   CPPUNIT_TEST(testGetBasePath);
   CPPUNIT_TEST(testSetFileFilter);
@@ -20,6 +21,7 @@ class DownloadContextTest : public CppUnit::TestFixture {
 public:
   void testFindFileEntryByOffset();
   void testGetPieceHash();
+  void testSetPieceHashes_differentLength();
   void testGetNumPieces();
   void testGetBasePath();
   void testSetFileFilter();
@@ -54,10 +56,46 @@ void DownloadContextTest::testFindFileEntryByOffset()
 void DownloadContextTest::testGetPieceHash()
 {
   DownloadContext ctx;
-  const std::string pieceHashes[] = {"hash1", "hash2", "shash3"};
+  const std::string pieceHashes[] = {"hash1", "hash2", "hash3"};
   ctx.setPieceHashes("sha-1", &pieceHashes[0], &pieceHashes[3]);
-  CPPUNIT_ASSERT_EQUAL(std::string("hash1"), ctx.getPieceHash(0));
-  CPPUNIT_ASSERT_EQUAL(std::string(""), ctx.getPieceHash(3));
+  CPPUNIT_ASSERT_EQUAL((size_t)3, ctx.countPieceHash());
+  CPPUNIT_ASSERT_EQUAL((size_t)5, ctx.getPieceHashLength());
+  CPPUNIT_ASSERT_EQUAL(std::string("hash1"),
+                       std::string(ctx.getPieceHash(0), 5));
+  CPPUNIT_ASSERT_EQUAL(std::string("hash3"),
+                       std::string(ctx.getPieceHash(2), 5));
+  CPPUNIT_ASSERT(!ctx.getPieceHash(3));
+  CPPUNIT_ASSERT(ctx.matchPieceHash(1, "hash2"));
+  CPPUNIT_ASSERT(!ctx.matchPieceHash(1, "hash3"));
+  CPPUNIT_ASSERT(!ctx.matchPieceHash(1, "hash"));
+  CPPUNIT_ASSERT(!ctx.matchPieceHash(3, "hash3"));
+
+  ctx.setPieceHashes("md5", "abcdefgh", 4);
+  CPPUNIT_ASSERT_EQUAL(std::string("md5"), ctx.getPieceHashType());
+  CPPUNIT_ASSERT_EQUAL((size_t)2, ctx.countPieceHash());
+  CPPUNIT_ASSERT(ctx.matchPieceHash(1, "efgh"));
+  CPPUNIT_ASSERT(!ctx.getPieceHash(2));
+}
+
+void DownloadContextTest::testSetPieceHashes_differentLength()
+{
+  DownloadContext ctx;
+  const std::string pieceHashes[] = {"hash1", "hash2", "shash3"};
+  try {
+    ctx.setPieceHashes("sha-1", &pieceHashes[0], &pieceHashes[3]);
+    CPPUNIT_FAIL("exception must be thrown.");
+  }
+  catch (RecoverableException& e) {
+    // success
+  }
+  try {
+    ctx.setPieceHashes("sha-1", "abcdefghi", 4);
+    CPPUNIT_FAIL("exception must be thrown.");
+  }
+  catch (RecoverableException& e) {
+    // success
+  }
+  CPPUNIT_ASSERT_EQUAL((size_t)0, ctx.countPieceHash());
 }
 
 void DownloadContextTest::testGetNumPieces()
@@ -0,0 +1,114 @@
+#include "DownloadEngine.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "prefs.h"
+#include "Option.h"
+#include "RequestGroupMan.h"
+#include "SelectEventPoll.h"
+#include "wallclock.h"
+
+namespace aria2 {
+
+class DownloadEngineTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(DownloadEngineTest);
+  CPPUNIT_TEST(testAddTimer);
+  CPPUNIT_TEST(testAddTimer_commandDeleted);
+  CPPUNIT_TEST(testRun_timerExpired);
+  CPPUNIT_TEST(testRun_parked);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  std::unique_ptr<DownloadEngine> e_;
+  std::shared_ptr<Option> option_;
+
+public:
+  void setUp()
+  {
+    option_ = std::make_shared<Option>();
+    e_ = make_unique<DownloadEngine>(make_unique<SelectEventPoll>());
+    e_->setOption(option_.get());
+    e_->setRequestGroupMan(make_unique<RequestGroupMan>(
+        std::vector<std::shared_ptr<RequestGroup>>{}, 1, option_.get()));
+  }
+
+  void testAddTimer();
+  void testAddTimer_commandDeleted();
+  void testRun_timerExpired();
+  void testRun_parked();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(DownloadEngineTest);
+
+namespace {
+class MockCommand : public Command {
+public:
+  int* numExecute;
+
+  MockCommand(int* numExecute) : Command(1), numExecute(numExecute) {}
+
+  virtual bool execute() CXX11_OVERRIDE
+  {
+    ++*numExecute;
+    return true;
+  }
+};
+} // namespace
+
+void DownloadEngineTest::testAddTimer()
+{
+  int numExecute = 0;
+  auto command = make_unique<MockCommand>(&numExecute);
+  auto deadline = global::wallclock();
+  deadline.advance(10_s);
+  e_->addTimer(deadline, command.get());
+  CPPUNIT_ASSERT_EQUAL((size_t)1, e_->countTimer());
+  // Only the earliest deadline is kept.
+  deadline.sub(5_s);
+  e_->addTimer(deadline, command.get());
+  CPPUNIT_ASSERT_EQUAL((size_t)1, e_->countTimer());
+}
+
+void DownloadEngineTest::testAddTimer_commandDeleted()
+{
+  int numExecute = 0;
+  auto command = make_unique<MockCommand>(&numExecute);
+  e_->addTimer(global::wallclock(), command.get());
+  CPPUNIT_ASSERT_EQUAL((size_t)1, e_->countTimer());
+  command.reset();
+  CPPUNIT_ASSERT_EQUAL((size_t)0, e_->countTimer());
+}
+
+void DownloadEngineTest::testRun_timerExpired()
+{
+  int numExecute = 0;
+  auto command = make_unique<MockCommand>(&numExecute);
+  command->setStatusInactive();
+  global::wallclock().reset();
+  auto deadline = global::wallclock();
+  deadline.sub(1_s);
+  e_->addTimer(deadline, command.get());
+  e_->addCommand(std::move(command));
+  e_->run(true);
+  CPPUNIT_ASSERT_EQUAL(1, numExecute);
+  CPPUNIT_ASSERT_EQUAL((size_t)0, e_->countTimer());
+}
+
+void DownloadEngineTest::testRun_parked()
+{
+  int numExecute = 0;
+  auto command = make_unique<MockCommand>(&numExecute);
+  command->setStatusInactive();
+  e_->addCommand(std::move(command));
+  e_->run(true);
+  // No I/O event nor timer
+  CPPUNIT_ASSERT_EQUAL(0, numExecute);
+
+  e_->getRequestGroupMan()->requestRefresh();
+  e_->run(true);
+  CPPUNIT_ASSERT_EQUAL(1, numExecute);
+  CPPUNIT_ASSERT(!e_->getRequestGroupMan()->refreshRequested());
+}
+
+} // namespace aria2
@@ -0,0 +1,113 @@
+#include "DownloadResultIndex.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "DownloadResult.h"
+
+namespace aria2 {
+
+class DownloadResultIndexTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(DownloadResultIndexTest);
+  CPPUNIT_TEST(testAdd);
+  CPPUNIT_TEST(testRemove);
+  CPPUNIT_TEST(testClear);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  std::vector<std::shared_ptr<DownloadResult>> results_;
+
+public:
+  void setUp()
+  {
+    results_.clear();
+    addResult(error_code::FINISHED, "/a");
+    addResult(error_code::TIME_OUT, "/a");
+    addResult(error_code::REMOVED, "/b");
+    addResult(error_code::FINISHED, "/b");
+    addResult(error_code::NETWORK_PROBLEM, "/a");
+  }
+
+  void addResult(error_code::Value result, const std::string& dir)
+  {
+    auto dr = std::make_shared<DownloadResult>();
+    dr->result = result;
+    dr->dir = dir;
+    dr->seq = results_.size() + 1;
+    results_.push_back(dr);
+  }
+
+  void testAdd();
+  void testRemove();
+  void testClear();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(DownloadResultIndexTest);
+
+namespace {
+std::string toString(const DownloadResultIndex::SeqList& seqs)
+{
+  std::string res;
+  for (auto seq : seqs) {
+    res += std::to_string(seq);
+  }
+  return res;
+}
+} // namespace
+
+void DownloadResultIndexTest::testAdd()
+{
+  DownloadResultIndex index;
+  for (auto& dr : results_) {
+    index.add(*dr);
+  }
+  CPPUNIT_ASSERT_EQUAL(std::string("14"),
+                       toString(index.findByErrorCode(error_code::FINISHED)));
+  CPPUNIT_ASSERT_EQUAL(std::string("3"),
+                       toString(index.findByErrorCode(error_code::REMOVED)));
+  CPPUNIT_ASSERT_EQUAL(std::string("2"),
+                       toString(index.findByErrorCode(error_code::TIME_OUT)));
+  CPPUNIT_ASSERT(
+      index.findByErrorCode(error_code::RESOURCE_NOT_FOUND).empty());
+  CPPUNIT_ASSERT_EQUAL(std::string("25"), toString(index.findErrors()));
+  CPPUNIT_ASSERT_EQUAL(std::string("125"), toString(index.findByDir("/a")));
+  CPPUNIT_ASSERT_EQUAL(std::string("34"), toString(index.findByDir("/b")));
+  CPPUNIT_ASSERT(index.findByDir("/c").empty());
+}
+
+void DownloadResultIndexTest::testRemove()
+{
+  DownloadResultIndex index;
+  for (auto& dr : results_) {
+    index.add(*dr);
+  }
+  // oldest one
+  index.remove(*results_[0]);
+  CPPUNIT_ASSERT_EQUAL(std::string("4"),
+                       toString(index.findByErrorCode(error_code::FINISHED)));
+  CPPUNIT_ASSERT_EQUAL(std::string("25"), toString(index.findByDir("/a")));
+  // in the middle
+  index.remove(*results_[3]);
+  CPPUNIT_ASSERT(index.findByErrorCode(error_code::FINISHED).empty());
+  CPPUNIT_ASSERT_EQUAL(std::string("3"), toString(index.findByDir("/b")));
+  index.remove(*results_[4]);
+  CPPUNIT_ASSERT_EQUAL(std::string("2"), toString(index.findErrors()));
+  CPPUNIT_ASSERT_EQUAL(std::string("2"), toString(index.findByDir("/a")));
+  // not in the index
+  index.remove(*results_[4]);
+  CPPUNIT_ASSERT_EQUAL(std::string("2"), toString(index.findErrors()));
+}
+
+void DownloadResultIndexTest::testClear()
+{
+  DownloadResultIndex index;
+  for (auto& dr : results_) {
+    index.add(*dr);
+  }
+  index.clear();
+  CPPUNIT_ASSERT(index.findByErrorCode(error_code::FINISHED).empty());
+  CPPUNIT_ASSERT(index.findErrors().empty());
+  CPPUNIT_ASSERT(index.findByDir("/a").empty());
+}
+
+} // namespace aria2
@@ -0,0 +1,81 @@
+#include "FreeListAllocated.h"
+
+#include <memory>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "a2functional.h"
+
+namespace aria2 {
+
+class FreeListAllocatedTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(FreeListAllocatedTest);
+  CPPUNIT_TEST(testReuse);
+  CPPUNIT_TEST(testMaxFree);
+  CPPUNIT_TEST(testSubclass);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void testReuse();
+  void testMaxFree();
+  void testSubclass();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(FreeListAllocatedTest);
+
+namespace {
+class Base {
+public:
+  virtual ~Base() = default;
+};
+
+class Obj : public Base, public FreeListAllocated<Obj, 2> {
+public:
+  Obj(int n = 0) : n(n) {}
+  int n;
+};
+
+class LargeObj : public Obj {
+public:
+  char data[64];
+};
+} // namespace
+
+void FreeListAllocatedTest::testReuse()
+{
+  auto a = make_unique<Obj>(1);
+  auto p = a.get();
+  auto n = Obj::countFreeBlock();
+  a.reset();
+  CPPUNIT_ASSERT_EQUAL(n + 1, Obj::countFreeBlock());
+  std::unique_ptr<Base> b = make_unique<Obj>(2);
+  CPPUNIT_ASSERT(p == b.get());
+  CPPUNIT_ASSERT_EQUAL(n, Obj::countFreeBlock());
+  // Deleted through the pointer to Base
+  b.reset();
+  CPPUNIT_ASSERT_EQUAL(n + 1, Obj::countFreeBlock());
+}
+
+void FreeListAllocatedTest::testMaxFree()
+{
+  auto a = make_unique<Obj>();
+  auto b = make_unique<Obj>();
+  auto c = make_unique<Obj>();
+  CPPUNIT_ASSERT_EQUAL((size_t)0, Obj::countFreeBlock());
+  a.reset();
+  b.reset();
+  c.reset();
+  CPPUNIT_ASSERT_EQUAL((size_t)2, Obj::countFreeBlock());
+}
+
+void FreeListAllocatedTest::testSubclass()
+{
+  auto before = Obj::countFreeBlock();
+  std::unique_ptr<Obj> a = make_unique<LargeObj>();
+  CPPUNIT_ASSERT_EQUAL(before, Obj::countFreeBlock());
+  a.reset();
+  CPPUNIT_ASSERT_EQUAL(before, Obj::countFreeBlock());
+}
+
+} // namespace aria2
@@ -11,10 +11,12 @@ class GZipEncoderTest : public CppUnit::TestFixture {
 
   CPPUNIT_TEST_SUITE(GZipEncoderTest);
   CPPUNIT_TEST(testEncode);
+  CPPUNIT_TEST(testEncode_large);
   CPPUNIT_TEST_SUITE_END();
 
 public:
   void testEncode();
+  void testEncode_large();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(GZipEncoderTest);
@@ -45,4 +47,30 @@ void GZipEncoderTest::testEncode()
                        gunzippedData);
 }
 
+void GZipEncoderTest::testEncode_large()
+{
+  GZipEncoder encoder;
+  encoder.init();
+
+  std::string expected;
+  for (int i = 0; i < 10000; ++i) {
+    auto s = util::itos(i);
+    encoder << s;
+    encoder << ",";
+    expected += s;
+    expected += ",";
+  }
+  CPPUNIT_ASSERT(expected.size() > 16_k);
+
+  std::string gzippedData = encoder.str();
+
+  GZipDecoder decoder;
+  decoder.init();
+  std::string gunzippedData =
+      decoder.decode(reinterpret_cast<const unsigned char*>(gzippedData.data()),
+                     gzippedData.size());
+  CPPUNIT_ASSERT(decoder.finished());
+  CPPUNIT_ASSERT_EQUAL(expected, gunzippedData);
+}
+
 } // namespace aria2
@@ -0,0 +1,86 @@
+#include "HttpServerBodyCommand.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "HttpServer.h"
+#include "SocketCore.h"
+#include "DownloadEngine.h"
+#include "SelectEventPoll.h"
+#include "RequestGroupMan.h"
+#include "RequestGroup.h"
+#include "Option.h"
+#include "a2functional.h"
+
+namespace aria2 {
+
+class HttpServerBodyCommandTest : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(HttpServerBodyCommandTest);
+  CPPUNIT_TEST(testExecute_jsonpParseError);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  std::unique_ptr<Option> option_;
+  std::unique_ptr<DownloadEngine> e_;
+
+public:
+  void setUp()
+  {
+    option_ = make_unique<Option>();
+    e_ = make_unique<DownloadEngine>(make_unique<SelectEventPoll>());
+    e_->setOption(option_.get());
+    e_->setRequestGroupMan(make_unique<RequestGroupMan>(
+        std::vector<std::shared_ptr<RequestGroup>>{}, 1, option_.get()));
+    // Keep downloadFinished() false
+    e_->getRequestGroupMan()->setKeepRunning(true);
+  }
+
+  void testExecute_jsonpParseError();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(HttpServerBodyCommandTest);
+
+void HttpServerBodyCommandTest::testExecute_jsonpParseError()
+{
+  SocketCore server;
+  server.bind(0);
+  server.beginListen();
+  server.setBlockingMode();
+
+  SocketCore client;
+  client.establishConnection("localhost", server.getAddrInfo().port);
+  while (!client.isWritable(0)) {
+  }
+  std::shared_ptr<SocketCore> inbound = server.acceptConnection();
+  inbound->setBlockingMode();
+  auto httpServer = std::make_shared<HttpServer>(inbound);
+
+  // params is base64 of "[1,", which is not valid JSON.
+  client.writeData("GET /jsonrpc?method=aria2.getVersion&id=foo"
+                   "&params=WzEs&jsoncallback=cb HTTP/1.1\r\n"
+                   "Host: localhost\r\n\r\n");
+  while (!httpServer->receiveRequest()) {
+  }
+  CPPUNIT_ASSERT_EQUAL(RPC_TYPE_JSONP,
+                       httpServer->getRequestType());
+
+  auto command = make_unique<HttpServerBodyCommand>(1, httpServer, e_.get(),
+                                                    inbound);
+  CPPUNIT_ASSERT(command->execute());
+  while (!httpServer->sendBufferIsEmpty()) {
+    httpServer->sendResponse();
+  }
+
+  std::string response;
+  char buf[4096];
+  while (response.find("cb(") == std::string::npos ||
+         response.back() != ')') {
+    size_t len = sizeof(buf);
+    client.readData(buf, len);
+    CPPUNIT_ASSERT(len > 0);
+    response.append(buf, len);
+  }
+  CPPUNIT_ASSERT_MESSAGE(response,
+                         response.find("\"code\":-32700") != std::string::npos);
+}
+
+} // namespace aria2
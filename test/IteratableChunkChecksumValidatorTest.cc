@@ -17,6 +17,7 @@ class IteratableChunkChecksumValidatorTest : public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(IteratableChunkChecksumValidatorTest);
   CPPUNIT_TEST(testValidate);
   CPPUNIT_TEST(testValidate_readError);
+  CPPUNIT_TEST(testCheckChunk);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -27,6 +28,7 @@ public:
 
   void testValidate();
   void testValidate_readError();
+  void testCheckChunk();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(IteratableChunkChecksumValidatorTest);
@@ -106,4 +108,29 @@ void IteratableChunkChecksumValidatorTest::testValidate_readError()
   CPPUNIT_ASSERT(!ps->hasPiece(4));
 }
 
+void IteratableChunkChecksumValidatorTest::testCheckChunk()
+{
+  Option option;
+  std::shared_ptr<DownloadContext> dctx(new DownloadContext(
+      100, 250, A2_TEST_DIR "/chunkChecksumTestFile250.txt"));
+  dctx->setPieceHashes("sha-1", &csArray[0], &csArray[3]);
+  std::shared_ptr<DefaultPieceStorage> ps(
+      new DefaultPieceStorage(dctx, &option));
+  ps->initStorage();
+  ps->getDiskAdaptor()->enableReadOnly();
+  ps->getDiskAdaptor()->openFile();
+
+  IteratableChunkChecksumValidator validator(dctx, ps);
+  validator.init();
+
+  while (!validator.finished()) {
+    validator.checkChunk();
+  }
+  // PieceStorage is not updated until storeResult() is called.
+  CPPUNIT_ASSERT(!ps->hasPiece(0));
+
+  validator.storeResult();
+  CPPUNIT_ASSERT(ps->downloadFinished());
+}
+
 } // namespace aria2
@@ -0,0 +1,185 @@
+#include "JsonRpcRequestParser.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "ValueBaseJsonParser.h"
+#include "ValueBase.h"
+#include "json.h"
+
+namespace aria2 {
+
+namespace rpc {
+
+class JsonRpcRequestParserTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(JsonRpcRequestParserTest);
+  CPPUNIT_TEST(testParse);
+  CPPUNIT_TEST(testParse_batch);
+  CPPUNIT_TEST(testParse_invalidRequest);
+  CPPUNIT_TEST(testParse_error);
+  CPPUNIT_TEST(testParse_sameAsJsonParser);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void testParse();
+  void testParse_batch();
+  void testParse_invalidRequest();
+  void testParse_error();
+  void testParse_sameAsJsonParser();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(JsonRpcRequestParserTest);
+
+void JsonRpcRequestParserTest::testParse()
+{
+  JsonRpcRequestParser parser;
+  std::string src = "{\"jsonrpc\":\"2.0\", \"id\":\"qwer\","
+                    " \"method\":\"aria2.tellStatus\","
+                    " \"params\":[\"token:s\\\"ecret\","
+                    " \"2089b05ecca3d829\", [\"gid\", \"\\u00A2\"],"
+                    " -12, true, null, {\"a\":{}}],"
+                    " \"extra\":[{\"b\":[1.5e+3]}]}";
+  CPPUNIT_ASSERT_EQUAL(0, parser.parse(src.c_str(), src.size()));
+  CPPUNIT_ASSERT(!parser.isBatch());
+  auto& calls = parser.getCalls();
+  CPPUNIT_ASSERT_EQUAL((size_t)1, calls.size());
+  auto& call = calls[0];
+  CPPUNIT_ASSERT_EQUAL(0, call.error);
+  CPPUNIT_ASSERT(call.req.jsonRpc);
+  CPPUNIT_ASSERT_EQUAL(std::string("aria2.tellStatus"), call.req.methodName);
+  CPPUNIT_ASSERT_EQUAL(std::string("qwer"), downcast<String>(call.req.id)->s());
+  CPPUNIT_ASSERT_EQUAL(std::string("[\"token:s\\\"ecret\","
+                                   "\"2089b05ecca3d829\","
+                                   "[\"gid\",\"\xc2\xa2\"],"
+                                   "-12,true,null,{\"a\":{}}]"),
+                       json::encode(call.req.params.get()));
+
+  // "params" is optional
+  src = "{\"method\":\"aria2.getVersion\",\"id\":null}";
+  CPPUNIT_ASSERT_EQUAL(0, parser.parse(src.c_str(), src.size()));
+  CPPUNIT_ASSERT_EQUAL((size_t)1, calls.size());
+  CPPUNIT_ASSERT_EQUAL(0, calls[0].error);
+  CPPUNIT_ASSERT(downcast<Null>(calls[0].req.id));
+  CPPUNIT_ASSERT(calls[0].req.params->empty());
+}
+
+void JsonRpcRequestParserTest::testParse_batch()
+{
+  JsonRpcRequestParser parser;
+  std::string src = "[{\"id\":1,\"method\":\"aria2.tellActive\"},"
+                    " 1, [{}], {\"id\":2,\"method\":\"aria2.tellWaiting\","
+                    " \"params\":[0, 10]}]";
+  CPPUNIT_ASSERT_EQUAL(0, parser.parse(src.c_str(), src.size()));
+  CPPUNIT_ASSERT(parser.isBatch());
+  auto& calls = parser.getCalls();
+  CPPUNIT_ASSERT_EQUAL((size_t)2, calls.size());
+  CPPUNIT_ASSERT_EQUAL(std::string("aria2.tellActive"),
+                       calls[0].req.methodName);
+  CPPUNIT_ASSERT_EQUAL((int64_t)1, downcast<Integer>(calls[0].req.id)->i());
+  CPPUNIT_ASSERT_EQUAL(std::string("aria2.tellWaiting"),
+                       calls[1].req.methodName);
+  CPPUNIT_ASSERT_EQUAL((size_t)2, calls[1].req.params->size());
+
+  src = " [ ] ";
+  CPPUNIT_ASSERT_EQUAL(0, parser.parse(src.c_str(), src.size()));
+  CPPUNIT_ASSERT(parser.isBatch());
+  CPPUNIT_ASSERT(parser.getCalls().empty());
+}
+
+void JsonRpcRequestParserTest::testParse_invalidRequest()
+{
+  JsonRpcRequestParser parser;
+  // no id
+  std::string src = "{\"method\":\"aria2.getVersion\"}";
+  CPPUNIT_ASSERT_EQUAL(0, parser.parse(src.c_str(), src.size()));
+  CPPUNIT_ASSERT_EQUAL(-32600, parser.getCalls()[0].error);
+  CPPUNIT_ASSERT(!parser.getCalls()[0].req.id);
+  // method is not a string
+  src = "{\"method\":\"aria2.getVersion\",\"id\":\"a\",\"method\":1}";
+  CPPUNIT_ASSERT_EQUAL(0, parser.parse(src.c_str(), src.size()));
+  CPPUNIT_ASSERT_EQUAL(-32600, parser.getCalls()[0].error);
+  CPPUNIT_ASSERT(downcast<String>(parser.getCalls()[0].req.id));
+  // params is not an array
+  src = "{\"method\":\"aria2.getVersion\",\"id\":\"a\",\"params\":{}}";
+  CPPUNIT_ASSERT_EQUAL(0, parser.parse(src.c_str(), src.size()));
+  CPPUNIT_ASSERT_EQUAL(-32602, parser.getCalls()[0].error);
+  // not an object
+  src = "\"aria2.getVersion\"";
+  CPPUNIT_ASSERT_EQUAL(0, parser.parse(src.c_str(), src.size()));
+  CPPUNIT_ASSERT(!parser.isBatch());
+  CPPUNIT_ASSERT_EQUAL((size_t)1, parser.getCalls().size());
+  CPPUNIT_ASSERT_EQUAL(-32600, parser.getCalls()[0].error);
+}
+
+void JsonRpcRequestParserTest::testParse_error()
+{
+  JsonRpcRequestParser parser;
+  std::string src = "";
+  CPPUNIT_ASSERT_EQUAL((int)json::ERR_PREMATURE_DATA,
+                       parser.parse(src.c_str(), src.size()));
+  src = "{\"id\":1,\"method\":\"aria2.getVersion\"";
+  CPPUNIT_ASSERT_EQUAL((int)json::ERR_PREMATURE_DATA,
+                       parser.parse(src.c_str(), src.size()));
+  src = "{\"id\":tru}";
+  CPPUNIT_ASSERT_EQUAL((int)json::ERR_UNEXPECTED_LITERAL,
+                       parser.parse(src.c_str(), src.size()));
+  src = "{\"id\":1 \"method\":\"aria2.getVersion\"}";
+  CPPUNIT_ASSERT_EQUAL((int)json::ERR_UNEXPECTED_CHAR_BEFORE_OBJ_SEP,
+                       parser.parse(src.c_str(), src.size()));
+  src = "{\"id\":[1,]}";
+  CPPUNIT_ASSERT_EQUAL((int)json::ERR_UNEXPECTED_CHAR_BEFORE_VAL,
+                       parser.parse(src.c_str(), src.size()));
+  src = "{\"id\":\"\\uD800\\u0041\"}";
+  CPPUNIT_ASSERT_EQUAL((int)json::ERR_INVALID_UNICODE_POINT,
+                       parser.parse(src.c_str(), src.size()));
+  src = "{\"id\":9223372036854775808}";
+  CPPUNIT_ASSERT_EQUAL((int)json::ERR_NUMBER_OUT_OF_RANGE,
+                       parser.parse(src.c_str(), src.size()));
+  src = std::string(50, '[') + std::string(50, ']');
+  CPPUNIT_ASSERT_EQUAL((int)json::ERR_STRUCTURE_TOO_DEEP,
+                       parser.parse(src.c_str(), src.size()));
+}
+
+void JsonRpcRequestParserTest::testParse_sameAsJsonParser()
+{
+  // Inputs are accepted or rejected the same as ValueBaseJsonParser,
+  // and params are decoded to the same values.
+  const char* srcs[] = {
+      "{\"id\":1,\"method\":\"m\",\"params\":[\"\\b\\f\\n\\r\\t\\/\\\\\"]}",
+      "{\"id\":1,\"method\":\"m\",\"params\":[\"\\uD834\\uDD1E\\u3042\"]}",
+      "{\"id\":1,\"method\":\"m\",\"params\":[-0, 12.0e5, 3E-2, 4.5]}",
+      "{\"id\":1,\"method\":\"m\",\"params\":[false, {\"a\":1,\"a\":2}],}",
+      "{\"id\":1,\"method\":\"m\",\"params\":[\"\\\"\\\"\\\\\\\"\"]}",
+      "\r\n\t {\"id\":1 , \"method\" : \"m\" , \"params\" : [ ] } trailing",
+      "{\"id\":1,\"method\":\"m\",\"params\":[1.]}",
+      "{\"id\":1,\"method\":\"m\",\"params\":[1e]}",
+      "{\"id\":1,\"method\":\"m\",\"params\":[-]}",
+      "{\"id\":1,\"method\":\"m\",\"params\":[1e19]}",
+      "{\"id\":1,\"method\":\"m\",\"params\":[\"\\u12G4\"]}",
+      "{\"id\":1,\"method\":\"m\",\"params\":[nul]}",
+      "{\"id\":1,\"method\":\"m\",\"params\":[\"abc]}",
+      "{\"id\":1,\"method\":\"m\" \"params\":[]}",
+      "{1:2}",
+      "123",
+  };
+  for (auto src : srcs) {
+    std::string s = src;
+    json::ValueBaseJsonParser jsonParser;
+    ssize_t error;
+    auto expected = jsonParser.parseFinal(s.c_str(), s.size(), error);
+    JsonRpcRequestParser parser;
+    int rv = parser.parse(s.c_str(), s.size());
+    CPPUNIT_ASSERT_MESSAGE(s, (error < 0) == (rv < 0));
+    if (rv < 0) {
+      continue;
+    }
+    auto params = downcast<Dict>(expected)->get("params");
+    CPPUNIT_ASSERT_MESSAGE(
+        s, json::encode(params) ==
+               json::encode(parser.getCalls()[0].req.params.get()));
+  }
+}
+
+} // namespace rpc
+
+} // namespace aria2
@@ -0,0 +1,58 @@
+#include "JsonStructWriter.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+
+namespace aria2 {
+
+class JsonStructWriterTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(JsonStructWriterTest);
+  CPPUNIT_TEST(testWrite);
+  CPPUNIT_TEST(testWrite_empty);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void testWrite();
+  void testWrite_empty();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(JsonStructWriterTest);
+
+void JsonStructWriterTest::testWrite()
+{
+  std::string out;
+  json::JsonStructWriter w(out);
+  w.beginList();
+  w.beginDict();
+  w.put("name", "aria2");
+  w.put("size", 1000);
+  w.key("uris");
+  w.beginList();
+  w.value("http://localhost/");
+  w.value("\"quoted\"\n");
+  w.endList();
+  w.key("info");
+  w.beginDict();
+  w.endDict();
+  w.endDict();
+  w.value(-1);
+  w.beginList();
+  w.endList();
+  w.endList();
+  CPPUNIT_ASSERT_EQUAL(std::string("[{\"name\":\"aria2\",\"size\":1000,"
+                                   "\"uris\":[\"http:\\/\\/localhost\\/\","
+                                   "\"\\\"quoted\\\"\\n\"],\"info\":{}},"
+                                   "-1,[]]"),
+                       out);
+}
+
+void JsonStructWriterTest::testWrite_empty()
+{
+  std::string out;
+  json::JsonStructWriter w(out);
+  w.beginDict();
+  w.endDict();
+  CPPUNIT_ASSERT_EQUAL(std::string("{}"), out);
+}
+
+} // namespace aria2
@@ -228,6 +228,8 @@ public:
 
   virtual WrDiskCache* getWrDiskCache() CXX11_OVERRIDE { return 0; }
 
+  virtual RdDiskCache* getRdDiskCache() CXX11_OVERRIDE { return 0; }
+
   virtual void flushWrDiskCacheEntry() CXX11_OVERRIDE {}
 
   void setDiskAdaptor(const std::shared_ptr<DiskAdaptor>& adaptor)
@@ -254,6 +256,8 @@ public:
     throw FATAL_EXCEPTION("Not Implemented!");
   }
 
+  virtual uint64_t getLastHaveIndex() const CXX11_OVERRIDE { return 0; }
+
   virtual void removeAdvertisedPiece(const Timer& expiry) CXX11_OVERRIDE {}
 
   virtual void markAllPiecesDone() CXX11_OVERRIDE {}
@@ -1,5 +1,8 @@
 #include "PieceStatMan.h"
 
+#include <algorithm>
+#include <functional>
+
 #include <cppunit/extensions/HelperMacros.h>
 
 namespace aria2 {
@@ -11,6 +14,8 @@ class PieceStatManTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(testAddPieceStats_bitfield);
   CPPUNIT_TEST(testUpdatePieceStats);
   CPPUNIT_TEST(testSubtractPieceStats);
+  CPPUNIT_TEST(testGetRarestOrder);
+  CPPUNIT_TEST(testGetRarestOrder_shuffled);
   CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -22,6 +27,8 @@ public:
   void testAddPieceStats_bitfield();
   void testUpdatePieceStats();
   void testSubtractPieceStats();
+  void testGetRarestOrder();
+  void testGetRarestOrder_shuffled();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(PieceStatManTest);
@@ -126,4 +133,49 @@ void PieceStatManTest::testSubtractPieceStats()
   }
 }
 
+void PieceStatManTest::testGetRarestOrder()
+{
+  PieceStatMan pieceStatMan(10, true);
+  const unsigned char bitfield[] = {0xff, 0xc0};
+  const unsigned char oldBitfield[] = {0xf0, 0x00};
+  const unsigned char newBitfield[] = {0x1f, 0x00};
+  pieceStatMan.addPieceStats(bitfield, sizeof(bitfield));
+  pieceStatMan.addPieceStats(oldBitfield, sizeof(oldBitfield));
+  pieceStatMan.updatePieceStats(newBitfield, sizeof(newBitfield), oldBitfield);
+  pieceStatMan.addPieceStats(9);
+  pieceStatMan.addPieceStats(9);
+  pieceStatMan.subtractPieceStats(bitfield, sizeof(bitfield));
+  // counts: 0, 0, 0, 1, 1, 1, 1, 1, 0, 2
+  const std::vector<int>& counts(pieceStatMan.getCounts());
+  const std::vector<size_t>& order(pieceStatMan.getRarestOrder());
+  CPPUNIT_ASSERT_EQUAL((size_t)10, order.size());
+  std::vector<bool> seen(10);
+  for (size_t i = 0; i < order.size(); ++i) {
+    CPPUNIT_ASSERT(!seen[order[i]]);
+    seen[order[i]] = true;
+    if (i > 0) {
+      CPPUNIT_ASSERT(counts[order[i - 1]] <= counts[order[i]]);
+    }
+  }
+  CPPUNIT_ASSERT_EQUAL((size_t)9, order[9]);
+  CPPUNIT_ASSERT_EQUAL(0, counts[order[3]]);
+  CPPUNIT_ASSERT_EQUAL(1, counts[order[4]]);
+}
+
+void PieceStatManTest::testGetRarestOrder_shuffled()
+{
+  PieceStatMan pieceStatMan(64, true);
+  std::vector<unsigned char> bitfield(8, 0xff);
+  pieceStatMan.addPieceStats(bitfield.data(), bitfield.size());
+  const std::vector<size_t>& order(pieceStatMan.getRarestOrder());
+  // Moving every piece to the next bucket must not sort them by index.
+  CPPUNIT_ASSERT(!std::is_sorted(std::begin(order), std::end(order)));
+  CPPUNIT_ASSERT(!std::is_sorted(std::begin(order), std::end(order),
+                                 std::greater<size_t>()));
+  pieceStatMan.subtractPieceStats(bitfield.data(), bitfield.size());
+  CPPUNIT_ASSERT(!std::is_sorted(std::begin(order), std::end(order)));
+  CPPUNIT_ASSERT(!std::is_sorted(std::begin(order), std::end(order),
+                                 std::greater<size_t>()));
+}
+
 } // namespace aria2
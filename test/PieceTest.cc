@@ -21,6 +21,8 @@ class PieceTest : public CppUnit::TestFixture {
 
   CPPUNIT_TEST(testGetDigestWithWrCache);
   CPPUNIT_TEST(testUpdateHash);
+  CPPUNIT_TEST(testUpdateHash_wrCache);
+  CPPUNIT_TEST(testUpdateHash_wrCacheFlushed);
 
   CPPUNIT_TEST_SUITE_END();
 
@@ -44,6 +46,8 @@ public:
 
   void testGetDigestWithWrCache();
   void testUpdateHash();
+  void testUpdateHash_wrCache();
+  void testUpdateHash_wrCacheFlushed();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(PieceTest);
@@ -77,7 +81,7 @@ void PieceTest::testFlushWrCache()
   unsigned char* data;
   Piece p(0, 1_k);
   WrDiskCache dc(64);
-  p.initWrCache(&dc, adaptor_);
+  p.initWrCache(&dc, adaptor_, 0);
   data = new unsigned char[3];
   memcpy(data, "foo", 3);
   p.updateWrCache(&dc, data, 0, 3, 0);
@@ -103,7 +107,7 @@ void PieceTest::testAppendWrCache()
   unsigned char* data;
   Piece p(0, 1_k);
   WrDiskCache dc(1_k);
-  p.initWrCache(&dc, adaptor_);
+  p.initWrCache(&dc, adaptor_, 0);
   size_t capacity = 6;
   data = new unsigned char[capacity];
   memcpy(data, "foo", 3);
@@ -123,7 +127,7 @@ void PieceTest::testGetDigestWithWrCache()
   WrDiskCache dc(64);
   //                  012345678901234567890123456
   writer_->setString("abcde...ijklmnopq...uvwx.z");
-  p.initWrCache(&dc, adaptor_);
+  p.initWrCache(&dc, adaptor_, 0);
   data = new unsigned char[3];
   memcpy(data, "fgh", 3);
   p.updateWrCache(&dc, data, 0, 3, 5);
@@ -159,4 +163,68 @@ void PieceTest::testUpdateHash()
                        util::toHex(p.getDigest()));
 }
 
+namespace {
+void cacheData(Piece& p, WrDiskCache& dc, const std::string& data,
+               int64_t goff)
+{
+  auto buf = new unsigned char[data.size()];
+  memcpy(buf, data.c_str(), data.size());
+  p.updateWrCache(&dc, buf, 0, data.size(), goff);
+}
+} // namespace
+
+void PieceTest::testUpdateHash_wrCache()
+{
+  WrDiskCache dc(64);
+  Piece p(1, 16, 2_m);
+  p.setHashType("sha-1");
+  p.initWrCache(&dc, adaptor_, 16);
+
+  std::string data("SPAM!SPAM!SPAM!!");
+  auto d = reinterpret_cast<const unsigned char*>(data.c_str());
+  cacheData(p, dc, data.substr(10), 26);
+  CPPUNIT_ASSERT(!p.updateHash(10, d + 10, 6));
+  cacheData(p, dc, data.substr(5, 5), 21);
+  CPPUNIT_ASSERT(!p.updateHash(5, d + 5, 5));
+  CPPUNIT_ASSERT(!p.isHashCalculated());
+  // The data following it are eaten from the write disk cache.
+  cacheData(p, dc, data.substr(0, 5), 16);
+  CPPUNIT_ASSERT(p.updateHash(0, d, 5));
+  CPPUNIT_ASSERT(p.isHashCalculated());
+  CPPUNIT_ASSERT_EQUAL(std::string("d9189aff79e075a2e60271b9556a710dc1bc7de7"),
+                       util::toHex(p.getDigest()));
+  p.clearWrCache(&dc);
+
+  // Overlapping data only contribute the part not hashed yet.
+  cacheData(p, dc, data.substr(8), 24);
+  cacheData(p, dc, data.substr(3, 7), 19);
+  CPPUNIT_ASSERT(p.updateHash(0, d, 4));
+  CPPUNIT_ASSERT(p.isHashCalculated());
+  CPPUNIT_ASSERT_EQUAL(std::string("d9189aff79e075a2e60271b9556a710dc1bc7de7"),
+                       util::toHex(p.getDigest()));
+  p.releaseWrCache(&dc);
+}
+
+void PieceTest::testUpdateHash_wrCacheFlushed()
+{
+  WrDiskCache dc(64);
+  Piece p(0, 16, 2_m);
+  p.setHashType("sha-1");
+  p.initWrCache(&dc, adaptor_, 0);
+
+  std::string data("SPAM!SPAM!SPAM!!");
+  auto d = reinterpret_cast<const unsigned char*>(data.c_str());
+  cacheData(p, dc, data.substr(5), 5);
+  CPPUNIT_ASSERT(!p.updateHash(5, d + 5, 11));
+  // The data written to the disk are not hashed.
+  p.flushWrCache(&dc);
+  cacheData(p, dc, data.substr(0, 5), 0);
+  CPPUNIT_ASSERT(p.updateHash(0, d, 5));
+  CPPUNIT_ASSERT(!p.isHashCalculated());
+  CPPUNIT_ASSERT_EQUAL(
+      std::string("d9189aff79e075a2e60271b9556a710dc1bc7de7"),
+      util::toHex(p.getDigestWithWrCache(p.getLength(), adaptor_)));
+  p.releaseWrCache(&dc);
+}
+
 } // namespace aria2
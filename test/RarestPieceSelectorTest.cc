@@ -12,6 +12,7 @@ class RarestPieceSelectorTest : public CppUnit::TestFixture {
 
   CPPUNIT_TEST_SUITE(RarestPieceSelectorTest);
   CPPUNIT_TEST(testSelect);
+  CPPUNIT_TEST(testSelect_buckets);
   CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -24,6 +25,7 @@ public:
   void testUpdatePieceStats();
   void testSubtractPieceStats();
   void testSelect();
+  void testSelect_buckets();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(RarestPieceSelectorTest);
@@ -47,4 +49,62 @@ void RarestPieceSelectorTest::testSelect()
   CPPUNIT_ASSERT_EQUAL((size_t)2, index);
 }
 
+namespace {
+// Returns the first piece in getRarestOrder() which bf has.
+size_t firstInRarestOrder(const PieceStatMan& pieceStatMan,
+                          const BitfieldMan& bf)
+{
+  for (auto idx : pieceStatMan.getRarestOrder()) {
+    if (bf.isBitSet(idx)) {
+      return idx;
+    }
+  }
+  return bf.countBlock();
+}
+} // namespace
+
+void RarestPieceSelectorTest::testSelect_buckets()
+{
+  // 200 pieces make 4 words of bitfield.
+  std::shared_ptr<PieceStatMan> pieceStatMan(new PieceStatMan(200, true));
+  RarestPieceSelector selector(pieceStatMan);
+  BitfieldMan bf(1_k, 200_k);
+  bf.setAllBit();
+  pieceStatMan->addPieceStats(bf.getBitfield(), bf.getBitfieldLength());
+  pieceStatMan->addPieceStats(bf.getBitfield(), bf.getBitfieldLength());
+  bf.clearAllBit();
+  bf.setBit(7);
+  bf.setBit(150);
+  pieceStatMan->subtractPieceStats(bf.getBitfield(), bf.getBitfieldLength());
+  pieceStatMan->addPieceStats(199);
+  // counts: 2 except for 7 and 150 (1) and 199 (3)
+  size_t index;
+
+  bf.setBit(199);
+  // The rarest bucket is small, so it is scanned piece by piece.
+  CPPUNIT_ASSERT(selector.select(index, bf.getBitfield(), bf.countBlock()));
+  CPPUNIT_ASSERT(index == 7 || index == 150);
+  CPPUNIT_ASSERT_EQUAL(firstInRarestOrder(*pieceStatMan, bf), index);
+
+  // The next bucket is large, so it is matched a word at a time.
+  for (int i = 0; i < 4; ++i) {
+    bf.clearAllBit();
+    bf.setBit(199);
+    for (int j = 0; j < 10; ++j) {
+      bf.setBit(i * 50 + j * 3 + 1);
+    }
+    CPPUNIT_ASSERT(selector.select(index, bf.getBitfield(), bf.countBlock()));
+    CPPUNIT_ASSERT(index != 199);
+    CPPUNIT_ASSERT_EQUAL(firstInRarestOrder(*pieceStatMan, bf), index);
+  }
+
+  bf.clearAllBit();
+  bf.setBit(199);
+  CPPUNIT_ASSERT(selector.select(index, bf.getBitfield(), bf.countBlock()));
+  CPPUNIT_ASSERT_EQUAL((size_t)199, index);
+
+  bf.clearAllBit();
+  CPPUNIT_ASSERT(!selector.select(index, bf.getBitfield(), bf.countBlock()));
+}
+
 } // namespace aria2
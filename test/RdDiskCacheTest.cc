@@ -0,0 +1,101 @@
+#include "RdDiskCache.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "TestUtil.h"
+#include "WrDiskCache.h"
+#include "WrDiskCacheEntry.h"
+#include "DirectDiskAdaptor.h"
+#include "ByteArrayDiskWriter.h"
+
+namespace aria2 {
+
+class RdDiskCacheTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(RdDiskCacheTest);
+  CPPUNIT_TEST(testAdd);
+  CPPUNIT_TEST(testRemove);
+  CPPUNIT_TEST(testAdd_wrDiskCache);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void testAdd();
+  void testRemove();
+  void testAdd_wrDiskCache();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(RdDiskCacheTest);
+
+namespace {
+std::vector<unsigned char> createData(const std::string& s)
+{
+  return std::vector<unsigned char>(std::begin(s), std::end(s));
+}
+
+std::string toString(const std::vector<unsigned char>* data)
+{
+  return std::string(std::begin(*data), std::end(*data));
+}
+} // namespace
+
+void RdDiskCacheTest::testAdd()
+{
+  RdDiskCache dc(20);
+  CPPUNIT_ASSERT(!dc.get(1, 0));
+  CPPUNIT_ASSERT_EQUAL(std::string("who knows?"),
+                       toString(dc.add(1, 0, createData("who knows?"))));
+  CPPUNIT_ASSERT(dc.add(1, 1, createData("hello")));
+  CPPUNIT_ASSERT_EQUAL((size_t)15, dc.getSize());
+  // Make piece 0 most recently used.
+  CPPUNIT_ASSERT_EQUAL(std::string("who knows?"), toString(dc.get(1, 0)));
+  // Piece 1 is evicted.
+  CPPUNIT_ASSERT(dc.add(2, 0, createData("seconddata")));
+  CPPUNIT_ASSERT_EQUAL((size_t)20, dc.getSize());
+  CPPUNIT_ASSERT(!dc.get(1, 1));
+  CPPUNIT_ASSERT(dc.get(1, 0));
+  CPPUNIT_ASSERT(dc.get(2, 0));
+  // Too large to cache
+  CPPUNIT_ASSERT(!dc.add(3, 0, createData("012345678901234567890")));
+  CPPUNIT_ASSERT_EQUAL((size_t)2, dc.getNumEntry());
+  // Replace the existing entry
+  CPPUNIT_ASSERT(dc.add(2, 0, createData("foo")));
+  CPPUNIT_ASSERT_EQUAL((size_t)13, dc.getSize());
+  CPPUNIT_ASSERT_EQUAL(std::string("foo"), toString(dc.get(2, 0)));
+}
+
+void RdDiskCacheTest::testRemove()
+{
+  RdDiskCache dc(100);
+  dc.add(1, 0, createData("a"));
+  dc.add(2, 0, createData("bb"));
+  dc.add(2, 5, createData("ccc"));
+  dc.add(3, 1, createData("dddd"));
+  dc.remove(2);
+  CPPUNIT_ASSERT_EQUAL((size_t)2, dc.getNumEntry());
+  CPPUNIT_ASSERT_EQUAL((size_t)5, dc.getSize());
+  CPPUNIT_ASSERT(dc.get(1, 0));
+  CPPUNIT_ASSERT(!dc.get(2, 0));
+  CPPUNIT_ASSERT(!dc.get(2, 5));
+  CPPUNIT_ASSERT(dc.get(3, 1));
+}
+
+void RdDiskCacheTest::testAdd_wrDiskCache()
+{
+  auto adaptor = std::make_shared<DirectDiskAdaptor>();
+  adaptor->setDiskWriter(make_unique<ByteArrayDiskWriter>());
+  WrDiskCache wrDiskCache(100);
+  WrDiskCacheEntry ent(adaptor);
+  ent.cacheData(createDataCell(0, "0123456789"));
+  wrDiskCache.add(&ent);
+
+  RdDiskCache dc(20, &wrDiskCache);
+  CPPUNIT_ASSERT(dc.add(1, 0, createData("hello")));
+  // 10 bytes are used by the write cache.
+  CPPUNIT_ASSERT(dc.add(1, 1, createData("world!")));
+  CPPUNIT_ASSERT(!dc.get(1, 0));
+  CPPUNIT_ASSERT(!dc.add(1, 2, createData("01234567890")));
+
+  wrDiskCache.remove(&ent);
+}
+
+} // namespace aria2
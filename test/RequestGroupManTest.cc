@@ -35,6 +35,7 @@ class RequestGroupManTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(testFillRequestGroupFromReserver_uriParser);
   CPPUNIT_TEST(testInsertReservedGroup);
   CPPUNIT_TEST(testAddDownloadResult);
+  CPPUNIT_TEST(testDownloadResultIndex);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -67,6 +68,7 @@ public:
   void testFillRequestGroupFromReserver_uriParser();
   void testInsertReservedGroup();
   void testAddDownloadResult();
+  void testDownloadResultIndex();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(RequestGroupManTest);
@@ -280,4 +282,40 @@ void RequestGroupManTest::testAddDownloadResult()
                        rgman_->getDownloadStat().getLastErrorResult());
 }
 
+void RequestGroupManTest::testDownloadResultIndex()
+{
+  std::string uri = "http://example.org";
+  rgman_->setMaxDownloadResult(3);
+  std::vector<std::shared_ptr<DownloadResult>> drs{
+      createDownloadResult(error_code::TIME_OUT, uri),
+      createDownloadResult(error_code::FINISHED, uri),
+      createDownloadResult(error_code::TIME_OUT, uri),
+      createDownloadResult(error_code::FINISHED, uri)};
+  for (auto& dr : drs) {
+    rgman_->addDownloadResult(dr);
+  }
+  auto& index = rgman_->getDownloadResultIndex();
+  // The first one was evicted.
+  CPPUNIT_ASSERT_EQUAL((size_t)1, index.findErrors().size());
+  CPPUNIT_ASSERT_EQUAL(drs[2]->seq, index.findErrors()[0]);
+  CPPUNIT_ASSERT_EQUAL((size_t)2,
+                       index.findByErrorCode(error_code::FINISHED).size());
+  CPPUNIT_ASSERT_EQUAL((size_t)3, index.findByDir("").size());
+
+  CPPUNIT_ASSERT_EQUAL((size_t)0, rgman_->findDownloadResultPosition(0));
+  CPPUNIT_ASSERT_EQUAL((size_t)1,
+                       rgman_->findDownloadResultPosition(drs[2]->seq));
+  CPPUNIT_ASSERT_EQUAL((size_t)3,
+                       rgman_->findDownloadResultPosition(drs[3]->seq + 1));
+
+  CPPUNIT_ASSERT(rgman_->removeDownloadResult(drs[2]->gid->getNumericId()));
+  CPPUNIT_ASSERT(index.findErrors().empty());
+  CPPUNIT_ASSERT_EQUAL((size_t)1,
+                       rgman_->findDownloadResultPosition(drs[3]->seq));
+
+  rgman_->purgeDownloadResult();
+  CPPUNIT_ASSERT(index.findByErrorCode(error_code::FINISHED).empty());
+  CPPUNIT_ASSERT(index.findByDir("").empty());
+}
+
 } // namespace aria2
@@ -21,11 +21,16 @@
 #include "download_helper.h"
 #include "FileEntry.h"
 #include "RpcMethodFactory.h"
+#include "ValueBaseJsonParser.h"
+#include "json.h"
 #ifdef ENABLE_BITTORRENT
 #  include "BtRegistry.h"
 #  include "BtRuntime.h"
 #  include "bittorrent_helper.h"
 #endif // ENABLE_BITTORRENT
+#ifdef ENABLE_WEBSOCKET
+#  include "WebSocketSession.h"
+#endif // ENABLE_WEBSOCKET
 
 namespace aria2 {
 
@@ -64,6 +69,10 @@ class RpcMethodTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(testTellStatus_withoutGid);
   CPPUNIT_TEST(testTellWaiting);
   CPPUNIT_TEST(testTellWaiting_fail);
+  CPPUNIT_TEST(testTellWaiting_json);
+  CPPUNIT_TEST(testQueryDownloads);
+  CPPUNIT_TEST(testQueryDownloads_cursor);
+  CPPUNIT_TEST(testQueryDownloads_fail);
   CPPUNIT_TEST(testGetVersion);
   CPPUNIT_TEST(testNoSuchMethod);
   CPPUNIT_TEST(testGatherStoppedDownload);
@@ -82,8 +91,12 @@ class RpcMethodTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(testPause);
   CPPUNIT_TEST(testSystemMulticall);
   CPPUNIT_TEST(testSystemMulticall_fail);
+#ifdef ENABLE_WEBSOCKET
+  CPPUNIT_TEST(testSystemMulticall_webSocket);
+#endif // ENABLE_WEBSOCKET
   CPPUNIT_TEST(testSystemListMethods);
   CPPUNIT_TEST(testSystemListNotifications);
+  CPPUNIT_TEST(testSubscribeStatus_withoutWebSocket);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -134,6 +147,10 @@ public:
   void testTellStatus_withoutGid();
   void testTellWaiting();
   void testTellWaiting_fail();
+  void testTellWaiting_json();
+  void testQueryDownloads();
+  void testQueryDownloads_cursor();
+  void testQueryDownloads_fail();
   void testGetVersion();
   void testNoSuchMethod();
   void testGatherStoppedDownload();
@@ -152,8 +169,12 @@ public:
   void testPause();
   void testSystemMulticall();
   void testSystemMulticall_fail();
+#ifdef ENABLE_WEBSOCKET
+  void testSystemMulticall_webSocket();
+#endif // ENABLE_WEBSOCKET
   void testSystemListMethods();
   void testSystemListNotifications();
+  void testSubscribeStatus_withoutWebSocket();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(RpcMethodTest);
@@ -901,6 +922,250 @@ void RpcMethodTest::testTellWaiting_fail()
   CPPUNIT_ASSERT_EQUAL(1, res.code);
 }
 
+void RpcMethodTest::testTellWaiting_json()
+{
+  addUri("http://1/", e_);
+  addUri("http://2/", e_);
+#ifdef ENABLE_BITTORRENT
+  addTorrent(A2_TEST_DIR "/single.torrent", e_);
+#else  // !ENABLE_BITTORRENT
+  addUri("http://3/", e_);
+#endif // !ENABLE_BITTORRENT
+  TellWaitingRpcMethod m;
+  auto req = createReq(TellWaitingRpcMethod::getMethodName());
+  req.params->append(Integer::g(-1));
+  req.params->append(Integer::g(3));
+  auto res = m.execute(std::move(req), e_.get());
+  CPPUNIT_ASSERT_EQUAL(0, res.code);
+
+  req = createReq(TellWaitingRpcMethod::getMethodName());
+  req.params->append(Integer::g(-1));
+  req.params->append(Integer::g(3));
+  req.jsonRpc = true;
+  auto jsonRes = m.executeJson(std::move(req), e_.get());
+  CPPUNIT_ASSERT_EQUAL(0, jsonRes.code);
+  CPPUNIT_ASSERT(!jsonRes.param);
+
+  json::ValueBaseJsonParser parser;
+  ssize_t error;
+  auto parsed =
+      parser.parseFinal(jsonRes.json.c_str(), jsonRes.json.size(), error);
+  CPPUNIT_ASSERT(parsed);
+  CPPUNIT_ASSERT_EQUAL((size_t)3, downcast<List>(parsed)->size());
+  CPPUNIT_ASSERT_EQUAL(json::encode(res.param.get()),
+                       json::encode(parsed.get()));
+
+  // missing params
+  req = createReq(TellWaitingRpcMethod::getMethodName());
+  req.jsonRpc = true;
+  jsonRes = m.executeJson(std::move(req), e_.get());
+  CPPUNIT_ASSERT_EQUAL(1, jsonRes.code);
+  CPPUNIT_ASSERT(downcast<Dict>(jsonRes.param));
+}
+
+namespace {
+std::unique_ptr<ValueBase>
+queryDownloads(std::unique_ptr<Dict> query,
+               const std::shared_ptr<DownloadEngine>& e)
+{
+  QueryDownloadsRpcMethod m;
+  auto req = createReq(QueryDownloadsRpcMethod::getMethodName());
+  req.params->append(std::move(query));
+  auto keys = List::g();
+  keys->append("gid");
+  req.params->append(std::move(keys));
+  auto res = m.execute(std::move(req), e.get());
+  if (res.code != 0) {
+    return nullptr;
+  }
+  return std::move(res.param);
+}
+} // namespace
+
+namespace {
+// Returns the GIDs of the downloads in |res|, separated by ' ', and
+// the cursor in |cursor|.
+std::string getQueryGids(const std::unique_ptr<ValueBase>& res,
+                         std::string* cursor = nullptr)
+{
+  const Dict* resDict = downcast<Dict>(res);
+  CPPUNIT_ASSERT(resDict);
+  std::string gids;
+  for (auto& elem : *downcast<List>(resDict->get("downloads"))) {
+    if (!gids.empty()) {
+      gids += ' ';
+    }
+    gids += downcast<String>(downcast<Dict>(elem)->get("gid"))->s();
+  }
+  if (cursor) {
+    const String* c = downcast<String>(resDict->get("cursor"));
+    *cursor = c ? c->s() : "";
+  }
+  return gids;
+}
+} // namespace
+
+void RpcMethodTest::testQueryDownloads()
+{
+  addUri("http://1/", e_);
+  addUri("http://2/", e_);
+  addUri("http://3/", e_);
+  auto& rgman = e_->getRequestGroupMan();
+  getReservedGroup(rgman.get(), 1)->setPauseRequested(true);
+  std::vector<std::string> gids;
+  for (auto& group : rgman->getReservedGroups()) {
+    gids.push_back(group->getGroupId()->toHex());
+  }
+  std::vector<std::pair<error_code::Value, std::string>> stopped{
+      {error_code::FINISHED, "/x"},
+      {error_code::TIME_OUT, "/y"},
+      {error_code::FINISHED, "/y"},
+      {error_code::REMOVED, "/x"}};
+  for (auto& s : stopped) {
+    auto dr = createDownloadResult(s.first, "http://host/");
+    dr->dir = s.second;
+    dr->option->put(PREF_DIR, s.second);
+    rgman->addDownloadResult(dr);
+    gids.push_back(dr->gid->toHex());
+  }
+
+  // no filter
+  CPPUNIT_ASSERT_EQUAL(gids[0] + " " + gids[1] + " " + gids[2] + " " +
+                           gids[3] + " " + gids[4] + " " + gids[5] + " " +
+                           gids[6],
+                       getQueryGids(queryDownloads(Dict::g(), e_)));
+  // status
+  auto query = Dict::g();
+  auto status = List::g();
+  status->append("paused");
+  status->append("error");
+  query->put("status", std::move(status));
+  CPPUNIT_ASSERT_EQUAL(gids[1] + " " + gids[4],
+                       getQueryGids(queryDownloads(std::move(query), e_)));
+  // status and dir
+  query = Dict::g();
+  status = List::g();
+  status->append("complete");
+  query->put("status", std::move(status));
+  query->put("dir", "/y");
+  CPPUNIT_ASSERT_EQUAL(gids[5],
+                       getQueryGids(queryDownloads(std::move(query), e_)));
+  // errorCode
+  query = Dict::g();
+  query->put("errorCode", "2");
+  CPPUNIT_ASSERT_EQUAL(gids[4],
+                       getQueryGids(queryDownloads(std::move(query), e_)));
+  // option
+  query = Dict::g();
+  auto option = Dict::g();
+  option->put(PREF_DIR->k, "/x");
+  query->put("option", std::move(option));
+  query->put("order", "desc");
+  CPPUNIT_ASSERT_EQUAL(gids[6] + " " + gids[3],
+                       getQueryGids(queryDownloads(std::move(query), e_)));
+}
+
+void RpcMethodTest::testQueryDownloads_cursor()
+{
+  addUri("http://1/", e_);
+  addUri("http://2/", e_);
+  addUri("http://3/", e_);
+  auto& rgman = e_->getRequestGroupMan();
+  std::vector<std::string> gids;
+  for (auto& group : rgman->getReservedGroups()) {
+    gids.push_back(group->getGroupId()->toHex());
+  }
+  for (int i = 0; i < 3; ++i) {
+    auto dr = createDownloadResult(error_code::FINISHED, "http://host/");
+    rgman->addDownloadResult(dr);
+    gids.push_back(dr->gid->toHex());
+  }
+  std::string cursor;
+  auto query = Dict::g();
+  query->put("limit", Integer::g(2));
+  CPPUNIT_ASSERT_EQUAL(
+      gids[0] + " " + gids[1],
+      getQueryGids(queryDownloads(std::move(query), e_), &cursor));
+  CPPUNIT_ASSERT_EQUAL("w:1:" + gids[1], cursor);
+
+  // The cursor survives the change of the queue.
+  rgman->removeReservedGroup(getReservedGroup(rgman.get(), 0)->getGID());
+  query = Dict::g();
+  query->put("limit", Integer::g(2));
+  query->put("cursor", cursor);
+  CPPUNIT_ASSERT_EQUAL(
+      gids[2] + " " + gids[3],
+      getQueryGids(queryDownloads(std::move(query), e_), &cursor));
+  CPPUNIT_ASSERT_EQUAL(std::string("s:1"), cursor);
+
+  query = Dict::g();
+  query->put("limit", Integer::g(2));
+  query->put("cursor", cursor);
+  CPPUNIT_ASSERT_EQUAL(
+      gids[4] + " " + gids[5],
+      getQueryGids(queryDownloads(std::move(query), e_), &cursor));
+  CPPUNIT_ASSERT_EQUAL(std::string("s:3"), cursor);
+
+  query = Dict::g();
+  query->put("limit", Integer::g(2));
+  query->put("cursor", cursor);
+  CPPUNIT_ASSERT_EQUAL(
+      std::string(),
+      getQueryGids(queryDownloads(std::move(query), e_), &cursor));
+  CPPUNIT_ASSERT_EQUAL(std::string(), cursor);
+
+  // descending order, using the index of completed downloads
+  query = Dict::g();
+  auto status = List::g();
+  status->append("complete");
+  status->append("waiting");
+  query->put("status", std::move(status));
+  query->put("order", "desc");
+  query->put("limit", Integer::g(3));
+  CPPUNIT_ASSERT_EQUAL(
+      gids[5] + " " + gids[4] + " " + gids[3],
+      getQueryGids(queryDownloads(std::move(query), e_), &cursor));
+  query = Dict::g();
+  query->put("order", "desc");
+  query->put("cursor", cursor);
+  CPPUNIT_ASSERT_EQUAL(
+      gids[2] + " " + gids[1],
+      getQueryGids(queryDownloads(std::move(query), e_), &cursor));
+  CPPUNIT_ASSERT_EQUAL(std::string(), cursor);
+}
+
+void RpcMethodTest::testQueryDownloads_fail()
+{
+  auto query = Dict::g();
+  auto status = List::g();
+  status->append("unknown");
+  query->put("status", std::move(status));
+  CPPUNIT_ASSERT(!queryDownloads(std::move(query), e_));
+
+  query = Dict::g();
+  query->put("limit", Integer::g(0));
+  CPPUNIT_ASSERT(!queryDownloads(std::move(query), e_));
+
+  for (auto cursor : {"", "s", "s:", "s:-1", "s:1:0", "x:1",
+                      "w:1", "w:1:00000000000000zz"}) {
+    query = Dict::g();
+    query->put("cursor", cursor);
+    CPPUNIT_ASSERT_MESSAGE(cursor, !queryDownloads(std::move(query), e_));
+  }
+
+  query = Dict::g();
+  auto option = Dict::g();
+  option->put("no-such-option", "1");
+  query->put("option", std::move(option));
+  CPPUNIT_ASSERT(!queryDownloads(std::move(query), e_));
+
+  // query must be a struct
+  QueryDownloadsRpcMethod m;
+  auto req = createReq(QueryDownloadsRpcMethod::getMethodName());
+  req.params->append("foo");
+  CPPUNIT_ASSERT_EQUAL(1, m.execute(std::move(req), e_.get()).code);
+}
+
 void RpcMethodTest::testGetVersion()
 {
   GetVersionRpcMethod m;
@@ -1418,6 +1683,46 @@ void RpcMethodTest::testSystemMulticall_fail()
   CPPUNIT_ASSERT_EQUAL(1, res.code);
 }
 
+#ifdef ENABLE_WEBSOCKET
+void RpcMethodTest::testSystemMulticall_webSocket()
+{
+  WebSocketSession wsSession(std::shared_ptr<SocketCore>(), e_.get());
+  SystemMulticallRpcMethod m;
+  auto req = createReq("system.multicall");
+  req.wsSession = &wsSession;
+  auto reqparams = List::g();
+  {
+    auto dict = Dict::g();
+    dict->put("methodName", AddUriRpcMethod::getMethodName());
+    auto params = List::g();
+    auto urisParam = List::g();
+    urisParam->append("http://localhost/");
+    params->append(std::move(urisParam));
+    dict->put("params", std::move(params));
+    reqparams->append(std::move(dict));
+  }
+  {
+    auto dict = Dict::g();
+    dict->put("methodName", SubscribeStatusRpcMethod::getMethodName());
+    dict->put("params", List::g());
+    reqparams->append(std::move(dict));
+  }
+  req.params->append(std::move(reqparams));
+  auto res = m.execute(std::move(req), e_.get());
+  CPPUNIT_ASSERT_EQUAL(0, res.code);
+  const List* resParams = downcast<List>(res.param);
+  CPPUNIT_ASSERT_EQUAL((size_t)2, resParams->size());
+  // The WebSocket session is passed to the method called in
+  // system.multicall.
+  CPPUNIT_ASSERT_EQUAL(
+      std::string("OK"),
+      downcast<String>(downcast<List>(resParams->get(1))->get(0))->s());
+  CPPUNIT_ASSERT(!wsSession.wantWrite());
+  wsSession.notifyStatusChange();
+  CPPUNIT_ASSERT(wsSession.wantWrite());
+}
+#endif // ENABLE_WEBSOCKET
+
 void RpcMethodTest::testSystemListMethods()
 {
   SystemListMethodsRpcMethod m;
@@ -1454,6 +1759,19 @@ void RpcMethodTest::testSystemListNotifications()
   }
 }
 
+void RpcMethodTest::testSubscribeStatus_withoutWebSocket()
+{
+  SubscribeStatusRpcMethod m;
+  auto res = m.execute(createReq(SubscribeStatusRpcMethod::getMethodName()),
+                       e_.get());
+  CPPUNIT_ASSERT_EQUAL(1, res.code);
+
+  UnsubscribeStatusRpcMethod um;
+  res = um.execute(createReq(UnsubscribeStatusRpcMethod::getMethodName()),
+                   e_.get());
+  CPPUNIT_ASSERT_EQUAL(1, res.code);
+}
+
 } // namespace rpc
 
 } // namespace aria2
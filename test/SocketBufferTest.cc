@@ -0,0 +1,120 @@
+#include "SocketBuffer.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "TestUtil.h"
+#include "SocketCore.h"
+#include "DirectDiskAdaptor.h"
+#include "DefaultDiskWriter.h"
+#include "ByteArrayDiskWriter.h"
+
+namespace aria2 {
+
+class SocketBufferTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(SocketBufferTest);
+  CPPUNIT_TEST(testPushBytes);
+  CPPUNIT_TEST(testPushFile);
+  CPPUNIT_TEST(testPushFile_noFd);
+  CPPUNIT_TEST_SUITE_END();
+
+  std::shared_ptr<SocketCore> sender_;
+  std::shared_ptr<SocketCore> receiver_;
+
+public:
+  void setUp()
+  {
+    SocketCore serverSock;
+    serverSock.bind(0);
+    serverSock.beginListen();
+    serverSock.setBlockingMode();
+    auto endpoint = serverSock.getAddrInfo();
+    sender_ = std::make_shared<SocketCore>();
+    sender_->establishConnection("localhost", endpoint.port);
+    sender_->setBlockingMode();
+    receiver_ = serverSock.acceptConnection();
+    receiver_->setBlockingMode();
+  }
+
+  void testPushBytes();
+  void testPushFile();
+  void testPushFile_noFd();
+
+private:
+  std::string receive(size_t len)
+  {
+    std::string res;
+    while (res.size() < len) {
+      char buf[4_k];
+      size_t n = std::min(sizeof(buf), len - res.size());
+      receiver_->readData(buf, n);
+      CPPUNIT_ASSERT(n > 0);
+      res.append(buf, n);
+    }
+    return res;
+  }
+
+  void sendAll(SocketBuffer& sb)
+  {
+    while (!sb.sendBufferIsEmpty()) {
+      sb.send();
+    }
+  }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(SocketBufferTest);
+
+void SocketBufferTest::testPushBytes()
+{
+  SocketBuffer sb(sender_);
+  sb.pushBytes({'a', 'b', 'c'});
+  sb.pushStr("defg");
+  CPPUNIT_ASSERT_EQUAL((size_t)2, sb.getBufferEntrySize());
+  CPPUNIT_ASSERT_EQUAL((ssize_t)7, sb.send());
+  CPPUNIT_ASSERT(sb.sendBufferIsEmpty());
+  CPPUNIT_ASSERT_EQUAL(std::string("abcdefg"), receive(7));
+}
+
+void SocketBufferTest::testPushFile()
+{
+  std::string path = A2_TEST_OUT_DIR "/aria2_SocketBufferTest_testPushFile";
+  std::string data(100_k, '\0');
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = 'a' + i % 26;
+  }
+  createFile(path, 0);
+  auto adaptor = std::make_shared<DirectDiskAdaptor>();
+  adaptor->setDiskWriter(make_unique<DefaultDiskWriter>(path));
+  adaptor->setTotalLength(data.size());
+  adaptor->openFile();
+  adaptor->writeData(reinterpret_cast<const unsigned char*>(data.data()),
+                     data.size(), 0);
+
+  SocketBuffer sb(sender_);
+  sb.pushStr("header");
+  sb.pushFile(adaptor, 3, 64_k);
+  sb.pushStr("trailer");
+  sb.pushFile(adaptor, 90_k, 10_k);
+  CPPUNIT_ASSERT_EQUAL((size_t)4, sb.getBufferEntrySize());
+  sendAll(sb);
+  CPPUNIT_ASSERT_EQUAL("header" + data.substr(3, 64_k) + "trailer" +
+                           data.substr(90_k),
+                       receive(6 + 64_k + 7 + 10_k));
+  adaptor->closeFile();
+}
+
+void SocketBufferTest::testPushFile_noFd()
+{
+  // ByteArrayDiskWriter has no file descriptor.  The data are read
+  // into memory and sent.
+  auto adaptor = std::make_shared<DirectDiskAdaptor>();
+  auto dw = make_unique<ByteArrayDiskWriter>();
+  dw->setString(std::string(20_k, 'x') + "hello");
+  adaptor->setDiskWriter(std::move(dw));
+  SocketBuffer sb(sender_);
+  sb.pushFile(adaptor, 20_k - 3, 8);
+  sendAll(sb);
+  CPPUNIT_ASSERT_EQUAL(std::string("xxxhello"), receive(8));
+}
+
+} // namespace aria2
@@ -8,6 +8,11 @@ class SpeedCalcTest : public CppUnit::TestFixture {
 
   CPPUNIT_TEST_SUITE(SpeedCalcTest);
   CPPUNIT_TEST(testUpdate);
+  CPPUNIT_TEST(testCalculateSpeed);
+  CPPUNIT_TEST(testCalculateSpeed_window);
+  CPPUNIT_TEST(testCalculateSpeed_firstSample);
+  CPPUNIT_TEST(testUpdate_staleSlot);
+  CPPUNIT_TEST(testCalculateNewestSpeed);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -15,14 +20,80 @@ public:
   void setUp() {}
 
   void testUpdate();
+  void testCalculateSpeed();
+  void testCalculateSpeed_window();
+  void testCalculateSpeed_firstSample();
+  void testUpdate_staleSlot();
+  void testCalculateNewestSpeed();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(SpeedCalcTest);
 
+namespace {
+Timer at(int64_t millis) { return Timer(std::chrono::milliseconds(millis)); }
+} // namespace
+
 void SpeedCalcTest::testUpdate()
 {
   SpeedCalc calc;
   calc.update(1000);
 }
 
+void SpeedCalcTest::testCalculateSpeed()
+{
+  SpeedCalc calc;
+  CPPUNIT_ASSERT_EQUAL(0, calc.calculateSpeed(at(100000)));
+  calc.update(1000, at(100000));
+  calc.update(1000, at(100500));
+  calc.update(2000, at(101500));
+  CPPUNIT_ASSERT_EQUAL(2000, calc.calculateSpeed(at(102000)));
+  CPPUNIT_ASSERT_EQUAL(2000, calc.getMaxSpeed());
+  CPPUNIT_ASSERT_EQUAL(1000, calc.calculateSpeed(at(104000)));
+  CPPUNIT_ASSERT_EQUAL(2000, calc.getMaxSpeed());
+}
+
+void SpeedCalcTest::testCalculateSpeed_window()
+{
+  SpeedCalc calc;
+  calc.update(1000, at(100000));
+  calc.update(1000, at(105000));
+  CPPUNIT_ASSERT_EQUAL(2000 * 1000 / 6000,
+                       calc.calculateSpeed(at(106000)));
+  // The first update is out of the window.
+  CPPUNIT_ASSERT_EQUAL(1000 * 1000 / 5000,
+                       calc.calculateSpeed(at(110000)));
+  CPPUNIT_ASSERT_EQUAL(0, calc.calculateSpeed(at(115000)));
+}
+
+void SpeedCalcTest::testCalculateSpeed_firstSample()
+{
+  SpeedCalc calc;
+  calc.update(1000, at(100500));
+  calc.update(2000, at(101200));
+  // Elapsed time is measured from the first update, not from the
+  // start of its second.
+  CPPUNIT_ASSERT_EQUAL(3000 * 1000 / 1500, calc.calculateSpeed(at(102000)));
+  CPPUNIT_ASSERT_EQUAL(2000 * 1000 / 800,
+                       calc.calculateNewestSpeed(2, at(102000)));
+}
+
+void SpeedCalcTest::testUpdate_staleSlot()
+{
+  SpeedCalc calc;
+  calc.update(5000, at(100000));
+  // Lands on the same slot as the update 11 seconds ago.
+  calc.update(1000, at(111000));
+  CPPUNIT_ASSERT_EQUAL(2000, calc.calculateSpeed(at(111500)));
+}
+
+void SpeedCalcTest::testCalculateNewestSpeed()
+{
+  SpeedCalc calc;
+  calc.update(1000, at(100000));
+  calc.update(4000, at(104000));
+  CPPUNIT_ASSERT_EQUAL(8000, calc.calculateNewestSpeed(2, at(104500)));
+  CPPUNIT_ASSERT_EQUAL(5000 * 1000 / 4500,
+                       calc.calculateNewestSpeed(5, at(104500)));
+}
+
 } // namespace aria2
@@ -0,0 +1,141 @@
+#include "StatusSubscription.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "DownloadEngine.h"
+#include "SelectEventPoll.h"
+#include "Option.h"
+#include "RequestGroupMan.h"
+#include "RequestGroup.h"
+#include "download_helper.h"
+#include "ValueBase.h"
+#include "ValueBaseJsonParser.h"
+#include "prefs.h"
+#include "File.h"
+
+namespace aria2 {
+
+namespace rpc {
+
+class StatusSubscriptionTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(StatusSubscriptionTest);
+  CPPUNIT_TEST(testCreateNotification);
+  CPPUNIT_TEST(testCreateNotification_allKeys);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  std::shared_ptr<DownloadEngine> e_;
+  std::shared_ptr<Option> option_;
+
+public:
+  void setUp()
+  {
+    option_ = std::make_shared<Option>();
+    option_->put(PREF_DIR, A2_TEST_OUT_DIR "/aria2_StatusSubscriptionTest");
+    option_->put(PREF_PIECE_LENGTH, "1048576");
+    File(option_->get(PREF_DIR)).mkdirs();
+    e_ = make_unique<DownloadEngine>(make_unique<SelectEventPoll>());
+    e_->setOption(option_.get());
+    e_->setRequestGroupMan(make_unique<RequestGroupMan>(
+        std::vector<std::shared_ptr<RequestGroup>>{}, 1, option_.get()));
+  }
+
+  std::shared_ptr<RequestGroup> addUri(const std::string& uri)
+  {
+    std::vector<std::shared_ptr<RequestGroup>> result;
+    createRequestGroupForUri(result, option_, {uri});
+    e_->getRequestGroupMan()->addReservedGroup(result[0]);
+    return result[0];
+  }
+
+  void testCreateNotification();
+  void testCreateNotification_allKeys();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(StatusSubscriptionTest);
+
+void StatusSubscriptionTest::testCreateNotification()
+{
+  auto g1 = addUri("http://1/");
+  auto g2 = addUri("http://2/");
+  // "gid" is reported even if it is not requested.
+  StatusSubscription sub({"status", "totalLength"});
+
+  CPPUNIT_ASSERT_EQUAL(std::string("{\"jsonrpc\":\"2.0\","
+                                   "\"method\":\"aria2.onStatusChange\","
+                                   "\"params\":[{\"changed\":[{\"gid\":\"") +
+                           g1->getGroupId()->toHex() +
+                           "\",\"status\":\"waiting\","
+                           "\"totalLength\":\"0\"},{\"gid\":\"" +
+                           g2->getGroupId()->toHex() +
+                           "\",\"status\":\"waiting\","
+                           "\"totalLength\":\"0\"}],"
+                           "\"removed\":[]}]}",
+                       sub.createNotification(e_.get()));
+  // Nothing has changed
+  CPPUNIT_ASSERT_EQUAL(std::string(), sub.createNotification(e_.get()));
+
+  // Only the changed field is reported.
+  g1->setPauseRequested(true);
+  CPPUNIT_ASSERT_EQUAL(std::string("{\"jsonrpc\":\"2.0\","
+                                   "\"method\":\"aria2.onStatusChange\","
+                                   "\"params\":[{\"changed\":[{\"gid\":\"") +
+                           g1->getGroupId()->toHex() +
+                           "\",\"status\":\"paused\"}],"
+                           "\"removed\":[]}]}",
+                       sub.createNotification(e_.get()));
+
+  // The status is gathered again, but no field has changed.
+  g2->updateStatusVersion();
+  CPPUNIT_ASSERT_EQUAL(std::string(), sub.createNotification(e_.get()));
+
+  e_->getRequestGroupMan()->removeReservedGroup(g2->getGID());
+  CPPUNIT_ASSERT_EQUAL(std::string("{\"jsonrpc\":\"2.0\","
+                                   "\"method\":\"aria2.onStatusChange\","
+                                   "\"params\":[{\"changed\":[],"
+                                   "\"removed\":[\"") +
+                           g2->getGroupId()->toHex() + "\"]}]}",
+                       sub.createNotification(e_.get()));
+  CPPUNIT_ASSERT_EQUAL(std::string(), sub.createNotification(e_.get()));
+
+  // A download added later is reported with all fields.
+  auto g3 = addUri("http://3/");
+  CPPUNIT_ASSERT_EQUAL(std::string("{\"jsonrpc\":\"2.0\","
+                                   "\"method\":\"aria2.onStatusChange\","
+                                   "\"params\":[{\"changed\":[{\"gid\":\"") +
+                           g3->getGroupId()->toHex() +
+                           "\",\"status\":\"waiting\","
+                           "\"totalLength\":\"0\"}],"
+                           "\"removed\":[]}]}",
+                       sub.createNotification(e_.get()));
+}
+
+void StatusSubscriptionTest::testCreateNotification_allKeys()
+{
+  auto g1 = addUri("http://1/");
+  StatusSubscription sub({});
+
+  auto s = sub.createNotification(e_.get());
+  json::ValueBaseJsonParser parser;
+  ssize_t error;
+  auto parsed = parser.parseFinal(s.c_str(), s.size(), error);
+  CPPUNIT_ASSERT(parsed);
+  auto params = downcast<List>(downcast<Dict>(parsed)->get("params"));
+  auto changed = downcast<List>(downcast<Dict>(params->get(0))->get("changed"));
+  CPPUNIT_ASSERT_EQUAL((size_t)1, changed->size());
+  auto status = downcast<Dict>(changed->get(0));
+  CPPUNIT_ASSERT_EQUAL(g1->getGroupId()->toHex(),
+                       downcast<String>(status->get("gid"))->s());
+  CPPUNIT_ASSERT_EQUAL(std::string("waiting"),
+                       downcast<String>(status->get("status"))->s());
+  CPPUNIT_ASSERT_EQUAL(std::string("0"),
+                       downcast<String>(status->get("totalLength"))->s());
+  CPPUNIT_ASSERT(downcast<List>(status->get("files")));
+
+  CPPUNIT_ASSERT_EQUAL(std::string(), sub.createNotification(e_.get()));
+}
+
+} // namespace rpc
+
+} // namespace aria2
@@ -0,0 +1,73 @@
+#include "ThreadPool.h"
+
+#include <atomic>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "DlAbortEx.h"
+
+namespace aria2 {
+
+class ThreadPoolTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(ThreadPoolTest);
+  CPPUNIT_TEST(testSubmit);
+  CPPUNIT_TEST(testSubmit_exception);
+  CPPUNIT_TEST(testDestructor);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void testSubmit();
+  void testSubmit_exception();
+  void testDestructor();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ThreadPoolTest);
+
+void ThreadPoolTest::testSubmit()
+{
+  ThreadPool pool(2);
+  CPPUNIT_ASSERT_EQUAL((size_t)2, pool.getNumThreads());
+
+  std::atomic<int> count{0};
+  std::vector<std::future<void>> futures;
+  for (int i = 0; i < 100; ++i) {
+    futures.push_back(pool.submit([&count]() { ++count; }));
+  }
+  for (auto& f : futures) {
+    f.get();
+  }
+  CPPUNIT_ASSERT_EQUAL(100, count.load());
+}
+
+void ThreadPoolTest::testSubmit_exception()
+{
+  ThreadPool pool(1);
+  auto f = pool.submit([]() { throw DL_ABORT_EX("error"); });
+  try {
+    f.get();
+    CPPUNIT_FAIL("exception must be thrown.");
+  }
+  catch (RecoverableException& e) {
+    CPPUNIT_ASSERT_EQUAL(std::string("error"), std::string(e.what()));
+  }
+}
+
+void ThreadPoolTest::testDestructor()
+{
+  std::atomic<bool> done{false};
+  std::promise<void> started;
+  {
+    ThreadPool pool(1);
+    pool.submit([&started, &done]() {
+      started.set_value();
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      done = true;
+    });
+    started.get_future().wait();
+  }
+  // The destructor waits for the running task.
+  CPPUNIT_ASSERT(done);
+}
+
+} // namespace aria2
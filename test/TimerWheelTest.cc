@@ -0,0 +1,132 @@
+#include "TimerWheel.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+
+namespace aria2 {
+
+class TimerWheelTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(TimerWheelTest);
+  CPPUNIT_TEST(testExpire);
+  CPPUNIT_TEST(testExpire_cascade);
+  CPPUNIT_TEST(testExpire_past);
+  CPPUNIT_TEST(testNextTimeout);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void testExpire();
+  void testExpire_cascade();
+  void testExpire_past();
+  void testNextTimeout();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TimerWheelTest);
+
+namespace {
+Command* cmd(uintptr_t n) { return reinterpret_cast<Command*>(n); }
+
+Timer at(int64_t ms) { return Timer(std::chrono::milliseconds(ms)); }
+} // namespace
+
+void TimerWheelTest::testExpire()
+{
+  TimerWheel wheel(std::chrono::milliseconds(10), at(0));
+  wheel.add(at(25), cmd(1));
+  wheel.add(at(20), cmd(2));
+  wheel.add(at(500), cmd(3));
+  CPPUNIT_ASSERT_EQUAL((size_t)3, wheel.size());
+
+  std::vector<Command*> res;
+  wheel.expire(at(19), res);
+  CPPUNIT_ASSERT(res.empty());
+
+  wheel.expire(at(20), res);
+  CPPUNIT_ASSERT_EQUAL((size_t)1, res.size());
+  CPPUNIT_ASSERT(cmd(2) == res[0]);
+
+  // 25ms is rounded up to 30ms
+  res.clear();
+  wheel.expire(at(29), res);
+  CPPUNIT_ASSERT(res.empty());
+  wheel.expire(at(30), res);
+  CPPUNIT_ASSERT_EQUAL((size_t)1, res.size());
+  CPPUNIT_ASSERT(cmd(1) == res[0]);
+
+  res.clear();
+  wheel.expire(at(499), res);
+  CPPUNIT_ASSERT(res.empty());
+  wheel.expire(at(1000), res);
+  CPPUNIT_ASSERT_EQUAL((size_t)1, res.size());
+  CPPUNIT_ASSERT(cmd(3) == res[0]);
+  CPPUNIT_ASSERT_EQUAL((size_t)0, wheel.size());
+}
+
+void TimerWheelTest::testExpire_cascade()
+{
+  TimerWheel wheel(std::chrono::milliseconds(1), at(0));
+  std::vector<Command*> res;
+  wheel.expire(at(100), res);
+  // Goes to the upper levels
+  wheel.add(at(100 + 5000), cmd(1));
+  wheel.add(at(100 + 300000), cmd(2));
+  wheel.add(at(100 + 64), cmd(3));
+
+  wheel.expire(at(100 + 63), res);
+  CPPUNIT_ASSERT(res.empty());
+  wheel.expire(at(100 + 64), res);
+  CPPUNIT_ASSERT_EQUAL((size_t)1, res.size());
+  CPPUNIT_ASSERT(cmd(3) == res[0]);
+
+  res.clear();
+  wheel.expire(at(100 + 4999), res);
+  CPPUNIT_ASSERT(res.empty());
+  wheel.expire(at(100 + 5000), res);
+  CPPUNIT_ASSERT_EQUAL((size_t)1, res.size());
+  CPPUNIT_ASSERT(cmd(1) == res[0]);
+
+  res.clear();
+  wheel.expire(at(100 + 299999), res);
+  CPPUNIT_ASSERT(res.empty());
+  wheel.expire(at(100 + 300000), res);
+  CPPUNIT_ASSERT_EQUAL((size_t)1, res.size());
+  CPPUNIT_ASSERT(cmd(2) == res[0]);
+}
+
+void TimerWheelTest::testExpire_past()
+{
+  TimerWheel wheel(std::chrono::milliseconds(10), at(0));
+  std::vector<Command*> res;
+  wheel.expire(at(1000), res);
+  wheel.add(at(500), cmd(1));
+  // Expired entries are processed in the next tick.
+  CPPUNIT_ASSERT_EQUAL((int64_t)10,
+                       (int64_t)wheel.nextTimeout(at(1000)).count());
+  wheel.expire(at(1010), res);
+  CPPUNIT_ASSERT_EQUAL((size_t)1, res.size());
+}
+
+void TimerWheelTest::testNextTimeout()
+{
+  TimerWheel wheel(std::chrono::milliseconds(10), at(0));
+  CPPUNIT_ASSERT(std::chrono::milliseconds::max() ==
+                 wheel.nextTimeout(at(0)));
+
+  wheel.add(at(300), cmd(1));
+  CPPUNIT_ASSERT_EQUAL((int64_t)295,
+                       (int64_t)wheel.nextTimeout(at(5)).count());
+
+  wheel.add(at(100000), cmd(2));
+  // cmd(1) is in the lowest level
+  CPPUNIT_ASSERT_EQUAL((int64_t)300,
+                       (int64_t)wheel.nextTimeout(at(0)).count());
+
+  std::vector<Command*> res;
+  wheel.expire(at(300), res);
+  CPPUNIT_ASSERT_EQUAL((size_t)1, res.size());
+  // cmd(2) is in level 2 and cascaded at tick 8192 (2 << 12), before
+  // its deadline.
+  CPPUNIT_ASSERT_EQUAL((int64_t)(81920 - 300),
+                       (int64_t)wheel.nextTimeout(at(300)).count());
+}
+
+} // namespace aria2
@@ -0,0 +1,108 @@
+#include "TokenBucket.h"
+
+#include <limits>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+namespace aria2 {
+
+class TokenBucketTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(TokenBucketTest);
+  CPPUNIT_TEST(testAvailable);
+  CPPUNIT_TEST(testConsume);
+  CPPUNIT_TEST(testUnlimited);
+  CPPUNIT_TEST(testParent);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void testAvailable();
+  void testConsume();
+  void testUnlimited();
+  void testParent();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TokenBucketTest);
+
+namespace {
+Timer at(int64_t ms) { return Timer(std::chrono::milliseconds(ms)); }
+} // namespace
+
+void TokenBucketTest::testAvailable()
+{
+  TokenBucket bucket(1000000);
+  CPPUNIT_ASSERT_EQUAL((size_t)0, bucket.available(at(1000)));
+  // Less than TokenBucket::MIN_AVAILABLE.
+  CPPUNIT_ASSERT_EQUAL((size_t)0, bucket.available(at(1010)));
+  CPPUNIT_ASSERT_EQUAL((size_t)20000, bucket.available(at(1020)));
+  // Capped by 100ms worth of tokens.
+  CPPUNIT_ASSERT_EQUAL((size_t)100000, bucket.available(at(5000)));
+
+  bucket.setRate(2000000);
+  CPPUNIT_ASSERT_EQUAL((size_t)0, bucket.available(at(5000)));
+  CPPUNIT_ASSERT_EQUAL((size_t)20000, bucket.available(at(5010)));
+  // Idle for a long time.
+  CPPUNIT_ASSERT_EQUAL((size_t)200000, bucket.available(at(3605000)));
+
+  // The bucket is smaller than TokenBucket::MIN_AVAILABLE.
+  bucket.setRate(10000);
+  bucket.available(at(5000));
+  CPPUNIT_ASSERT_EQUAL((size_t)0, bucket.available(at(5050)));
+  CPPUNIT_ASSERT_EQUAL((size_t)1000, bucket.available(at(5100)));
+}
+
+void TokenBucketTest::testConsume()
+{
+  TokenBucket bucket(1000000);
+  bucket.available(at(1000));
+  CPPUNIT_ASSERT_EQUAL((size_t)100000, bucket.available(at(2000)));
+  CPPUNIT_ASSERT_EQUAL((int64_t)0,
+                       (int64_t)bucket.timeToAvailable(at(2000)).count());
+  // Goes into debt.
+  bucket.consume(150000, at(2000));
+  CPPUNIT_ASSERT_EQUAL((size_t)0, bucket.available(at(2000)));
+  // 50000 + 16384 tokens are needed.
+  CPPUNIT_ASSERT_EQUAL((int64_t)67,
+                       (int64_t)bucket.timeToAvailable(at(2000)).count());
+  CPPUNIT_ASSERT_EQUAL((size_t)0, bucket.available(at(2066)));
+  CPPUNIT_ASSERT_EQUAL((int64_t)1,
+                       (int64_t)bucket.timeToAvailable(at(2066)).count());
+  CPPUNIT_ASSERT_EQUAL((size_t)17000, bucket.available(at(2067)));
+}
+
+void TokenBucketTest::testUnlimited()
+{
+  TokenBucket bucket;
+  CPPUNIT_ASSERT_EQUAL(std::numeric_limits<size_t>::max(),
+                       bucket.available(at(1000)));
+  bucket.consume(1000000, at(1000));
+  CPPUNIT_ASSERT_EQUAL(std::numeric_limits<size_t>::max(),
+                       bucket.available(at(1000)));
+  CPPUNIT_ASSERT_EQUAL((int64_t)0,
+                       (int64_t)bucket.timeToAvailable(at(1000)).count());
+}
+
+void TokenBucketTest::testParent()
+{
+  TokenBucket parent(1000000);
+  TokenBucket child1(0, &parent);
+  TokenBucket child2(500000, &parent);
+  parent.available(at(1000));
+  child2.available(at(1000));
+
+  CPPUNIT_ASSERT_EQUAL((size_t)100000, child1.available(at(2000)));
+  CPPUNIT_ASSERT_EQUAL((size_t)50000, child2.available(at(2000)));
+
+  child2.consume(30000, at(2000));
+  CPPUNIT_ASSERT_EQUAL((size_t)20000, child2.available(at(2000)));
+  CPPUNIT_ASSERT_EQUAL((size_t)70000, child1.available(at(2000)));
+
+  child1.consume(60000, at(2000));
+  CPPUNIT_ASSERT_EQUAL((size_t)0, child1.available(at(2000)));
+  // child2 has its own tokens, but the parent does not have enough.
+  CPPUNIT_ASSERT_EQUAL((size_t)0, child2.available(at(2000)));
+  CPPUNIT_ASSERT_EQUAL((int64_t)7,
+                       (int64_t)child2.timeToAvailable(at(2000)).count());
+}
+
+} // namespace aria2
@@ -315,6 +315,37 @@ void UDPTrackerClientTest::testRequestFailure()
     CPPUNIT_ASSERT(tr.getPendingRequests().empty());
     CPPUNIT_ASSERT(tr.getInflightRequests().empty());
   }
+  {
+    // The request fails after requestSent() is called.
+    std::shared_ptr<UDPTrackerRequest> req1(
+        createAnnounce("192.168.0.1", 6991, 0));
+    std::shared_ptr<UDPTrackerRequest> req2(
+        createAnnounce("192.168.0.1", 6991, 0));
+    std::shared_ptr<UDPTrackerRequest> req3(
+        createAnnounce("192.168.0.2", 6991, 0));
+
+    tr.addRequest(req1);
+    tr.addRequest(req2);
+    tr.addRequest(req3);
+    tr.createRequest(data, sizeof(data), remoteAddr, remotePort, now);
+    tr.requestSent(now);
+    tr.createRequest(data, sizeof(data), remoteAddr, remotePort, now);
+    tr.requestSent(now);
+    CPPUNIT_ASSERT_EQUAL((size_t)2, tr.getInflightRequests().size());
+    tr.requestFail("192.168.0.1", 6991, UDPT_ERR_NETWORK);
+    CPPUNIT_ASSERT_EQUAL((int)UDPT_STA_COMPLETE, req1->state);
+    CPPUNIT_ASSERT_EQUAL((int)UDPT_ERR_NETWORK, req1->error);
+    CPPUNIT_ASSERT_EQUAL((int)UDPT_STA_COMPLETE, req2->state);
+    CPPUNIT_ASSERT_EQUAL((int)UDPT_ERR_NETWORK, req2->error);
+    CPPUNIT_ASSERT_EQUAL((int)UDPT_STA_PENDING, req3->state);
+    CPPUNIT_ASSERT(tr.getConnectRequests().empty());
+    CPPUNIT_ASSERT_EQUAL((size_t)1, tr.getPendingRequests().size());
+    CPPUNIT_ASSERT_EQUAL((size_t)1, tr.getInflightRequests().size());
+    tr.requestFail("192.168.0.2", 6991, UDPT_ERR_NETWORK);
+    CPPUNIT_ASSERT_EQUAL((int)UDPT_STA_COMPLETE, req3->state);
+    CPPUNIT_ASSERT(tr.getPendingRequests().empty());
+    CPPUNIT_ASSERT(tr.getInflightRequests().empty());
+  }
   {
     std::shared_ptr<UDPTrackerRequest> req1(
         createAnnounce("192.168.0.1", 6991, 0));
@@ -388,6 +419,7 @@ void UDPTrackerClientTest::testTimeout()
   Timer now;
   UDPTrackerClient tr;
   std::shared_ptr<UDPTrackerRequest> recvReq;
+  Timer deadline;
 
   {
     std::shared_ptr<UDPTrackerRequest> req1(
@@ -397,10 +429,13 @@ void UDPTrackerClientTest::testTimeout()
 
     tr.addRequest(req1);
     tr.addRequest(req2);
+    CPPUNIT_ASSERT(!tr.getNextDeadline(deadline));
     rv = tr.createRequest(data, sizeof(data), remoteAddr, remotePort, now);
     CPPUNIT_ASSERT_EQUAL((int)UDPT_ACT_CONNECT,
                          (int)bittorrent::getIntParam(data, 8));
     tr.requestSent(now);
+    CPPUNIT_ASSERT(tr.getNextDeadline(deadline));
+    CPPUNIT_ASSERT(std::chrono::seconds(5) == now.difference(deadline));
     now.advance(20_s);
     // 15 seconds 1st stage timeout passed
     tr.handleTimeout(now);
@@ -0,0 +1,61 @@
+#include "ValueBaseStructWriter.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "ValueBase.h"
+#include "json.h"
+
+namespace aria2 {
+
+class ValueBaseStructWriterTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(ValueBaseStructWriterTest);
+  CPPUNIT_TEST(testWrite);
+  CPPUNIT_TEST(testWrite_container);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void testWrite();
+  void testWrite_container();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ValueBaseStructWriterTest);
+
+void ValueBaseStructWriterTest::testWrite()
+{
+  ValueBaseStructWriter w;
+  w.beginList();
+  w.beginDict();
+  w.put("size", 1000);
+  w.put("name", "aria2");
+  w.key("uris");
+  w.beginList();
+  w.value("http://localhost/");
+  w.endList();
+  w.endDict();
+  w.value("end");
+  w.endList();
+  auto res = w.getResult();
+  CPPUNIT_ASSERT(downcast<List>(res));
+  CPPUNIT_ASSERT_EQUAL(std::string("[{\"name\":\"aria2\",\"size\":1000,"
+                                   "\"uris\":[\"http:\\/\\/localhost\\/\"]},"
+                                   "\"end\"]"),
+                       json::encode(res.get()));
+}
+
+void ValueBaseStructWriterTest::testWrite_container()
+{
+  auto dict = Dict::g();
+  dict->put("gid", "2089b05ecca3d829");
+  ValueBaseStructWriter w(dict.get());
+  w.put("status", "active");
+  w.key("files");
+  w.beginList();
+  w.endList();
+  CPPUNIT_ASSERT(!w.getResult());
+  CPPUNIT_ASSERT_EQUAL(std::string("{\"files\":[],\"gid\":\"2089b05ecca3d829\","
+                                   "\"status\":\"active\"}"),
+                       json::encode(dict.get()));
+}
+
+} // namespace aria2
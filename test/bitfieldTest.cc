@@ -2,7 +2,11 @@
 
 #include <cppunit/extensions/HelperMacros.h>
 
+#include <vector>
+#include <iterator>
+
 #include "TimerA2.h"
+#include "array_fun.h"
 
 namespace aria2 {
 
@@ -13,6 +17,11 @@ class bitfieldTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(testCountBit32);
   CPPUNIT_TEST(testCountSetBit);
   CPPUNIT_TEST(testLastByteMask);
+  CPPUNIT_TEST(testCountBit64);
+  CPPUNIT_TEST(testLoadWord);
+  CPPUNIT_TEST(testGetFirstSetBitIndex);
+  CPPUNIT_TEST(testGetFirstNSetBitIndex);
+  CPPUNIT_TEST(testIsBitRangeSet);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -21,6 +30,11 @@ public:
   void testCountBit32();
   void testCountSetBit();
   void testLastByteMask();
+  void testCountBit64();
+  void testLoadWord();
+  void testGetFirstSetBitIndex();
+  void testGetFirstNSetBitIndex();
+  void testIsBitRangeSet();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(bitfieldTest);
@@ -71,4 +85,88 @@ void bitfieldTest::testLastByteMask()
                        (unsigned int)bitfield::lastByteMask(16));
 }
 
+void bitfieldTest::testCountBit64()
+{
+  CPPUNIT_ASSERT_EQUAL((size_t)64, bitfield::countBit64(UINT64_MAX));
+  CPPUNIT_ASSERT_EQUAL((size_t)0, bitfield::countBit64(0));
+  CPPUNIT_ASSERT_EQUAL((size_t)9, bitfield::countBit64(0x80000000000000ffULL));
+  CPPUNIT_ASSERT_EQUAL((size_t)0, bitfield::countLeadingZero64(UINT64_MAX));
+  CPPUNIT_ASSERT_EQUAL((size_t)63, bitfield::countLeadingZero64(1));
+}
+
+void bitfieldTest::testLoadWord()
+{
+  unsigned char a[] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08};
+  unsigned char b[] = {0xff, 0x00, 0xff, 0x00, 0xff, 0x00, 0xff, 0x00};
+  CPPUNIT_ASSERT_EQUAL((uint64_t)0x0102030405060708ULL,
+                       bitfield::loadWord(a, 0));
+  CPPUNIT_ASSERT_EQUAL((uint64_t)0x0102030405060708ULL,
+                       bitfield::loadWord(expr::array(a), 0));
+  CPPUNIT_ASSERT_EQUAL((uint64_t)0x0002000400060008ULL,
+                       bitfield::loadWord(expr::array(a) & ~expr::array(b), 0));
+  unsigned char c[8];
+  bitfield::storeWord(c, 0, 0x0102030405060708ULL);
+  CPPUNIT_ASSERT(memcmp(a, c, sizeof(a)) == 0);
+}
+
+void bitfieldTest::testGetFirstSetBitIndex()
+{
+  std::vector<unsigned char> bitfield(32);
+  size_t index;
+  CPPUNIT_ASSERT(!bitfield::getFirstSetBitIndex(index, bitfield, 256));
+  bitfield[31] = 0x01;
+  CPPUNIT_ASSERT(!bitfield::getFirstSetBitIndex(index, bitfield, 255));
+  CPPUNIT_ASSERT(bitfield::getFirstSetBitIndex(index, bitfield, 256));
+  CPPUNIT_ASSERT_EQUAL((size_t)255, index);
+  bitfield[9] = 0x10;
+  CPPUNIT_ASSERT(bitfield::getFirstSetBitIndex(index, bitfield, 256));
+  CPPUNIT_ASSERT_EQUAL((size_t)75, index);
+  CPPUNIT_ASSERT(bitfield::getFirstSetBitIndex(
+      index, expr::array(bitfield.data()), 256));
+  CPPUNIT_ASSERT_EQUAL((size_t)75, index);
+  CPPUNIT_ASSERT(bitfield::getFirstSetBitIndex(
+      index, ~expr::array(bitfield.data()), 256));
+  CPPUNIT_ASSERT_EQUAL((size_t)0, index);
+}
+
+void bitfieldTest::testGetFirstNSetBitIndex()
+{
+  std::vector<unsigned char> bitfield(20);
+  bitfield[0] = 0x80;
+  bitfield[8] = 0x41;
+  bitfield[19] = 0xff;
+  std::vector<size_t> out;
+  CPPUNIT_ASSERT_EQUAL((size_t)5, bitfield::getFirstNSetBitIndex(
+                                      std::back_inserter(out), 5,
+                                      expr::array(bitfield.data()), 156));
+  CPPUNIT_ASSERT_EQUAL((size_t)5, out.size());
+  CPPUNIT_ASSERT_EQUAL((size_t)0, out[0]);
+  CPPUNIT_ASSERT_EQUAL((size_t)65, out[1]);
+  CPPUNIT_ASSERT_EQUAL((size_t)71, out[2]);
+  CPPUNIT_ASSERT_EQUAL((size_t)152, out[3]);
+  CPPUNIT_ASSERT_EQUAL((size_t)153, out[4]);
+  out.clear();
+  CPPUNIT_ASSERT_EQUAL((size_t)7, bitfield::getFirstNSetBitIndex(
+                                      std::back_inserter(out), 10,
+                                      expr::array(bitfield.data()), 156));
+  CPPUNIT_ASSERT_EQUAL((size_t)155, out[6]);
+}
+
+void bitfieldTest::testIsBitRangeSet()
+{
+  std::vector<unsigned char> bitfield(32, 0xff);
+  CPPUNIT_ASSERT(bitfield::isBitRangeSet(bitfield.data(), 0, 255));
+  CPPUNIT_ASSERT(bitfield::isBitRangeSet(bitfield.data(), 3, 5));
+  bitfield[20] = 0xfe;
+  CPPUNIT_ASSERT(!bitfield::isBitRangeSet(bitfield.data(), 0, 255));
+  CPPUNIT_ASSERT(!bitfield::isBitRangeSet(bitfield.data(), 167, 167));
+  CPPUNIT_ASSERT(bitfield::isBitRangeSet(bitfield.data(), 160, 166));
+  CPPUNIT_ASSERT(bitfield::isBitRangeSet(bitfield.data(), 168, 255));
+  CPPUNIT_ASSERT(!bitfield::isBitRangeSet(bitfield.data(), 9, 200));
+  bitfield[20] = 0xff;
+  bitfield[2] = 0x00;
+  CPPUNIT_ASSERT(!bitfield::isBitRangeSet(bitfield.data(), 9, 200));
+  CPPUNIT_ASSERT(bitfield::isBitRangeSet(bitfield.data(), 24, 200));
+}
+
 } // namespace aria2